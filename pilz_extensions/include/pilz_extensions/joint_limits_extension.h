@@ -25,6 +25,8 @@ namespace joint_limits_interface {
 
 /**
  * @brief Extends joint_limits_interface::JointLimits with a deceleration parameter
+ *
+ * The jerk limit (has_jerk_limits, max_jerk) is inherited from joint_limits_interface::JointLimits.
  */
 struct JointLimits : ::joint_limits_interface::JointLimits {
   JointLimits()
@@ -45,6 +45,8 @@ TEST_F(JointLimitTest, SimpleRead) {
 
   EXPECT_EQ(1, joint_limits_extended.max_acceleration);
   EXPECT_EQ(-1, joint_limits_extended.max_deceleration);
+  EXPECT_TRUE(joint_limits_extended.has_jerk_limits);
+  EXPECT_EQ(10, joint_limits_extended.max_jerk);
 }
 
 /**
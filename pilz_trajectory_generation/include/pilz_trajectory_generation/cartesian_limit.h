@@ -89,6 +89,26 @@ public:
    */
   double getMaxTranslationalDeceleration() const;
 
+  // Translational Jerk Limit
+
+  /**
+   * @brief Check if translational jerk limit is set.
+   * @return True if limit was set false otherwise
+   */
+  bool hasMaxTranslationalJerk() const;
+
+  /**
+   * @brief Set the maximum translational jerk
+   * @param Maximum translational jerk [m/s^3]
+   */
+  void setMaxTranslationalJerk(double max_trans_jerk);
+
+  /**
+   * @brief Return the maximal translational jerk [m/s^3], 0 if nothing was set
+   * @return maximal translational jerk, 0 if nothing was set
+   */
+  double getMaxTranslationalJerk() const;
+
   // Rotational Velocity Limit
 
   /**
@@ -128,6 +148,12 @@ private:
   ///    Maximum translational deceleration, always <=0 [m/s^2]
   double max_trans_dec_;
 
+  ///    Flag if a maximum translational jerk was set
+  bool   has_max_trans_jerk_;
+
+  ///    Maximum translational jerk [m/s^3]
+  double max_trans_jerk_;
+
   ///    Flag if a maximum rotational velocity was set
   bool   has_max_rot_vel_;
 
@@ -37,6 +37,7 @@ class CartesianLimitsAggregator
      * - "max_trans_vel", the maximum translational velocity [m/s]
      * - "max_trans_acc, the maximum translational acceleration [m/s^2]
      * - "max_trans_dec", the maximum translational deceleration (<= 0) [m/s^2]
+     * - "max_trans_jerk", the maximum translational jerk (optional) [m/s^3]
      * - "max_rot_vel", the maximum rotational velocity [rad/s]
      * - "max_rot_acc", the maximum rotational acceleration [rad/s^2]
      * - "max_rot_dec", the maximum rotational deceleration (<= 0)[rad/s^2]
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CARTESIAN_PATH_H
+#define CARTESIAN_PATH_H
+
+#include <vector>
+
+#include <Eigen/Geometry>
+
+#include "pilz_trajectory_generation/tip_pose_track.h"
+
+namespace pilz {
+
+/**
+ * @brief Geometric Cartesian path of a link, parametrized by its path length.
+ *
+ * The orientation is interpolated around the single axis which rotates the start into the goal orientation.
+ * As in KDL, translation and rotation are combined by an equivalent radius: the path length is the longer one of the
+ * translational distance and the rotation angle times the equivalent radius, the other motion is scaled to it.
+ */
+class CartesianPath
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  virtual ~CartesianPath(){}
+
+  /// length of the path, the path parameter ranges from 0 to the path length
+  double getPathLength() const {return path_length_;}
+
+  /**
+   * @brief pose at the path parameter s
+   */
+  virtual Eigen::Affine3d getPose(double s) const = 0;
+
+  /**
+   * @brief evaluate the poses at all path parameters in one call
+   * @param path_parameters: path parameters of the poses
+   * @param poses: the poses, resized to the number of path parameters
+   */
+  virtual void getPoses(const std::vector<double>& path_parameters, PoseVector& poses) const = 0;
+
+protected:
+  CartesianPath(const Eigen::Matrix3d& start_orientation, const Eigen::Matrix3d& goal_orientation);
+
+  /**
+   * @brief set the path length and the scaling of translation and rotation
+   * @param distance: translational distance of the path
+   * @param eqradius: equivalent radius converting the rotation angle into a distance
+   */
+  void setPathLength(double distance, double eqradius);
+
+  /// orientation at the path parameter s
+  Eigen::Matrix3d orientation(double s) const
+  {
+    return (start_orientation_ * Eigen::Quaterniond(Eigen::AngleAxisd(s*scale_rotation_, rotation_axis_)))
+        .toRotationMatrix();
+  }
+
+protected:
+  Eigen::Quaterniond start_orientation_;
+
+  /// axis of the rotation from start to goal orientation in the start frame
+  Eigen::Vector3d rotation_axis_;
+
+  /// angle of the rotation from start to goal orientation in [0, pi]
+  double rotation_angle_;
+
+  double path_length_ {0};
+
+  /// translational distance per path length
+  double scale_translation_ {1};
+
+  /// rotation angle per path length
+  double scale_rotation_ {1};
+};
+
+/**
+ * @brief Straight line from the start to the goal pose
+ */
+class CartesianPathLine : public CartesianPath
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * @param eqradius: equivalent radius, ratio of the translational and the rotational velocity
+   */
+  CartesianPathLine(const Eigen::Affine3d& start_pose, const Eigen::Affine3d& goal_pose, double eqradius);
+
+  virtual Eigen::Affine3d getPose(double s) const override;
+
+  virtual void getPoses(const std::vector<double>& path_parameters, PoseVector& poses) const override;
+
+private:
+  Eigen::Vector3d start_position_;
+
+  /// unit vector from start to goal position
+  Eigen::Vector3d direction_;
+};
+
+/**
+ * @brief Circular arc around a center point from the start pose, the orientation ends at the goal orientation
+ */
+class CartesianPathCircle : public CartesianPath
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * @param start_pose: start of the arc
+   * @param center_point: center of the circle
+   * @param plane_point: point in the plane of the circle, defines the direction of the motion together with the start
+   * @param goal_orientation: orientation at the end of the arc
+   * @param angle: angle of the arc
+   * @param eqradius: equivalent radius, ratio of the translational and the rotational velocity
+   * @throws KDL::Error_MotionPlanning_Circle_ToSmall if the start is at the center point
+   * @throws KDL::Error_MotionPlanning_Circle_No_Plane if the start, center and plane point are colinear
+   */
+  CartesianPathCircle(const Eigen::Affine3d& start_pose,
+                      const Eigen::Vector3d& center_point,
+                      const Eigen::Vector3d& plane_point,
+                      const Eigen::Matrix3d& goal_orientation,
+                      double angle,
+                      double eqradius);
+
+  virtual Eigen::Affine3d getPose(double s) const override;
+
+  virtual void getPoses(const std::vector<double>& path_parameters, PoseVector& poses) const override;
+
+  double getRadius() const {return radius_;}
+
+private:
+  Eigen::Vector3d center_point_;
+  double radius_;
+
+  /// unit vectors in the circle plane, from the center to the start and in direction of the motion
+  Eigen::Vector3d x_axis_, y_axis_;
+};
+
+}
+
+#endif // CARTESIAN_PATH_H
@@ -18,9 +18,11 @@
 #define COMMAND_LIST_MANAGER_H
 
 #include <moveit/planning_interface/planning_interface.h>
+#include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit_msgs/MotionPlanResponse.h>
 
 #include "pilz_msgs/MotionBlendRequestList.h"
+#include "pilz_trajectory_generation/tip_pose_track.h"
 #include "pilz_trajectory_generation/trajectory_blender.h"
 
 namespace pilz_trajectory_generation {
@@ -37,6 +39,9 @@ public:
 
   /**
    * @brief CommandListManager
+   *
+   * The planning pipeline which solves the single requests is loaded once from the given node handle and kept for the
+   * lifetime of the manager, so its plan cache and thread pool are reused by all sequences.
    * @param model The robot model
    */
   CommandListManager(const ros::NodeHandle& nh, const robot_model::RobotModelConstPtr& model);
@@ -68,12 +73,14 @@ private:
   /**
    * @brief Validates that two consecutive blending radii do not overlap
    * @param motion_plan_responses List of responses from the trajectory generator. Contains the trajectories.
+   * @param tip_pose_tracks Poses of the tip frame for each response, nullptr where the generator did not sample them
    * @param radii List with the blending radii
    * @param group_name The group to consider
    * @return True if there is no overlap, false otherwise
    */
   bool validateBlendingRadiiDoNotOverlap(
       const std::vector<planning_interface::MotionPlanResponse>& motion_plan_responses,
+      const std::vector<pilz::TipPoseTrackConstPtr>& tip_pose_tracks,
       const std::vector<double>& radii,
       const std::string& group_name);
 
@@ -83,6 +90,7 @@ private:
    * @param req_list The motion plan request list
    * @param res The response used to set the error code on validation error
    * @param motion_plan_responses Essentially constains the generated trajectories
+   * @param tip_pose_tracks Poses of the tip frame for each response, nullptr where the generator did not sample them
    * @param radii List of blending radii
    * @return True if trajectories for all request could be generated
    */
@@ -90,17 +98,32 @@ private:
                      const pilz_msgs::MotionBlendRequestList &req_list,
                      planning_interface::MotionPlanResponse &res,
                      std::vector<planning_interface::MotionPlanResponse>& motion_plan_responses,
+                     std::vector<pilz::TipPoseTrackConstPtr>& tip_pose_tracks,
                      std::vector<double>& radii);
 
+  /**
+   * @brief Solves a single request with the planning pipeline
+   *
+   * Without request adapters and path checks the pipeline only passes on the response of the planner. The planning
+   * context is then solved directly to obtain the tip pose track of the generator as well.
+   * @param[out] tip_pose_track Poses of the tip frame at the way points, nullptr if the planner did not provide them
+   */
+  void generatePlan(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                    const planning_interface::MotionPlanRequest& req,
+                    planning_interface::MotionPlanResponse& res,
+                    pilz::TipPoseTrackConstPtr& tip_pose_track);
+
   /**
    * @brief Blends all trajectories inside motion_plan_responses with the given radii
    * @param motion_plan_responses Essentially constains the generated trajectories
+   * @param tip_pose_tracks Poses of the tip frame for each response, nullptr where the generator did not sample them
    * @param radii List of blending radii
    * @param result_trajectory
    * @param res The response used to set the error code on validation error
    * @return True if blending succeeded, false otherwise. On false the res will contain the error code.
    */
   bool blend(const std::vector<planning_interface::MotionPlanResponse> &motion_plan_responses,
+             const std::vector<pilz::TipPoseTrackConstPtr>& tip_pose_tracks,
              const std::vector<double> &radii,
              robot_trajectory::RobotTrajectoryPtr& result_trajectory,
              planning_interface::MotionPlanResponse &res);
@@ -120,6 +143,9 @@ private:
 
   /// TrajectoryBlender
   std::unique_ptr<pilz::TrajectoryBlender> blender_;
+
+  /// Planning pipeline solving the single requests of all sequences
+  planning_pipeline::PlanningPipelinePtr planning_pipeline_;
 };
 
 }
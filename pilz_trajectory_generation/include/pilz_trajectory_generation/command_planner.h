@@ -90,6 +90,18 @@ public:
    */
   void registerContextLoader(pilz::PlanningContextLoaderPtr planning_context_loader);
 
+  /**
+   * @brief Returns the cache of solved requests shared by all contexts, e.g. to read its hit and miss counters
+   * @return the cache or nullptr if the option "plan_cache" is disabled
+   */
+  pilz::PlanCacheConstPtr getPlanCache() const {return plan_cache_;}
+
+  /**
+   * @brief Returns the thread pool shared by the planning contexts
+   * @return the pool or nullptr before initialize() or if the option "parallel_ik" is disabled
+   */
+  pilz::ThreadPoolPtr getThreadPool() const {return generator_options_.thread_pool;}
+
 private:
 
   /// Plugin loader
@@ -109,6 +121,12 @@ private:
 
   /// cartesian limit
   pilz::CartesianLimit cartesian_limit_;
+
+  /// options of the trajectory generators
+  pilz::GeneratorOptions generator_options_;
+
+  /// cache of solved requests, recreated at initialize since the model and the limits may have changed
+  pilz::PlanCachePtr plan_cache_;
 };
 
 MOVEIT_CLASS_FORWARD(CommandPlanner)
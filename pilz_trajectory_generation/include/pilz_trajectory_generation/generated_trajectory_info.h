@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENERATED_TRAJECTORY_INFO_H
+#define GENERATED_TRAJECTORY_INFO_H
+
+#include "pilz_trajectory_generation/tip_pose_track.h"
+
+namespace pilz {
+
+/**
+ * @brief Scaling factors a trajectory was generated with.
+ *
+ * The generators may reduce the factors of the request, e.g. by the velocity scaling search of LIN and CIRC.
+ */
+struct TrajectoryScaling
+{
+  double velocity_scaling_factor {1.};
+  double acceleration_scaling_factor {1.};
+};
+
+/**
+ * @brief Results of the trajectory generation besides the motion plan response.
+ */
+struct GeneratedTrajectoryInfo
+{
+  /// poses of the target link at the way points of the trajectory, nullptr if the generator did not sample poses
+  TipPoseTrackConstPtr tip_pose_track;
+
+  /// scaling factors of the trajectory, lower than the factors of the request if the generator reduced them
+  TrajectoryScaling scaling;
+};
+
+}
+
+#endif // GENERATED_TRAJECTORY_INFO_H
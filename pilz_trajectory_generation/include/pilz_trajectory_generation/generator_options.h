@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENERATOR_OPTIONS_H
+#define GENERATOR_OPTIONS_H
+
+#include "pilz_trajectory_generation/thread_pool.h"
+
+namespace pilz {
+
+/**
+ * @brief Options of the trajectory generators which do not belong to the robot description.
+ *
+ * The defaults reproduce the plain sequential sampling of the generators.
+ */
+struct GeneratorOptions
+{
+  /// number of worker threads of the pool shared by all planners of the process, 0 uses the number of hardware
+  /// threads, the pool keeps the size of the first planner creating it
+  unsigned int thread_pool_size {0};
+
+  /// workers of the parallel tasks, the command planner uses the shared pool if parallel_ik is enabled,
+  /// tasks are executed sequentially without a pool
+  ThreadPoolPtr thread_pool;
+
+  /// solve the IK of long Cartesian trajectories in parallel chunks
+  bool parallel_ik {false};
+
+  /// number of chunks solved in parallel, 0 uses the number of workers of the thread pool
+  unsigned int parallel_ik_threads {0};
+
+  /// minimal number of samples of a trajectory to solve its IK in parallel
+  unsigned int parallel_ik_min_samples {200};
+
+  /// solve the IK of Cartesian trajectories only at knots and interpolate in joint space in between
+  bool adaptive_sampling {false};
+
+  /// maximal number of samples between two initial knots of the adaptive sampling
+  unsigned int adaptive_sampling_max_knot_interval {16};
+
+  /// maximal translational deviation of an interpolated sample from the Cartesian path [m]
+  double adaptive_sampling_position_tolerance {1e-4};
+
+  /// maximal rotational deviation of an interpolated sample from the Cartesian path [rad]
+  double adaptive_sampling_orientation_tolerance {1e-3};
+
+  /// refine the solution predicted from the previous samples by Jacobian steps before calling the IK solver
+  bool differential_ik {false};
+
+  /// maximal number of Jacobian steps of the differential IK
+  unsigned int differential_ik_max_iterations {3};
+
+  /// maximal translational residual of a differential IK solution [m]
+  double differential_ik_position_tolerance {1e-5};
+
+  /// maximal rotational residual of a differential IK solution [rad]
+  double differential_ik_orientation_tolerance {1e-4};
+
+  /// select the nearest of all IK solutions of an analytic solver plugin like IKFast
+  bool ik_nearest_solution {false};
+
+  /// use the jerk limited VelocityProfile_SCurve if jerk limits are given, otherwise the trapezoidal profiles
+  bool jerk_limited_profile {false};
+
+  /// cache the trajectories of solved requests and return them for repeated requests
+  bool plan_cache {false};
+
+  /// maximal number of trajectories in the plan cache, the least recently used one is evicted
+  unsigned int plan_cache_capacity {64};
+
+  /// quantization step of the start joint positions in the key of the plan cache [rad or m], velocities are exact,
+  /// should stay well below the start state tolerance of the controller
+  double plan_cache_joint_resolution {1e-4};
+
+  /// reduce the scaling factors of LIN/CIRC to the largest feasible ones instead of failing on a joint limit violation
+  bool velocity_scaling_search {false};
+
+  /// relative margin below the computed feasible time scaling, absorbs the deviations of the resampling
+  double velocity_scaling_search_margin {0.01};
+
+  /// plan LIN/CIRC with the time optimal velocity profile under the joint and Cartesian limits
+  bool time_optimal_parameterization {false};
+
+  /// step of the path length grid on which the time optimal profile is computed, the linear interpolation of the joint
+  /// path between the grid points should deviate less than the adaptive sampling tolerances [m]
+  double time_optimal_grid_step {0.005};
+
+  /// approximate the LIN path by joint space interpolation between IK knots, set by the loader of planner id LIN_APPROX
+  bool lin_approximation {false};
+
+  /// maximal translational deviation of the joint space approximation from the LIN path [m]
+  double lin_approximation_position_tolerance {1e-3};
+
+  /// maximal rotational deviation of the joint space approximation from the LIN path [rad]
+  double lin_approximation_orientation_tolerance {1e-2};
+
+  /// check the manipulability at sparse points of the LIN/CIRC path before the dense sampling
+  bool singularity_prescan {false};
+
+  /// number of intervals between the points of the pre-scan
+  unsigned int singularity_prescan_intervals {20};
+
+  /// minimal ratio of the smallest to the largest singular value of the Jacobian along the path
+  double singularity_prescan_min_manipulability {5e-3};
+
+  /// align blended trajectories by the interpolated crossing times of the blend sphere instead of the times of the
+  /// intersection points, changes the timing of every blend
+  bool blend_crossing_time_alignment {false};
+};
+
+}
+
+#endif // GENERATOR_OPTIONS_H
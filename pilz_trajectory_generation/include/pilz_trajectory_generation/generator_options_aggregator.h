@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENERATOR_OPTIONS_AGGREGATOR_H
+#define GENERATOR_OPTIONS_AGGREGATOR_H
+
+#include <ros/node_handle.h>
+
+#include "pilz_trajectory_generation/generator_options.h"
+
+namespace pilz {
+
+/**
+ * @brief Obtains the options of the trajectory generators from the parameter server
+ */
+class GeneratorOptionsAggregator
+{
+  public:
+
+   /**
+     * @brief Loads the generator options from the parameter server
+     *
+     * The parameters are expected to be under "~/trajectory_generation" of the given node handle.
+     * Options which are not specified keep their default value.
+     * The following options can be specified:
+     * - "thread_pool_size", number of worker threads shared by all planners, 0 for the number of hardware
+     *   threads [int]
+     * - "parallel_ik", solve the IK of long Cartesian trajectories in parallel chunks [bool]
+     * - "parallel_ik_threads", number of chunks, 0 for the number of workers of the thread pool [int]
+     * - "parallel_ik_min_samples", minimal number of samples to solve the IK in parallel [int]
+     * - "adaptive_sampling", solve the IK only at knots and interpolate in joint space in between [bool]
+     * - "adaptive_sampling_max_knot_interval", maximal number of samples between two initial knots [int]
+     * - "adaptive_sampling_position_tolerance", maximal translational deviation from the path [double, m]
+     * - "adaptive_sampling_orientation_tolerance", maximal rotational deviation from the path [double, rad]
+     * - "differential_ik", refine predicted solutions by Jacobian steps before calling the IK solver [bool]
+     * - "differential_ik_max_iterations", maximal number of Jacobian steps [int]
+     * - "differential_ik_position_tolerance", maximal translational residual [double, m]
+     * - "differential_ik_orientation_tolerance", maximal rotational residual [double, rad]
+     * - "ik_nearest_solution", select the nearest of all solutions of an analytic IK solver plugin [bool]
+     * - "jerk_limited_profile", use the jerk limited velocity profile if jerk limits are given [bool]
+     * - "plan_cache", return the cached trajectories of repeated requests [bool]
+     * - "plan_cache_capacity", maximal number of cached trajectories [int]
+     * - "plan_cache_joint_resolution", quantization step of the start joint positions [double, rad or m]
+     * - "velocity_scaling_search", reduce the scaling of LIN/CIRC to the largest feasible one [bool]
+     * - "velocity_scaling_search_margin", relative margin below the feasible time scaling [double, 0 to 1]
+     * - "time_optimal_parameterization", plan LIN/CIRC with the time optimal profile under the joint limits [bool]
+     * - "time_optimal_grid_step", step of the path length grid of the time optimal profile [double, positive]
+     * - "lin_approximation_position_tolerance", translational tolerance of LIN_APPROX [double, positive]
+     * - "lin_approximation_orientation_tolerance", rotational tolerance of LIN_APPROX [double, positive]
+     * - "singularity_prescan", check the manipulability along LIN/CIRC before the dense sampling [bool]
+     * - "singularity_prescan_intervals", number of intervals between the points of the pre-scan [int, positive]
+     * - "singularity_prescan_min_manipulability", minimal inverse condition number of the Jacobian [double, [0, 1)]
+     * - "blend_crossing_time_alignment", align blends by the interpolated crossing times of the sphere [bool]
+     * @param nh node handle to access the parameters
+     * @return the obtained options
+     */
+    static GeneratorOptions getAggregatedOptions(const ros::NodeHandle& nh);
+};
+
+}
+
+#endif // GENERATOR_OPTIONS_AGGREGATOR_H
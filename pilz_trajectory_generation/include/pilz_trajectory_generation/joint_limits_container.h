@@ -75,6 +75,14 @@ public:
    */
   pilz_extensions::JointLimit getLimit(const std::string& joint_name) const;
 
+  /**
+   * @brief getLimits get the limits of multiple joints as a flat table
+   * @param joint_names
+   * @return joint_limits in the order of joint_names, joints without limit get a limit with all
+   * has_[position|velocity|...]_limits flags set to false
+   */
+  std::vector<pilz_extensions::JointLimit> getLimits(const std::vector<std::string>& joint_names) const;
+
   /**
    * @brief ConstIterator to the underlying data structure
    * @return
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOINT_LIMITS_TABLE_H
+#define JOINT_LIMITS_TABLE_H
+
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "pilz_extensions/joint_limits_extension.h"
+
+namespace pilz {
+
+/**
+ * @brief Flat table of the velocity, acceleration and deceleration limits of a list of joints.
+ *
+ * All limits are stored as absolute values, joints without a limit are represented by infinity.
+ * The table is meant for the batch verification of complete trajectories.
+ */
+struct JointLimitsTable
+{
+  JointLimitsTable() = default;
+
+  /**
+   * @brief Constructor
+   * @param joint_limits: limits of the joints, defines the order of the table
+   */
+  explicit JointLimitsTable(const std::vector<pilz_extensions::JointLimit>& joint_limits);
+
+  Eigen::VectorXd max_velocity;
+  Eigen::VectorXd max_acceleration;
+  Eigen::VectorXd max_deceleration;
+};
+
+}
+
+#endif // JOINT_LIMITS_TABLE_H
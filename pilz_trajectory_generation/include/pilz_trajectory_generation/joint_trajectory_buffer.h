@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOINT_TRAJECTORY_BUFFER_H
+#define JOINT_TRAJECTORY_BUFFER_H
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+#include "pilz_trajectory_generation/tip_pose_track.h"
+
+namespace pilz {
+
+/**
+ * @brief Compact storage of a sampled joint trajectory.
+ *
+ * Positions, velocities and accelerations of all points are stored in flat arrays which are allocated once
+ * by reserve(). The generators fill the buffer and convert it directly into a robot trajectory, the message
+ * representation is only created on demand by toMsg().
+ *
+ * Note: The maps returned by positions(), velocities() and accelerations() are invalidated by addPoint().
+ */
+class JointTrajectoryBuffer
+{
+public:
+  JointTrajectoryBuffer() = default;
+
+  /**
+   * @brief Constructor
+   * @param joint_names: names of the joints, defines the order of the joint values of each point
+   */
+  explicit JointTrajectoryBuffer(const std::vector<std::string>& joint_names);
+
+  /**
+   * @brief set the names of the joints, all points are removed
+   */
+  void setJointNames(const std::vector<std::string>& joint_names);
+
+  const std::vector<std::string>& getJointNames() const {return joint_names_;}
+  std::size_t getJointCount() const {return joint_names_.size();}
+
+  /**
+   * @brief allocate the memory of the given number of points
+   */
+  void reserve(std::size_t point_count);
+
+  /**
+   * @brief remove all points and the tip pose track, the joint names and the allocated memory are kept
+   */
+  void clear();
+
+  std::size_t size() const {return times_.size();}
+  bool empty() const {return times_.empty();}
+
+  /**
+   * @brief append a point with all joint values set to zero
+   * @param time_from_start: time of the point
+   * @return index of the new point
+   */
+  std::size_t addPoint(double time_from_start);
+
+  double getTimeFromStart(std::size_t index) const {return times_[index];}
+
+  Eigen::Map<Eigen::VectorXd> positions(std::size_t index);
+  Eigen::Map<const Eigen::VectorXd> positions(std::size_t index) const;
+  Eigen::Map<Eigen::VectorXd> velocities(std::size_t index);
+  Eigen::Map<const Eigen::VectorXd> velocities(std::size_t index) const;
+  Eigen::Map<Eigen::VectorXd> accelerations(std::size_t index);
+  Eigen::Map<const Eigen::VectorXd> accelerations(std::size_t index) const;
+
+  /**
+   * @brief set the poses of the sampled link at all points, they are attached to the robot trajectory of the response
+   */
+  void setTipPoseTrack(const TipPoseTrackConstPtr& track) {tip_pose_track_ = track;}
+  const TipPoseTrackConstPtr& getTipPoseTrack() const {return tip_pose_track_;}
+
+  /**
+   * @brief convert into a joint trajectory message
+   */
+  void toMsg(trajectory_msgs::JointTrajectory& joint_trajectory) const;
+
+  /**
+   * @brief convert into a robot trajectory, equivalent to RobotTrajectory::setRobotTrajectoryMsg()
+   *
+   * The variable indices of the joints are resolved once instead of matching the names for each point. The transforms
+   * of each way point are updated.
+   * @param reference_state: state of all joints which are not part of the buffer
+   * @param trajectory: the robot trajectory, existing way points are removed
+   * @return false if a joint is unknown to the robot model
+   */
+  bool toRobotTrajectory(const robot_state::RobotState& reference_state,
+                         robot_trajectory::RobotTrajectory& trajectory) const;
+
+private:
+  std::vector<std::string> joint_names_;
+  std::vector<double> times_;
+  /// joint values of all points, the values of one point are stored consecutively
+  std::vector<double> positions_;
+  std::vector<double> velocities_;
+  std::vector<double> accelerations_;
+  TipPoseTrackConstPtr tip_pose_track_;
+};
+
+}
+
+#endif // JOINT_TRAJECTORY_BUFFER_H
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KINEMATICS_SESSION_H
+#define KINEMATICS_SESSION_H
+
+#include <map>
+#include <string>
+
+#include <vector>
+
+#include <Eigen/Geometry>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+
+namespace pilz {
+
+/**
+ * @brief Stateful inverse/forward kinematics of one planning group and one target link.
+ *
+ * The planning group, the target link and the availability of an IK solver are resolved once.
+ * All IK/FK calls reuse the same robot state instead of constructing a new one per call,
+ * which makes the session suitable for the sampling loop of Cartesian trajectories.
+ *
+ * Joint values can be passed either by name or as a vector ordered like getJointNames(), the active joints
+ * of the planning group. The vector interface resolves the joint names once and is meant for hot loops.
+ *
+ * Note: A session is not thread-safe. Use one session per thread.
+ */
+class KinematicsSession
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * @brief Constructor
+   * @param robot_model: kinematic model of the robot
+   * @param group_name: name of the planning group
+   * @param link_name: name of the target link, the tip frame of the group solver is used if empty
+   */
+  KinematicsSession(const robot_model::RobotModelConstPtr& robot_model,
+                    const std::string& group_name,
+                    const std::string& link_name = "");
+
+  /**
+   * @brief set the target link of the IK/FK computations
+   * @param link_name: name of target link
+   * @return true if the link is known by the robot model
+   */
+  bool setLinkName(const std::string& link_name);
+
+  /**
+   * @brief select the IK solution nearest to the seed among all solutions of the IK solver plugin
+   *
+   * Analytic solver plugins like IKFast return all closed-form branches of a pose in one call. Solutions are
+   * compared by their Euclidean joint distance to the seed. Plugins which cannot return all solutions and target
+   * links which are not rigidly attached to the tip frame of the solver fall back to RobotState::setFromIK.
+   * @param enable: true to select the nearest solution
+   */
+  void setSelectNearestSolution(bool enable) {select_nearest_solution_ = enable;}
+
+  /**
+   * @brief compute the inverse kinematics of a given pose, also check robot self collision
+   * @param pose: target pose of the target link in model frame
+   * @param seed: seed state of IK solver
+   * @param solution: solution of IK
+   * @param check_self_collision: true to enable self collision checking after IK computation
+   * @param max_attempt: maximal attempts of IK
+   * @return true if succeed
+   */
+  bool solveIK(const Eigen::Affine3d& pose,
+               const std::map<std::string, double>& seed,
+               std::map<std::string, double>& solution,
+               bool check_self_collision = false,
+               int max_attempt = 2);
+
+  /**
+   * @brief compute the inverse kinematics of a given pose
+   * @param seed: seed state of IK solver, ordered like getJointNames()
+   * @param solution: solution of IK, ordered like getJointNames()
+   * @see solveIK(const Eigen::Affine3d&, const std::map<std::string, double>&, std::map<std::string, double>&,
+   * bool, int)
+   */
+  bool solveIK(const Eigen::Affine3d& pose,
+               const Eigen::VectorXd& seed,
+               Eigen::VectorXd& solution,
+               bool check_self_collision = false,
+               int max_attempt = 2);
+
+  /**
+   * @brief refine a seed close to the solution by damped least squares steps of the Jacobian
+   *
+   * This is much cheaper than a call of the IK solver plugin but only converges if the seed is close to the
+   * solution, e.g. if it is predicted from the solutions of the previous samples of a trajectory.
+   * @param pose: target pose of the target link in model frame
+   * @param seed: initial joint positions, ordered like getJointNames()
+   * @param solution: solution which satisfies the tolerances and the joint position limits
+   * @param position_tolerance: maximal translational residual of the solution [m]
+   * @param orientation_tolerance: maximal rotational residual of the solution [rad]
+   * @param max_iterations: maximal number of Jacobian steps
+   * @param check_self_collision: true to enable self collision checking of the solution
+   * @return true if a solution was found, the IK solver plugin should be used otherwise
+   */
+  bool solveIKDifferential(const Eigen::Affine3d& pose,
+                           const Eigen::VectorXd& seed,
+                           Eigen::VectorXd& solution,
+                           double position_tolerance,
+                           double orientation_tolerance,
+                           unsigned int max_iterations,
+                           bool check_self_collision = false);
+
+  /**
+   * @brief compute the pose of the target link at given joint positions
+   * @param positions: joint positions
+   * @param pose: pose of the target link in model frame
+   * @return true if succeed
+   */
+  bool fk(const std::map<std::string, double>& positions, Eigen::Affine3d& pose);
+
+  /**
+   * @brief compute the pose of the target link at given joint positions
+   * @param positions: joint positions of the planning group, ordered like getJointNames()
+   * @see fk(const std::map<std::string, double>&, Eigen::Affine3d&)
+   */
+  bool fk(const Eigen::VectorXd& positions, Eigen::Affine3d& pose);
+
+  /**
+   * @brief check the joint positions of the planning group for self collision
+   * @param positions: joint positions of the planning group, ordered like getJointNames()
+   * @return true if the robot is free of self collision at the given positions
+   */
+  bool isSelfCollisionFree(const Eigen::VectorXd& positions);
+
+  /**
+   * @brief compute the manipulability of the target link at given joint positions
+   *
+   * The manipulability is the inverse condition number of the Jacobian, i.e. the ratio of its smallest to its largest
+   * singular value. It is 1 for an isotropic and 0 for a singular configuration.
+   * @param positions: joint positions of the planning group, ordered like getJointNames()
+   * @param manipulability: inverse condition number of the Jacobian in [0, 1]
+   * @return true if the Jacobian could be computed
+   */
+  bool computeManipulability(const Eigen::VectorXd& positions, double& manipulability);
+
+  /**
+   * @brief convert named joint values of the planning group into a joint vector
+   * @param joint_values: joint values by name, additional joints are ignored
+   * @param joint_vector: joint values ordered like getJointNames()
+   * @return false if a joint of the planning group is missing
+   */
+  bool toJointVector(const std::map<std::string, double>& joint_values, Eigen::VectorXd& joint_vector) const;
+
+  /**
+   * @brief copy the joint positions of the planning group from a robot state into a joint vector
+   */
+  void toJointVector(const robot_state::RobotState& state, Eigen::VectorXd& joint_vector) const;
+
+  /**
+   * @brief convert a joint vector ordered like getJointNames() into named joint values
+   */
+  void toJointMap(const Eigen::VectorXd& joint_vector, std::map<std::string, double>& joint_values) const;
+
+  const robot_model::RobotModelConstPtr& getRobotModel() const {return robot_model_;}
+  const std::string& getGroupName() const {return group_name_;}
+  const std::string& getLinkName() const {return link_name_;}
+  const moveit::core::JointModelGroup* getJointModelGroup() const {return group_;}
+  /// active joints of the planning group, defines the order of all joint vectors
+  const std::vector<std::string>& getJointNames() const {return joint_names_;}
+
+private:
+  /// check that the planning group exists and provides an IK solver for the target link
+  bool canSolveIK() const;
+
+  /// solve the IK seeded by the current robot state, the solution is stored in the robot state
+  bool solveIKFromState(const Eigen::Affine3d& pose, bool check_self_collision, int max_attempt);
+
+  /// check the current robot state for self collision with the checker of the calling thread
+  bool isStateSelfCollisionFree();
+
+  /// resolve the frames and joints of the solver plugin for the nearest solution selection
+  void updateSolverFrames();
+
+  /// solve the IK by selecting the nearest of all solver solutions to the current robot state
+  bool solveIKNearestFromState(const Eigen::Affine3d& pose, bool check_self_collision);
+
+private:
+  robot_model::RobotModelConstPtr robot_model_;
+  std::string group_name_;
+  std::string link_name_;
+
+  /// resolved planning group, nullptr if the group does not exist
+  const moveit::core::JointModelGroup* group_ {nullptr};
+  /// active joint names of the planning group
+  std::vector<std::string> joint_names_;
+  /// robot state variable index of each active joint
+  std::vector<int> variable_indices_;
+  /// true if an IK solver exists for the target link in the planning group
+  bool can_solve_ik_ {false};
+  /// true if the target link is known by the robot state
+  bool knows_link_ {false};
+  /// target link if it is a link of the robot model, required for the Jacobian
+  const moveit::core::LinkModel* link_model_ {nullptr};
+  /// parent link of the first joint of the planning group, the Jacobian is expressed in its frame
+  const moveit::core::LinkModel* root_link_model_ {nullptr};
+  /// Jacobian reused by the differential IK
+  Eigen::MatrixXd jacobian_;
+
+  /// true to select the nearest of all solutions of the solver plugin
+  bool select_nearest_solution_ {false};
+  /// true if the target link is rigidly attached to the tip frame of the solver plugin
+  bool solver_frames_valid_ {false};
+  /// base link of the solver plugin
+  const moveit::core::LinkModel* solver_base_link_ {nullptr};
+  /// pose of the solver tip frame relative to the target link
+  Eigen::Affine3d link_to_tip_ {Eigen::Affine3d::Identity()};
+  /// index in the joint vectors of each joint of the solver plugin
+  std::vector<std::size_t> solver_joint_indices_;
+
+  /// robot state reused by all IK/FK computations
+  robot_state::RobotState state_;
+};
+
+}
+
+#endif // KINEMATICS_SESSION_H
@@ -18,14 +18,16 @@
 #ifndef PATH_CIRCLE_GENERATOR_H
 #define PATH_CIRCLE_GENERATOR_H
 
-#include <kdl/path.hpp>
-#include <kdl/path_circle.hpp>
+#include <memory>
+
+#include <Eigen/Geometry>
 #include <kdl/utilities/error.h>
-#include <kdl/rotational_interpolation_sa.hpp>
+
+#include "pilz_trajectory_generation/cartesian_path.h"
 
 namespace pilz {
 /**
- * @brief Generator class for KDL::Path_Circle from different circle representations
+ * @brief Generator class for CartesianPathCircle from different circle representations
  */
 class PathCircleGenerator
 {
@@ -37,10 +39,10 @@ public:
    * by circle center since start/goal/center points are colinear.
    * @throws KDL::Error_MotionPlanning in case start and goal have different radii to the center point.
    */
-  static std::unique_ptr<KDL::Path> circleFromCenter(
-      const KDL::Frame& start_pose,
-      const KDL::Frame& goal_pose,
-      const KDL::Vector& center_point,
+  static std::unique_ptr<CartesianPath> circleFromCenter(
+      const Eigen::Affine3d& start_pose,
+      const Eigen::Affine3d& goal_pose,
+      const Eigen::Vector3d& center_point,
       double eqradius);
 
   /**
@@ -48,10 +50,10 @@ public:
 
    * @throws KDL::Error_MotionPlanning if the given points are colinear.
    */
-  static std::unique_ptr<KDL::Path> circleFromInterim(
-      const KDL::Frame& start_pose,
-      const KDL::Frame& goal_pose,
-      const KDL::Vector& interim_point,
+  static std::unique_ptr<CartesianPath> circleFromInterim(
+      const Eigen::Affine3d& start_pose,
+      const Eigen::Affine3d& goal_pose,
+      const Eigen::Vector3d& interim_point,
       double eqradius);
 
 private:
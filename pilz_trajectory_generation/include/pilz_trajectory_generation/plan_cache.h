@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <moveit/planning_interface/planning_request.h>
+#include <moveit/planning_interface/planning_response.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit_msgs/RobotState.h>
+
+#include "pilz_trajectory_generation/generated_trajectory_info.h"
+
+namespace pilz {
+
+/**
+ * @brief Bounded cache of the trajectories of successfully solved motion plan requests.
+ *
+ * The cache is keyed by the normalized request: planner id, group, start state, goal and path constraints including
+ * their tolerances and weights and scaling factors. The joint positions of the start state are quantized to the joint
+ * resolution, so requests whose start states only differ by sensor noise share one entry. The remaining values,
+ * including the start velocities, are compared exactly.
+ * A hit therefore returns a trajectory starting up to half the joint resolution away from the requested start state.
+ * The lookup with a start state moves the first way point onto it, so that the trajectory starts exactly at the
+ * current state and the deviation is absorbed by the first segment.
+ * If the cache is full the least recently used entry is evicted.
+ *
+ * The trajectories are copied on insertion and on lookup, the callers can modify their trajectories freely.
+ * All functions are thread-safe.
+ */
+class PlanCache
+{
+public:
+  /**
+   * @brief Constructor
+   * @param capacity: maximal number of cached trajectories
+   * @param joint_resolution: quantization step of the joint positions of the start state [rad or m]
+   */
+  PlanCache(std::size_t capacity, double joint_resolution);
+
+  /**
+   * @brief compute the key of a request
+   *
+   * The start state of the request has to be set already, an empty start state is not replaced by the current state.
+   */
+  std::string computeKey(const planning_interface::MotionPlanRequest& req) const;
+
+  /**
+   * @brief look up the trajectory of a key and mark it as most recently used
+   * @param res: gets a copy of the cached trajectory and SUCCESS as error code on a hit, untouched on a miss
+   * @return true on a hit
+   */
+  bool lookup(const std::string& key, planning_interface::MotionPlanResponse& res);
+
+  /**
+   * @brief look up the trajectory of a key and the results of its generation
+   * @param info: gets the generation results stored with the trajectory on a hit, untouched on a miss
+   */
+  bool lookup(const std::string& key, planning_interface::MotionPlanResponse& res, GeneratedTrajectoryInfo& info);
+
+  /**
+   * @brief look up the trajectory of a key and move its first way point onto the start state of the request
+   *
+   * The first pose of the tip pose track is updated accordingly.
+   * @param start_state: start state of the request the key was computed for
+   */
+  bool lookup(const std::string& key, const moveit_msgs::RobotState& start_state,
+              planning_interface::MotionPlanResponse& res, GeneratedTrajectoryInfo& info);
+
+  /**
+   * @brief store a copy of the trajectory of a successful response, evicts the least recently used entry if full
+   * @param info: results of the generation of the trajectory, returned by lookup() with it
+   */
+  void insert(const std::string& key, const planning_interface::MotionPlanResponse& res,
+              const GeneratedTrajectoryInfo& info = GeneratedTrajectoryInfo());
+
+  /**
+   * @brief remove all entries, needs to be called if the robot model or the limits change
+   */
+  void clear();
+
+  std::size_t size() const;
+  std::size_t capacity() const {return capacity_;}
+  double jointResolution() const {return joint_resolution_;}
+
+  /// number of lookups which found a trajectory
+  std::uint64_t hits() const;
+  /// number of lookups which found no trajectory
+  std::uint64_t misses() const;
+
+private:
+  struct Entry
+  {
+    std::string key;
+    robot_trajectory::RobotTrajectoryPtr trajectory;
+    GeneratedTrajectoryInfo info;
+  };
+  typedef std::list<Entry> EntryList;
+
+  const std::size_t capacity_;
+  const double joint_resolution_;
+
+  mutable std::mutex mutex_;
+  /// entries ordered from most to least recently used
+  EntryList entries_;
+  std::unordered_map<std::string, EntryList::iterator> index_;
+
+  std::uint64_t hits_ {0};
+  std::uint64_t misses_ {0};
+};
+
+typedef std::shared_ptr<PlanCache> PlanCachePtr;
+typedef std::shared_ptr<const PlanCache> PlanCacheConstPtr;
+
+}
+
+#endif // PLAN_CACHE_H
@@ -18,8 +18,11 @@
 #ifndef PLANNING_CONTEXT_BASE_H
 #define PLANNING_CONTEXT_BASE_H
 
+#include "pilz_trajectory_generation/generator_options.h"
 #include "pilz_trajectory_generation/joint_limits_container.h"
+#include "pilz_trajectory_generation/plan_cache.h"
 #include "pilz_trajectory_generation/trajectory_generator.h"
+#include "pilz_trajectory_generation/trajectory_info_context.h"
 
 #include <ros/ros.h>
 
@@ -29,6 +32,7 @@
 #include <moveit/robot_state/conversions.h>
 
 #include <atomic>
+#include <sstream>
 #include <thread>
 
 namespace pilz {
@@ -37,24 +41,30 @@ namespace pilz {
  * @brief PlanningContext for obtaining trajectories
  */
 template <typename GeneratorT>
-class PlanningContextBase : public planning_interface::PlanningContext
+class PlanningContextBase : public planning_interface::PlanningContext, public pilz::TrajectoryInfoContext
 {
 public:
 
   PlanningContextBase<GeneratorT>(const std::string& name,
                      const std::string& group,
                      const moveit::core::RobotModelConstPtr& model,
-                     const pilz::LimitsContainer& limits):
+                     const pilz::LimitsContainer& limits,
+                     const pilz::GeneratorOptions& options = pilz::GeneratorOptions(),
+                     const pilz::PlanCachePtr& plan_cache = nullptr):
   planning_interface::PlanningContext(name, group),
   terminated_(false),
   model_(model),
   limits_(limits),
-  generator_(model, limits_){}
+  plan_cache_(plan_cache),
+  generator_(model, limits_, options){}
 
   virtual ~PlanningContextBase() {}
 
   /**
    * @brief Calculates a trajectory for the request this context is currently set for
+   *
+   * If a plan cache is set, the trajectory of an equal request is returned from the cache and new trajectories are
+   * stored in it.
    * @param res The result containing the respective trajectory, or error_code on failure
    * @return true on success, false otherwise
    */
@@ -63,12 +73,21 @@ public:
   /**
    * @brief Will return the same trajectory as solve(planning_interface::MotionPlanResponse& res)
    * This function just delegates to the common response however here the same trajectory is stored with the
-   * descriptions "plan", "simplify", "interpolate"
+   * descriptions "plan", "simplify", "interpolate".
+   * If the generator reduced the scaling factors of the request, the achieved factors are appended to the first
+   * description, e.g. "plan (velocity_scaling_factor: 0.5, acceleration_scaling_factor: 0.25)".
    * @param res The detailed response
    * @return true on success, false otherwise
    */
   virtual bool solve(planning_interface::MotionPlanDetailedResponse& res) override;
 
+  /**
+   * @brief Calculates a trajectory like solve(planning_interface::MotionPlanResponse& res)
+   * @param info The results of the generator besides the response, e.g. the achieved scaling factors
+   * @return true on success, false otherwise
+   */
+  virtual bool solve(planning_interface::MotionPlanResponse& res, pilz::GeneratedTrajectoryInfo& info) override;
+
   /**
    * @brief Will terminate solve()
    * @return
@@ -90,6 +109,9 @@ public:
   /// Joint limits to be used during planning
   pilz::LimitsContainer limits_;
 
+  /// Cache of solved requests, nullptr if caching is disabled
+  pilz::PlanCachePtr plan_cache_;
+
 protected:
   GeneratorT generator_;
 
@@ -98,6 +120,15 @@ protected:
 
 template <typename GeneratorT>
 bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlanResponse &res)
+{
+  pilz::GeneratedTrajectoryInfo info;
+  return solve(res, info);
+}
+
+
+template <typename GeneratorT>
+bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlanResponse &res,
+                                                  pilz::GeneratedTrajectoryInfo &info)
 {
   if(!terminated_)
   {
@@ -108,7 +139,26 @@ bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlan
       moveit::core::robotStateToRobotStateMsg(getPlanningScene()->getCurrentState(), currentState);
       request_.start_state = currentState;
     }
-    bool result = generator_.generate(request_, res);
+
+    std::string cache_key;
+    if(plan_cache_)
+    {
+      ros::Time lookup_start = ros::Time::now();
+      cache_key = plan_cache_->computeKey(request_);
+      if(plan_cache_->lookup(cache_key, request_.start_state, res, info))
+      {
+        res.planning_time_ = (ros::Time::now() - lookup_start).toSec();
+        ROS_DEBUG_STREAM("Returning cached trajectory (hits: " << plan_cache_->hits()
+                         << ", misses: " << plan_cache_->misses() << ")");
+        return true;
+      }
+    }
+
+    bool result = generator_.generate(request_, res, info);
+    if(result && plan_cache_)
+    {
+      plan_cache_->insert(cache_key, res, info);
+    }
     return result;
     //res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
     //return false; // TODO
@@ -125,9 +175,20 @@ bool pilz::PlanningContextBase<GeneratorT>::solve(planning_interface::MotionPlan
 {
    // delegate to regular response
    planning_interface::MotionPlanResponse undetailed_response;
-   bool result = solve(undetailed_response);
-
-   res.description_.push_back("plan");
+   pilz::GeneratedTrajectoryInfo info;
+   bool result = solve(undetailed_response, info);
+
+   // report scaling factors which were reduced by the generator
+   std::ostringstream description;
+   description << "plan";
+   if(result && (info.scaling.velocity_scaling_factor < request_.max_velocity_scaling_factor ||
+                 info.scaling.acceleration_scaling_factor < request_.max_acceleration_scaling_factor))
+   {
+     description << " (velocity_scaling_factor: " << info.scaling.velocity_scaling_factor
+                 << ", acceleration_scaling_factor: " << info.scaling.acceleration_scaling_factor << ")";
+   }
+
+   res.description_.push_back(description.str());
    res.trajectory_.push_back(undetailed_response.trajectory_);
    res.processing_time_.push_back(undetailed_response.planning_time_);
 
@@ -45,8 +45,10 @@ class PlanningContextCIRC : public pilz::PlanningContextBase<TrajectoryGenerator
     PlanningContextCIRC(const std::string& name,
                        const std::string& group,
                        const moveit::core::RobotModelConstPtr& model,
-                       const pilz::LimitsContainer& limits):
-    pilz::PlanningContextBase<TrajectoryGeneratorCIRC>(name, group, model, limits){}
+                       const pilz::LimitsContainer& limits,
+                       const pilz::GeneratorOptions& options = pilz::GeneratorOptions(),
+                       const pilz::PlanCachePtr& plan_cache = nullptr):
+    pilz::PlanningContextBase<TrajectoryGeneratorCIRC>(name, group, model, limits, options, plan_cache){}
 };
 
 } // namespace
@@ -45,8 +45,10 @@ class PlanningContextLIN : public pilz::PlanningContextBase<TrajectoryGeneratorL
     PlanningContextLIN(const std::string& name,
                        const std::string& group,
                        const moveit::core::RobotModelConstPtr& model,
-                       const pilz::LimitsContainer& limits):
-    pilz::PlanningContextBase<TrajectoryGeneratorLIN>(name, group, model, limits){}
+                       const pilz::LimitsContainer& limits,
+                       const pilz::GeneratorOptions& options = pilz::GeneratorOptions(),
+                       const pilz::PlanCachePtr& plan_cache = nullptr):
+    pilz::PlanningContextBase<TrajectoryGeneratorLIN>(name, group, model, limits, options, plan_cache){}
 };
 
 } // namespace
@@ -18,7 +18,9 @@
 #ifndef PLANNING_CONTEXT_LOADER_H
 #define PLANNING_CONTEXT_LOADER_H
 
+#include "pilz_trajectory_generation/generator_options.h"
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/plan_cache.h"
 
 #include <memory>
 #include <vector>
@@ -57,6 +59,22 @@ public:
    */
   virtual bool setLimits(const pilz::LimitsContainer& limits);
 
+  /**
+   * @brief Sets the options of the trajectory generation the planner can pass to the contexts
+   * @param options options of the trajectory generators, defaults are used if never set
+   * @return true if options could be set
+   */
+  virtual bool setOptions(const pilz::GeneratorOptions& options);
+
+  /**
+   * @brief Sets the plan cache the planner shares between the contexts
+   *
+   * The cache is cleared if the model or the limits are set afterwards.
+   * @param plan_cache cache of solved requests, nullptr disables caching
+   * @return true if the cache could be set
+   */
+  virtual bool setPlanCache(const pilz::PlanCachePtr& plan_cache);
+
   /**
    * @brief Return the planning context
    * @param planning_context
@@ -93,6 +111,12 @@ protected:
   /// Limits to be used during planning
   pilz::LimitsContainer limits_;
 
+  /// Options of the trajectory generation
+  pilz::GeneratorOptions options_;
+
+  /// Cache of solved requests, nullptr if caching is disabled
+  pilz::PlanCachePtr plan_cache_;
+
   /// True if model is set
   bool model_set_;
 
@@ -111,7 +135,7 @@ bool PlanningContextLoader::loadContext(planning_interface::PlanningContextPtr&
                                                          const std::string& group) const
 {
   if(limits_set_ && model_set_) {
-    planning_context.reset(new T(name, group, model_, limits_));
+    planning_context.reset(new T(name, group, model_, limits_, options_, plan_cache_));
     return true;
   }
   else
@@ -44,8 +44,10 @@ class PlanningContextPTP : public pilz::PlanningContextBase<TrajectoryGeneratorP
     PlanningContextPTP(const std::string& name,
                        const std::string& group,
                        const moveit::core::RobotModelConstPtr& model,
-                       const pilz::LimitsContainer& limits):
-    pilz::PlanningContextBase<TrajectoryGeneratorPTP>(name, group, model, limits){}
+                       const pilz::LimitsContainer& limits,
+                       const pilz::GeneratorOptions& options = pilz::GeneratorOptions(),
+                       const pilz::PlanCachePtr& plan_cache = nullptr):
+    pilz::PlanningContextBase<TrajectoryGeneratorPTP>(name, group, model, limits, options, plan_cache){}
 };
 
 } // namespace
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PTP_TRAJECTORY_H
+#define PTP_TRAJECTORY_H
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "pilz_trajectory_generation/joint_trajectory_buffer.h"
+
+namespace pilz {
+
+/**
+ * @brief Analytic representation of a fully synchronized ptp trajectory.
+ *
+ * All joints share the durations of the acceleration, constant and deceleration phase. Each joint is described by
+ * its start and goal position, the velocity of the constant phase and the acceleration of the first and the third
+ * phase. All three values are signed, the deceleration has the opposite sign of the velocity. A zero total duration
+ * means the goal is already reached.
+ */
+struct PTPTrajectory
+{
+  /// names of the joints, defines the order of the joint values
+  std::vector<std::string> joint_names;
+  Eigen::VectorXd start_position;
+  Eigen::VectorXd goal_position;
+
+  double acc_duration {0.0};
+  double const_duration {0.0};
+  double dec_duration {0.0};
+
+  Eigen::VectorXd velocity;
+  Eigen::VectorXd acceleration;
+  Eigen::VectorXd deceleration;
+
+  double duration() const {return acc_duration + const_duration + dec_duration;}
+};
+
+/**
+ * @brief Evaluation of a PTPTrajectory at arbitrary times.
+ *
+ * The values are identical to the ones of VelocityProfile_ATrap::Pos(), Vel() and Acc() of the synchronized
+ * profiles the trajectory was created from.
+ */
+class PTPTrajectoryEvaluator
+{
+public:
+  explicit PTPTrajectoryEvaluator(const PTPTrajectory& trajectory);
+
+  /**
+   * @brief evaluate all joints at the given time, the times need not be ordered
+   * @param time: time from start, the start/goal state is returned before/after the motion
+   * @param positions: position of each joint
+   * @param velocities: velocity of each joint
+   * @param accelerations: acceleration of each joint
+   */
+  void evaluate(double time,
+                Eigen::Ref<Eigen::VectorXd> positions,
+                Eigen::Ref<Eigen::VectorXd> velocities,
+                Eigen::Ref<Eigen::VectorXd> accelerations) const;
+
+  /**
+   * @brief sample the trajectory with the given sampling time, the last point is at the end of the motion
+   *
+   * The result is the same as the one of the dense ptp planning with this sampling time. A trajectory which already
+   * reaches its goal results in one point at the sampling time.
+   * @param sampling_time
+   * @param joint_trajectory: the sampled trajectory, existing points are removed
+   */
+  void sample(double sampling_time, JointTrajectoryBuffer& joint_trajectory) const;
+
+private:
+  PTPTrajectory trajectory_;
+
+  /// coefficients of the position polynomial in the three phases, see VelocityProfile_ATrap
+  Eigen::ArrayXd a3_, b1_, c1_, c3_;
+};
+
+}
+
+#endif // PTP_TRAJECTORY_H
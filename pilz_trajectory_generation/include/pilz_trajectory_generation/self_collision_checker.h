@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SELF_COLLISION_CHECKER_H
+#define SELF_COLLISION_CHECKER_H
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <moveit/collision_detection/collision_matrix.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+
+namespace pilz {
+
+/**
+ * @brief Self collision checker of one robot model which is reused for all samples of a trajectory.
+ *
+ * The collision representation of the robot and the allowed collision matrix of the SRDF are created once.
+ * Link pairs which have not moved since the previous collision free state are not checked again and a state
+ * without any moved link reuses the previous result.
+ *
+ * Note: A checker is not thread-safe. Use getThreadInstance() to obtain the checker of the calling thread.
+ */
+class SelfCollisionChecker
+{
+public:
+  /**
+   * @brief Constructor
+   * @param robot_model: kinematic model of the robot
+   * @param epsilon: maximal change of a link transform which is considered as not moved
+   */
+  SelfCollisionChecker(const robot_model::RobotModelConstPtr& robot_model, double epsilon = 1e-9);
+
+  /**
+   * @brief check a robot state for self collision
+   * @param state: robot state, the link transforms are updated if necessary
+   * @return true if the state is free of self collision
+   */
+  bool isCollisionFree(robot_state::RobotState& state);
+
+  /**
+   * @brief get the checker of the robot model for the calling thread, it is created on first use
+   */
+  static SelfCollisionChecker& getThreadInstance(const robot_model::RobotModelConstPtr& robot_model);
+
+  const robot_model::RobotModelConstPtr& getRobotModel() const {return robot_model_;}
+
+  /**
+   * @brief get the allowed collision matrix, initialized by the SRDF
+   *
+   * Entries which are changed between two checks should be followed by a check of a different state, since a state
+   * without any moved link reuses the previous result.
+   */
+  collision_detection::AllowedCollisionMatrix& getAllowedCollisionMatrix() {return acm_;}
+
+private:
+  /// link pair which is temporarily allowed and its original entry of the allowed collision matrix
+  struct SkippedPair
+  {
+    std::size_t link1;
+    std::size_t link2;
+    /// false if the pair had no entry
+    bool has_entry;
+    collision_detection::AllowedCollision::Type type;
+    /// decision function of a CONDITIONAL entry
+    collision_detection::DecideContactFn decide_contact;
+  };
+
+  robot_model::RobotModelConstPtr robot_model_;
+  double epsilon_;
+
+  /// scene providing the collision representation of the robot
+  planning_scene::PlanningScenePtr scene_;
+  /// allowed collision matrix of the SRDF, temporarily extended by the link pairs which have not moved
+  collision_detection::AllowedCollisionMatrix acm_;
+
+  /// links with collision geometry
+  std::vector<const moveit::core::LinkModel*> links_;
+  /// link transforms of the previously checked state
+  std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > last_transforms_;
+  /// true if a state was checked before
+  bool has_last_state_ {false};
+  /// result of the previously checked state
+  bool last_collision_free_ {false};
+
+  /// moved flag of each link, reused by all checks
+  std::vector<bool> moved_;
+  /// link pairs which are temporarily allowed, reused by all checks
+  std::vector<SkippedPair> skipped_pairs_;
+};
+
+}
+
+#endif // SELF_COLLISION_CHECKER_H
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pilz {
+
+/**
+ * @brief Fixed set of worker threads shared by all parallel work of the trajectory generation
+ *
+ * Each worker owns a queue of tasks. Tasks submitted by a worker are queued at the back of its own queue and taken
+ * from there first (LIFO), idle workers steal from the front of the other queues (FIFO). Tasks submitted by other
+ * threads are distributed round robin. Tasks are usually submitted through a TaskGroup.
+ *
+ * One pool is meant to be shared by all planners of a process, see getSharedPool(), so that concurrent requests do not
+ * start more workers than there are cores.
+ *
+ * The destructor executes all queued tasks before the workers are joined. All other functions are thread-safe.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * @brief Constructor, starts the workers
+   * @param thread_count: number of worker threads, 0 uses the number of hardware threads
+   */
+  explicit ThreadPool(unsigned int thread_count = 0);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// number of worker threads
+  unsigned int size() const {return static_cast<unsigned int>(threads_.size());}
+
+  /**
+   * @brief get the pool shared by all users of the process, it is created on first use and destroyed with its last user
+   * @param thread_count: number of worker threads if the pool is created, 0 uses the number of hardware threads
+   */
+  static std::shared_ptr<ThreadPool> getSharedPool(unsigned int thread_count = 0);
+
+  /**
+   * @brief queue a task, it must not throw
+   * @param owner: identifies the tasks which runPendingTask() may execute for a waiting thread, e.g. the task group
+   */
+  void submit(std::function<void()> task, const void* owner = nullptr);
+
+  /**
+   * @brief execute one queued task of the owner on the calling thread, used by threads waiting for their tasks
+   *
+   * Tasks of other owners are left to the workers, a waiting request never executes the work of another request.
+   * @return false if no task of the owner was queued
+   */
+  bool runPendingTask(const void* owner);
+
+private:
+  struct Task
+  {
+    const void* owner;
+    std::function<void()> function;
+  };
+
+  struct TaskQueue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * @brief take a task from the back of the own queue or from the front of another queue
+   * @param owner: only take tasks of this owner, nullptr takes any task
+   */
+  bool popTask(std::size_t queue_index, const void* owner, std::function<void()>& task);
+
+  void workerLoop(std::size_t queue_index);
+
+  std::vector<std::unique_ptr<TaskQueue> > queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stop_ {false};
+  /// number of queued tasks, can be negative for a moment since it is counted after the task was queued
+  std::atomic<long> pending_ {0};
+  std::atomic<std::size_t> next_queue_ {0};
+};
+
+typedef std::shared_ptr<ThreadPool> ThreadPoolPtr;
+
+/**
+ * @brief Set of tasks on a thread pool which are waited for and cancelled together
+ *
+ * Tasks which have not started when the group is cancelled are skipped, running tasks can poll isCancelled(). If a
+ * task throws, the group is cancelled and wait() rethrows the first exception. Without a pool the tasks are executed
+ * by run() on the calling thread. The destructor waits for all tasks but does not rethrow.
+ */
+class TaskGroup
+{
+public:
+  /**
+   * @brief Constructor
+   * @param pool: pool executing the tasks, nullptr executes them on the calling thread
+   */
+  explicit TaskGroup(ThreadPool* pool);
+
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  /**
+   * @brief add a task to the group, it is skipped if the group is cancelled
+   */
+  void run(std::function<void()> task);
+
+  /**
+   * @brief skip all tasks which have not started yet
+   */
+  void cancel() {cancelled_ = true;}
+
+  bool isCancelled() const {return cancelled_;}
+
+  /**
+   * @brief wait for all tasks of the group, the calling thread executes queued tasks of this group meanwhile
+   *
+   * Waiting from a task of the same pool does not block a worker, nested groups are possible.
+   */
+  void wait();
+
+private:
+  void execute(const std::function<void()>& task);
+
+  ThreadPool* pool_;
+  std::atomic<bool> cancelled_ {false};
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::size_t unfinished_ {0};
+  std::exception_ptr exception_;
+};
+
+}
+
+#endif // THREAD_POOL_H
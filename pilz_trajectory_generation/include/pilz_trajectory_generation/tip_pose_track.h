@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIP_POSE_TRACK_H
+#define TIP_POSE_TRACK_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+namespace pilz {
+
+typedef std::vector<Eigen::Affine3d, Eigen::aligned_allocator<Eigen::Affine3d> > PoseVector;
+
+/**
+ * @brief Poses of one link at all way points of a robot trajectory, in the model frame.
+ *
+ * The Cartesian generators know the pose of every sample. They return the track next to their trajectory, see
+ * GeneratedTrajectoryInfo, so that the blender can read these poses instead of computing the forward kinematics
+ * again. The track belongs to the trajectory as it was generated, whoever changes the way points has to drop or
+ * update the track.
+ */
+struct TipPoseTrack
+{
+  std::string link_name;
+  PoseVector poses;
+};
+
+typedef std::shared_ptr<const TipPoseTrack> TipPoseTrackConstPtr;
+
+/**
+ * @brief Access to the poses of a link at the way points of a trajectory.
+ *
+ * The poses are read from the given tip pose track if it belongs to the link and matches the way point count,
+ * otherwise they are computed by forward kinematics.
+ */
+class TipPoseLookup
+{
+public:
+  TipPoseLookup(const robot_trajectory::RobotTrajectoryPtr& trajectory,
+                const std::string& link_name,
+                const TipPoseTrackConstPtr& track = nullptr);
+
+  /**
+   * @brief pose of the link at the way point with the given index
+   */
+  const Eigen::Affine3d& getPose(std::size_t index) const;
+
+  /**
+   * @brief true if the poses are read from a tip pose track
+   */
+  bool hasTrack() const {return track_ != nullptr;}
+
+private:
+  robot_trajectory::RobotTrajectoryPtr trajectory_;
+  std::string link_name_;
+  TipPoseTrackConstPtr track_;
+};
+
+}
+
+#endif // TIP_POSE_TRACK_H
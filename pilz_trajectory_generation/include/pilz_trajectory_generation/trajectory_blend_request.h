@@ -22,6 +22,8 @@
 
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
+#include "pilz_trajectory_generation/tip_pose_track.h"
+
 namespace pilz
 {
 
@@ -37,6 +39,11 @@ struct TrajectoryBlendRequest
   robot_trajectory::RobotTrajectoryPtr first_trajectory;
   robot_trajectory::RobotTrajectoryPtr second_trajectory;
 
+  // Optional poses of the target link at the way points of the trajectories, e.g. from the generator,
+  // computed by forward kinematics if not given
+  TipPoseTrackConstPtr first_tip_pose_track;
+  TipPoseTrackConstPtr second_tip_pose_track;
+
   // Blend radius in meter
   double blend_radius;
 };
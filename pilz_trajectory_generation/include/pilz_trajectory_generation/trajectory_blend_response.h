@@ -22,6 +22,8 @@
 
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
+#include "pilz_trajectory_generation/tip_pose_track.h"
+
 namespace pilz
 {
 
@@ -35,6 +37,12 @@ struct TrajectoryBlendResponse
   robot_trajectory::RobotTrajectoryPtr blend_trajectory;
   robot_trajectory::RobotTrajectoryPtr second_trajectory;
 
+  // Poses of the target link at the way points of the resulted trajectories, the first and second track are only
+  // set if the request had one
+  TipPoseTrackConstPtr first_tip_pose_track;
+  TipPoseTrackConstPtr blend_tip_pose_track;
+  TipPoseTrackConstPtr second_tip_pose_track;
+
   // Error code
   moveit_msgs::MoveItErrorCodes error_code;
 };
@@ -32,8 +32,13 @@ namespace pilz {
 class TrajectoryBlenderTransitionWindow : public TrajectoryBlender
 {
 public:
-  TrajectoryBlenderTransitionWindow(const LimitsContainer& planner_limits)
-    :TrajectoryBlender::TrajectoryBlender(planner_limits)
+  /**
+   * @param crossing_time_alignment: align the trajectories by the interpolated times at which they cross the blend
+   * sphere instead of the times of the intersection points, see determineTrajectoryAlignment()
+   */
+  TrajectoryBlenderTransitionWindow(const LimitsContainer& planner_limits, bool crossing_time_alignment = false)
+    :TrajectoryBlender::TrajectoryBlender(planner_limits),
+     crossing_time_alignment_(crossing_time_alignment)
   {
   }
 
@@ -80,15 +85,20 @@ private:
    * @param req: trajectory blend request
    * @param first_interse_index: index of the intersection point between first trajectory and blend sphere
    * @param second_interse_index: index of the intersection point between second trajectory and blend sphere
+   * @param first_crossing_time: time at which the first trajectory enters the blend sphere
+   * @param second_crossing_time: time at which the second trajectory leaves the blend sphere
    */
   bool searchIntersectionPoints(const pilz::TrajectoryBlendRequest& req,
                                 std::size_t& first_interse_index,
-                                std::size_t& second_interse_index) const;
+                                std::size_t& second_interse_index,
+                                double& first_crossing_time,
+                                double& second_crossing_time) const;
 
   /**
    * @brief Determine how the second trajectory should be aligned with the first trajectory for blend.
-   * tau_1 is the time of the first trajectory from the first_interse_index to the end
-   * tau_2 is the time of the second trajectory from begin to  the second_interse_index
+   * tau_1 is the time of the first trajectory from the first intersection point to the end
+   * tau_2 is the time of the second trajectory from begin to the second intersection point
+   * With crossing time alignment, the times are measured from the interpolated crossings of the blend sphere instead.
    * if tau_1 > tau_2
    *    change the first intersection index to fit tau_2
    *    first traj:  |-------------|--------!--------------|
@@ -105,11 +115,16 @@ private:
    * @param second_interse_index: index of the intersection point between second trajectory and blend sphere
    * @param blend_align_index: index on the first trajectory, to which the first point on the second trajectory should
    * be aligned to for motion blend. It is now always same as first intersection index
-   * @param blend_time: time of the motion blend period
+   * @param first_crossing_time: time at which the first trajectory enters the blend sphere, only used with crossing
+   * time alignment
+   * @param second_crossing_time: time at which the second trajectory leaves the blend sphere, only used with crossing
+   * time alignment
    */
   void determineTrajectoryAlignment(const pilz::TrajectoryBlendRequest& req,
                                     std::size_t first_interse_index,
                                     std::size_t second_interse_index,
+                                    double first_crossing_time,
+                                    double second_crossing_time,
                                     std::size_t& blend_align_index) const;
 
   /**
@@ -126,9 +141,30 @@ private:
                                 double sampling_time,
                                 pilz::CartesianTrajectory &trajectory) const;
 
+  /**
+   * @brief set the tip pose tracks of the trajectories of the response
+   *
+   * The tracks of the first and second trajectory are cut from the tracks of the request, if present.
+   * The track of the blend trajectory consists of the blended Cartesian samples.
+   * @param req: trajectory blend request
+   * @param first_interse_index: index of the intersection point between first trajectory and blend sphere
+   * @param second_interse_index: index of the intersection point between second trajectory and blend sphere
+   * @param blend_trajectory_cartesian: the blend trajectory in Cartesian space
+   * @param res: response with the trajectories after blending
+   */
+  void setResponseTipPoseTracks(const pilz::TrajectoryBlendRequest& req,
+                                std::size_t first_interse_index,
+                                std::size_t second_interse_index,
+                                const pilz::CartesianTrajectory& blend_trajectory_cartesian,
+                                pilz::TrajectoryBlendResponse& res) const;
+
 private: // static members
   // Constant to check for equality of values.
   static constexpr double EPSILON = 1e-4;
+
+private:
+  /// align by the interpolated crossing times of the blend sphere instead of the times of the intersection points
+  bool crossing_time_alignment_;
 };
 
 }
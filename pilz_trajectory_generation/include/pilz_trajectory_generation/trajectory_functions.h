@@ -18,8 +18,13 @@
 #ifndef TRAJECTORY_FUNCTIONS_H
 #define TRAJECTORY_FUNCTIONS_H
 
+#include <functional>
+#include <memory>
+
 #include <Eigen/Geometry>
+#include <Eigen/StdVector>
 #include <kdl/trajectory.hpp>
+#include <kdl/velocityprofile.hpp>
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
 #include <eigen_conversions/eigen_kdl.h>
@@ -28,11 +33,24 @@
 #include <moveit/robot_trajectory/robot_trajectory.h>
 
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/cartesian_path.h"
 #include "pilz_trajectory_generation/cartesian_trajectory.h"
+#include "pilz_trajectory_generation/generator_options.h"
+#include "pilz_trajectory_generation/joint_limits_table.h"
+#include "pilz_trajectory_generation/joint_trajectory_buffer.h"
+#include "pilz_trajectory_generation/kinematics_session.h"
+#include "pilz_trajectory_generation/tip_pose_track.h"
 
 
 namespace pilz {
 
+/**
+ * @brief creates the velocity profile of a path for a time scaling factor in (0, 1]
+ *
+ * The profile of a factor r must be the profile of factor 1 slowed down in time, s_r(t) = s_1(r*t).
+ */
+typedef std::function<std::unique_ptr<KDL::VelocityProfile>(double)> VelocityProfileFactory;
+
 /**
  * @brief compute the inverse kinematics of a given pose, also check robot self collision
  * @param robot_model: kinematic model of the robot
@@ -94,8 +112,9 @@ bool computeLinkFK(const robot_model::RobotModelConstPtr& robot_model,
  * @param position_current: position of current sample
  * @param duration_last: duration of last sample
  * @param duration_current: duration of current sample
- * @param joint_limits: joint limits
+ * @param joint_limits: joint limits, must contain every joint of position_current
  * @return
+ * @throws std::out_of_range if a joint of position_current has no limit in joint_limits or no last position
  */
 bool verifySampleJointLimits(const std::map<std::string, double>& position_last,
                              const std::map<std::string, double>& velocity_last,
@@ -104,6 +123,143 @@ bool verifySampleJointLimits(const std::map<std::string, double>& position_last,
                              double duration_current,
                              const JointLimitsContainer &joint_limits);
 
+/**
+ * @brief verify the velocity/acceleration limits of current sample on joint vectors
+ * @param joint_limits: limits of the joints, ordered like the joint vectors
+ * @param joint_names: names of the joints, only used for error messages
+ * @see verifySampleJointLimits(const std::map<std::string, double>&, const std::map<std::string, double>&,
+ * const std::map<std::string, double>&, double, double, const JointLimitsContainer&)
+ */
+bool verifySampleJointLimits(const Eigen::VectorXd& position_last,
+                             const Eigen::VectorXd& velocity_last,
+                             const Eigen::VectorXd& position_current,
+                             double duration_last,
+                             double duration_current,
+                             const std::vector<pilz_extensions::JointLimit>& joint_limits,
+                             const std::vector<std::string>& joint_names);
+
+/**
+ * @brief first violation of the joint limits found by verifyJointTrajectoryLimits()
+ */
+struct JointLimitViolation
+{
+  enum Type {NONE, DURATION, VELOCITY, ACCELERATION, DECELERATION};
+
+  Type type {NONE};
+  /// index of the violating sample
+  std::size_t sample {0};
+  /// index of the violating joint, not set for a duration violation
+  std::size_t joint {0};
+  /// violating value and its limit
+  double value {0.};
+  double limit {0.};
+};
+
+/**
+ * @brief verify the velocity/acceleration limits of all samples of a joint trajectory in one pass
+ *
+ * The velocities and accelerations are computed by finite differences like in verifySampleJointLimits() for all
+ * samples of one joint at once.
+ * @param positions: joint positions, one row per sample and one column per joint
+ * @param initial_position: joint positions before the first sample
+ * @param initial_velocity: joint velocities before the first sample
+ * @param durations: duration between each sample and its predecessor
+ * @param durations_last: duration of the last sample used for the acceleration of each sample
+ * @param limits: limits of the joints, ordered like the columns
+ * @param joint_names: names of the joints, only used for error messages
+ * @param velocities: velocity of each sample
+ * @param accelerations: acceleration of each sample
+ * @param violation: first violation in the order of samples and joints
+ * @return true if no limit is violated
+ */
+bool verifyJointTrajectoryLimits(const Eigen::MatrixXd& positions,
+                                 const Eigen::VectorXd& initial_position,
+                                 const Eigen::VectorXd& initial_velocity,
+                                 const Eigen::VectorXd& durations,
+                                 const Eigen::VectorXd& durations_last,
+                                 const JointLimitsTable& limits,
+                                 const std::vector<std::string>& joint_names,
+                                 Eigen::MatrixXd& velocities,
+                                 Eigen::MatrixXd& accelerations,
+                                 JointLimitViolation& violation);
+
+
+/**
+ * @brief compute the largest factor to scale a sampled joint trajectory in time with, so that no limit is violated
+ *
+ * Slowing down all samples by the factor r, i.e. stretching their durations by 1/r, scales the finite difference
+ * velocities by r and the accelerations by r^2. The initial velocity is scaled as well.
+ * @param velocities: velocity of each sample as computed by verifyJointTrajectoryLimits()
+ * @param accelerations: acceleration of each sample as computed by verifyJointTrajectoryLimits()
+ * @param initial_velocity: joint velocities before the first sample
+ * @param limits: limits of the joints, ordered like the columns
+ * @return 1 if no limit is violated, the factor in [0, 1) otherwise
+ */
+double computeFeasibleTimeScaling(const Eigen::MatrixXd& velocities,
+                                  const Eigen::MatrixXd& accelerations,
+                                  const Eigen::VectorXd& initial_velocity,
+                                  const JointLimitsTable& limits);
+
+/**
+ * @brief compute the inverse kinematics of a sequence of poses, each pose is seeded by the solution of its predecessor
+ *
+ * If options.parallel_ik is set and the sequence is long enough, it is split into chunks which are solved in
+ * parallel. Each chunk is seeded by the IK solution of its first pose, these boundary solutions are chained from the
+ * initial joint position. If the goal joint position is given, the chunks are seeded by interpolating between the
+ * initial and the goal joint position instead. A chunk whose first solution jumps away from the last solution of the
+ * previous chunk is solved again sequentially. The chunks are executed by the workers of options.thread_pool, without
+ * a pool the poses are solved sequentially. The parallel mode requires a thread-safe IK solver plugin.
+ * If options.differential_ik is set, each pose is first solved by Jacobian steps from the prediction of the
+ * previous two solutions, see KinematicsSession::solveIKDifferential().
+ * @param kinematics: kinematics session of the planning group and target link
+ * @param poses: poses of the target link
+ * @param initial_joint_position: seed of the first pose, ordered like kinematics.getJointNames()
+ * @param max_joint_step: maximal joint step between consecutive solutions which is considered as continuous
+ * @param options: options of the trajectory generation
+ * @param solutions: IK solutions of all poses
+ * @param check_self_collision: true to enable self collision checking after IK computation
+ * @param goal_joint_position: known solution of the last pose, e.g. of the goal of a request, empty if unknown.
+ * It is used as last solution without IK if it is continuous to the previous solution.
+ * @return true if all poses could be solved
+ */
+bool computePoseSequenceIK(KinematicsSession& kinematics,
+                           const PoseVector& poses,
+                           const Eigen::VectorXd& initial_joint_position,
+                           const Eigen::VectorXd& max_joint_step,
+                           const GeneratorOptions& options,
+                           std::vector<Eigen::VectorXd>& solutions,
+                           bool check_self_collision = false,
+                           const Eigen::VectorXd& goal_joint_position = Eigen::VectorXd());
+
+/**
+ * @brief compute the joint positions of a sequence of poses by solving the inverse kinematics only at knots
+ *
+ * The IK is solved at every options.adaptive_sampling_max_knot_interval-th pose, the knots are chained from the
+ * initial joint position. Poses between two knots are interpolated linearly in joint space over the path parameter.
+ * An interval is bisected by an additional knot as long as the forward kinematics of an interpolated pose deviates
+ * from its Cartesian pose by more than the tolerances of the options or the knots jump further than max_joint_step
+ * per pose. Interpolated poses are not checked for self collision.
+ * @param kinematics: kinematics session of the planning group and target link
+ * @param poses: poses of the target link
+ * @param path_parameters: monotonic path parameter of each pose, e.g. the path length
+ * @param initial_joint_position: seed of the first pose, ordered like kinematics.getJointNames()
+ * @param max_joint_step: maximal joint step between consecutive poses which is considered as continuous
+ * @param options: options of the trajectory generation
+ * @param solutions: joint positions of all poses
+ * @param check_self_collision: true to enable self collision checking of the knots
+ * @param goal_joint_position: known solution of the last pose, empty if unknown, it is used as last knot without IK
+ * if it is continuous to the previous knot
+ * @return true if all knots could be solved
+ */
+bool computePoseSequenceIKAdaptive(KinematicsSession& kinematics,
+                                   const PoseVector& poses,
+                                   const std::vector<double>& path_parameters,
+                                   const Eigen::VectorXd& initial_joint_position,
+                                   const Eigen::VectorXd& max_joint_step,
+                                   const GeneratorOptions& options,
+                                   std::vector<Eigen::VectorXd>& solutions,
+                                   bool check_self_collision = false,
+                                   const Eigen::VectorXd& goal_joint_position = Eigen::VectorXd());
 
 /**
  * @brief Generate joint trajectory from a KDL Cartesian trajectory
@@ -130,6 +286,158 @@ bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
                              moveit_msgs::MoveItErrorCodes& error_code,
                              bool check_self_collision = false);
 
+/**
+ * @brief Generate joint trajectory from a KDL Cartesian trajectory using an existing kinematics session
+ * @param kinematics: kinematics session of the planning group and target link
+ * @param initial_joint_position: initial joint positions, ordered like kinematics.getJointNames()
+ * @param joint_trajectory: output as compact joint trajectory, existing points are removed
+ * @param options: options of the trajectory generation, e.g. parallel IK or adaptive sampling
+ * @see generateJointTrajectory(const robot_model::RobotModelConstPtr&, const JointLimitsContainer&,
+ * const KDL::Trajectory&, ...)
+ */
+bool generateJointTrajectory(KinematicsSession& kinematics,
+                             const JointLimitsContainer& joint_limits,
+                             const KDL::Trajectory& trajectory,
+                             const Eigen::VectorXd& initial_joint_position,
+                             const double& sampling_time,
+                             JointTrajectoryBuffer& joint_trajectory,
+                             moveit_msgs::MoveItErrorCodes& error_code,
+                             bool check_self_collision = false,
+                             const GeneratorOptions& options = GeneratorOptions());
+
+/**
+ * @brief Generate joint trajectory from a Cartesian path and a velocity profile of its path parameter
+ *
+ * All poses are evaluated by the path in one call, no KDL frames are involved.
+ * @param path: Cartesian path
+ * @param velocity_profile: profile of the path parameter over time, defines the duration of the trajectory
+ * @param goal_joint_position: known solution of the end of the path, empty if unknown, see computePoseSequenceIK()
+ * @see generateJointTrajectory(KinematicsSession&, const JointLimitsContainer&, const KDL::Trajectory&, ...)
+ */
+bool generateJointTrajectory(KinematicsSession& kinematics,
+                             const JointLimitsContainer& joint_limits,
+                             const CartesianPath& path,
+                             const KDL::VelocityProfile& velocity_profile,
+                             const Eigen::VectorXd& initial_joint_position,
+                             const double& sampling_time,
+                             JointTrajectoryBuffer& joint_trajectory,
+                             moveit_msgs::MoveItErrorCodes& error_code,
+                             bool check_self_collision = false,
+                             const GeneratorOptions& options = GeneratorOptions(),
+                             const Eigen::VectorXd& goal_joint_position = Eigen::VectorXd());
+
+/**
+ * @brief Generate joint trajectory from a Cartesian path with the fastest velocity profile which obeys the joint limits
+ *
+ * The IK of the path is solved once at the samples of the profile with time scaling 1. If the joint trajectory violates
+ * a limit, the factor is reduced by computeFeasibleTimeScaling() (less options.velocity_scaling_search_margin) and the
+ * joint positions of the new samples are interpolated on the solved joint path. The IK is only solved again for
+ * samples whose interpolation deviates from the path by more than the adaptive sampling tolerances of the options.
+ * This is repeated until the limits are obeyed. Interpolated samples are not checked for self collision.
+ * @param velocity_profile_factory: creates the velocity profile of the path for a time scaling factor
+ * @param min_time_scaling: smallest time scaling factor, the generation fails below
+ * @param time_scaling: time scaling factor of the generated trajectory
+ * @param goal_joint_position: known solution of the end of the path, empty if unknown, see computePoseSequenceIK()
+ * @see generateJointTrajectory(KinematicsSession&, const JointLimitsContainer&, const CartesianPath&, ...)
+ */
+bool generateJointTrajectoryTimeScaled(KinematicsSession& kinematics,
+                                       const JointLimitsContainer& joint_limits,
+                                       const CartesianPath& path,
+                                       const VelocityProfileFactory& velocity_profile_factory,
+                                       const Eigen::VectorXd& initial_joint_position,
+                                       const double& sampling_time,
+                                       double min_time_scaling,
+                                       JointTrajectoryBuffer& joint_trajectory,
+                                       double& time_scaling,
+                                       moveit_msgs::MoveItErrorCodes& error_code,
+                                       bool check_self_collision = false,
+                                       const GeneratorOptions& options = GeneratorOptions(),
+                                       const Eigen::VectorXd& goal_joint_position = Eigen::VectorXd());
+
+/**
+ * @brief Generate joint trajectory from a Cartesian path with the time optimal velocity profile under the joint limits
+ *
+ * The IK of the path is solved on a uniform grid of the path length with the step options.time_optimal_grid_step.
+ * The joint velocity and acceleration limits along this joint path, together with the limits of the path velocity
+ * and acceleration, define the time optimal profile, see VelocityProfile_TOPP. The joint positions of its samples are
+ * interpolated on the grid. Since the limits are only enforced at the grid points, the profile is slowed down
+ * uniformly like in generateJointTrajectoryTimeScaled() if a sample still violates a limit.
+ * @param max_path_velocity: limit of the path velocity, must be positive
+ * @param max_path_acceleration: limit of the path acceleration
+ * @param max_path_deceleration: limit of the path deceleration (absolute value)
+ * @param min_time_scaling: smallest time scaling factor, the generation fails below
+ * @param time_scaling: time scaling factor of the generated trajectory relative to the time optimal profile
+ * @param goal_joint_position: known solution of the end of the path, empty if unknown, see computePoseSequenceIK()
+ * @see generateJointTrajectory(KinematicsSession&, const JointLimitsContainer&, const CartesianPath&, ...)
+ */
+bool generateJointTrajectoryTimeOptimal(KinematicsSession& kinematics,
+                                        const JointLimitsContainer& joint_limits,
+                                        const CartesianPath& path,
+                                        double max_path_velocity,
+                                        double max_path_acceleration,
+                                        double max_path_deceleration,
+                                        const Eigen::VectorXd& initial_joint_position,
+                                        const double& sampling_time,
+                                        double min_time_scaling,
+                                        JointTrajectoryBuffer& joint_trajectory,
+                                        double& time_scaling,
+                                        moveit_msgs::MoveItErrorCodes& error_code,
+                                        bool check_self_collision = false,
+                                        const GeneratorOptions& options = GeneratorOptions(),
+                                        const Eigen::VectorXd& goal_joint_position = Eigen::VectorXd());
+
+/**
+ * @brief Generate joint trajectory from the joint space approximation of a Cartesian path
+ *
+ * The joint path interpolates IK solutions at knots of the path by cubic splines. It starts with the knots at the start
+ * and the goal and inserts a knot at the sample of each knot interval which deviates most, until the forward kinematics
+ * of all samples of the velocity profile are within the tolerances of the path. The samples of the joint path are
+ * timed by the velocity profile and checked against the joint limits. Since the splines may overshoot between the
+ * knots, every sample is also checked against the position limits and for self collision.
+ * @param path: Cartesian path
+ * @param velocity_profile: profile of the path parameter over time, defines the duration of the trajectory
+ * @param goal_joint_position: joint position at the end of the path
+ * @param position_tolerance: maximal translational deviation from the path [m]
+ * @param orientation_tolerance: maximal rotational deviation from the path [rad]
+ * @return true if succeed
+ */
+bool generateJointTrajectoryApproximated(KinematicsSession& kinematics,
+                                         const JointLimitsContainer& joint_limits,
+                                         const CartesianPath& path,
+                                         const KDL::VelocityProfile& velocity_profile,
+                                         const Eigen::VectorXd& initial_joint_position,
+                                         const Eigen::VectorXd& goal_joint_position,
+                                         const double& sampling_time,
+                                         double position_tolerance,
+                                         double orientation_tolerance,
+                                         JointTrajectoryBuffer& joint_trajectory,
+                                         moveit_msgs::MoveItErrorCodes& error_code,
+                                         bool check_self_collision = false);
+
+/**
+ * @brief check the manipulability at sparse points of a Cartesian path before its dense sampling
+ *
+ * The path is divided into options.singularity_prescan_intervals intervals of equal path length. The end points are
+ * evaluated at the initial and the goal joint position, the inner points at the IK solution seeded by the joint
+ * interpolation between them (by the previous point if the goal is unknown). Points without IK solution are skipped,
+ * they are reported by the dense sampling. See KinematicsSession::computeManipulability().
+ * @param kinematics: kinematics session of the planning group and target link
+ * @param path: Cartesian path
+ * @param initial_joint_position: joint position of the start of the path, ordered like kinematics.getJointNames()
+ * @param goal_joint_position: joint position of the end of the path, empty if unknown
+ * @param options: options of the trajectory generation
+ * @param min_manipulability: smallest manipulability of the evaluated points
+ * @param min_path_parameter: path parameter of the smallest manipulability
+ * @return true if no point is below options.singularity_prescan_min_manipulability
+ */
+bool checkPathManipulability(KinematicsSession& kinematics,
+                             const CartesianPath& path,
+                             const Eigen::VectorXd& initial_joint_position,
+                             const Eigen::VectorXd& goal_joint_position,
+                             const GeneratorOptions& options,
+                             double& min_manipulability,
+                             double& min_path_parameter);
+
 /**
  * @brief Generate joint trajectory from a MultiDOFJointTrajectory
  * @param trajectory: Cartesian trajectory
@@ -150,6 +458,23 @@ bool generateJointTrajectory(const robot_model::RobotModelConstPtr& robot_model,
                              moveit_msgs::MoveItErrorCodes& error_code,
                              bool check_self_collision = false);
 
+/**
+ * @brief Generate joint trajectory from a MultiDOFJointTrajectory using an existing kinematics session
+ * @param kinematics: kinematics session of the planning group and target link
+ * @param initial_joint_position: initial joint positions, ordered like kinematics.getJointNames()
+ * @param initial_joint_velocity: initial joint velocities, ordered like kinematics.getJointNames()
+ * @see generateJointTrajectory(const robot_model::RobotModelConstPtr&, const JointLimitsContainer&,
+ * const pilz::CartesianTrajectory&, ...)
+ */
+bool generateJointTrajectory(KinematicsSession& kinematics,
+                             const JointLimitsContainer& joint_limits,
+                             const pilz::CartesianTrajectory& trajectory,
+                             const Eigen::VectorXd& initial_joint_position,
+                             const Eigen::VectorXd& initial_joint_velocity,
+                             trajectory_msgs::JointTrajectory& joint_trajectory,
+                             moveit_msgs::MoveItErrorCodes& error_code,
+                             bool check_self_collision = false);
+
 
 /**
  * @brief Determines the sampling time and checks that both trajectroies use the
@@ -195,15 +520,44 @@ bool isRobotStateStationary(const robot_state::RobotStatePtr& state,
  * @param inverseOrder TRUE: Farthest element from blending sphere center is located at the
  * smallest index of trajectroy.
  * @param index The intersection index which has to be determined.
+ * @param tip_pose_track Poses of the link at the way points of the trajectory, computed by forward kinematics if
+ * nullptr.
  */
 bool linearSearchIntersectionPoint(const std::string &link_name,
                                    const Eigen::Vector3d &center_position,
                                    const double &r,
                                    const robot_trajectory::RobotTrajectoryPtr& traj,
                                    bool inverseOrder,
-                                   std::size_t &index);
+                                   std::size_t &index,
+                                   const TipPoseTrackConstPtr& tip_pose_track = nullptr);
 
 
+/**
+ * @brief Search the intersection point of the trajectory with the blending sphere and the time of the crossing.
+ *
+ * The index is the same as of linearSearchIntersectionPoint(). Trajectories with a tip pose track of the link are
+ * sampled from a Cartesian path, their distance to the sphere center grows monotonically away from the center.
+ * The intersection is bracketed by galloping steps and located by bisection over the tracked positions. If a probed
+ * distance contradicts the monotonicity or the trajectory has no track, the linear search is used.
+ * @param center_position Center of blending sphere.
+ * @param r Radius of blending sphere.
+ * @param traj The trajectory.
+ * @param inverseOrder TRUE: Farthest element from blending sphere center is located at the
+ * smallest index of trajectroy.
+ * @param index The intersection index which has to be determined.
+ * @param crossing_time Time from start at which the link crosses the sphere, interpolated between the
+ * intersection index and its neighbour outside of the sphere.
+ * @param tip_pose_track Poses of the link at the way points of the trajectory as generated, nullptr if unknown.
+ */
+bool searchIntersectionPoint(const std::string &link_name,
+                             const Eigen::Vector3d &center_position,
+                             const double &r,
+                             const robot_trajectory::RobotTrajectoryPtr& traj,
+                             bool inverseOrder,
+                             std::size_t &index,
+                             double &crossing_time,
+                             const TipPoseTrackConstPtr& tip_pose_track = nullptr);
+
 bool intersectionFound(const Eigen::Vector3d &p_center,
                        const Eigen::Vector3d &p_current,
                        const Eigen::Vector3d &p_next,
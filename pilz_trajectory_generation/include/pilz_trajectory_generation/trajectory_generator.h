@@ -25,7 +25,12 @@
 #include <kdl/trajectory.hpp>
 
 #include "pilz_extensions/joint_limits_extension.h"
+#include "pilz_trajectory_generation/cartesian_path.h"
+#include "pilz_trajectory_generation/generated_trajectory_info.h"
+#include "pilz_trajectory_generation/generator_options.h"
+#include "pilz_trajectory_generation/joint_trajectory_buffer.h"
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/kinematics_session.h"
 #include "pilz_trajectory_generation/trajectory_functions.h"
 
 namespace pilz {
@@ -40,8 +45,9 @@ class TrajectoryGenerator
 public:
 
   TrajectoryGenerator(const robot_model::RobotModelConstPtr& robot_model,
-                      const pilz::LimitsContainer& planner_limits)
-    :robot_model_(robot_model), planner_limits_(planner_limits), MIN_SCALING_FACTOR(0.0001)
+                      const pilz::LimitsContainer& planner_limits,
+                      const pilz::GeneratorOptions& options = pilz::GeneratorOptions())
+    :robot_model_(robot_model), planner_limits_(planner_limits), options_(options), MIN_SCALING_FACTOR(0.0001)
   {
   }
 
@@ -58,6 +64,16 @@ public:
                         planning_interface::MotionPlanResponse&  res,
                         double sampling_time=0.008) = 0;
 
+  /**
+   * @brief generate robot trajectory with given sampling time
+   * @param info: results besides the motion plan response, only set on success
+   * @see generate(const planning_interface::MotionPlanRequest&, planning_interface::MotionPlanResponse&, double)
+   */
+  virtual bool generate(const planning_interface::MotionPlanRequest& req,
+                        planning_interface::MotionPlanResponse&  res,
+                        GeneratedTrajectoryInfo& info,
+                        double sampling_time=0.008) = 0;
+
 protected:
   /**
    * @brief This class is used to extract needed information from motion plan request.
@@ -69,8 +85,13 @@ protected:
     std::string link_name;
     Eigen::Affine3d start_pose;
     Eigen::Affine3d goal_pose;
-    std::map<std::string, double> start_joint_position;
-    std::map<std::string, double> goal_joint_position;
+    /// active joints of the planning group, defines the order of the joint positions
+    std::vector<std::string> joint_names;
+    Eigen::VectorXd start_joint_position;
+    /// velocity of the start state, zero if the start state has no velocity
+    Eigen::VectorXd start_joint_velocity;
+    /// joint goal of the request or the IK solution of the Cartesian goal, ordered like joint_names
+    Eigen::VectorXd goal_joint_position;
     std::pair<std::string, Eigen::Vector3d> circ_path_point;
   };
 
@@ -82,7 +103,7 @@ protected:
    *    - req.group_name is a JointModelGroup of the Robotmodel, moveit_msgs::MoveItErrorCodes::INVALID_GROUP_NAME on failure
    *    - req.start_state.joint_state is not empty, moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE on failure
    *    - req.start_state.joint_state is within the limits, moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE on failure
-   *    - req.start_state.joint_state is all zero, moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE on failure
+   *    - req.start_state.joint_state.velocity is accepted by validateStartVelocity()
    *    - req.goal_constraints must have exactly 1 defined cartesian oder joint constraint
    *      moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS on failure
    * A joint goal is checked for:
@@ -101,26 +122,70 @@ protected:
   virtual bool validateRequest(const planning_interface::MotionPlanRequest& req,
                                moveit_msgs::MoveItErrorCodes& error_code) const;
 
+  /**
+   * @brief Validate the velocity of the start state, called by validateRequest()
+   *
+   * The default implementation requires a start state at rest.
+   * @param req: motion plan request
+   * @param error_code: moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE on failure
+   * @return true if the start velocity can be planned from
+   */
+  virtual bool validateStartVelocity(const planning_interface::MotionPlanRequest& req,
+                                     moveit_msgs::MoveItErrorCodes& error_code) const;
+
   /**
    * @brief build cartesian velocity profile for the path
    *
    * Uses the path to get the cartesian length and the angular distance from start to goal.
-   * The trap profile returns uses the longer distance of translational and rotational motion.
+   * The profile uses the longer distance of translational and rotational motion. It is an asymmetric trapezoid which
+   * accelerates with the translational acceleration limit and decelerates with the translational deceleration limit,
+   * or an S-curve additionally limited by the translational jerk if options.jerk_limited_profile is set and the jerk
+   * limit is defined.
+   * @param time_scaling: slows the profile down in time, scales the velocity by the factor, the acceleration by its
+   * square and the jerk by its cube
    */
-  virtual std::unique_ptr<KDL::VelocityProfile> cartesianTrapVelocityProfile(
+  virtual std::unique_ptr<KDL::VelocityProfile> cartesianVelocityProfile(
       const planning_interface::MotionPlanRequest &req,
       const MotionPlanInfo &plan_info,
-      const std::unique_ptr<KDL::Path> &path) const;
+      const CartesianPath &path,
+      double time_scaling = 1.0) const;
+
+  /**
+   * @brief sample the Cartesian path with its velocity profile and compute the joint trajectory using inverse kinematics
+   *
+   * If options.velocity_scaling_search is set, the profile is slowed down to the fastest one which obeys the joint
+   * limits, see generateJointTrajectoryTimeScaled(). If options.time_optimal_parameterization is set, the time optimal
+   * profile under the joint limits and the scaled Cartesian limits is used instead, see
+   * generateJointTrajectoryTimeOptimal(). The goal joint position of the plan info is the last sample if the sampled
+   * solutions reach it continuously.
+   * If options.singularity_prescan is set, the manipulability along the path is checked before, see
+   * checkPathManipulability(). A path below the minimal manipulability fails with
+   * moveit_msgs::MoveItErrorCodes::PLANNING_FAILED, unless the trajectory may be slowed down by one of the options
+   * above.
+   * @param scaling: scaling factors of the generated trajectory, reduced by the time scaling of both options
+   * @return true if succeed, error_code is set on failure
+   */
+  bool generateCartesianJointTrajectory(const planning_interface::MotionPlanRequest &req,
+                                        const MotionPlanInfo &plan_info,
+                                        KinematicsSession &kinematics,
+                                        const CartesianPath &path,
+                                        double sampling_time,
+                                        JointTrajectoryBuffer &joint_trajectory,
+                                        TrajectoryScaling &scaling,
+                                        moveit_msgs::MoveItErrorCodes &error_code) const;
 
   /**
    * @brief Extract needed information from a motion plan request in order to simplify
    * further usages.
    * @param req: motion plan request
+   * @param kinematics: kinematics session of the requested planning group, the target link is set
+   * to info.link_name
    * @param info: information extracted from motion plan request which is necessary for the planning
    * @param error_code: MoveItErrorCodes which indicates the detailed error
    * @return: true if planning information is successfully extracted
    */
   virtual bool extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
+                                     KinematicsSession& kinematics,
                                      MotionPlanInfo& info,
                                      moveit_msgs::MoveItErrorCodes& error_code) const = 0;
 
@@ -130,10 +195,11 @@ protected:
    * @param res: MotionPlanResponse
    * @param joint_trajectory
    * @param err_code
+   * @return false if err_code is not SUCCESS or the conversion into a robot trajectory fails (FAILURE)
    */
   bool setResponse(const planning_interface::MotionPlanRequest& req,
                    planning_interface::MotionPlanResponse& res,
-                   const trajectory_msgs::JointTrajectory& joint_trajectory,
+                   const JointTrajectoryBuffer& joint_trajectory,
                    const moveit_msgs::MoveItErrorCodes& err_code,
                    const ros::Time &planning_start) const;
 
@@ -141,6 +207,7 @@ protected:
 protected:
   const robot_model::RobotModelConstPtr robot_model_;
   const pilz::LimitsContainer planner_limits_;
+  const pilz::GeneratorOptions options_;
   const double MIN_SCALING_FACTOR;
 };
 
@@ -19,7 +19,6 @@
 #define TRAJECTORY_GENERATOR_CIRC_H
 
 #include <eigen3/Eigen/Eigen>
-#include <kdl/path.hpp>
 #include <kdl/velocityprofile.hpp>
 #include "pilz_trajectory_generation/trajectory_generator.h"
 
@@ -38,9 +37,11 @@ public:
    * @throw TrajectoryGeneratorInvalidLimitsException
    * @param model: robot model
    * @param planner_limits: limits in joint and Cartesian spaces
+   * @param options: options of the trajectory generation
    */
   TrajectoryGeneratorCIRC(const robot_model::RobotModelConstPtr& robot_model,
-                          const pilz::LimitsContainer& planner_limits);
+                          const pilz::LimitsContainer& planner_limits,
+                          const pilz::GeneratorOptions& options = pilz::GeneratorOptions());
 
   ~TrajectoryGeneratorCIRC();
 
@@ -75,6 +76,15 @@ public:
                         planning_interface::MotionPlanResponse& res,
                         double sampling_time=0.1) override;
 
+  /**
+   * @copydoc generate(const planning_interface::MotionPlanRequest&, planning_interface::MotionPlanResponse&, double)
+   * @param info: results besides the motion plan response, only set on success
+   */
+  virtual bool generate(const planning_interface::MotionPlanRequest& req,
+                        planning_interface::MotionPlanResponse& res,
+                        GeneratedTrajectoryInfo& info,
+                        double sampling_time=0.1) override;
+
 private:
 
   /**
@@ -89,22 +99,24 @@ private:
   /**
    * @brief extractMotionPlanInfo
    * @param req
+   * @param kinematics
    * @param info
    * @param error_code
    * @return
    */
   virtual bool extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req,
+                                     KinematicsSession& kinematics,
                                      MotionPlanInfo &info,
                                      moveit_msgs::MoveItErrorCodes &error_code) const final;
 
   /**
-   * @brief construct a KDL::Path object for a Cartesian path of an arc
+   * @brief construct the Cartesian path of an arc
    * @param req: motion plan request
    * @param error_code: moveit error code
    * @return a unique pointer of the path object. null_ptr in case of an error.
    */
-  std::unique_ptr<KDL::Path> setPathCIRC(const MotionPlanInfo &info,
-                                         moveit_msgs::MoveItErrorCodes &error_code) const;
+  std::unique_ptr<CartesianPath> setPathCIRC(const MotionPlanInfo &info,
+                                             moveit_msgs::MoveItErrorCodes &error_code) const;
 
 
 };
@@ -21,7 +21,6 @@
 #include "eigen3/Eigen/Eigen"
 #include "pilz_trajectory_generation/trajectory_generator.h"
 #include "pilz_trajectory_generation/velocity_profile_atrap.h"
-#include <kdl/rotational_interpolation_sa.hpp>
 
 namespace pilz {
 
@@ -30,6 +29,8 @@ namespace pilz {
 /**
  * @brief This class implements a linear trajectory generator in Cartesian space.
  * The Cartesian trajetory are based on trapezoid velocity profile.
+ * If options.lin_approximation is set, the line is approximated in joint space within the tolerances of the options,
+ * see generateJointTrajectoryApproximated().
  */
 class TrajectoryGeneratorLIN : public TrajectoryGenerator
 {
@@ -39,9 +40,11 @@ public:
    * @throw TrajectoryGeneratorInvalidLimitsException
    * @param model: robot model
    * @param planner_limits: limits in joint and Cartesian spaces
+   * @param options: options of the trajectory generation
    */
   TrajectoryGeneratorLIN(const robot_model::RobotModelConstPtr& robot_model,
-                         const pilz::LimitsContainer& planner_limits);
+                         const pilz::LimitsContainer& planner_limits,
+                         const pilz::GeneratorOptions& options = pilz::GeneratorOptions());
 
   ~TrajectoryGeneratorLIN();
 
@@ -73,28 +76,39 @@ public:
                         planning_interface::MotionPlanResponse& res,
                         double sampling_time=0.1) override;
 
+  /**
+   * @copydoc generate(const planning_interface::MotionPlanRequest&, planning_interface::MotionPlanResponse&, double)
+   * @param info: results besides the motion plan response, only set on success
+   */
+  virtual bool generate(const planning_interface::MotionPlanRequest& req,
+                        planning_interface::MotionPlanResponse& res,
+                        GeneratedTrajectoryInfo& info,
+                        double sampling_time=0.1) override;
+
 private:
 
   /**
    * @brief Extract needed information from a motion plan request in order to simplify
    * further usages.
    * @param req: motion plan request
+   * @param kinematics: kinematics session of the requested planning group
    * @param info: information extracted from motion plan request which is necessary for the planning
    * @param error_code: MoveItErrorCodes which indicates the detailed error
    * @return: ture if planning information is successfully extracted
    */
   virtual bool extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
+                                     KinematicsSession& kinematics,
                                      MotionPlanInfo& info,
                                      moveit_msgs::MoveItErrorCodes& error_code) const final;
 
   /**
-   * @brief construct a KDL::Path object for a Cartesian straight line
+   * @brief construct the Cartesian path of a straight line
    * @param req: motion plan request
    * @param error_code: moveit error code
    * @return a unique pointer of the path object. null_ptr in case of an error.
    */
-  std::unique_ptr<KDL::Path> setPathLIN(const MotionPlanInfo &info,
-                                        moveit_msgs::MoveItErrorCodes &error_code) const;
+  std::unique_ptr<CartesianPath> setPathLIN(const MotionPlanInfo &info,
+                                            moveit_msgs::MoveItErrorCodes &error_code) const;
 
 };
 
@@ -21,6 +21,8 @@
 #include "eigen3/Eigen/Eigen"
 #include "pilz_trajectory_generation/trajectory_generator.h"
 #include "pilz_trajectory_generation/velocity_profile_atrap.h"
+#include "pilz_trajectory_generation/velocity_profile_scurve.h"
+#include "pilz_trajectory_generation/ptp_trajectory.h"
 
 namespace pilz {
 
@@ -28,7 +30,7 @@ namespace pilz {
 
 /**
  * @brief This class implements a point-to-point trajectory generator based on
- * VelocityProfile_ATrap.
+ * VelocityProfile_ATrap, or VelocityProfile_SCurve if the jerk limited profile is enabled by the options.
  */
 class TrajectoryGeneratorPTP : public TrajectoryGenerator
 {
@@ -37,9 +39,11 @@ public:
    * @brief Constructor of PTP Trajectory Generator
    * @throw TrajectoryGeneratorInvalidLimitsException
    * @param model: a map of joint limits information
+   * @param options: options of the trajectory generation
    */
   TrajectoryGeneratorPTP(const robot_model::RobotModelConstPtr& robot_model,
-                         const pilz::LimitsContainer& planner_limits);
+                         const pilz::LimitsContainer& planner_limits,
+                         const pilz::GeneratorOptions& options = pilz::GeneratorOptions());
 
   ~TrajectoryGeneratorPTP();
 
@@ -72,39 +76,150 @@ public:
                         planning_interface::MotionPlanResponse&  res,
                         double sampling_time=0.1) override;
 
+  /**
+   * @copydoc generate(const planning_interface::MotionPlanRequest&, planning_interface::MotionPlanResponse&, double)
+   * @param info: results besides the motion plan response, only set on success
+   */
+  virtual bool generate(const planning_interface::MotionPlanRequest& req,
+                        planning_interface::MotionPlanResponse&  res,
+                        GeneratedTrajectoryInfo& info,
+                        double sampling_time=0.1) override;
+
+  /**
+   * @brief generate the analytic representation of a ptp trajectory instead of sampled points
+   *
+   * The trajectory can be sampled with any sampling time by PTPTrajectoryEvaluator.
+   * Only the trapezoidal velocity profile has an analytic representation.
+   * This is a library function only, the planner plugin always returns the sampled trajectory of generate().
+   * @param req: motion plan request, the same fields as for generate() are used
+   * @param trajectory: phase durations and coefficients of all joints
+   * @param error_code: MoveItErrorCodes which indicates the detailed error
+   * @return motion plan succeed/fail
+   */
+  bool generateAnalytic(const planning_interface::MotionPlanRequest& req,
+                        PTPTrajectory& trajectory,
+                        moveit_msgs::MoveItErrorCodes& error_code);
+
 private:
 
   /**
    * @brief Extract needed information from a motion plan request in order to simplify
    * further usages.
    * @param req: motion plan request
+   * @param kinematics: kinematics session of the requested planning group
    * @param info: information extracted from motion plan request which is necessary for the planning
    * @param error_code: MoveItErrorCodes which indicates the detailed error
    * @return: ture if planning information is successfully extracted
    */
   virtual bool extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
+                                     KinematicsSession& kinematics,
                                      MotionPlanInfo& info,
                                      moveit_msgs::MoveItErrorCodes& error_code) const override;
 
   /**
-   * @brief plan ptp joint trajectory with zero start velocity
+   * @brief Validate the velocity of the start state
+   *
+   * A start velocity is accepted if it is given for all joints of the start state and does not exceed the scaled
+   * velocity limit of the joint.
+   * @param req: motion plan request
+   * @param error_code: moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE on failure
+   * @return true if the start velocity can be planned from
+   */
+  virtual bool validateStartVelocity(const planning_interface::MotionPlanRequest& req,
+                                     moveit_msgs::MoveItErrorCodes& error_code) const override;
+
+  /**
+   * @brief plan ptp joint trajectory
+   * @param joint_names: names of the joints, defines the order of the joint positions
    * @param start_pos
+   * @param start_vel
    * @param goal_pos
    * @param joint_trajectory
    * @param velocity_scaling_factor
    * @param acceleration_scaling_factor
    * @param sampling_time
+   * @return false if the joints cannot be synchronized to common phase durations
    */
-  void planPTP(const std::map<std::string, double>& start_pos,
-               const std::map<std::string, double>& goal_pos,
-               trajectory_msgs::JointTrajectory& joint_trajectory,
+  bool planPTP(const std::vector<std::string>& joint_names,
+               const Eigen::VectorXd& start_pos,
+               const Eigen::VectorXd& start_vel,
+               const Eigen::VectorXd& goal_pos,
+               JointTrajectoryBuffer& joint_trajectory,
                const double& velocity_scaling_factor,
                const double& acceleration_scaling_factor,
                const double& sampling_time);
 
+  /**
+   * @brief plan ptp joint trajectory with zero start velocity and jerk limited velocity profiles
+   * @param joint_names: names of the joints, defines the order of the joint positions
+   * @param start_pos
+   * @param goal_pos
+   * @param joint_trajectory
+   * @param velocity_scaling_factor
+   * @param acceleration_scaling_factor: also scales the jerk limits
+   * @param sampling_time
+   * @return false if the joints cannot be synchronized to common phase durations
+   */
+  bool planPTPJerkLimited(const std::vector<std::string>& joint_names,
+                          const Eigen::VectorXd& start_pos,
+                          const Eigen::VectorXd& goal_pos,
+                          JointTrajectoryBuffer& joint_trajectory,
+                          const double& velocity_scaling_factor,
+                          const double& acceleration_scaling_factor,
+                          const double& sampling_time);
+
+  /**
+   * @brief plan the analytic ptp trajectory with zero start velocity
+   * @param joint_names: names of the joints, defines the order of the joint positions
+   * @param start_pos
+   * @param goal_pos
+   * @param trajectory
+   * @param velocity_scaling_factor
+   * @param acceleration_scaling_factor
+   * @return false if not all joints can be synchronized to common phase durations
+   */
+  bool planPTPAnalytic(const std::vector<std::string>& joint_names,
+                       const Eigen::VectorXd& start_pos,
+                       const Eigen::VectorXd& goal_pos,
+                       PTPTrajectory& trajectory,
+                       const double& velocity_scaling_factor,
+                       const double& acceleration_scaling_factor);
+
+  /**
+   * @brief compute the velocity profiles of all joints with their own limits, synchronized to the fastest
+   * common phase durations
+   * @param joint_names: names of the joints, defines the order of the joint positions
+   * @param start_pos
+   * @param start_vel
+   * @param goal_pos
+   * @param velocity_scaling_factor
+   * @param acceleration_scaling_factor
+   * @param velocity_profile: profile of each joint
+   * @param leading_axis: index of the slowest joint
+   * @return false if the profile of a joint cannot be synchronized, it keeps its fastest profile
+   */
+  bool planVelocityProfiles(const std::vector<std::string>& joint_names,
+                            const Eigen::VectorXd& start_pos,
+                            const Eigen::VectorXd& start_vel,
+                            const Eigen::VectorXd& goal_pos,
+                            const double& velocity_scaling_factor,
+                            const double& acceleration_scaling_factor,
+                            std::vector<VelocityProfile_ATrap>& velocity_profile,
+                            std::size_t& leading_axis) const;
+
+  /**
+   * @brief check if the jerk limited profile is enabled and all given joints have jerk limits
+   */
+  bool useJerkLimitedProfile(const std::vector<std::string>& joint_names) const;
+
+  /**
+   * @brief check if all joints are already at their goal positions
+   */
+  bool isGoalReached(const Eigen::VectorXd& start_pos, const Eigen::VectorXd& goal_pos) const;
+
 private:
   const double MIN_MOVEMENT = 0.001;
-  /// ptp planner assume all joints have the same limit
+  /// limits of each joint, the profile of a joint respects its own limits
   pilz::JointLimitsContainer joint_limits_;
   pilz_extensions::JointLimit mostStrictLimit_;
 };
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORY_INFO_CONTEXT_H
+#define TRAJECTORY_INFO_CONTEXT_H
+
+#include <moveit/planning_interface/planning_response.h>
+
+#include "pilz_trajectory_generation/generated_trajectory_info.h"
+
+namespace pilz {
+
+/**
+ * @brief Interface of the planning contexts which return the results of the generator besides the response.
+ *
+ * Users of the planner plugin, e.g. the command list manager, cast the loaded planning context to this interface to
+ * obtain the tip pose track of a trajectory. The interface is header-only so that it can be cast to from every library
+ * loading the plugins.
+ */
+class TrajectoryInfoContext
+{
+public:
+  virtual ~TrajectoryInfoContext() {}
+
+  /**
+   * @brief Calculates a trajectory for the request the context is currently set for
+   * @param info The results of the generator besides the response, e.g. the tip pose track
+   * @return true on success, false otherwise
+   */
+  virtual bool solve(planning_interface::MotionPlanResponse& res, pilz::GeneratedTrajectoryInfo& info) = 0;
+};
+
+}
+
+#endif // TRAJECTORY_INFO_CONTEXT_H
@@ -20,6 +20,9 @@
 
 #include "kdl/velocityprofile.hpp"
 #include <iostream>
+#include <vector>
+
+#include <Eigen/Core>
 
 namespace pilz {
 
@@ -94,6 +97,24 @@ public:
    */
   bool SetProfileStartVelocity(double pos1, double pos2, double vel1);
 
+  /**
+   * @brief Profile with start velocity and given first/constant/third phase durations.
+   * The velocity changes linearly from the start velocity to the constant velocity in the first phase and from the
+   * constant velocity to zero in the third phase. The start velocity may point away from the goal and the goal
+   * may be passed in the first phase. If the velocity changes its direction in the first phase, the first phase
+   * must obey the acceleration and the deceleration limit.
+   * Otherwise the operation will be ignored.
+   * @param pos1: start position
+   * @param pos2: goal position
+   * @param vel1: start velocity
+   * @param duration1: time of the first phase, must be positive
+   * @param duration2: time of the constant phase
+   * @param duration3: time of the third phase, must be positive
+   * @return true if the combination of three durations is valid
+   */
+  bool SetProfileStartVelocityAllDurations(double pos1, double pos2, double vel1,
+                                           double duration1, double duration2, double duration3);
+
   /**
    * @brief get the time of first phase
    * @return
@@ -152,6 +173,7 @@ public:
   virtual KDL::VelocityProfile* Clone() const override;
 
   friend std::ostream &operator<<(std::ostream& os, const VelocityProfile_ATrap& p); //LCOV_EXCL_LINE
+  friend class VelocityProfile_ATrapBatch;
 
   virtual ~VelocityProfile_ATrap();
 
@@ -185,6 +207,64 @@ private:
 
 std::ostream &operator<<(std::ostream& os, const VelocityProfile_ATrap& p);//LCOV_EXCL_LINE
 
+/**
+ * @brief Evaluation of the profiles of all joints at once.
+ *
+ * The coefficients and phase times of all profiles are stored per phase in arrays over the joints. Each joint
+ * keeps a phase cursor which is moved forward with the time, the coefficients of the current phases are then
+ * evaluated for all joints in one vectorized expression. The results are identical to
+ * VelocityProfile_ATrap::Pos(), Vel() and Acc().
+ */
+class VelocityProfile_ATrapBatch
+{
+public:
+  /**
+   * @brief Constructor
+   * @param profiles: profile of each joint, defines the order of the joint values
+   */
+  explicit VelocityProfile_ATrapBatch(const std::vector<VelocityProfile_ATrap>& profiles);
+
+  /**
+   * @brief move the phase cursors back to the beginning
+   */
+  void reset();
+
+  /**
+   * @brief evaluate all profiles at the given time
+   *
+   * The time must not be smaller than the time of the previous call since reset().
+   * @param time
+   * @param positions: position of each joint
+   * @param velocities: velocity of each joint
+   * @param accelerations: acceleration of each joint
+   */
+  void evaluate(double time,
+                Eigen::Ref<Eigen::VectorXd> positions,
+                Eigen::Ref<Eigen::VectorXd> velocities,
+                Eigen::Ref<Eigen::VectorXd> accelerations);
+
+private:
+  /// before the motion, the three phases of the trapezoid and after the motion
+  static constexpr int PHASE_COUNT {5};
+
+  /// the phase of joint i is entered at the time phase_begin_(i, phase-1)
+  Eigen::ArrayXXd phase_begin_;
+
+  /// coefficients of each joint (row) and phase (column)
+  Eigen::ArrayXXd pos_coef0_, pos_coef1_, pos_coef2_;
+  Eigen::ArrayXXd vel_coef0_, vel_coef1_;
+  Eigen::ArrayXXd time_shift1_, time_shift2_;
+  Eigen::ArrayXXd acc_;
+
+  /// phase cursors and the coefficients of the current phases
+  std::vector<int> phase_, acc_phase_;
+  Eigen::ArrayXd cur_pos_coef0_, cur_pos_coef1_, cur_pos_coef2_;
+  Eigen::ArrayXd cur_vel_coef0_, cur_vel_coef1_;
+  Eigen::ArrayXd cur_time_shift1_, cur_time_shift2_;
+  Eigen::ArrayXd cur_acc_;
+  Eigen::ArrayXd dt_;
+};
+
 }
 
 #endif // VELOCITY_PROFILE_ATRAP_H
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VELOCITY_PROFILE_SCURVE_H
+#define VELOCITY_PROFILE_SCURVE_H
+
+#include "kdl/velocityprofile.hpp"
+#include <iostream>
+#include <vector>
+
+namespace pilz {
+
+/**
+ * @brief A PTP Trajectory Generator of jerk limited (S-curve) velocity profile.
+ * Counterpart of VelocityProfile_ATrap with the same three phases:
+ *   - The acceleration and the deceleration phase ramp the acceleration up and down with limited jerk,
+ *     the acceleration is zero at the begin and the end of each phase.
+ *   - Maximal acceleration and deceleration can be different.
+ *   - Function to generate full synchronized PTP trajectory is provided.
+ *   - Function to generate velocity profile with start velocity.
+ */
+class VelocityProfile_SCurve : public KDL::VelocityProfile
+{
+public:
+  /**
+   * @brief Constructor
+   * @param max_vel: maximal velocity (absolute value, always positive)
+   * @param max_acc: maximal acceleration (absolute value, always positive)
+   * @param max_dec: maximal deceleration (absolute value, always positive)
+   * @param max_jerk: maximal jerk (absolute value, always positive)
+   */
+  VelocityProfile_SCurve(double max_vel = 0, double max_acc = 0, double max_dec = 0, double max_jerk = 0);
+
+  /**
+   * @brief compute the fastest profile
+   * Algorithm:
+   *  - compute the minimal distance which is needed to reach maximal velocity
+   *  - if maximal velocity can be reached
+   *     - add a constant velocity phase for the remaining distance
+   *  - if maximal velocity can not be reached
+   *     - search the velocity which can be reached within the distance
+   *
+   * @param pos1: start position
+   * @param pos2: goal position
+   */
+  virtual void SetProfile(double pos1, double pos2) override;
+
+  /**
+   * @brief Profile scaled by the total duration
+   * @param pos1: start position
+   * @param pos2: goal position
+   * @param duration: trajectory duration (must be longer than fastest case, otherwise will be ignored)
+   */
+  virtual void SetProfileDuration(double pos1, double pos2, double duration) override;
+
+  /**
+   * @brief Profile with given acceleration/constant/deceleration durations.
+   * Each duration must obey the maximal velocity/acceleration/deceleration/jerk constraints.
+   * Otherwise the operation will be ignored.
+   * Algorithm:
+   * - compute the maximal velocity of given durations
+   * - within the acceleration and deceleration phase choose the acceleration ramps with the lowest jerk
+   *   which obey the acceleration/deceleration limit
+   * - if limits are fulfilled
+   *   - compute the segments
+   * @param pos1: start position
+   * @param pos2: goal position
+   * @param duration1: time of acceleration phase
+   * @param duration2: time of constant phase
+   * @param duration3: time of deceleration phase
+   * @return ture if the combination of three durations is valid
+   */
+  bool SetProfileAllDurations(double pos1, double pos2, double duration1, double duration2, double duration3);
+
+  /**
+   * @brief Profile with start velocity and zero start acceleration
+   * Note: As VelocityProfile_ATrap::SetProfileStartVelocity() the start velocity must point towards the goal
+   * (vel1*(pos2-pos1)>0). If the goal is within the brake distance, the profile brakes, moves back and stops at
+   * the goal.
+   * @param pos1: start position
+   * @param pos2: goal position
+   * @param vel1: start velocity
+   * @return false if the start velocity points away from the goal
+   */
+  bool SetProfileStartVelocity(double pos1, double pos2, double vel1);
+
+  /**
+   * @brief get the time of first phase
+   * @return
+   */
+  double FirstPhaseDuration() const {return t_a_;}
+  /**
+   * @brief get the time of second phase
+   * @return
+   */
+  double SecondPhaseDuration() const {return t_b_;}
+  /**
+   * @brief get the time of third phase
+   * @return
+   */
+  double ThirdPhaseDuration() const  {return t_c_;}
+
+  /**
+   * @brief Duration
+   * @return total duration of the trajectory
+   */
+  virtual double Duration() const override;
+  /**
+   * @brief Get position at given time
+   * @param time
+   * @return
+   */
+  virtual double Pos(double time) const override;
+  /**
+   * @brief Get velocity at given time
+   * @param time
+   * @return
+   */
+  virtual double Vel(double time) const override;
+  /**
+   * @brief Get given acceleration/deceleration at given time
+   * @param time
+   * @return
+   */
+  virtual double Acc(double time) const override;
+  /**
+   * @brief Write basic information
+   * @param os
+   */
+  virtual void Write(std::ostream& os) const override;
+  /**
+   * @brief returns copy of current VelocityProfile object
+   * @return
+   */
+  virtual KDL::VelocityProfile* Clone() const override;
+
+  friend std::ostream &operator<<(std::ostream& os, const VelocityProfile_SCurve& p); //LCOV_EXCL_LINE
+
+  virtual ~VelocityProfile_SCurve();
+
+private:
+  /**
+   * @brief segment of constant jerk, the state at its begin is stored to evaluate the segment
+   */
+  struct Segment
+  {
+    double begin_time;
+    double duration;
+    double pos, vel, acc;
+    double jerk;
+  };
+
+  /// helper functions
+  void setEmptyProfile();
+
+  /**
+   * @brief append a segment of constant jerk, segments of zero duration are skipped
+   *
+   * The first segment starts at the start position with the start velocity, each further segment at the end of
+   * the previous one.
+   */
+  void appendSegment(double duration, double jerk);
+
+  /**
+   * @brief append a change of the velocity with zero acceleration at begin and end
+   *
+   * The acceleration is ramped up with the given jerk, held and ramped down within the given duration.
+   * @param duration: duration of the change
+   * @param ramp_duration: duration of each of the two acceleration ramps, at most half of the duration
+   * @param delta_vel: signed change of the velocity
+   */
+  void appendVelocityChange(double duration, double ramp_duration, double delta_vel);
+
+  /**
+   * @brief time optimal change of the velocity by delta_vel with the given acceleration limit
+   * @param delta_vel: absolute change of the velocity
+   * @param max_acc: absolute acceleration limit
+   * @param ramp_duration: duration of each acceleration ramp
+   * @return duration of the change
+   */
+  double fastestVelocityChange(double delta_vel, double max_acc, double& ramp_duration) const;
+
+  /**
+   * @brief distance of the fastest rest to rest motion which reaches the given velocity
+   */
+  double restToRestDistance(double vel) const;
+
+  /**
+   * @brief distance of the fastest motion from the start velocity via the given velocity to rest
+   */
+  double startVelocityDistance(double start_vel, double vel) const;
+
+  /**
+   * @brief append the fastest rest to rest motion over the given signed distance
+   * @param distance: signed distance
+   * @param acc_duration: duration of the acceleration phase
+   * @param const_duration: duration of the constant velocity phase
+   * @param dec_duration: duration of the deceleration phase
+   */
+  void appendRestToRest(double distance, double& acc_duration, double& const_duration, double& dec_duration);
+
+private:
+  /// specification of the motion profile :
+  const double max_vel_;
+  const double max_acc_;
+  const double max_dec_;
+  const double max_jerk_;
+  double start_pos_;
+  double end_pos_;
+
+  /// for initial velocity
+  double start_vel_;
+
+  /// segments of constant jerk of all phases
+  std::vector<Segment> segments_;
+
+  /// time of three phases
+  double t_a_; /// the duration of first phase
+  double t_b_; /// the duration of second phase
+  double t_c_; /// the duration of third phase
+};
+
+std::ostream &operator<<(std::ostream& os, const VelocityProfile_SCurve& p);//LCOV_EXCL_LINE
+
+}
+
+#endif // VELOCITY_PROFILE_SCURVE_H
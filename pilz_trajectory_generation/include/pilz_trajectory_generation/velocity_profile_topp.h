@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VELOCITY_PROFILE_TOPP_H
+#define VELOCITY_PROFILE_TOPP_H
+
+#include "kdl/velocityprofile.hpp"
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace pilz {
+
+/**
+ * @brief Time optimal velocity profile of a path parameter under linear constraints along the path.
+ *
+ * The constraints are given on a grid of the path parameter s. At each grid point the squared path velocity
+ * x = ds/dt^2 is bounded from above and the path acceleration u = d^2s/dt^2 is bounded by linear constraints
+ * a*u + b*x <= c. Joint velocity and acceleration limits of a joint path q(s) take this form, since
+ * dq/dt = q'(s)*ds/dt and d^2q/dt^2 = q'(s)*u + q''(s)*x.
+ *
+ * The profile is computed by reachability analysis like TOPP-RA: a backward pass computes at each grid point the
+ * interval of squared path velocities from which the end of the path can be reached at rest, a forward pass starts
+ * at rest and chooses the largest path acceleration which stays within these intervals. The path acceleration is
+ * constant between two grid points.
+ */
+class VelocityProfile_TOPP : public KDL::VelocityProfile
+{
+public:
+  /// rows (a, b, c) of the constraints a*u + b*x <= c of the path acceleration u and the squared path velocity x
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 3> ConstraintMatrix;
+
+  VelocityProfile_TOPP();
+
+  /**
+   * @brief compute the time optimal profile from rest at the first to rest at the last grid point
+   * @param grid: path parameters of the grid points, strictly increasing
+   * @param max_squared_velocity: upper bound of the squared path velocity at each grid point
+   * @param constraints: constraints of the path acceleration from each grid point to its successor, evaluated at the
+   * grid point, one matrix for each grid point except the last
+   * @return false if no feasible profile exists, the profile is empty then
+   */
+  bool SetProfileConstraints(const std::vector<double>& grid,
+                             const std::vector<double>& max_squared_velocity,
+                             const std::vector<ConstraintMatrix>& constraints);
+
+  /**
+   * @brief reset the profile to the time optimal one
+   *
+   * The positions are defined by the grid of SetProfileConstraints(), the arguments are ignored.
+   * @param pos1: start position
+   * @param pos2: goal position
+   */
+  virtual void SetProfile(double pos1, double pos2) override;
+
+  /**
+   * @brief slow the time optimal profile down uniformly in time
+   *
+   * The velocity is scaled by the ratio of the durations and the acceleration by its square.
+   * @param pos1: start position, ignored
+   * @param pos2: goal position, ignored
+   * @param duration: trajectory duration (must be longer than the time optimal one, otherwise will be ignored)
+   */
+  virtual void SetProfileDuration(double pos1, double pos2, double duration) override;
+
+  /**
+   * @brief Duration
+   * @return total duration of the trajectory
+   */
+  virtual double Duration() const override;
+  /**
+   * @brief Get position at given time
+   * @param time
+   * @return
+   */
+  virtual double Pos(double time) const override;
+  /**
+   * @brief Get velocity at given time
+   * @param time
+   * @return
+   */
+  virtual double Vel(double time) const override;
+  /**
+   * @brief Get given acceleration/deceleration at given time
+   * @param time
+   * @return
+   */
+  virtual double Acc(double time) const override;
+  /**
+   * @brief Write basic information
+   * @param os
+   */
+  virtual void Write(std::ostream& os) const override;
+  /**
+   * @brief returns copy of current VelocityProfile object
+   * @return
+   */
+  virtual KDL::VelocityProfile* Clone() const override;
+
+  friend std::ostream &operator<<(std::ostream& os, const VelocityProfile_TOPP& p); //LCOV_EXCL_LINE
+
+  virtual ~VelocityProfile_TOPP();
+
+private:
+  /// helper functions
+  void setEmptyProfile();
+
+  /**
+   * @brief index of the grid interval which contains the time of the unscaled profile
+   */
+  std::size_t interval(double time) const;
+
+  /**
+   * @brief range of the squared path velocity at a grid point from which the successor range can be reached
+   *
+   * Solves the two dimensional linear programs over (u, x) by enumerating the vertices of the feasible polygon.
+   * @param constraints: constraints at the grid point
+   * @param step: distance to the successor
+   * @param max_squared_velocity: upper bound of the squared path velocity at the grid point
+   * @param next_min: lower bound of the squared path velocity at the successor
+   * @param next_max: upper bound of the squared path velocity at the successor
+   * @param min: smallest feasible squared path velocity
+   * @param max: largest feasible squared path velocity
+   * @return false if the range is empty
+   */
+  static bool controllableRange(const ConstraintMatrix& constraints,
+                                double step,
+                                double max_squared_velocity,
+                                double next_min,
+                                double next_max,
+                                double& min,
+                                double& max);
+
+private:
+  /// path parameters of the grid points
+  std::vector<double> grid_;
+  /// path velocity at the grid points
+  std::vector<double> velocities_;
+  /// constant path acceleration from each grid point to its successor
+  std::vector<double> accelerations_;
+  /// time of the grid points
+  std::vector<double> times_;
+
+  /// ratio of the time optimal duration and the duration of the profile
+  double time_scaling_;
+};
+
+std::ostream &operator<<(std::ostream& os, const VelocityProfile_TOPP& p);//LCOV_EXCL_LINE
+
+}
+
+#endif // VELOCITY_PROFILE_TOPP_H
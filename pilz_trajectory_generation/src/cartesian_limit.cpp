@@ -24,6 +24,8 @@ pilz::CartesianLimit::CartesianLimit():
   max_trans_acc_(0.0),
   has_max_trans_dec_(false),
   max_trans_dec_(0.0),
+  has_max_trans_jerk_(false),
+  max_trans_jerk_(0.0),
   has_max_rot_vel_(false),
   max_rot_vel_(0.0)
 {
@@ -84,6 +86,24 @@ double pilz::CartesianLimit::getMaxTranslationalDeceleration() const
   return max_trans_dec_;
 }
 
+// Translational Jerk Limit
+
+bool pilz::CartesianLimit::hasMaxTranslationalJerk() const
+{
+  return has_max_trans_jerk_;
+}
+
+void pilz::CartesianLimit::setMaxTranslationalJerk(double max_trans_jerk)
+{
+  has_max_trans_jerk_ = true;
+  max_trans_jerk_ = max_trans_jerk;
+}
+
+double pilz::CartesianLimit::getMaxTranslationalJerk() const
+{
+  return max_trans_jerk_;
+}
+
 // Rotational Velocity Limit
 
 bool pilz::CartesianLimit::hasMaxRotationalVelocity() const
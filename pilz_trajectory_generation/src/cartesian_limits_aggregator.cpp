@@ -24,6 +24,7 @@ static const std::string param_cartesian_limits_ns = "cartesian_limits";
 static const std::string param_max_trans_vel = "max_trans_vel";
 static const std::string param_max_trans_acc = "max_trans_acc";
 static const std::string param_max_trans_dec = "max_trans_dec";
+static const std::string param_max_trans_jerk = "max_trans_jerk";
 static const std::string param_max_rot_vel = "max_rot_vel";
 static const std::string param_max_rot_acc = "max_rot_acc";
 static const std::string param_max_rot_dec = "max_rot_dec";
@@ -56,6 +57,13 @@ pilz::CartesianLimit pilz::CartesianLimitsAggregator::getAggregatedLimits(const
     cartesian_limit.setMaxTranslationalDeceleration(max_trans_dec);
   }
 
+  // translational jerk
+  double max_trans_jerk;
+  if(nh.getParam(param_prefix + param_max_trans_jerk, max_trans_jerk))
+  {
+    cartesian_limit.setMaxTranslationalJerk(max_trans_jerk);
+  }
+
   // rotational velocity
   double max_rot_vel;
   if(nh.getParam(param_prefix + param_max_rot_vel, max_rot_vel))
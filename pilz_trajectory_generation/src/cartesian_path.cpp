@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/cartesian_path.h"
+
+#include <cmath>
+
+#include <kdl/utilities/error.h>
+
+namespace pilz {
+
+/// same as KDL::epsilon, below which the geometry of a circle is degenerated
+static const double CIRCLE_EPSILON = 1e-6;
+
+CartesianPath::CartesianPath(const Eigen::Matrix3d &start_orientation, const Eigen::Matrix3d &goal_orientation)
+  : start_orientation_(start_orientation)
+{
+  start_orientation_.normalize();
+  Eigen::Quaterniond goal(goal_orientation);
+  goal.normalize();
+
+  // the angle of the angle-axis representation of a quaternion is within [0, pi]
+  const Eigen::AngleAxisd start_goal(start_orientation_.conjugate() * goal);
+  rotation_axis_ = start_goal.axis();
+  rotation_angle_ = start_goal.angle();
+}
+
+void CartesianPath::setPathLength(double distance, double eqradius)
+{
+  // the slower motion defines the path length, the other one is scaled to it
+  if(rotation_angle_ != 0 && rotation_angle_ * eqradius > distance)
+  {
+    path_length_ = rotation_angle_ * eqradius;
+    scale_rotation_ = 1 / eqradius;
+    scale_translation_ = distance / path_length_;
+  }
+  else if(distance != 0)
+  {
+    path_length_ = distance;
+    scale_rotation_ = rotation_angle_ / path_length_;
+    scale_translation_ = 1;
+  }
+  else
+  {
+    path_length_ = 0;
+    scale_rotation_ = 1;
+    scale_translation_ = 1;
+  }
+}
+
+CartesianPathLine::CartesianPathLine(const Eigen::Affine3d &start_pose, const Eigen::Affine3d &goal_pose,
+                                     double eqradius)
+  : CartesianPath(start_pose.linear(), goal_pose.linear()),
+    start_position_(start_pose.translation()),
+    direction_(goal_pose.translation() - start_pose.translation())
+{
+  const double distance = direction_.norm();
+  if(distance > 0)
+  {
+    direction_ /= distance;
+  }
+  setPathLength(distance, eqradius);
+}
+
+Eigen::Affine3d CartesianPathLine::getPose(double s) const
+{
+  Eigen::Affine3d pose;
+  pose.linear() = orientation(s);
+  pose.translation() = start_position_ + direction_ * (s * scale_translation_);
+  pose.makeAffine();
+  return pose;
+}
+
+void CartesianPathLine::getPoses(const std::vector<double> &path_parameters, PoseVector &poses) const
+{
+  poses.resize(path_parameters.size());
+  for(std::size_t i = 0; i < path_parameters.size(); ++i)
+  {
+    poses[i].linear() = orientation(path_parameters[i]);
+    poses[i].translation() = start_position_ + direction_ * (path_parameters[i] * scale_translation_);
+    poses[i].makeAffine();
+  }
+}
+
+CartesianPathCircle::CartesianPathCircle(const Eigen::Affine3d &start_pose,
+                                         const Eigen::Vector3d &center_point,
+                                         const Eigen::Vector3d &plane_point,
+                                         const Eigen::Matrix3d &goal_orientation,
+                                         double angle,
+                                         double eqradius)
+  : CartesianPath(start_pose.linear(), goal_orientation),
+    center_point_(center_point)
+{
+  x_axis_ = start_pose.translation() - center_point_;
+  radius_ = x_axis_.norm();
+  if(radius_ < CIRCLE_EPSILON)
+  {
+    throw KDL::Error_MotionPlanning_Circle_ToSmall();
+  }
+  x_axis_ /= radius_;
+
+  // as KDL, a plane point at the center is replaced by the x axis
+  Eigen::Vector3d plane_direction = plane_point - center_point_;
+  const double plane_distance = plane_direction.norm();
+  if(plane_distance < CIRCLE_EPSILON)
+  {
+    plane_direction = Eigen::Vector3d::UnitX();
+  }
+  else
+  {
+    plane_direction /= plane_distance;
+  }
+
+  Eigen::Vector3d z_axis = x_axis_.cross(plane_direction);
+  const double z_norm = z_axis.norm();
+  if(z_norm < CIRCLE_EPSILON)
+  {
+    throw KDL::Error_MotionPlanning_Circle_No_Plane();
+  }
+  z_axis /= z_norm;
+  y_axis_ = z_axis.cross(x_axis_);
+
+  setPathLength(angle * radius_, eqradius);
+}
+
+Eigen::Affine3d CartesianPathCircle::getPose(double s) const
+{
+  const double phi = s * scale_translation_ / radius_;
+  Eigen::Affine3d pose;
+  pose.linear() = orientation(s);
+  pose.translation() = center_point_ + radius_ * (std::cos(phi) * x_axis_ + std::sin(phi) * y_axis_);
+  pose.makeAffine();
+  return pose;
+}
+
+void CartesianPathCircle::getPoses(const std::vector<double> &path_parameters, PoseVector &poses) const
+{
+  poses.resize(path_parameters.size());
+  const double angle_per_length = scale_translation_ / radius_;
+  for(std::size_t i = 0; i < path_parameters.size(); ++i)
+  {
+    const double phi = path_parameters[i] * angle_per_length;
+    poses[i].linear() = orientation(path_parameters[i]);
+    poses[i].translation() = center_point_ + radius_ * (std::cos(phi) * x_axis_ + std::sin(phi) * y_axis_);
+    poses[i].makeAffine();
+  }
+}
+
+}
@@ -18,13 +18,14 @@
 #include "pilz_trajectory_generation/command_list_manager.h"
 
 #include <ros/ros.h>
-#include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/robot_state/conversions.h>
 
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
 #include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/generator_options_aggregator.h"
 #include "pilz_trajectory_generation/trajectory_blender_transition_window.h"
 #include "pilz_trajectory_generation/trajectory_blend_request.h"
+#include "pilz_trajectory_generation/trajectory_info_context.h"
 
 namespace pilz_trajectory_generation {
 
@@ -50,9 +51,16 @@ CommandListManager::CommandListManager(const ros::NodeHandle &nh, const moveit::
   limits.setJointLimits(aggregated_limit_active_joints);
   limits.setCartesianLimits(cartesian_limit);
 
+  // The blend options are read from the namespace of the planning pipeline, like the options of the generators
+  pilz::GeneratorOptions options = pilz::GeneratorOptionsAggregator::getAggregatedOptions(nh_);
+
   // Currently using Lloyed blender
-  std::unique_ptr<pilz::TrajectoryBlender> blender(new pilz::TrajectoryBlenderTransitionWindow(limits));
+  std::unique_ptr<pilz::TrajectoryBlender> blender(
+        new pilz::TrajectoryBlenderTransitionWindow(limits, options.blend_crossing_time_alignment));
   blender_ = std::move(blender);
+
+  // Load the planner once, a new pipeline for each sequence would not reuse its plan cache
+  planning_pipeline_.reset(new planning_pipeline::PlanningPipeline(model_, nh_));
 }
 
 bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
@@ -82,9 +90,10 @@ bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& plan
 
   // Collect the responses
   std::vector<planning_interface::MotionPlanResponse> motion_plan_responses;
+  std::vector<pilz::TipPoseTrackConstPtr> tip_pose_tracks;
   std::vector<double> radii;
 
-  if(!solveRequests(planning_scene, req_list, res, motion_plan_responses, radii))
+  if(!solveRequests(planning_scene, req_list, res, motion_plan_responses, tip_pose_tracks, radii))
   {
     return false;
   }
@@ -95,7 +104,7 @@ bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& plan
 
   const auto group_name = req_list.requests.front().req.group_name;
 
-  if(!validateBlendingRadiiDoNotOverlap(motion_plan_responses, radii, group_name))
+  if(!validateBlendingRadiiDoNotOverlap(motion_plan_responses, tip_pose_tracks, radii, group_name))
   {
     res.trajectory_.reset(new robot_trajectory::RobotTrajectory(model_, 0));
     res.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
@@ -121,7 +130,7 @@ bool CommandListManager::solve(const planning_scene::PlanningSceneConstPtr& plan
     return true;
   }
 
-  if(!blend(motion_plan_responses, radii, result_trajectory, res))
+  if(!blend(motion_plan_responses, tip_pose_tracks, radii, result_trajectory, res))
   {
     return false;
   }
@@ -190,6 +199,7 @@ bool CommandListManager::validateRequestList(const pilz_msgs::MotionBlendRequest
 
 bool CommandListManager::validateBlendingRadiiDoNotOverlap(
     const std::vector<planning_interface::MotionPlanResponse> &motion_plan_responses,
+    const std::vector<pilz::TipPoseTrackConstPtr> &tip_pose_tracks,
     const std::vector<double> &radii,
     const std::string& group_name)
 {
@@ -199,8 +209,10 @@ bool CommandListManager::validateBlendingRadiiDoNotOverlap(
     {
       auto traj_1 = motion_plan_responses.at(i).trajectory_;
       auto traj_2 = motion_plan_responses.at(i+1).trajectory_;
-      auto distance_endpoints = (traj_1->getLastWayPoint().getFrameTransform(getTipFrame(group_name)).translation() -
-                                 traj_2->getLastWayPoint().getFrameTransform(getTipFrame(group_name)).translation())
+      const pilz::TipPoseLookup tip_poses_1(traj_1, getTipFrame(group_name), tip_pose_tracks.at(i));
+      const pilz::TipPoseLookup tip_poses_2(traj_2, getTipFrame(group_name), tip_pose_tracks.at(i+1));
+      auto distance_endpoints = (tip_poses_1.getPose(traj_1->getWayPointCount() - 1).translation() -
+                                 tip_poses_2.getPose(traj_2->getWayPointCount() - 1).translation())
                                 .norm();
 
       if(distance_endpoints <= (radii.at(i) + radii.at(i+1)))
@@ -218,11 +230,9 @@ bool CommandListManager::solveRequests(const planning_scene::PlanningSceneConstP
                                        const pilz_msgs::MotionBlendRequestList &req_list,
                                        planning_interface::MotionPlanResponse &res,
                                        std::vector<planning_interface::MotionPlanResponse> &motion_plan_responses,
+                                       std::vector<pilz::TipPoseTrackConstPtr> &tip_pose_tracks,
                                        std::vector<double> &radii)
 {
-  // Obtain the planning pipeline
-  planning_pipeline::PlanningPipelinePtr planning_pipeline(new planning_pipeline::PlanningPipeline(model_, nh_));
-
   for(auto req_it = req_list.requests.begin(); req_it < req_list.requests.end(); req_it++)
   {
     size_t idx = std::distance(req_list.requests.begin(), req_it);
@@ -237,7 +247,8 @@ bool CommandListManager::solveRequests(const planning_scene::PlanningSceneConstP
                                               req.start_state);
     }
 
-    planning_pipeline->generatePlan(planning_scene, req, plan_res);
+    pilz::TipPoseTrackConstPtr tip_pose_track;
+    generatePlan(planning_scene, req, plan_res, tip_pose_track);
     /* Check that the planning was successful */
     if (plan_res.error_code_.val != plan_res.error_code_.SUCCESS)
     {
@@ -251,23 +262,63 @@ bool CommandListManager::solveRequests(const planning_scene::PlanningSceneConstP
     ROS_DEBUG_STREAM("Solved [" << idx+1 << "/" << req_list.requests.size() << "]");
 
     motion_plan_responses.push_back(plan_res);
+    tip_pose_tracks.push_back(tip_pose_track);
     radii.push_back(req_it->blend_radius);
   }
 
   return true;
 }
 
+void CommandListManager::generatePlan(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                      const planning_interface::MotionPlanRequest& req,
+                                      planning_interface::MotionPlanResponse& res,
+                                      pilz::TipPoseTrackConstPtr& tip_pose_track)
+{
+  tip_pose_track.reset();
+
+  const planning_interface::PlannerManagerPtr& planner = planning_pipeline_->getPlannerManager();
+  if(!planner || !planning_pipeline_->getAdapterPluginNames().empty() || planning_pipeline_->getCheckSolutionPaths())
+  {
+    planning_pipeline_->generatePlan(planning_scene, req, res);
+    return;
+  }
+
+  planning_interface::PlanningContextPtr context = planner->getPlanningContext(planning_scene, req, res.error_code_);
+  if(!context)
+  {
+    ROS_ERROR("Unable to obtain a planning context.");
+    return;
+  }
+
+  // Only the contexts of the trajectory generators provide a tip pose track
+  pilz::TrajectoryInfoContext* info_context = dynamic_cast<pilz::TrajectoryInfoContext*>(context.get());
+  if(!info_context)
+  {
+    context->solve(res);
+    return;
+  }
+
+  pilz::GeneratedTrajectoryInfo info;
+  if(info_context->solve(res, info))
+  {
+    tip_pose_track = info.tip_pose_track;
+  }
+}
+
 bool CommandListManager::blend(const std::vector<planning_interface::MotionPlanResponse> &motion_plan_responses,
+                               const std::vector<pilz::TipPoseTrackConstPtr>& tip_pose_tracks,
                                const std::vector<double> &radii,
                                robot_trajectory::RobotTrajectoryPtr& result_trajectory,
                                planning_interface::MotionPlanResponse &res)
 {
   // prefill the first_trajectory for the next blending request
   auto first_trajectory = motion_plan_responses.front().trajectory_;
+  pilz::TipPoseTrackConstPtr first_tip_pose_track = tip_pose_tracks.front();
 
   for(size_t i = 0; i < motion_plan_responses.size()-1; i++)
   {
     auto traj_2 = motion_plan_responses.at(i+1).trajectory_;
+    const pilz::TipPoseTrackConstPtr& tip_pose_track_2 = tip_pose_tracks.at(i+1);
     auto blend_radius = radii.at(i);
 
     // No blending is needed if the radius is 0.0
@@ -278,8 +329,10 @@ bool CommandListManager::blend(const std::vector<planning_interface::MotionPlanR
 
       // The blending is always done between the rest of the previous segment and the new part
       blend_request.first_trajectory = first_trajectory;
+      blend_request.first_tip_pose_track = first_tip_pose_track;
 
       blend_request.second_trajectory = traj_2;
+      blend_request.second_tip_pose_track = tip_pose_track_2;
       blend_request.blend_radius = blend_radius;
       blend_request.group_name = first_trajectory->getGroupName();
       blend_request.link_name = model_->getJointModelGroup(blend_request.group_name)->getSolverInstance()->getTipFrame();
@@ -298,12 +351,14 @@ bool CommandListManager::blend(const std::vector<planning_interface::MotionPlanR
       result_trajectory->append(*blend_response.first_trajectory, 0.0);
       result_trajectory->append(*blend_response.blend_trajectory, 0.0);
       first_trajectory = blend_response.second_trajectory; // first for next blending segment
+      first_tip_pose_track = blend_response.second_tip_pose_track;
     }
     // if blend radius == 0.0
     else
     {
       result_trajectory->append(*first_trajectory, 0.0);
       first_trajectory = traj_2;
+      first_tip_pose_track = tip_pose_track_2;
     }
   }
 
@@ -23,6 +23,7 @@
 
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
 #include "pilz_trajectory_generation/cartesian_limits_aggregator.h"
+#include "pilz_trajectory_generation/generator_options_aggregator.h"
 
 // Boost includes
 #include <boost/scoped_ptr.hpp>
@@ -51,6 +52,25 @@ bool CommandPlanner::initialize(const moveit::core::RobotModelConstPtr &model, c
   // Obtain cartesian limits
   cartesian_limit_ = pilz::CartesianLimitsAggregator::getAggregatedLimits(ros::NodeHandle(PARAM_NAMESPACE_LIMTS));
 
+  // Obtain the options of the trajectory generators from the planner namespace
+  generator_options_ = pilz::GeneratorOptionsAggregator::getAggregatedOptions(ros::NodeHandle(ns));
+
+  // Create an empty plan cache, cached trajectories of a previous model or previous limits must not be returned
+  plan_cache_.reset();
+  if(generator_options_.plan_cache)
+  {
+    plan_cache_ = std::make_shared<pilz::PlanCache>(generator_options_.plan_cache_capacity,
+                                                    generator_options_.plan_cache_joint_resolution);
+  }
+
+  // Use the workers shared by all planners of the process only if parallel work is enabled, concurrent planners
+  // must not start more workers than there are cores
+  if(generator_options_.parallel_ik)
+  {
+    generator_options_.thread_pool = pilz::ThreadPool::getSharedPool(generator_options_.thread_pool_size);
+    ROS_INFO_STREAM("Using thread pool with " << generator_options_.thread_pool->size() << " workers.");
+  }
+
   // Load the planning context loader
   planner_context_loader.reset(new pluginlib::ClassLoader<PlanningContextLoader>("pilz_trajectory_generation",
                                                                                     "pilz::PlanningContextLoader"));
@@ -77,7 +97,9 @@ bool CommandPlanner::initialize(const moveit::core::RobotModelConstPtr &model, c
     limits.setCartesianLimits(cartesian_limit_);
 
     loader_pointer->setLimits(limits);
+    loader_pointer->setOptions(generator_options_);
     loader_pointer->setModel(model_);
+    loader_pointer->setPlanCache(plan_cache_);
 
     registerContextLoader(loader_pointer);
 
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ros/ros.h"
+
+#include "pilz_trajectory_generation/generator_options_aggregator.h"
+
+static const std::string param_generator_options_ns = "trajectory_generation";
+
+static const std::string param_thread_pool_size = "thread_pool_size";
+static const std::string param_parallel_ik = "parallel_ik";
+static const std::string param_parallel_ik_threads = "parallel_ik_threads";
+static const std::string param_parallel_ik_min_samples = "parallel_ik_min_samples";
+
+static const std::string param_adaptive_sampling = "adaptive_sampling";
+static const std::string param_adaptive_sampling_max_knot_interval = "adaptive_sampling_max_knot_interval";
+static const std::string param_adaptive_sampling_position_tolerance = "adaptive_sampling_position_tolerance";
+static const std::string param_adaptive_sampling_orientation_tolerance = "adaptive_sampling_orientation_tolerance";
+
+static const std::string param_differential_ik = "differential_ik";
+static const std::string param_differential_ik_max_iterations = "differential_ik_max_iterations";
+static const std::string param_differential_ik_position_tolerance = "differential_ik_position_tolerance";
+static const std::string param_differential_ik_orientation_tolerance = "differential_ik_orientation_tolerance";
+
+static const std::string param_ik_nearest_solution = "ik_nearest_solution";
+
+static const std::string param_jerk_limited_profile = "jerk_limited_profile";
+
+static const std::string param_plan_cache = "plan_cache";
+static const std::string param_plan_cache_capacity = "plan_cache_capacity";
+static const std::string param_plan_cache_joint_resolution = "plan_cache_joint_resolution";
+static const std::string param_velocity_scaling_search = "velocity_scaling_search";
+static const std::string param_velocity_scaling_search_margin = "velocity_scaling_search_margin";
+static const std::string param_time_optimal_parameterization = "time_optimal_parameterization";
+static const std::string param_time_optimal_grid_step = "time_optimal_grid_step";
+static const std::string param_lin_approximation_position_tolerance = "lin_approximation_position_tolerance";
+static const std::string param_lin_approximation_orientation_tolerance = "lin_approximation_orientation_tolerance";
+static const std::string param_singularity_prescan = "singularity_prescan";
+static const std::string param_singularity_prescan_intervals = "singularity_prescan_intervals";
+static const std::string param_singularity_prescan_min_manipulability = "singularity_prescan_min_manipulability";
+static const std::string param_blend_crossing_time_alignment = "blend_crossing_time_alignment";
+
+pilz::GeneratorOptions pilz::GeneratorOptionsAggregator::getAggregatedOptions(const ros::NodeHandle& nh)
+{
+  std::string param_prefix = param_generator_options_ns + "/";
+
+  pilz::GeneratorOptions options;
+
+  // thread pool
+  int thread_pool_size;
+  if(nh.getParam(param_prefix + param_thread_pool_size, thread_pool_size))
+  {
+    if(thread_pool_size >= 0)
+    {
+      options.thread_pool_size = static_cast<unsigned int>(thread_pool_size);
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring negative " << param_thread_pool_size << ": " << thread_pool_size);
+    }
+  }
+
+  // parallel ik
+  nh.getParam(param_prefix + param_parallel_ik, options.parallel_ik);
+
+  int parallel_ik_threads;
+  if(nh.getParam(param_prefix + param_parallel_ik_threads, parallel_ik_threads))
+  {
+    if(parallel_ik_threads >= 0)
+    {
+      options.parallel_ik_threads = static_cast<unsigned int>(parallel_ik_threads);
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring negative " << param_parallel_ik_threads << ": " << parallel_ik_threads);
+    }
+  }
+
+  int parallel_ik_min_samples;
+  if(nh.getParam(param_prefix + param_parallel_ik_min_samples, parallel_ik_min_samples))
+  {
+    if(parallel_ik_min_samples >= 0)
+    {
+      options.parallel_ik_min_samples = static_cast<unsigned int>(parallel_ik_min_samples);
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring negative " << param_parallel_ik_min_samples << ": " << parallel_ik_min_samples);
+    }
+  }
+
+  // adaptive sampling
+  nh.getParam(param_prefix + param_adaptive_sampling, options.adaptive_sampling);
+
+  int adaptive_sampling_max_knot_interval;
+  if(nh.getParam(param_prefix + param_adaptive_sampling_max_knot_interval, adaptive_sampling_max_knot_interval))
+  {
+    if(adaptive_sampling_max_knot_interval > 0)
+    {
+      options.adaptive_sampling_max_knot_interval = static_cast<unsigned int>(adaptive_sampling_max_knot_interval);
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring non-positive " << param_adaptive_sampling_max_knot_interval << ": "
+                      << adaptive_sampling_max_knot_interval);
+    }
+  }
+
+  double adaptive_sampling_position_tolerance;
+  if(nh.getParam(param_prefix + param_adaptive_sampling_position_tolerance, adaptive_sampling_position_tolerance))
+  {
+    if(adaptive_sampling_position_tolerance >= 0)
+    {
+      options.adaptive_sampling_position_tolerance = adaptive_sampling_position_tolerance;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring negative " << param_adaptive_sampling_position_tolerance << ": "
+                      << adaptive_sampling_position_tolerance);
+    }
+  }
+
+  double adaptive_sampling_orientation_tolerance;
+  if(nh.getParam(param_prefix + param_adaptive_sampling_orientation_tolerance,
+                 adaptive_sampling_orientation_tolerance))
+  {
+    if(adaptive_sampling_orientation_tolerance >= 0)
+    {
+      options.adaptive_sampling_orientation_tolerance = adaptive_sampling_orientation_tolerance;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring negative " << param_adaptive_sampling_orientation_tolerance << ": "
+                      << adaptive_sampling_orientation_tolerance);
+    }
+  }
+
+  // differential ik
+  nh.getParam(param_prefix + param_differential_ik, options.differential_ik);
+
+  int differential_ik_max_iterations;
+  if(nh.getParam(param_prefix + param_differential_ik_max_iterations, differential_ik_max_iterations))
+  {
+    if(differential_ik_max_iterations >= 0)
+    {
+      options.differential_ik_max_iterations = static_cast<unsigned int>(differential_ik_max_iterations);
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring negative " << param_differential_ik_max_iterations << ": "
+                      << differential_ik_max_iterations);
+    }
+  }
+
+  double differential_ik_position_tolerance;
+  if(nh.getParam(param_prefix + param_differential_ik_position_tolerance, differential_ik_position_tolerance))
+  {
+    if(differential_ik_position_tolerance >= 0)
+    {
+      options.differential_ik_position_tolerance = differential_ik_position_tolerance;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring negative " << param_differential_ik_position_tolerance << ": "
+                      << differential_ik_position_tolerance);
+    }
+  }
+
+  double differential_ik_orientation_tolerance;
+  if(nh.getParam(param_prefix + param_differential_ik_orientation_tolerance, differential_ik_orientation_tolerance))
+  {
+    if(differential_ik_orientation_tolerance >= 0)
+    {
+      options.differential_ik_orientation_tolerance = differential_ik_orientation_tolerance;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring negative " << param_differential_ik_orientation_tolerance << ": "
+                      << differential_ik_orientation_tolerance);
+    }
+  }
+
+  // ik branch selection
+  nh.getParam(param_prefix + param_ik_nearest_solution, options.ik_nearest_solution);
+
+  // velocity profile
+  nh.getParam(param_prefix + param_jerk_limited_profile, options.jerk_limited_profile);
+
+  // plan cache
+  nh.getParam(param_prefix + param_plan_cache, options.plan_cache);
+
+  int plan_cache_capacity;
+  if(nh.getParam(param_prefix + param_plan_cache_capacity, plan_cache_capacity))
+  {
+    if(plan_cache_capacity > 0)
+    {
+      options.plan_cache_capacity = static_cast<unsigned int>(plan_cache_capacity);
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring non-positive " << param_plan_cache_capacity << ": " << plan_cache_capacity);
+    }
+  }
+
+  double plan_cache_joint_resolution;
+  if(nh.getParam(param_prefix + param_plan_cache_joint_resolution, plan_cache_joint_resolution))
+  {
+    if(plan_cache_joint_resolution > 0)
+    {
+      options.plan_cache_joint_resolution = plan_cache_joint_resolution;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring non-positive " << param_plan_cache_joint_resolution << ": "
+                      << plan_cache_joint_resolution);
+    }
+  }
+
+  // velocity scaling search
+  nh.getParam(param_prefix + param_velocity_scaling_search, options.velocity_scaling_search);
+
+  double velocity_scaling_search_margin;
+  if(nh.getParam(param_prefix + param_velocity_scaling_search_margin, velocity_scaling_search_margin))
+  {
+    if(velocity_scaling_search_margin >= 0 && velocity_scaling_search_margin < 1)
+    {
+      options.velocity_scaling_search_margin = velocity_scaling_search_margin;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring " << param_velocity_scaling_search_margin << " outside of [0, 1): "
+                      << velocity_scaling_search_margin);
+    }
+  }
+
+  // time optimal parameterization
+  nh.getParam(param_prefix + param_time_optimal_parameterization, options.time_optimal_parameterization);
+
+  double time_optimal_grid_step;
+  if(nh.getParam(param_prefix + param_time_optimal_grid_step, time_optimal_grid_step))
+  {
+    if(time_optimal_grid_step > 0)
+    {
+      options.time_optimal_grid_step = time_optimal_grid_step;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring non-positive " << param_time_optimal_grid_step << ": " << time_optimal_grid_step);
+    }
+  }
+
+  // joint space approximation of LIN
+  double lin_approximation_position_tolerance;
+  if(nh.getParam(param_prefix + param_lin_approximation_position_tolerance, lin_approximation_position_tolerance))
+  {
+    if(lin_approximation_position_tolerance > 0)
+    {
+      options.lin_approximation_position_tolerance = lin_approximation_position_tolerance;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring non-positive " << param_lin_approximation_position_tolerance << ": "
+                      << lin_approximation_position_tolerance);
+    }
+  }
+
+  double lin_approximation_orientation_tolerance;
+  if(nh.getParam(param_prefix + param_lin_approximation_orientation_tolerance, lin_approximation_orientation_tolerance))
+  {
+    if(lin_approximation_orientation_tolerance > 0)
+    {
+      options.lin_approximation_orientation_tolerance = lin_approximation_orientation_tolerance;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring non-positive " << param_lin_approximation_orientation_tolerance << ": "
+                      << lin_approximation_orientation_tolerance);
+    }
+  }
+
+  // singularity pre-scan
+  nh.getParam(param_prefix + param_singularity_prescan, options.singularity_prescan);
+
+  int singularity_prescan_intervals;
+  if(nh.getParam(param_prefix + param_singularity_prescan_intervals, singularity_prescan_intervals))
+  {
+    if(singularity_prescan_intervals > 0)
+    {
+      options.singularity_prescan_intervals = static_cast<unsigned int>(singularity_prescan_intervals);
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring non-positive " << param_singularity_prescan_intervals << ": "
+                      << singularity_prescan_intervals);
+    }
+  }
+
+  double singularity_prescan_min_manipulability;
+  if(nh.getParam(param_prefix + param_singularity_prescan_min_manipulability, singularity_prescan_min_manipulability))
+  {
+    if(singularity_prescan_min_manipulability >= 0 && singularity_prescan_min_manipulability < 1)
+    {
+      options.singularity_prescan_min_manipulability = singularity_prescan_min_manipulability;
+    }
+    else
+    {
+      ROS_WARN_STREAM("Ignoring " << param_singularity_prescan_min_manipulability << " outside of [0, 1): "
+                      << singularity_prescan_min_manipulability);
+    }
+  }
+
+  // blending
+  nh.getParam(param_prefix + param_blend_crossing_time_alignment, options.blend_crossing_time_alignment);
+
+  return options;
+}
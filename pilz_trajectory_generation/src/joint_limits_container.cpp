@@ -65,6 +65,8 @@ pilz_extensions::JointLimit pilz::JointLimitsContainer::getCommonLimit() const
     common_limit.max_acceleration = 0;
     common_limit.has_deceleration_limits = false;
     common_limit.max_deceleration = 0;
+    common_limit.has_jerk_limits = false;
+    common_limit.max_jerk = 0;
     return common_limit;
   }
 
@@ -134,6 +136,21 @@ pilz_extensions::JointLimit pilz::JointLimitsContainer::getCommonLimit() const
         common_limit.max_deceleration = it->second.max_deceleration;
       }
     }
+
+    // If this limit has jerk limits
+    if(it->second.has_jerk_limits)
+    {
+      // Merge if common_limit has allready limit
+      if(common_limit.has_jerk_limits)
+      {
+        common_limit.max_jerk = std::min(common_limit.max_jerk, it->second.max_jerk);
+      }
+      else
+      {
+        common_limit.has_jerk_limits = true;
+        common_limit.max_jerk = it->second.max_jerk;
+      }
+    }
   }
 
   return common_limit;
@@ -144,6 +161,21 @@ pilz_extensions::JointLimit pilz::JointLimitsContainer::getLimit(const std::stri
   return container_.at(joint_name);
 }
 
+std::vector<pilz_extensions::JointLimit> pilz::JointLimitsContainer::getLimits(
+    const std::vector<std::string> &joint_names) const
+{
+  std::vector<pilz_extensions::JointLimit> joint_limits(joint_names.size());
+  for(std::size_t i=0; i<joint_names.size(); ++i)
+  {
+    auto it = container_.find(joint_names.at(i));
+    if(it != container_.end())
+    {
+      joint_limits.at(i) = it->second;
+    }
+  }
+  return joint_limits;
+}
+
 std::map<std::string, pilz_extensions::JointLimit>::const_iterator pilz::JointLimitsContainer::begin() const
 {
   return container_.begin();
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/joint_limits_table.h"
+
+#include <cmath>
+#include <limits>
+
+namespace pilz {
+
+JointLimitsTable::JointLimitsTable(const std::vector<pilz_extensions::JointLimit> &joint_limits)
+  : max_velocity(joint_limits.size()),
+    max_acceleration(joint_limits.size()),
+    max_deceleration(joint_limits.size())
+{
+  const double unlimited = std::numeric_limits<double>::infinity();
+  for(std::size_t i = 0; i < joint_limits.size(); ++i)
+  {
+    const pilz_extensions::JointLimit& limit = joint_limits[i];
+    max_velocity(i) = limit.has_velocity_limits ? std::fabs(limit.max_velocity) : unlimited;
+    max_acceleration(i) = limit.has_acceleration_limits ? std::fabs(limit.max_acceleration) : unlimited;
+    max_deceleration(i) = limit.has_deceleration_limits ? std::fabs(limit.max_deceleration) : unlimited;
+  }
+}
+
+}
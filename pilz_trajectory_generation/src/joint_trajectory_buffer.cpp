@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/joint_trajectory_buffer.h"
+
+#include <ros/ros.h>
+
+namespace pilz {
+
+JointTrajectoryBuffer::JointTrajectoryBuffer(const std::vector<std::string> &joint_names)
+  : joint_names_(joint_names)
+{
+}
+
+void JointTrajectoryBuffer::setJointNames(const std::vector<std::string> &joint_names)
+{
+  joint_names_ = joint_names;
+  clear();
+}
+
+void JointTrajectoryBuffer::reserve(std::size_t point_count)
+{
+  times_.reserve(point_count);
+  positions_.reserve(point_count * joint_names_.size());
+  velocities_.reserve(point_count * joint_names_.size());
+  accelerations_.reserve(point_count * joint_names_.size());
+}
+
+void JointTrajectoryBuffer::clear()
+{
+  times_.clear();
+  positions_.clear();
+  velocities_.clear();
+  accelerations_.clear();
+  tip_pose_track_.reset();
+}
+
+std::size_t JointTrajectoryBuffer::addPoint(double time_from_start)
+{
+  times_.push_back(time_from_start);
+  positions_.resize(positions_.size() + joint_names_.size(), 0.0);
+  velocities_.resize(velocities_.size() + joint_names_.size(), 0.0);
+  accelerations_.resize(accelerations_.size() + joint_names_.size(), 0.0);
+  return times_.size() - 1;
+}
+
+Eigen::Map<Eigen::VectorXd> JointTrajectoryBuffer::positions(std::size_t index)
+{
+  return Eigen::Map<Eigen::VectorXd>(positions_.data() + index * joint_names_.size(), joint_names_.size());
+}
+
+Eigen::Map<const Eigen::VectorXd> JointTrajectoryBuffer::positions(std::size_t index) const
+{
+  return Eigen::Map<const Eigen::VectorXd>(positions_.data() + index * joint_names_.size(), joint_names_.size());
+}
+
+Eigen::Map<Eigen::VectorXd> JointTrajectoryBuffer::velocities(std::size_t index)
+{
+  return Eigen::Map<Eigen::VectorXd>(velocities_.data() + index * joint_names_.size(), joint_names_.size());
+}
+
+Eigen::Map<const Eigen::VectorXd> JointTrajectoryBuffer::velocities(std::size_t index) const
+{
+  return Eigen::Map<const Eigen::VectorXd>(velocities_.data() + index * joint_names_.size(), joint_names_.size());
+}
+
+Eigen::Map<Eigen::VectorXd> JointTrajectoryBuffer::accelerations(std::size_t index)
+{
+  return Eigen::Map<Eigen::VectorXd>(accelerations_.data() + index * joint_names_.size(), joint_names_.size());
+}
+
+Eigen::Map<const Eigen::VectorXd> JointTrajectoryBuffer::accelerations(std::size_t index) const
+{
+  return Eigen::Map<const Eigen::VectorXd>(accelerations_.data() + index * joint_names_.size(),
+                                           joint_names_.size());
+}
+
+void JointTrajectoryBuffer::toMsg(trajectory_msgs::JointTrajectory &joint_trajectory) const
+{
+  const std::size_t joint_count = joint_names_.size();
+  joint_trajectory.joint_names = joint_names_;
+  joint_trajectory.points.resize(times_.size());
+  for(std::size_t k = 0; k < times_.size(); ++k)
+  {
+    trajectory_msgs::JointTrajectoryPoint& point = joint_trajectory.points[k];
+    point.time_from_start = ros::Duration(times_[k]);
+    point.positions.assign(positions_.begin() + k * joint_count, positions_.begin() + (k + 1) * joint_count);
+    point.velocities.assign(velocities_.begin() + k * joint_count, velocities_.begin() + (k + 1) * joint_count);
+    point.accelerations.assign(accelerations_.begin() + k * joint_count,
+                               accelerations_.begin() + (k + 1) * joint_count);
+  }
+}
+
+bool JointTrajectoryBuffer::toRobotTrajectory(const robot_state::RobotState &reference_state,
+                                              robot_trajectory::RobotTrajectory &trajectory) const
+{
+  const moveit::core::RobotModel& robot_model = *reference_state.getRobotModel();
+  const std::size_t joint_count = joint_names_.size();
+
+  // resolve the variable indices once
+  std::vector<int> variable_indices(joint_count);
+  for(std::size_t i = 0; i < joint_count; ++i)
+  {
+    if(!robot_model.hasJointModel(joint_names_[i]))
+    {
+      ROS_ERROR_STREAM("Joint " << joint_names_[i] << " is unknown to the robot model.");
+      return false;
+    }
+    variable_indices[i] = robot_model.getJointModel(joint_names_[i])->getFirstVariableIndex();
+  }
+
+  trajectory.clear();
+  double time_last = 0.0;
+  for(std::size_t k = 0; k < times_.size(); ++k)
+  {
+    robot_state::RobotStatePtr state(new robot_state::RobotState(reference_state));
+    for(std::size_t i = 0; i < joint_count; ++i)
+    {
+      state->setVariablePosition(variable_indices[i], positions_[k * joint_count + i]);
+      state->setVariableVelocity(variable_indices[i], velocities_[k * joint_count + i]);
+      state->setVariableAcceleration(variable_indices[i], accelerations_[k * joint_count + i]);
+    }
+    state->update();
+    trajectory.addSuffixWayPoint(state, times_[k] - time_last);
+    time_last = times_[k];
+  }
+  return true;
+}
+
+}
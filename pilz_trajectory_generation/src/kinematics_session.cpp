@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/kinematics_session.h"
+#include "pilz_trajectory_generation/self_collision_checker.h"
+
+#include <algorithm>
+#include <Eigen/SVD>
+
+#include <ros/ros.h>
+#include <eigen_conversions/eigen_msg.h>
+
+namespace pilz {
+
+KinematicsSession::KinematicsSession(const moveit::core::RobotModelConstPtr &robot_model,
+                                     const std::string &group_name,
+                                     const std::string &link_name)
+  : robot_model_(robot_model),
+    group_name_(group_name),
+    state_(robot_model)
+{
+  state_.setToDefaultValues();
+
+  if(robot_model_->hasJointModelGroup(group_name_))
+  {
+    group_ = robot_model_->getJointModelGroup(group_name_);
+    joint_names_ = group_->getActiveJointModelNames();
+    for(const moveit::core::JointModel* joint : group_->getActiveJointModels())
+    {
+      variable_indices_.push_back(joint->getFirstVariableIndex());
+    }
+    if(!group_->getJointModels().empty())
+    {
+      root_link_model_ = group_->getJointModels().front()->getParentLinkModel();
+    }
+  }
+
+  if(!link_name.empty())
+  {
+    setLinkName(link_name);
+  }
+  else if(group_ && group_->getSolverInstance())
+  {
+    setLinkName(group_->getSolverInstance()->getTipFrame());
+  }
+}
+
+bool KinematicsSession::setLinkName(const std::string &link_name)
+{
+  link_name_ = link_name;
+  can_solve_ik_ = group_ && group_->canSetStateFromIK(link_name_);
+  knows_link_ = state_.knowsFrameTransform(link_name_);
+  link_model_ = robot_model_->hasLinkModel(link_name_) ? robot_model_->getLinkModel(link_name_) : nullptr;
+  updateSolverFrames();
+  return knows_link_;
+}
+
+bool KinematicsSession::solveIK(const Eigen::Affine3d &pose,
+                                const std::map<std::string, double> &seed,
+                                std::map<std::string, double> &solution,
+                                bool check_self_collision,
+                                int max_attempt)
+{
+  if(!canSolveIK())
+  {
+    return false;
+  }
+
+  // set the seed
+  state_.setVariablePositions(seed);
+
+  if(!solveIKFromState(pose, check_self_collision, max_attempt))
+  {
+    return false;
+  }
+
+  // copy the solution
+  for(std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    solution[joint_names_[i]] = state_.getVariablePosition(variable_indices_[i]);
+  }
+  return true;
+}
+
+bool KinematicsSession::solveIK(const Eigen::Affine3d &pose,
+                                const Eigen::VectorXd &seed,
+                                Eigen::VectorXd &solution,
+                                bool check_self_collision,
+                                int max_attempt)
+{
+  if(!canSolveIK())
+  {
+    return false;
+  }
+
+  if(static_cast<std::size_t>(seed.size()) != joint_names_.size())
+  {
+    ROS_ERROR_STREAM("Size of IK seed (" << seed.size() << ") does not match the number of active joints ("
+                     << joint_names_.size() << ") in planning group " << group_name_);
+    return false;
+  }
+
+  // set the seed
+  for(std::size_t i = 0; i < variable_indices_.size(); ++i)
+  {
+    state_.setVariablePosition(variable_indices_[i], seed(i));
+  }
+
+  if(!solveIKFromState(pose, check_self_collision, max_attempt))
+  {
+    return false;
+  }
+
+  // copy the solution, no reallocation if the size is unchanged
+  solution.resize(joint_names_.size());
+  for(std::size_t i = 0; i < variable_indices_.size(); ++i)
+  {
+    solution(i) = state_.getVariablePosition(variable_indices_[i]);
+  }
+  return true;
+}
+
+bool KinematicsSession::canSolveIK() const
+{
+  if(!group_)
+  {
+    ROS_ERROR_STREAM("Robot model has no planning group named as " << group_name_);
+    return false;
+  }
+
+  if(!can_solve_ik_)
+  {
+    ROS_ERROR_STREAM("No valid IK solver exists for " << link_name_ << " in planning group " << group_name_);
+    return false;
+  }
+
+  return true;
+}
+
+bool KinematicsSession::solveIKFromState(const Eigen::Affine3d &pose, bool check_self_collision, int max_attempt)
+{
+  if(select_nearest_solution_ && solver_frames_valid_ && solveIKNearestFromState(pose, check_self_collision))
+  {
+    return true;
+  }
+
+  // call ik
+  if(!state_.setFromIK(group_, pose, link_name_, max_attempt))
+  {
+    ROS_ERROR_STREAM("Inverse kinematics for pose \n"
+                     << pose.translation()
+                     << " has no solution.");
+    return false;
+  }
+
+  // self collision checking
+  if(check_self_collision && !isStateSelfCollisionFree())
+  {
+    // LCOV_EXCL_START
+    ROS_ERROR("Inverse kinematics solution has self collision.");
+    return false;
+    // LCOV_EXCL_STOP
+  }
+
+  return true;
+}
+
+void KinematicsSession::updateSolverFrames()
+{
+  solver_frames_valid_ = false;
+  solver_joint_indices_.clear();
+  if(!group_ || !link_model_ || !group_->getSolverInstance())
+  {
+    return;
+  }
+  const kinematics::KinematicsBaseConstPtr solver = group_->getSolverInstance();
+
+  // frames of the solver plugin might be given with a leading slash
+  std::string base_frame = solver->getBaseFrame();
+  std::string tip_frame = solver->getTipFrame();
+  if(!base_frame.empty() && base_frame.front() == '/')
+  {
+    base_frame.erase(0, 1);
+  }
+  if(!tip_frame.empty() && tip_frame.front() == '/')
+  {
+    tip_frame.erase(0, 1);
+  }
+  if(!robot_model_->hasLinkModel(base_frame))
+  {
+    return;
+  }
+  solver_base_link_ = robot_model_->getLinkModel(base_frame);
+
+  // the target link has to be rigidly attached to the tip frame
+  Eigen::Affine3d tip_to_link = Eigen::Affine3d::Identity();
+  const moveit::core::LinkModel* link = link_model_;
+  while(link->getName() != tip_frame)
+  {
+    const moveit::core::JointModel* joint = link->getParentJointModel();
+    if(!joint || joint->getType() != moveit::core::JointModel::FIXED || !joint->getParentLinkModel())
+    {
+      return;
+    }
+    tip_to_link = link->getJointOriginTransform() * tip_to_link;
+    link = joint->getParentLinkModel();
+  }
+  link_to_tip_ = tip_to_link.inverse();
+
+  for(const std::string& joint_name : solver->getJointNames())
+  {
+    auto it = std::find(joint_names_.begin(), joint_names_.end(), joint_name);
+    if(it == joint_names_.end())
+    {
+      solver_joint_indices_.clear();
+      return;
+    }
+    solver_joint_indices_.push_back(std::distance(joint_names_.begin(), it));
+  }
+
+  solver_frames_valid_ = true;
+}
+
+bool KinematicsSession::solveIKNearestFromState(const Eigen::Affine3d &pose, bool check_self_collision)
+{
+  const kinematics::KinematicsBaseConstPtr solver = group_->getSolverInstance();
+
+  // pose of the tip frame in the base frame of the solver
+  geometry_msgs::Pose tip_pose;
+  tf::poseEigenToMsg(state_.getGlobalLinkTransform(solver_base_link_).inverse() * pose * link_to_tip_, tip_pose);
+
+  std::vector<double> seed(solver_joint_indices_.size());
+  for(std::size_t j = 0; j < solver_joint_indices_.size(); ++j)
+  {
+    seed[j] = state_.getVariablePosition(variable_indices_[solver_joint_indices_[j]]);
+  }
+
+  std::vector<std::vector<double> > solutions;
+  kinematics::KinematicsResult result;
+  if(!solver->getPositionIK(std::vector<geometry_msgs::Pose>(1, tip_pose), seed, solutions, result,
+                            kinematics::KinematicsQueryOptions()) || solutions.empty())
+  {
+    return false;
+  }
+
+  // sort the solutions by their distance to the seed
+  std::vector<std::pair<double, std::size_t> > distances;
+  for(std::size_t k = 0; k < solutions.size(); ++k)
+  {
+    if(solutions[k].size() != seed.size())
+    {
+      continue;
+    }
+    double distance = 0;
+    for(std::size_t j = 0; j < seed.size(); ++j)
+    {
+      distance += (solutions[k][j] - seed[j]) * (solutions[k][j] - seed[j]);
+    }
+    distances.push_back(std::make_pair(distance, k));
+  }
+  std::sort(distances.begin(), distances.end());
+
+  // take the nearest valid solution
+  for(const auto& distance : distances)
+  {
+    const std::vector<double>& solution = solutions[distance.second];
+    for(std::size_t j = 0; j < solution.size(); ++j)
+    {
+      state_.setVariablePosition(variable_indices_[solver_joint_indices_[j]], solution[j]);
+    }
+    state_.update();
+    if(state_.satisfiesBounds(group_) && (!check_self_collision || isStateSelfCollisionFree()))
+    {
+      return true;
+    }
+  }
+
+  // restore the seed for the fallback
+  for(std::size_t j = 0; j < seed.size(); ++j)
+  {
+    state_.setVariablePosition(variable_indices_[solver_joint_indices_[j]], seed[j]);
+  }
+  return false;
+}
+
+bool KinematicsSession::isStateSelfCollisionFree()
+{
+  return SelfCollisionChecker::getThreadInstance(robot_model_).isCollisionFree(state_);
+}
+
+bool KinematicsSession::solveIKDifferential(const Eigen::Affine3d &pose,
+                                            const Eigen::VectorXd &seed,
+                                            Eigen::VectorXd &solution,
+                                            double position_tolerance,
+                                            double orientation_tolerance,
+                                            unsigned int max_iterations,
+                                            bool check_self_collision)
+{
+  if(!group_ || !link_model_ || static_cast<std::size_t>(seed.size()) != joint_names_.size())
+  {
+    return false;
+  }
+
+  // squared damping factor, keeps the steps bounded close to singularities
+  const double DAMPING = 1e-6;
+
+  solution = seed;
+  Eigen::Matrix<double, 6, 1> error;
+  for(unsigned int iteration = 0; ; ++iteration)
+  {
+    for(std::size_t i = 0; i < variable_indices_.size(); ++i)
+    {
+      state_.setVariablePosition(variable_indices_[i], solution(i));
+    }
+    state_.update();
+
+    // residual of the current solution in model frame
+    const Eigen::Affine3d& link_pose = state_.getGlobalLinkTransform(link_model_);
+    const Eigen::AngleAxisd rotation_error(pose.linear() * link_pose.linear().transpose());
+    if((pose.translation() - link_pose.translation()).norm() <= position_tolerance &&
+       rotation_error.angle() <= orientation_tolerance)
+    {
+      break;
+    }
+
+    if(iteration >= max_iterations ||
+       !state_.getJacobian(group_, link_model_, Eigen::Vector3d::Zero(), jacobian_) ||
+       jacobian_.rows() != 6)
+    {
+      return false;
+    }
+
+    // the Jacobian is expressed in the frame of the root link of the group
+    const Eigen::Matrix3d root_rotation = root_link_model_ ?
+          Eigen::Matrix3d(state_.getGlobalLinkTransform(root_link_model_).linear().transpose()) :
+          Eigen::Matrix3d::Identity();
+    error.head<3>() = root_rotation * (pose.translation() - link_pose.translation());
+    error.tail<3>() = root_rotation * (rotation_error.angle() * rotation_error.axis());
+
+    // damped least squares step
+    const Eigen::Matrix<double, 6, 6> jjt = jacobian_ * jacobian_.transpose()
+        + DAMPING * Eigen::Matrix<double, 6, 6>::Identity();
+    solution += jacobian_.transpose() * jjt.ldlt().solve(error);
+  }
+
+  if(!state_.satisfiesBounds(group_))
+  {
+    return false;
+  }
+
+  return !check_self_collision || isStateSelfCollisionFree();
+}
+
+bool KinematicsSession::fk(const std::map<std::string, double> &positions, Eigen::Affine3d &pose)
+{
+  // check the reference frame of the target pose
+  if(!knows_link_)
+  {
+    ROS_ERROR_STREAM("The target link " << link_name_ << " is not known by robot.");
+    return false;
+  }
+
+  // set the joint positions
+  state_.setVariablePositions(positions);
+
+  // update the frame
+  state_.update();
+  pose = state_.getFrameTransform(link_name_);
+
+  return true;
+}
+
+bool KinematicsSession::fk(const Eigen::VectorXd &positions, Eigen::Affine3d &pose)
+{
+  if(!knows_link_)
+  {
+    ROS_ERROR_STREAM("The target link " << link_name_ << " is not known by robot.");
+    return false;
+  }
+
+  if(static_cast<std::size_t>(positions.size()) != joint_names_.size())
+  {
+    ROS_ERROR_STREAM("Size of joint positions (" << positions.size() << ") does not match the number of active joints ("
+                     << joint_names_.size() << ") in planning group " << group_name_);
+    return false;
+  }
+
+  for(std::size_t i = 0; i < variable_indices_.size(); ++i)
+  {
+    state_.setVariablePosition(variable_indices_[i], positions(i));
+  }
+
+  state_.update();
+  pose = state_.getFrameTransform(link_name_);
+
+  return true;
+}
+
+bool KinematicsSession::isSelfCollisionFree(const Eigen::VectorXd &positions)
+{
+  if(static_cast<std::size_t>(positions.size()) != joint_names_.size())
+  {
+    ROS_ERROR_STREAM("Size of joint positions (" << positions.size() << ") does not match the number of active joints ("
+                     << joint_names_.size() << ") in planning group " << group_name_);
+    return false;
+  }
+
+  for(std::size_t i = 0; i < variable_indices_.size(); ++i)
+  {
+    state_.setVariablePosition(variable_indices_[i], positions(i));
+  }
+  state_.update();
+
+  return isStateSelfCollisionFree();
+}
+
+bool KinematicsSession::computeManipulability(const Eigen::VectorXd &positions, double &manipulability)
+{
+  if(!group_ || !link_model_ || static_cast<std::size_t>(positions.size()) != joint_names_.size())
+  {
+    return false;
+  }
+
+  for(std::size_t i = 0; i < variable_indices_.size(); ++i)
+  {
+    state_.setVariablePosition(variable_indices_[i], positions(i));
+  }
+  state_.update();
+
+  if(!state_.getJacobian(group_, link_model_, Eigen::Vector3d::Zero(), jacobian_))
+  {
+    return false;
+  }
+
+  // singular values are sorted in decreasing order
+  const Eigen::VectorXd singular_values = Eigen::JacobiSVD<Eigen::MatrixXd>(jacobian_).singularValues();
+  manipulability = singular_values.size() > 0 && singular_values(0) > 0.0 ?
+        singular_values(singular_values.size() - 1) / singular_values(0) : 0.0;
+  return true;
+}
+
+bool KinematicsSession::toJointVector(const std::map<std::string, double> &joint_values,
+                                      Eigen::VectorXd &joint_vector) const
+{
+  joint_vector.resize(joint_names_.size());
+  for(std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    auto it = joint_values.find(joint_names_[i]);
+    if(it == joint_values.end())
+    {
+      ROS_ERROR_STREAM("Missing value of joint " << joint_names_[i] << " of planning group " << group_name_);
+      return false;
+    }
+    joint_vector(i) = it->second;
+  }
+  return true;
+}
+
+void KinematicsSession::toJointVector(const moveit::core::RobotState &state, Eigen::VectorXd &joint_vector) const
+{
+  joint_vector.resize(joint_names_.size());
+  for(std::size_t i = 0; i < variable_indices_.size(); ++i)
+  {
+    joint_vector(i) = state.getVariablePosition(variable_indices_[i]);
+  }
+}
+
+void KinematicsSession::toJointMap(const Eigen::VectorXd &joint_vector,
+                                   std::map<std::string, double> &joint_values) const
+{
+  for(std::size_t i = 0; i < joint_names_.size(); ++i)
+  {
+    joint_values[joint_names_[i]] = joint_vector(i);
+  }
+}
+
+}
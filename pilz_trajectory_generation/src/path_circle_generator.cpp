@@ -17,18 +17,21 @@
 
 #include "pilz_trajectory_generation/path_circle_generator.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace pilz {
 
-std::unique_ptr<KDL::Path> PathCircleGenerator::circleFromCenter(
-    const KDL::Frame &start_pose,
-    const KDL::Frame &goal_pose,
-    const KDL::Vector &center_point,
+std::unique_ptr<CartesianPath> PathCircleGenerator::circleFromCenter(
+    const Eigen::Affine3d &start_pose,
+    const Eigen::Affine3d &goal_pose,
+    const Eigen::Vector3d &center_point,
     double eqradius
     )
 {
-  double a = (start_pose.p - center_point).Norm();
-  double b = (goal_pose.p - center_point).Norm();
-  double c = (start_pose.p - goal_pose.p).Norm();
+  double a = (start_pose.translation() - center_point).norm();
+  double b = (goal_pose.translation() - center_point).norm();
+  double c = (start_pose.translation() - goal_pose.translation()).norm();
 
   if(fabs(a-b) > max_radius_diff_)
   {
@@ -38,49 +41,38 @@ std::unique_ptr<KDL::Path> PathCircleGenerator::circleFromCenter(
   // compute the rotation angle
   double alpha = cosines(a,b,c);
 
-  KDL::RotationalInterpolation* rot_interpo = new KDL::RotationalInterpolation_SingleAxis();
-  try
-  {
-    KDL::Path* circ = new KDL::Path_Circle(start_pose,
-                                           center_point,
-                                           goal_pose.p,
-                                           goal_pose.M,
-                                           alpha,
-                                           rot_interpo,
-                                           eqradius,
-                                           true /* take ownership of RotationalInterpolation */);
-    return std::unique_ptr<KDL::Path>(circ);
-  }
-  catch(KDL::Error_MotionPlanning &)
-  {
-    delete rot_interpo; // in case we could not construct the Path object, avoid a memory leak
-    throw; // and pass the exception on to the caller
-  }
+  return std::unique_ptr<CartesianPath>(new CartesianPathCircle(start_pose,
+                                                                center_point,
+                                                                goal_pose.translation(),
+                                                                goal_pose.linear(),
+                                                                alpha,
+                                                                eqradius));
 }
 
-std::unique_ptr<KDL::Path> PathCircleGenerator::circleFromInterim(
-    const KDL::Frame &start_pose,
-    const KDL::Frame &goal_pose,
-    const KDL::Vector &interim_point,
+std::unique_ptr<CartesianPath> PathCircleGenerator::circleFromInterim(
+    const Eigen::Affine3d &start_pose,
+    const Eigen::Affine3d &goal_pose,
+    const Eigen::Vector3d &interim_point,
     double eqradius
     )
 {
   // compute the center point from interim point
   // triangle edges
-  const KDL::Vector t = interim_point - start_pose.p;
-  const KDL::Vector u = goal_pose.p - start_pose.p;
-  const KDL::Vector v = goal_pose.p - interim_point;
+  const Eigen::Vector3d t = interim_point - start_pose.translation();
+  const Eigen::Vector3d u = goal_pose.translation() - start_pose.translation();
+  const Eigen::Vector3d v = goal_pose.translation() - interim_point;
   // triangle normal
-  const KDL::Vector w = t*u;
+  const Eigen::Vector3d w = t.cross(u);
 
   // circle center
-  const KDL::Vector center_point = start_pose.p + (u*dot(t,t)*dot(u,v) - t*dot(u,u)*dot(t,v))* 0.5/pow(w.Norm(),2);
+  const Eigen::Vector3d center_point = start_pose.translation()
+      + (u*t.dot(t)*u.dot(v) - t*u.dot(u)*t.dot(v)) * 0.5/pow(w.norm(),2);
 
   // compute the rotation angle
-  double interim_angle = cosines(t.Norm(), v.Norm(), u.Norm());
-  double a = (start_pose.p - center_point).Norm();
-  double b = (goal_pose.p - center_point).Norm();
-  double c = (start_pose.p - goal_pose.p).Norm();
+  double interim_angle = cosines(t.norm(), v.norm(), u.norm());
+  double a = (start_pose.translation() - center_point).norm();
+  double b = (goal_pose.translation() - center_point).norm();
+  double c = (start_pose.translation() - goal_pose.translation()).norm();
   // compute the rotation angle
   double alpha = cosines(a,b,c);
   // rotation angle is an acute angle
@@ -90,24 +82,12 @@ std::unique_ptr<KDL::Path> PathCircleGenerator::circleFromInterim(
     alpha = 2*M_PI - alpha;
   }
 
-  KDL::RotationalInterpolation* rot_interpo = new KDL::RotationalInterpolation_SingleAxis();
-  try
-  {
-    KDL::Path_Circle* circ = new KDL::Path_Circle(start_pose,
-                                                  center_point,
-                                                  interim_point,
-                                                  goal_pose.M,
-                                                  alpha,
-                                                  rot_interpo,
-                                                  eqradius,
-                                                  true /* take ownership of RotationalInterpolation */);
-    return std::unique_ptr<KDL::Path>(circ);
-  }
-  catch(KDL::Error_MotionPlanning &)
-  {
-    delete rot_interpo; // in case we could not construct the Path object, avoid a memory leak
-    throw; // and pass the exception on to the caller
-  }
+  return std::unique_ptr<CartesianPath>(new CartesianPathCircle(start_pose,
+                                                                center_point,
+                                                                interim_point,
+                                                                goal_pose.linear(),
+                                                                alpha,
+                                                                eqradius));
 }
 
 double PathCircleGenerator::cosines(const double a, const double b, const double c)
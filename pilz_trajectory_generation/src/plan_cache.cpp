@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/plan_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#include <moveit/robot_state/conversions.h>
+
+namespace pilz {
+
+namespace
+{
+
+void appendSize(std::string& key, std::size_t size)
+{
+  const std::uint64_t value = size;
+  key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& key, const std::string& str)
+{
+  appendSize(key, str.size());
+  key.append(str);
+}
+
+void appendDouble(std::string& key, double value)
+{
+  // -0.0 and 0.0 are the same value but differ in their bits
+  if(value == 0.0)
+  {
+    value = 0.0;
+  }
+  key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendQuantized(std::string& key, double value, double resolution)
+{
+  const std::int64_t step = std::llround(value / resolution);
+  key.append(reinterpret_cast<const char*>(&step), sizeof(step));
+}
+
+void appendPose(std::string& key, const geometry_msgs::Pose& pose)
+{
+  appendDouble(key, pose.position.x);
+  appendDouble(key, pose.position.y);
+  appendDouble(key, pose.position.z);
+  appendDouble(key, pose.orientation.x);
+  appendDouble(key, pose.orientation.y);
+  appendDouble(key, pose.orientation.z);
+  appendDouble(key, pose.orientation.w);
+}
+
+void appendPositionConstraints(std::string& key, const std::vector<moveit_msgs::PositionConstraint>& constraints)
+{
+  appendSize(key, constraints.size());
+  for(const auto& constraint : constraints)
+  {
+    appendString(key, constraint.header.frame_id);
+    appendString(key, constraint.link_name);
+    appendDouble(key, constraint.target_point_offset.x);
+    appendDouble(key, constraint.target_point_offset.y);
+    appendDouble(key, constraint.target_point_offset.z);
+    appendSize(key, constraint.constraint_region.primitives.size());
+    for(const auto& primitive : constraint.constraint_region.primitives)
+    {
+      appendSize(key, primitive.type);
+      appendSize(key, primitive.dimensions.size());
+      for(double dimension : primitive.dimensions)
+      {
+        appendDouble(key, dimension);
+      }
+    }
+    appendSize(key, constraint.constraint_region.primitive_poses.size());
+    for(const auto& pose : constraint.constraint_region.primitive_poses)
+    {
+      appendPose(key, pose);
+    }
+    appendDouble(key, constraint.weight);
+  }
+}
+
+void appendConstraints(std::string& key, const moveit_msgs::Constraints& constraints)
+{
+  appendString(key, constraints.name);
+
+  appendSize(key, constraints.joint_constraints.size());
+  for(const auto& constraint : constraints.joint_constraints)
+  {
+    appendString(key, constraint.joint_name);
+    appendDouble(key, constraint.position);
+    appendDouble(key, constraint.tolerance_above);
+    appendDouble(key, constraint.tolerance_below);
+    appendDouble(key, constraint.weight);
+  }
+
+  appendPositionConstraints(key, constraints.position_constraints);
+
+  appendSize(key, constraints.orientation_constraints.size());
+  for(const auto& constraint : constraints.orientation_constraints)
+  {
+    appendString(key, constraint.header.frame_id);
+    appendString(key, constraint.link_name);
+    appendDouble(key, constraint.orientation.x);
+    appendDouble(key, constraint.orientation.y);
+    appendDouble(key, constraint.orientation.z);
+    appendDouble(key, constraint.orientation.w);
+    appendDouble(key, constraint.absolute_x_axis_tolerance);
+    appendDouble(key, constraint.absolute_y_axis_tolerance);
+    appendDouble(key, constraint.absolute_z_axis_tolerance);
+    appendDouble(key, constraint.weight);
+  }
+}
+
+/**
+ * @brief copy the way points of a trajectory
+ */
+robot_trajectory::RobotTrajectoryPtr copyTrajectory(const robot_trajectory::RobotTrajectoryPtr& trajectory)
+{
+  robot_trajectory::RobotTrajectoryPtr copy(new robot_trajectory::RobotTrajectory(trajectory->getRobotModel(),
+                                                                                  trajectory->getGroupName()));
+  for(std::size_t i = 0; i < trajectory->getWayPointCount(); ++i)
+  {
+    copy->addSuffixWayPoint(std::make_shared<robot_state::RobotState>(trajectory->getWayPoint(i)),
+                            trajectory->getWayPointDurationFromPrevious(i));
+  }
+  return copy;
+}
+
+}
+
+PlanCache::PlanCache(std::size_t capacity, double joint_resolution)
+  : capacity_(capacity),
+    joint_resolution_(joint_resolution)
+{
+  if(capacity_ == 0)
+  {
+    throw std::invalid_argument("The capacity of the plan cache must be positive.");
+  }
+  if(!(joint_resolution_ > 0))
+  {
+    throw std::invalid_argument("The joint resolution of the plan cache must be positive.");
+  }
+}
+
+std::string PlanCache::computeKey(const planning_interface::MotionPlanRequest &req) const
+{
+  std::string key;
+
+  appendString(key, req.planner_id);
+  appendString(key, req.group_name);
+  appendDouble(key, req.max_velocity_scaling_factor);
+  appendDouble(key, req.max_acceleration_scaling_factor);
+
+  // start state, sorted by joint name since the order of the joints in the message is arbitrary
+  const sensor_msgs::JointState& joint_state = req.start_state.joint_state;
+  std::vector<std::size_t> order(joint_state.name.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&joint_state](std::size_t a, std::size_t b) { return joint_state.name[a] < joint_state.name[b]; });
+
+  appendSize(key, order.size());
+  for(std::size_t i : order)
+  {
+    appendString(key, joint_state.name[i]);
+    appendQuantized(key, i < joint_state.position.size() ? joint_state.position[i] : 0.0, joint_resolution_);
+    // a missing velocity is the same as zero velocity, the velocities are compared exactly since the joint
+    // resolution is a position step
+    appendDouble(key, i < joint_state.velocity.size() ? joint_state.velocity[i] : 0.0);
+  }
+
+  // goal
+  appendSize(key, req.goal_constraints.size());
+  for(const auto& constraints : req.goal_constraints)
+  {
+    appendConstraints(key, constraints);
+  }
+
+  // the auxiliary point of CIRC
+  appendString(key, req.path_constraints.name);
+  appendPositionConstraints(key, req.path_constraints.position_constraints);
+
+  return key;
+}
+
+bool PlanCache::lookup(const std::string &key, planning_interface::MotionPlanResponse &res)
+{
+  GeneratedTrajectoryInfo info;
+  return lookup(key, res, info);
+}
+
+bool PlanCache::lookup(const std::string &key, planning_interface::MotionPlanResponse &res,
+                       GeneratedTrajectoryInfo &info)
+{
+  robot_trajectory::RobotTrajectoryPtr trajectory;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if(it == index_.end())
+    {
+      ++misses_;
+      return false;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    trajectory = it->second->trajectory;
+    info = it->second->info;
+  }
+
+  // the cached trajectory is never modified, it can be copied without holding the lock
+  res.trajectory_ = copyTrajectory(trajectory);
+  res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+  return true;
+}
+
+bool PlanCache::lookup(const std::string &key, const moveit_msgs::RobotState &start_state,
+                       planning_interface::MotionPlanResponse &res, GeneratedTrajectoryInfo &info)
+{
+  if(!lookup(key, res, info))
+  {
+    return false;
+  }
+  if(res.trajectory_->empty())
+  {
+    return true;
+  }
+
+  // the quantized key matches start states which differ by up to half the joint resolution
+  robot_state::RobotStatePtr first = res.trajectory_->getFirstWayPointPtr();
+  moveit::core::jointStateToRobotState(start_state.joint_state, *first);
+  first->update();
+
+  const TipPoseTrackConstPtr& track = info.tip_pose_track;
+  if(track && !track->poses.empty() && first->getRobotModel()->hasLinkModel(track->link_name))
+  {
+    std::shared_ptr<TipPoseTrack> rebased_track = std::make_shared<TipPoseTrack>(*track);
+    rebased_track->poses.front() = first->getFrameTransform(track->link_name);
+    info.tip_pose_track = rebased_track;
+  }
+  return true;
+}
+
+void PlanCache::insert(const std::string &key, const planning_interface::MotionPlanResponse &res,
+                       const GeneratedTrajectoryInfo &info)
+{
+  if(!res.trajectory_ || res.error_code_.val != moveit_msgs::MoveItErrorCodes::SUCCESS)
+  {
+    return;
+  }
+
+  robot_trajectory::RobotTrajectoryPtr trajectory = copyTrajectory(res.trajectory_);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if(it != index_.end())
+  {
+    it->second->trajectory = trajectory;
+    it->second->info = info;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  if(entries_.size() >= capacity_)
+  {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+  entries_.push_front(Entry{key, trajectory, info});
+  index_[key] = entries_.begin();
+}
+
+void PlanCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+}
+
+std::size_t PlanCache::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+std::uint64_t PlanCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+std::uint64_t PlanCache::misses() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+}
@@ -30,6 +30,10 @@ bool pilz::PlanningContextLoader::setModel(const moveit::core::RobotModelConstPt
 {
   model_ = model;
   model_set_ = true;
+  if(plan_cache_)
+  {
+    plan_cache_->clear();
+  }
   return true;
 }
 
@@ -37,6 +41,22 @@ bool pilz::PlanningContextLoader::setLimits(const pilz::LimitsContainer &limits)
 {
   limits_ = limits;
   limits_set_ = true;
+  if(plan_cache_)
+  {
+    plan_cache_->clear();
+  }
+  return true;
+}
+
+bool pilz::PlanningContextLoader::setOptions(const pilz::GeneratorOptions &options)
+{
+  options_ = options;
+  return true;
+}
+
+bool pilz::PlanningContextLoader::setPlanCache(const pilz::PlanCachePtr &plan_cache)
+{
+  plan_cache_ = plan_cache;
   return true;
 }
 
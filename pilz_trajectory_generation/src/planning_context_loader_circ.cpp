@@ -37,7 +37,7 @@ bool pilz::PlanningContextLoaderCIRC::loadContext(planning_interface::PlanningCo
                                                  const std::string& group) const
 {
   if(limits_set_ && model_set_) {
-    planning_context.reset(new PlanningContextCIRC(name, group, model_, limits_));
+    planning_context.reset(new PlanningContextCIRC(name, group, model_, limits_, options_, plan_cache_));
     return true;
   }
   else
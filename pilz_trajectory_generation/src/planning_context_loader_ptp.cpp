@@ -36,7 +36,7 @@ bool pilz::PlanningContextLoaderPTP::loadContext(planning_interface::PlanningCon
                                                  const std::string& group) const
 {
   if(limits_set_ && model_set_) {
-    planning_context.reset(new PlanningContextPTP(name, group, model_, limits_));
+    planning_context.reset(new PlanningContextPTP(name, group, model_, limits_, options_, plan_cache_));
     return true;
   }
   else
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/ptp_trajectory.h"
+
+namespace pilz {
+
+PTPTrajectoryEvaluator::PTPTrajectoryEvaluator(const PTPTrajectory& trajectory)
+  : trajectory_(trajectory)
+{
+  a3_ = trajectory_.acceleration.array() / 2.0;
+  b1_ = trajectory_.start_position.array() + a3_*trajectory_.acc_duration*trajectory_.acc_duration;
+  c1_ = b1_ + trajectory_.velocity.array()*trajectory_.const_duration;
+  c3_ = trajectory_.deceleration.array() / 2.0;
+}
+
+void PTPTrajectoryEvaluator::evaluate(double time,
+                                      Eigen::Ref<Eigen::VectorXd> positions,
+                                      Eigen::Ref<Eigen::VectorXd> velocities,
+                                      Eigen::Ref<Eigen::VectorXd> accelerations) const
+{
+  const double t_a = trajectory_.acc_duration;
+  const double t_b = trajectory_.const_duration;
+  const double t_c = trajectory_.dec_duration;
+
+  // position and velocity, the phases are selected as in VelocityProfile_ATrap::Pos() and Vel()
+  if(time < 0)
+  {
+    positions = trajectory_.start_position;
+    velocities.setZero();
+  }
+  else if(time < t_a)
+  {
+    positions = (trajectory_.start_position.array() + time*(a3_*time)).matrix();
+    velocities = (2*a3_*time).matrix();
+  }
+  else if(time < (t_a+t_b))
+  {
+    positions = (b1_ + (time-t_a)*trajectory_.velocity.array()).matrix();
+    velocities = trajectory_.velocity;
+  }
+  else if(time <= (t_a+t_b+t_c))
+  {
+    const double dt = time-t_a-t_b;
+    positions = (c1_ + dt*(trajectory_.velocity.array() + c3_*dt)).matrix();
+    velocities = (trajectory_.velocity.array() + 2*c3_*dt).matrix();
+  }
+  else
+  {
+    positions = trajectory_.goal_position;
+    velocities.setZero();
+  }
+
+  // acceleration, the phases are selected as in VelocityProfile_ATrap::Acc()
+  if(time <= 0)
+  {
+    accelerations.setZero();
+  }
+  else if(time <= t_a)
+  {
+    accelerations = (2*a3_).matrix();
+  }
+  else if(time <= (t_a+t_b))
+  {
+    accelerations.setZero();
+  }
+  else if(time <= (t_a+t_b+t_c))
+  {
+    accelerations = (2*c3_).matrix();
+  }
+  else
+  {
+    accelerations.setZero();
+  }
+}
+
+void PTPTrajectoryEvaluator::sample(double sampling_time, JointTrajectoryBuffer& joint_trajectory) const
+{
+  joint_trajectory.setJointNames(trajectory_.joint_names);
+
+  const double duration = trajectory_.duration();
+  if(duration <= 0)
+  {
+    const std::size_t point_index = joint_trajectory.addPoint(sampling_time);
+    joint_trajectory.positions(point_index) = trajectory_.start_position;
+    return;
+  }
+
+  // the same time samples as the dense ptp planning, the last one is the end of the motion
+  std::vector<double> time_samples;
+  for(double t_sample=0.0; t_sample<duration; t_sample+=sampling_time)
+  {
+    time_samples.push_back(t_sample);
+  }
+  time_samples.push_back(duration);
+
+  joint_trajectory.reserve(time_samples.size());
+  for(double time_stamp : time_samples)
+  {
+    const std::size_t point_index = joint_trajectory.addPoint(time_stamp);
+    Eigen::Map<Eigen::VectorXd> positions = joint_trajectory.positions(point_index);
+    Eigen::Map<Eigen::VectorXd> velocities = joint_trajectory.velocities(point_index);
+    Eigen::Map<Eigen::VectorXd> accelerations = joint_trajectory.accelerations(point_index);
+    evaluate(time_stamp, positions, velocities, accelerations);
+  }
+}
+
+}
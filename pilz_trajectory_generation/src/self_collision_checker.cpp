@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/self_collision_checker.h"
+
+#include <map>
+
+namespace pilz {
+
+SelfCollisionChecker::SelfCollisionChecker(const robot_model::RobotModelConstPtr &robot_model, double epsilon)
+  : robot_model_(robot_model),
+    epsilon_(epsilon),
+    scene_(new planning_scene::PlanningScene(robot_model))
+{
+  acm_ = scene_->getAllowedCollisionMatrix();
+  links_ = robot_model_->getLinkModelsWithCollisionGeometry();
+  last_transforms_.resize(links_.size());
+  moved_.resize(links_.size());
+}
+
+bool SelfCollisionChecker::isCollisionFree(robot_state::RobotState &state)
+{
+  state.update();
+
+  // find the links which moved since the last check
+  bool any_moved = !has_last_state_;
+  for(std::size_t i = 0; i < links_.size(); ++i)
+  {
+    const Eigen::Affine3d& transform = state.getGlobalLinkTransform(links_[i]);
+    moved_[i] = !has_last_state_ ||
+        (transform.matrix() - last_transforms_[i].matrix()).cwiseAbs().maxCoeff() > epsilon_;
+    if(moved_[i])
+    {
+      any_moved = true;
+      last_transforms_[i] = transform;
+    }
+  }
+
+  if(!any_moved)
+  {
+    return last_collision_free_;
+  }
+
+  // pairs of links which did not move keep their collision free relative pose
+  skipped_pairs_.clear();
+  if(has_last_state_ && last_collision_free_)
+  {
+    SkippedPair pair;
+    for(std::size_t i = 0; i < links_.size(); ++i)
+    {
+      for(std::size_t j = i + 1; j < links_.size() && !moved_[i]; ++j)
+      {
+        if(moved_[j])
+        {
+          continue;
+        }
+        const std::string& name1 = links_[i]->getName();
+        const std::string& name2 = links_[j]->getName();
+        pair.has_entry = acm_.getEntry(name1, name2, pair.type);
+        if(pair.has_entry && pair.type == collision_detection::AllowedCollision::ALWAYS)
+        {
+          continue;
+        }
+        pair.decide_contact = collision_detection::DecideContactFn();
+        if(pair.has_entry && pair.type == collision_detection::AllowedCollision::CONDITIONAL)
+        {
+          acm_.getEntry(name1, name2, pair.decide_contact);
+        }
+        pair.link1 = i;
+        pair.link2 = j;
+        acm_.setEntry(name1, name2, true);
+        skipped_pairs_.push_back(pair);
+      }
+    }
+  }
+
+  collision_detection::CollisionRequest collision_req;
+  collision_detection::CollisionResult collision_res;
+  scene_->getCollisionRobot()->checkSelfCollision(collision_req, collision_res, state, acm_);
+
+  // restore the original entries of the allowed collision matrix
+  for(const auto& pair : skipped_pairs_)
+  {
+    const std::string& name1 = links_[pair.link1]->getName();
+    const std::string& name2 = links_[pair.link2]->getName();
+    if(!pair.has_entry)
+    {
+      acm_.removeEntry(name1, name2);
+    }
+    else if(pair.type == collision_detection::AllowedCollision::CONDITIONAL)
+    {
+      acm_.setEntry(name1, name2, pair.decide_contact);
+    }
+    else
+    {
+      acm_.setEntry(name1, name2, false);
+    }
+  }
+
+  has_last_state_ = true;
+  last_collision_free_ = !collision_res.collision;
+  return last_collision_free_;
+}
+
+SelfCollisionChecker& SelfCollisionChecker::getThreadInstance(const robot_model::RobotModelConstPtr &robot_model)
+{
+  static thread_local std::map<const moveit::core::RobotModel*, std::unique_ptr<SelfCollisionChecker> > checkers;
+
+  // release the checkers of robot models which are not used anymore
+  for(auto it = checkers.begin(); it != checkers.end();)
+  {
+    if(it->first != robot_model.get() && it->second->getRobotModel().use_count() == 1)
+    {
+      it = checkers.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  std::unique_ptr<SelfCollisionChecker>& checker = checkers[robot_model.get()];
+  if(!checker)
+  {
+    checker.reset(new SelfCollisionChecker(robot_model));
+  }
+  return *checker;
+}
+
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace pilz {
+
+namespace
+{
+
+/// pool and queue of the worker running on the calling thread
+thread_local const ThreadPool* current_pool {nullptr};
+thread_local std::size_t current_queue {0};
+
+}
+
+ThreadPool::ThreadPool(unsigned int thread_count)
+{
+  if(thread_count == 0)
+  {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for(unsigned int i = 0; i < thread_count; ++i)
+  {
+    queues_.emplace_back(new TaskQueue());
+  }
+  for(std::size_t i = 0; i < thread_count; ++i)
+  {
+    threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_all();
+
+  for(auto& thread : threads_)
+  {
+    thread.join();
+  }
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::getSharedPool(unsigned int thread_count)
+{
+  static std::mutex shared_mutex;
+  static std::weak_ptr<ThreadPool> shared_pool;
+
+  std::lock_guard<std::mutex> lock(shared_mutex);
+  std::shared_ptr<ThreadPool> pool = shared_pool.lock();
+  if(!pool)
+  {
+    pool = std::make_shared<ThreadPool>(thread_count);
+    shared_pool = pool;
+  }
+  return pool;
+}
+
+void ThreadPool::submit(std::function<void()> task, const void* owner)
+{
+  // workers keep their tasks local, other threads distribute them
+  const std::size_t queue_index = current_pool == this ? current_queue : next_queue_++ % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue_index]->mutex);
+    queues_[queue_index]->tasks.push_back(Task{owner, std::move(task)});
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++pending_;
+  }
+  condition_.notify_one();
+}
+
+bool ThreadPool::runPendingTask(const void* owner)
+{
+  std::function<void()> task;
+  if(!popTask(current_pool == this ? current_queue : next_queue_ % queues_.size(), owner, task))
+  {
+    return false;
+  }
+  task();
+  return true;
+}
+
+bool ThreadPool::popTask(std::size_t queue_index, const void* owner, std::function<void()> &task)
+{
+  auto matches = [owner](const Task& queued) {return !owner || queued.owner == owner;};
+
+  if(current_pool == this)
+  {
+    TaskQueue& own = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    auto it = std::find_if(own.tasks.rbegin(), own.tasks.rend(), matches);
+    if(it != own.tasks.rend())
+    {
+      task = std::move(it->function);
+      own.tasks.erase(std::next(it).base());
+      --pending_;
+      return true;
+    }
+  }
+
+  for(std::size_t i = 0; i < queues_.size(); ++i)
+  {
+    TaskQueue& other = *queues_[(queue_index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    auto it = std::find_if(other.tasks.begin(), other.tasks.end(), matches);
+    if(it != other.tasks.end())
+    {
+      task = std::move(it->function);
+      other.tasks.erase(it);
+      --pending_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::workerLoop(std::size_t queue_index)
+{
+  current_pool = this;
+  current_queue = queue_index;
+
+  std::function<void()> task;
+  while(true)
+  {
+    if(popTask(queue_index, nullptr, task))
+    {
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    // queued tasks are executed before the worker stops
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]{return stop_ || pending_ > 0;});
+    if(stop_ && pending_ <= 0)
+    {
+      return;
+    }
+  }
+}
+
+TaskGroup::TaskGroup(ThreadPool *pool)
+  :pool_(pool)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+  try
+  {
+    wait();
+  }
+  catch(...)
+  {
+    // the exception of a task is only reported by an explicit wait()
+  }
+}
+
+void TaskGroup::run(std::function<void()> task)
+{
+  if(cancelled_)
+  {
+    return;
+  }
+
+  if(!pool_)
+  {
+    execute(task);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++unfinished_;
+  }
+  pool_->submit([this, task]()
+  {
+    execute(task);
+
+    // the group may be destroyed as soon as the lock is released
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(--unfinished_ == 0)
+    {
+      condition_.notify_all();
+    }
+  }, this);
+}
+
+void TaskGroup::wait()
+{
+  const std::chrono::milliseconds POLL_INTERVAL(1);
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if(unfinished_ == 0)
+      {
+        break;
+      }
+    }
+
+    // help executing the queued tasks of this group, the tasks of other groups are left to the workers
+    if(!pool_->runPendingTask(this))
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait_for(lock, POLL_INTERVAL, [this]{return unfinished_ == 0;});
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(exception_)
+  {
+    std::exception_ptr exception;
+    std::swap(exception, exception_);
+    std::rethrow_exception(exception);
+  }
+}
+
+void TaskGroup::execute(const std::function<void()> &task)
+{
+  if(cancelled_)
+  {
+    return;
+  }
+
+  try
+  {
+    task();
+  }
+  catch(...)
+  {
+    cancelled_ = true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(!exception_)
+    {
+      exception_ = std::current_exception();
+    }
+  }
+}
+
+}
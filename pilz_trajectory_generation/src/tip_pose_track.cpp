@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/tip_pose_track.h"
+
+namespace pilz {
+
+TipPoseLookup::TipPoseLookup(const robot_trajectory::RobotTrajectoryPtr &trajectory,
+                             const std::string &link_name,
+                             const TipPoseTrackConstPtr &track)
+  : trajectory_(trajectory),
+    link_name_(link_name),
+    track_(track)
+{
+  if(track_ && (track_->link_name != link_name || track_->poses.size() != trajectory->getWayPointCount()))
+  {
+    track_.reset();
+  }
+}
+
+const Eigen::Affine3d& TipPoseLookup::getPose(std::size_t index) const
+{
+  if(track_)
+  {
+    return track_->poses[index];
+  }
+  return trajectory_->getWayPointPtr(index)->getFrameTransform(link_name_);
+}
+
+}
@@ -36,7 +36,10 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
 
   std::size_t first_intersection_index;
   std::size_t second_intersection_index;
-  if(!searchIntersectionPoints(req, first_intersection_index, second_intersection_index))
+  double first_crossing_time;
+  double second_crossing_time;
+  if(!searchIntersectionPoints(req, first_intersection_index, second_intersection_index,
+                               first_crossing_time, second_crossing_time))
   {
     ROS_ERROR("Trajectory blend request is not valid.");
     res.error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
@@ -45,7 +48,8 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
 
   // Select blending period and adjust the start and end point of the blend phase
   std::size_t blend_align_index;
-  determineTrajectoryAlignment(req, first_intersection_index, second_intersection_index, blend_align_index);
+  determineTrajectoryAlignment(req, first_intersection_index, second_intersection_index,
+                               first_crossing_time, second_crossing_time, blend_align_index);
 
   // blend the trajectories in Cartesian space
   pilz::CartesianTrajectory blend_trajectory_cartesian;
@@ -111,6 +115,9 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
                                           req.second_trajectory->getWayPointDurationFromPrevious(i));
   }
 
+  // pass the tip poses on to the next blending, the poses of the blend trajectory are the blended samples
+  setResponseTipPoseTracks(req, first_intersection_index, second_intersection_index, blend_trajectory_cartesian, res);
+
   // adjust the time from start
   res.second_trajectory->setWayPointDurationFromPrevious(0, sampling_time);
 
@@ -118,6 +125,48 @@ bool pilz::TrajectoryBlenderTransitionWindow::blend(const pilz::TrajectoryBlendR
   return true;
 }
 
+void pilz::TrajectoryBlenderTransitionWindow::setResponseTipPoseTracks(
+    const pilz::TrajectoryBlendRequest &req,
+    std::size_t first_interse_index,
+    std::size_t second_interse_index,
+    const pilz::CartesianTrajectory &blend_trajectory_cartesian,
+    pilz::TrajectoryBlendResponse &res) const
+{
+  const TipPoseLookup first_tip_poses(req.first_trajectory, req.link_name, req.first_tip_pose_track);
+  if(first_tip_poses.hasTrack())
+  {
+    std::shared_ptr<TipPoseTrack> track = std::make_shared<TipPoseTrack>();
+    track->link_name = req.link_name;
+    track->poses.reserve(first_interse_index);
+    for(std::size_t i = 0; i < first_interse_index; ++i)
+    {
+      track->poses.push_back(first_tip_poses.getPose(i));
+    }
+    res.first_tip_pose_track = track;
+  }
+
+  std::shared_ptr<TipPoseTrack> blend_track = std::make_shared<TipPoseTrack>();
+  blend_track->link_name = req.link_name;
+  blend_track->poses.resize(blend_trajectory_cartesian.points.size());
+  for(std::size_t i = 0; i < blend_trajectory_cartesian.points.size(); ++i)
+  {
+    tf::poseMsgToEigen(blend_trajectory_cartesian.points[i].pose, blend_track->poses[i]);
+  }
+  res.blend_tip_pose_track = blend_track;
+
+  const TipPoseLookup second_tip_poses(req.second_trajectory, req.link_name, req.second_tip_pose_track);
+  if(second_tip_poses.hasTrack())
+  {
+    std::shared_ptr<TipPoseTrack> track = std::make_shared<TipPoseTrack>();
+    track->link_name = req.link_name;
+    for(std::size_t i = second_interse_index+1; i < req.second_trajectory->getWayPointCount(); ++i)
+    {
+      track->poses.push_back(second_tip_poses.getPose(i));
+    }
+    res.second_tip_pose_track = track;
+  }
+}
+
 bool pilz::TrajectoryBlenderTransitionWindow::validateRequest(const pilz::TrajectoryBlendRequest &req,
                                                    double& sampling_time,
                                                    moveit_msgs::MoveItErrorCodes &error_code) const
@@ -160,9 +209,11 @@ bool pilz::TrajectoryBlenderTransitionWindow::validateRequest(const pilz::Trajec
   }
 
   // trajectories should exceed the blending sphere
-  Eigen::Affine3d first_start = req.first_trajectory->getFirstWayPointPtr()->getFrameTransform(req.link_name);
-  Eigen::Affine3d first_end = req.first_trajectory->getLastWayPointPtr()->getFrameTransform(req.link_name);
-  Eigen::Affine3d second_end = req.second_trajectory->getLastWayPointPtr()->getFrameTransform(req.link_name);
+  const TipPoseLookup first_tip_poses(req.first_trajectory, req.link_name, req.first_tip_pose_track);
+  const TipPoseLookup second_tip_poses(req.second_trajectory, req.link_name, req.second_tip_pose_track);
+  Eigen::Affine3d first_start = first_tip_poses.getPose(0);
+  Eigen::Affine3d first_end = first_tip_poses.getPose(req.first_trajectory->getWayPointCount() - 1);
+  Eigen::Affine3d second_end = second_tip_poses.getPose(req.second_trajectory->getWayPointCount() - 1);
 
   if((first_end.translation() - first_start.translation()).norm() <= req.blend_radius ||
      (first_end.translation() - second_end.translation()).norm() <= req.blend_radius )
@@ -186,19 +237,20 @@ void pilz::TrajectoryBlenderTransitionWindow::blendTrajectoryCartesian(const pil
   trajectory.group_name = req.group_name;
   trajectory.link_name = req.link_name;
 
+  const TipPoseLookup first_tip_poses(req.first_trajectory, req.link_name, req.first_tip_pose_track);
+  const TipPoseLookup second_tip_poses(req.second_trajectory, req.link_name, req.second_tip_pose_track);
+
   // Pose on first trajectory
-  Eigen::Affine3d blend_sample_pose1
-      = req.first_trajectory->getWayPoint(first_interse_index).getFrameTransform(req.link_name);
+  Eigen::Affine3d blend_sample_pose1 = first_tip_poses.getPose(first_interse_index);
 
   // Pose on second trajectory
-  Eigen::Affine3d blend_sample_pose2
-      = req.second_trajectory->getWayPoint(second_interse_index).getFrameTransform(req.link_name);
+  Eigen::Affine3d blend_sample_pose2 = second_tip_poses.getPose(second_interse_index);
 
   // blend the trajectory
   double blend_sample_num = second_interse_index + blend_align_index - first_interse_index +1 ;
   pilz::CartesianTrajectoryPoint waypoint;
   geometry_msgs::Pose waypoint_pose;
-  blend_sample_pose2 = req.second_trajectory->getFirstWayPoint().getFrameTransform(req.link_name);
+  blend_sample_pose2 = second_tip_poses.getPose(0);
 
   // Pose on blending trajectory
   Eigen::Affine3d  blend_sample_pose;
@@ -207,14 +259,13 @@ void pilz::TrajectoryBlenderTransitionWindow::blendTrajectoryCartesian(const pil
     // if the first trajectory does not reach the last sample, update
     if((first_interse_index+i) < req.first_trajectory->getWayPointCount())
     {
-      blend_sample_pose1 = req.first_trajectory->getWayPoint(first_interse_index+i).getFrameTransform(req.link_name);
+      blend_sample_pose1 = first_tip_poses.getPose(first_interse_index+i);
     }
 
     // if after the alignment, the second trajectory starts, update
     if((first_interse_index+i) > blend_align_index)
     {
-      blend_sample_pose2
-         = req.second_trajectory->getWayPoint(first_interse_index+i-blend_align_index).getFrameTransform(req.link_name);
+      blend_sample_pose2 = second_tip_poses.getPose(first_interse_index+i-blend_align_index);
     }
 
     double s = (i+1)/blend_sample_num;
@@ -240,25 +291,30 @@ void pilz::TrajectoryBlenderTransitionWindow::blendTrajectoryCartesian(const pil
 
 bool pilz::TrajectoryBlenderTransitionWindow::searchIntersectionPoints(const pilz::TrajectoryBlendRequest &req,
                                                             std::size_t &first_interse_index,
-                                                            std::size_t &second_interse_index) const
+                                                            std::size_t &second_interse_index,
+                                                            double &first_crossing_time,
+                                                            double &second_crossing_time) const
 {
   ROS_INFO("Search for start and end point of blending trajectory.");
 
   // compute the position of the center of the blend sphere
   // (last point of the first trajectory, first point of the second trajectory)
-  Eigen::Affine3d circ_pose = req.first_trajectory->getLastWayPoint().getFrameTransform(req.link_name);
+  Eigen::Affine3d circ_pose = TipPoseLookup(req.first_trajectory, req.link_name, req.first_tip_pose_track)
+      .getPose(req.first_trajectory->getWayPointCount() - 1);
 
   // Searh for intersection points according to distance
-  if(!linearSearchIntersectionPoint(req.link_name, circ_pose.translation(), req.blend_radius,
-                                    req.first_trajectory, true, first_interse_index))
+  if(!searchIntersectionPoint(req.link_name, circ_pose.translation(), req.blend_radius,
+                              req.first_trajectory, true, first_interse_index, first_crossing_time,
+                              req.first_tip_pose_track))
   {
     ROS_ERROR_STREAM("Intersection point of first trajectory not found.");
     return false;
   }
   ROS_INFO_STREAM("Intersection point of first trajectory found, index: " << first_interse_index);
 
-  if(!linearSearchIntersectionPoint(req.link_name, circ_pose.translation(), req.blend_radius,
-                                    req.second_trajectory, false, second_interse_index))
+  if(!searchIntersectionPoint(req.link_name, circ_pose.translation(), req.blend_radius,
+                              req.second_trajectory, false, second_interse_index, second_crossing_time,
+                              req.second_tip_pose_track))
   {
     ROS_ERROR_STREAM("Intersection point of second trajectory not found.");
     return false;
@@ -271,12 +327,22 @@ bool pilz::TrajectoryBlenderTransitionWindow::searchIntersectionPoints(const pil
 void pilz::TrajectoryBlenderTransitionWindow::determineTrajectoryAlignment(const pilz::TrajectoryBlendRequest &req,
                                                                 std::size_t first_interse_index,
                                                                 std::size_t second_interse_index,
+                                                                double first_crossing_time,
+                                                                double second_crossing_time,
                                                                 std::size_t &blend_align_index) const
 {
   double tau_1 = (req.first_trajectory->getWayPointDurationFromStart(req.first_trajectory->getWayPointCount()) -
                   req.first_trajectory->getWayPointDurationFromStart(first_interse_index));
   double tau_2 = req.second_trajectory->getWayPointDurationFromStart(second_interse_index);
 
+  // the times inside of the sphere are measured from the interpolated crossings
+  if(crossing_time_alignment_)
+  {
+    tau_1 = (req.first_trajectory->getWayPointDurationFromStart(req.first_trajectory->getWayPointCount()) -
+             first_crossing_time);
+    tau_2 = second_crossing_time;
+  }
+
   if(tau_1 > tau_2)
   {
     blend_align_index = req.first_trajectory->getWayPointCount() - second_interse_index -1;
@@ -17,7 +17,13 @@
 
 #include "pilz_trajectory_generation/trajectory_functions.h"
 
-#include <moveit/planning_scene/planning_scene.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <kdl/trajectory_segment.hpp>
+
+#include "pilz_trajectory_generation/velocity_profile_topp.h"
 
 bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
                          const std::string &group_name,
@@ -29,306 +35,1476 @@ bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
                          bool check_self_collision,
                          int max_attempt)
 {
-  if(!robot_model->hasJointModelGroup(group_name))
-  {
-    ROS_ERROR_STREAM("Robot model has no planning group named as " << group_name);
-    return false;
-  }
+  if(frame_id != robot_model->getModelFrame())
+  {
+    ROS_ERROR_STREAM("Given frame (" << frame_id << ") is unequal to model frame(" << robot_model->getModelFrame() << ")");
+    return false;
+  }
+
+  KinematicsSession kinematics(robot_model, group_name, link_name);
+  return kinematics.solveIK(pose, seed, solution, check_self_collision, max_attempt);
+}
+
+
+bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
+                         const std::string &group_name,
+                         const std::string &link_name,
+                         const geometry_msgs::Pose &pose,
+                         const std::string &frame_id,
+                         const std::map<std::string, double> &seed,
+                         std::map<std::string, double> &solution,
+                         bool check_self_collision,
+                         int max_attempt)
+{
+  Eigen::Affine3d pose_eigen;
+  tf::poseMsgToEigen(pose, pose_eigen);
+  return computePoseIK(robot_model,
+                       group_name,
+                       link_name,
+                       pose_eigen,
+                       frame_id,
+                       seed,
+                       solution,
+                       check_self_collision,
+                       max_attempt);
+}
+
+bool pilz::computeLinkFK(const moveit::core::RobotModelConstPtr &robot_model,
+                         const std::string &link_name,
+                         const std::map<std::string, double> &joint_state,
+                         Eigen::Affine3d &pose)
+{
+  // the link is not bound to a planning group
+  KinematicsSession kinematics(robot_model, "", link_name);
+  return kinematics.fk(joint_state, pose);
+}
+
+bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position_last,
+                                   const std::map<std::string, double> &velocity_last,
+                                   const std::map<std::string, double> &position_current,
+                                   double duration_last,
+                                   double duration_current,
+                                   const pilz::JointLimitsContainer& joint_limits)
+{
+  std::vector<std::string> joint_names;
+  std::vector<pilz_extensions::JointLimit> limits;
+  Eigen::VectorXd position_last_vector(position_current.size());
+  Eigen::VectorXd velocity_last_vector(position_current.size());
+  Eigen::VectorXd position_current_vector(position_current.size());
+
+  // an unknown velocity of the last sample is considered as standstill
+  for(const auto& pos : position_current)
+  {
+    const Eigen::Index i = joint_names.size();
+    joint_names.push_back(pos.first);
+    // a joint without limit throws std::out_of_range
+    limits.push_back(joint_limits.getLimit(pos.first));
+    position_current_vector(i) = pos.second;
+    position_last_vector(i) = position_last.at(pos.first);
+    auto velocity_it = velocity_last.find(pos.first);
+    velocity_last_vector(i) = velocity_it != velocity_last.end() ? velocity_it->second : 0.0;
+  }
+
+  return verifySampleJointLimits(position_last_vector,
+                                 velocity_last_vector,
+                                 position_current_vector,
+                                 duration_last,
+                                 duration_current,
+                                 limits,
+                                 joint_names);
+}
+
+bool pilz::verifySampleJointLimits(const Eigen::VectorXd &position_last,
+                                   const Eigen::VectorXd &velocity_last,
+                                   const Eigen::VectorXd &position_current,
+                                   double duration_last,
+                                   double duration_current,
+                                   const std::vector<pilz_extensions::JointLimit> &joint_limits,
+                                   const std::vector<std::string> &joint_names)
+{
+  Eigen::MatrixXd velocities, accelerations;
+  JointLimitViolation violation;
+  return verifyJointTrajectoryLimits(position_current.transpose(),
+                                     position_last,
+                                     velocity_last,
+                                     Eigen::VectorXd::Constant(1, duration_current),
+                                     Eigen::VectorXd::Constant(1, duration_last),
+                                     JointLimitsTable(joint_limits),
+                                     joint_names,
+                                     velocities,
+                                     accelerations,
+                                     violation);
+}
+
+bool pilz::verifyJointTrajectoryLimits(const Eigen::MatrixXd &positions,
+                                       const Eigen::VectorXd &initial_position,
+                                       const Eigen::VectorXd &initial_velocity,
+                                       const Eigen::VectorXd &durations,
+                                       const Eigen::VectorXd &durations_last,
+                                       const pilz::JointLimitsTable &limits,
+                                       const std::vector<std::string> &joint_names,
+                                       Eigen::MatrixXd &velocities,
+                                       Eigen::MatrixXd &accelerations,
+                                       pilz::JointLimitViolation &violation)
+{
+  const double EPSILON = 10e-6;
+  const Eigen::Index sample_count = positions.rows();
+  const Eigen::Index joint_count = positions.cols();
+  velocities.resize(sample_count, joint_count);
+  accelerations.resize(sample_count, joint_count);
+  violation = JointLimitViolation();
+
+  for(Eigen::Index k = 0; k < sample_count; ++k)
+  {
+    if(durations(k) <= EPSILON)
+    {
+      ROS_ERROR("Sample duration too small, cannot compute the velocity");
+      violation.type = JointLimitViolation::DURATION;
+      violation.sample = k;
+      violation.value = durations(k);
+      violation.limit = EPSILON;
+      return false;
+    }
+  }
+  if(sample_count == 0)
+  {
+    return true;
+  }
+
+  const Eigen::ArrayXd acceleration_durations = (durations + durations_last).array();
+  const Eigen::Index tail = sample_count - 1;
+
+  // the first violation over all joints, samples after it do not need to be checked
+  Eigen::Index first_violating_sample = sample_count;
+  Eigen::ArrayXd velocity_last(sample_count);
+  Eigen::ArrayXd acceleration_limit(sample_count);
+  Eigen::Array<bool, Eigen::Dynamic, 1> violated(sample_count);
+  for(Eigen::Index j = 0; j < joint_count; ++j)
+  {
+    // finite differences of all samples of the joint
+    velocities(0, j) = (positions(0, j) - initial_position(j)) / durations(0);
+    velocities.col(j).tail(tail).array() = (positions.col(j).tail(tail) - positions.col(j).head(tail)).array()
+        / durations.tail(tail).array();
+
+    velocity_last(0) = initial_velocity(j);
+    velocity_last.tail(tail) = velocities.col(j).head(tail).array();
+    accelerations.col(j).array() = (velocities.col(j).array() - velocity_last) / acceleration_durations * 2;
+
+    // acceleration limit if the joint speeds up, deceleration limit otherwise
+    acceleration_limit = (velocity_last.abs() <= velocities.col(j).array().abs())
+        .select(Eigen::ArrayXd::Constant(sample_count, limits.max_acceleration(j)), limits.max_deceleration(j));
+    violated = (velocities.col(j).array().abs() > limits.max_velocity(j))
+        || (accelerations.col(j).array().abs() > acceleration_limit);
+
+    for(Eigen::Index k = 0; k < first_violating_sample; ++k)
+    {
+      if(violated(k))
+      {
+        first_violating_sample = k;
+        violation.sample = k;
+        violation.joint = j;
+        break;
+      }
+    }
+  }
+
+  if(first_violating_sample == sample_count)
+  {
+    return true;
+  }
+
+  // report the violation like the sample wise check
+  const std::size_t k = violation.sample;
+  const std::size_t j = violation.joint;
+  const double velocity = velocities(k, j);
+  const double acceleration = accelerations(k, j);
+  const double velocity_previous = k == 0 ? initial_velocity(j) : velocities(k-1, j);
+  if(std::fabs(velocity) > limits.max_velocity(j))
+  {
+    ROS_ERROR_STREAM("Joint velocity limit of " << joint_names[j] << " violated. Set the velocity scaling factor lower!"
+                     << " Actual joint velocity is " << velocity
+                     << ", while the limit is " << limits.max_velocity(j)
+                     << ". ");
+    violation.type = JointLimitViolation::VELOCITY;
+    violation.value = velocity;
+    violation.limit = limits.max_velocity(j);
+  }
+  else if(std::fabs(velocity_previous) <= std::fabs(velocity))
+  {
+    ROS_ERROR_STREAM("Joint acceleration limit of " << joint_names[j]
+                     << " violated. Set the acceleration scaling factor lower!"
+                     << " Actual joint acceleration is " << acceleration
+                     << ", while the limit is " << limits.max_acceleration(j)
+                     << ". ");
+    violation.type = JointLimitViolation::ACCELERATION;
+    violation.value = acceleration;
+    violation.limit = limits.max_acceleration(j);
+  }
+  else
+  {
+    ROS_ERROR_STREAM("Joint deceleration limit of " << joint_names[j]
+                     << " violated. Set the acceleration scaling factor lower!"
+                     << " Actual joint deceleration is " << acceleration
+                     << ", while the limit is " << limits.max_deceleration(j)
+                     << ". ");
+    violation.type = JointLimitViolation::DECELERATION;
+    violation.value = acceleration;
+    violation.limit = limits.max_deceleration(j);
+  }
+
+  return false;
+}
+
+double pilz::computeFeasibleTimeScaling(const Eigen::MatrixXd &velocities,
+                                        const Eigen::MatrixXd &accelerations,
+                                        const Eigen::VectorXd &initial_velocity,
+                                        const pilz::JointLimitsTable &limits)
+{
+  double time_scaling = 1.0;
+  for(Eigen::Index j = 0; j < velocities.cols(); ++j)
+  {
+    for(Eigen::Index k = 0; k < velocities.rows(); ++k)
+    {
+      const double velocity = std::fabs(velocities(k, j));
+      const double velocity_last = std::fabs(k == 0 ? initial_velocity(j) : velocities(k-1, j));
+      const double acceleration = std::fabs(accelerations(k, j));
+      // the velocities are scaled alike, so the choice of the limit does not change with the factor
+      const double acceleration_limit = velocity_last <= velocity ? limits.max_acceleration(j)
+                                                                  : limits.max_deceleration(j);
+      if(velocity > limits.max_velocity(j))
+      {
+        time_scaling = std::min(time_scaling, limits.max_velocity(j) / velocity);
+      }
+      if(acceleration > acceleration_limit)
+      {
+        time_scaling = std::min(time_scaling, std::sqrt(acceleration_limit / acceleration));
+      }
+    }
+  }
+  return time_scaling;
+}
+
+/**
+ * @brief solve the IK of poses[begin, end), the first pose is seeded by seed, all others by their predecessor
+ *
+ * With differential IK the solution is first refined by Jacobian steps from a linear prediction of the last two
+ * solutions, the IK solver is only called if this does not converge.
+ */
+static bool computePoseSequenceIKSequential(pilz::KinematicsSession &kinematics,
+                                            const pilz::PoseVector &poses,
+                                            std::size_t begin,
+                                            std::size_t end,
+                                            const Eigen::VectorXd &seed,
+                                            const pilz::GeneratorOptions &options,
+                                            std::vector<Eigen::VectorXd> &solutions,
+                                            bool check_self_collision)
+{
+  Eigen::VectorXd prediction;
+  for(std::size_t i = begin; i < end; ++i)
+  {
+    const Eigen::VectorXd& seed_current = i == begin ? seed : solutions[i-1];
+    if(options.differential_ik)
+    {
+      if(i >= begin + 2)
+      {
+        prediction = 2*solutions[i-1] - solutions[i-2];
+      }
+      else
+      {
+        prediction = seed_current;
+      }
+      if(kinematics.solveIKDifferential(poses[i], prediction, solutions[i],
+                                        options.differential_ik_position_tolerance,
+                                        options.differential_ik_orientation_tolerance,
+                                        options.differential_ik_max_iterations,
+                                        check_self_collision))
+      {
+        continue;
+      }
+    }
+
+    if(!kinematics.solveIK(poses[i], seed_current, solutions[i], check_self_collision))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief solve the IK of poses[0, sample_count), in parallel chunks if enabled by the options
+ * @param goal_joint_position: solution of the last pose of poses, empty if unknown
+ */
+static bool computePoseSequenceIKChunked(pilz::KinematicsSession &kinematics,
+                                         const pilz::PoseVector &poses,
+                                         std::size_t sample_count,
+                                         const Eigen::VectorXd &initial_joint_position,
+                                         const Eigen::VectorXd &goal_joint_position,
+                                         const Eigen::VectorXd &max_joint_step,
+                                         const pilz::GeneratorOptions &options,
+                                         std::vector<Eigen::VectorXd> &solutions,
+                                         bool check_self_collision)
+{
+  // determine the number of chunks, without workers the poses are solved sequentially
+  std::size_t chunk_count = 1;
+  if(options.parallel_ik && options.thread_pool && sample_count >= options.parallel_ik_min_samples)
+  {
+    unsigned int thread_count = options.parallel_ik_threads > 0 ? options.parallel_ik_threads
+                                                                : options.thread_pool->size();
+    chunk_count = std::max<std::size_t>(1, std::min<std::size_t>(thread_count, sample_count));
+  }
+
+  if(chunk_count == 1)
+  {
+    return computePoseSequenceIKSequential(kinematics, poses, 0, sample_count, initial_joint_position, options,
+                                           solutions, check_self_collision);
+  }
+
+  ROS_DEBUG_STREAM("Solve inverse kinematics of " << sample_count << " poses in " << chunk_count << " chunks.");
+
+  std::vector<std::size_t> chunk_begin(chunk_count + 1);
+  for(std::size_t k = 0; k <= chunk_count; ++k)
+  {
+    chunk_begin[k] = k * sample_count / chunk_count;
+  }
+
+  // seed each chunk by interpolating from the initial to the goal joint position if the goal is known, otherwise
+  // with the solution of its first pose, chained from the initial joint position
+  std::vector<Eigen::VectorXd> chunk_seeds(chunk_count);
+  chunk_seeds[0] = initial_joint_position;
+  const bool goal_known = goal_joint_position.size() == initial_joint_position.size() && poses.size() >= 2;
+  for(std::size_t k = 1; k < chunk_count; ++k)
+  {
+    if(goal_known)
+    {
+      chunk_seeds[k] = initial_joint_position + (goal_joint_position - initial_joint_position)
+          * (static_cast<double>(chunk_begin[k]) / (poses.size() - 1));
+    }
+    else if(!kinematics.solveIK(poses[chunk_begin[k]], chunk_seeds[k-1], chunk_seeds[k], check_self_collision))
+    {
+      // the chunk is solved sequentially after the seam check
+      chunk_seeds[k] = chunk_seeds[k-1];
+    }
+  }
+
+  // solve the chunks in parallel, a kinematics session must not be shared between threads
+  std::vector<char> chunk_solved(chunk_count, false);
+  pilz::TaskGroup chunk_tasks(options.thread_pool.get());
+  for(std::size_t k = 0; k < chunk_count; ++k)
+  {
+    chunk_tasks.run([&, k]()
+    {
+      pilz::KinematicsSession chunk_kinematics(kinematics);
+      chunk_solved[k] = computePoseSequenceIKSequential(chunk_kinematics, poses, chunk_begin[k], chunk_begin[k+1],
+                                                        chunk_seeds[k], options, solutions, check_self_collision);
+      // the other chunks are useless without the first one
+      if(k == 0 && !chunk_solved[k])
+      {
+        chunk_tasks.cancel();
+      }
+    });
+  }
+  chunk_tasks.wait();
+
+  // the first chunk starts at the initial joint position exactly like the sequential solution
+  if(!chunk_solved.front())
+  {
+    return false;
+  }
+
+  // check the continuity at the seams, a chunk which failed or jumps is solved sequentially from its predecessor
+  for(std::size_t k = 1; k < chunk_count; ++k)
+  {
+    const std::size_t seam = chunk_begin[k];
+    if(chunk_solved[k] &&
+       ((solutions[seam] - solutions[seam-1]).cwiseAbs().array() <= max_joint_step.array()).all())
+    {
+      continue;
+    }
+
+    ROS_DEBUG_STREAM("Discontinuity at sample " << seam << ", solve the chunk sequentially.");
+    if(!computePoseSequenceIKSequential(kinematics, poses, seam, chunk_begin[k+1], solutions[seam-1], options,
+                                        solutions, check_self_collision))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool pilz::computePoseSequenceIK(pilz::KinematicsSession &kinematics,
+                                 const pilz::PoseVector &poses,
+                                 const Eigen::VectorXd &initial_joint_position,
+                                 const Eigen::VectorXd &max_joint_step,
+                                 const pilz::GeneratorOptions &options,
+                                 std::vector<Eigen::VectorXd> &solutions,
+                                 bool check_self_collision,
+                                 const Eigen::VectorXd &goal_joint_position)
+{
+  const std::size_t pose_count = poses.size();
+  solutions.resize(pose_count);
+
+  // the IK of the last pose is only solved if the goal is unknown
+  const bool goal_known = goal_joint_position.size() == initial_joint_position.size() && pose_count >= 2;
+  if(!computePoseSequenceIKChunked(kinematics, poses, goal_known ? pose_count - 1 : pose_count,
+                                   initial_joint_position, goal_joint_position, max_joint_step, options, solutions,
+                                   check_self_collision))
+  {
+    return false;
+  }
+  if(!goal_known)
+  {
+    return true;
+  }
+
+  // the goal is the last sample if the sequence reaches it continuously, otherwise it ends on another IK branch
+  const std::size_t last = pose_count - 1;
+  if(((goal_joint_position - solutions[last-1]).cwiseAbs().array() <= max_joint_step.array()).all())
+  {
+    solutions[last] = goal_joint_position;
+    return true;
+  }
+  ROS_DEBUG("Goal joint position is not continuous to the sampled poses, solve the last pose.");
+  return computePoseSequenceIKSequential(kinematics, poses, last, pose_count, solutions[last-1], options, solutions,
+                                         check_self_collision);
+}
+
+/**
+ * @brief interpolate the joint positions of the poses between the knots begin and end
+ * @return false if an interpolated pose deviates from its Cartesian pose more than the tolerances or is in self
+ * collision if checked
+ */
+static bool interpolateKnotInterval(pilz::KinematicsSession &kinematics,
+                                    const pilz::PoseVector &poses,
+                                    const std::vector<double> &path_parameters,
+                                    std::size_t begin,
+                                    std::size_t end,
+                                    const pilz::GeneratorOptions &options,
+                                    std::vector<Eigen::VectorXd> &solutions,
+                                    bool check_self_collision)
+{
+  const double EPSILON = 10e-9;
+  const double path_length = path_parameters[end] - path_parameters[begin];
+  Eigen::Affine3d pose_interpolated;
+  for(std::size_t k = begin + 1; k < end; ++k)
+  {
+    // interpolate over the sample index if the path does not advance, e.g. during standstill
+    const double s = path_length > EPSILON ? (path_parameters[k] - path_parameters[begin]) / path_length
+                                           : static_cast<double>(k - begin) / (end - begin);
+    solutions[k] = solutions[begin] + s * (solutions[end] - solutions[begin]);
+
+    if(!kinematics.fk(solutions[k], pose_interpolated))
+    {
+      return false;
+    }
+    const double position_deviation = (pose_interpolated.translation() - poses[k].translation()).norm();
+    const double orientation_deviation =
+        Eigen::AngleAxisd(poses[k].linear().transpose() * pose_interpolated.linear()).angle();
+    if(position_deviation > options.adaptive_sampling_position_tolerance ||
+       orientation_deviation > options.adaptive_sampling_orientation_tolerance)
+    {
+      return false;
+    }
+
+    // the knots are solved with the collision check, the interpolated samples in between are not
+    if(check_self_collision && !kinematics.isSelfCollisionFree(solutions[k]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief solve the poses between the solved knots begin and end, bisect until the interpolation is accurate enough
+ * and, if checked, free of self collision
+ */
+static bool solveKnotInterval(pilz::KinematicsSession &kinematics,
+                              const pilz::PoseVector &poses,
+                              const std::vector<double> &path_parameters,
+                              std::size_t begin,
+                              std::size_t end,
+                              const Eigen::VectorXd &max_joint_step,
+                              const pilz::GeneratorOptions &options,
+                              std::vector<Eigen::VectorXd> &solutions,
+                              bool check_self_collision,
+                              std::size_t &ik_count)
+{
+  if(end - begin < 2)
+  {
+    return true;
+  }
+
+  // a jump between the knots cannot be interpolated, e.g. the IK solution switched the branch
+  const bool continuous = ((solutions[end] - solutions[begin]).cwiseAbs().array()
+                           <= max_joint_step.array() * static_cast<double>(end - begin)).all();
+  if(continuous && interpolateKnotInterval(kinematics, poses, path_parameters, begin, end, options, solutions,
+                                           check_self_collision))
+  {
+    return true;
+  }
+
+  // bisect, the interpolated solution is the seed of the new knot
+  const std::size_t middle = (begin + end) / 2;
+  const Eigen::VectorXd seed = solutions[begin] + 0.5 * (solutions[end] - solutions[begin]);
+  ++ik_count;
+  if(!kinematics.solveIK(poses[middle], continuous ? seed : solutions[begin], solutions[middle],
+                         check_self_collision))
+  {
+    return false;
+  }
+
+  return solveKnotInterval(kinematics, poses, path_parameters, begin, middle, max_joint_step, options,
+                           solutions, check_self_collision, ik_count) &&
+      solveKnotInterval(kinematics, poses, path_parameters, middle, end, max_joint_step, options,
+                        solutions, check_self_collision, ik_count);
+}
+
+bool pilz::computePoseSequenceIKAdaptive(pilz::KinematicsSession &kinematics,
+                                         const pilz::PoseVector &poses,
+                                         const std::vector<double> &path_parameters,
+                                         const Eigen::VectorXd &initial_joint_position,
+                                         const Eigen::VectorXd &max_joint_step,
+                                         const pilz::GeneratorOptions &options,
+                                         std::vector<Eigen::VectorXd> &solutions,
+                                         bool check_self_collision,
+                                         const Eigen::VectorXd &goal_joint_position)
+{
+  const std::size_t sample_count = poses.size();
+  if(path_parameters.size() != sample_count)
+  {
+    ROS_ERROR_STREAM("Number of path parameters (" << path_parameters.size()
+                     << ") does not match the number of poses (" << sample_count << ").");
+    return false;
+  }
+  solutions.resize(sample_count);
+  if(sample_count == 0)
+  {
+    return true;
+  }
+
+  // initial knots, the last pose is always a knot
+  const std::size_t knot_interval = std::max<std::size_t>(1, options.adaptive_sampling_max_knot_interval);
+  std::vector<std::size_t> knots;
+  for(std::size_t k = 0; k < sample_count - 1; k += knot_interval)
+  {
+    knots.push_back(k);
+  }
+  knots.push_back(sample_count - 1);
+
+  // solve the knots, each seeded by its predecessor
+  const bool goal_known = goal_joint_position.size() == initial_joint_position.size() && knots.size() >= 2;
+  std::size_t ik_count = 0;
+  for(std::size_t i = 0; i < knots.size(); ++i)
+  {
+    // the goal is the last knot if it is continuous to its predecessor
+    if(goal_known && i == knots.size() - 1 &&
+       ((goal_joint_position - solutions[knots[i-1]]).cwiseAbs().array()
+        <= max_joint_step.array() * static_cast<double>(knots[i] - knots[i-1])).all())
+    {
+      solutions[knots[i]] = goal_joint_position;
+      continue;
+    }
+    ++ik_count;
+    if(!kinematics.solveIK(poses[knots[i]], i == 0 ? initial_joint_position : solutions[knots[i-1]],
+                           solutions[knots[i]], check_self_collision))
+    {
+      return false;
+    }
+  }
+
+  for(std::size_t i = 1; i < knots.size(); ++i)
+  {
+    if(!solveKnotInterval(kinematics, poses, path_parameters, knots[i-1], knots[i], max_joint_step, options,
+                          solutions, check_self_collision, ik_count))
+    {
+      return false;
+    }
+  }
+
+  ROS_DEBUG_STREAM("Adaptive sampling solved " << ik_count << " of " << sample_count << " poses by IK.");
+  return true;
+}
+
+bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot_model,
+                                   const pilz::JointLimitsContainer& joint_limits,
+                                   const KDL::Trajectory &trajectory,
+                                   const std::string &group_name,
+                                   const std::string &link_name,
+                                   const std::map<std::string, double> &initial_joint_position,
+                                   const double &sampling_time,
+                                   trajectory_msgs::JointTrajectory &joint_trajectory,
+                                   moveit_msgs::MoveItErrorCodes &error_code,
+                                   bool check_self_collision)
+{
+  KinematicsSession kinematics(robot_model, group_name, link_name);
+  Eigen::VectorXd initial_joint_vector;
+  if(!kinematics.toJointVector(initial_joint_position, initial_joint_vector))
+  {
+    error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
+    return false;
+  }
+  JointTrajectoryBuffer joint_trajectory_buffer;
+  const bool generated = generateJointTrajectory(kinematics,
+                                                 joint_limits,
+                                                 trajectory,
+                                                 initial_joint_vector,
+                                                 sampling_time,
+                                                 joint_trajectory_buffer,
+                                                 error_code,
+                                                 check_self_collision);
+  joint_trajectory_buffer.toMsg(joint_trajectory);
+  return generated;
+}
+
+/**
+ * @brief sample times from 0 to duration with the sampling time, the last sample is at the duration
+ */
+static std::vector<double> sampleTimes(double duration, double sampling_time)
+{
+  const double EPSILON = 10e-06; // avoid adding the last time sample twice
+  std::vector<double> time_samples;
+  for(double t_sample=0.0; t_sample < duration - EPSILON; t_sample+=sampling_time)
+  {
+    time_samples.push_back(t_sample);
+  }
+  time_samples.push_back(duration);
+  return time_samples;
+}
+
+/**
+ * @brief sample a velocity profile with the sampling time
+ * @param time_samples: sample times from 0 to the duration of the profile
+ * @param path_parameters: position of the profile at the samples
+ */
+static void sampleVelocityProfile(const KDL::VelocityProfile &velocity_profile,
+                                  double sampling_time,
+                                  std::vector<double> &time_samples,
+                                  std::vector<double> &path_parameters)
+{
+  time_samples = sampleTimes(velocity_profile.Duration(), sampling_time);
+  path_parameters.resize(time_samples.size());
+  for(std::size_t k = 0; k < time_samples.size(); ++k)
+  {
+    path_parameters[k] = velocity_profile.Pos(time_samples[k]);
+  }
+}
+
+/**
+ * @brief solve the IK of the sampled poses, adaptively if enabled by the options
+ */
+static bool solvePoseSamples(pilz::KinematicsSession &kinematics,
+                             const pilz::PoseVector &pose_samples,
+                             const std::vector<double> &path_parameters,
+                             const Eigen::VectorXd &initial_joint_position,
+                             const Eigen::VectorXd &max_joint_step,
+                             const pilz::GeneratorOptions &options,
+                             std::vector<Eigen::VectorXd> &ik_solutions,
+                             bool check_self_collision,
+                             const Eigen::VectorXd &goal_joint_position)
+{
+  if(options.adaptive_sampling)
+  {
+    return pilz::computePoseSequenceIKAdaptive(kinematics, pose_samples, path_parameters, initial_joint_position,
+                                               max_joint_step, options, ik_solutions, check_self_collision,
+                                               goal_joint_position);
+  }
+  return pilz::computePoseSequenceIK(kinematics, pose_samples, initial_joint_position, max_joint_step, options,
+                                     ik_solutions, check_self_collision, goal_joint_position);
+}
+
+/**
+ * @brief verify the limits of all samples after the first one in one pass, the last interval can be shorter
+ * @return true if there is no more than one sample or no limit is violated
+ */
+static bool verifySampleLimits(const std::vector<double> &time_samples,
+                               const std::vector<Eigen::VectorXd> &ik_solutions,
+                               double sampling_time,
+                               const pilz::JointLimitsTable &limits_table,
+                               const std::vector<std::string> &joint_names,
+                               Eigen::MatrixXd &velocities,
+                               Eigen::MatrixXd &accelerations,
+                               pilz::JointLimitViolation &violation)
+{
+  const std::size_t sample_count = time_samples.size();
+  if(sample_count < 2)
+  {
+    return true;
+  }
+
+  const std::size_t joint_count = joint_names.size();
+  Eigen::MatrixXd positions(sample_count - 1, joint_count);
+  for(std::size_t k = 1; k < sample_count; ++k)
+  {
+    positions.row(k-1) = ik_solutions[k].transpose();
+  }
+  Eigen::VectorXd durations = Eigen::VectorXd::Constant(sample_count - 1, sampling_time);
+  durations(sample_count - 2) = time_samples[sample_count-1] - time_samples[sample_count-2];
+
+  return pilz::verifyJointTrajectoryLimits(positions,
+                                           ik_solutions.front(),
+                                           Eigen::VectorXd::Zero(joint_count),
+                                           durations,
+                                           Eigen::VectorXd::Constant(sample_count - 1, sampling_time),
+                                           limits_table,
+                                           joint_names,
+                                           velocities,
+                                           accelerations,
+                                           violation);
+}
+
+/**
+ * @brief fill the joint trajectory with the verified samples
+ * @param pose_samples: poses of the samples, moved into the tip pose track of the joint trajectory
+ */
+static void setJointTrajectorySamples(const pilz::KinematicsSession &kinematics,
+                                      const std::vector<double> &time_samples,
+                                      const std::vector<Eigen::VectorXd> &ik_solutions,
+                                      const Eigen::MatrixXd &velocities,
+                                      const Eigen::MatrixXd &accelerations,
+                                      pilz::PoseVector &pose_samples,
+                                      pilz::JointTrajectoryBuffer &joint_trajectory)
+{
+  // set joint names and allocate all points at once, velocity and acceleration of the first point stay zero
+  const std::size_t sample_count = time_samples.size();
+  joint_trajectory.setJointNames(kinematics.getJointNames());
+  joint_trajectory.reserve(sample_count);
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    const std::size_t point_index = joint_trajectory.addPoint(time_samples[k]);
+    joint_trajectory.positions(point_index) = ik_solutions[k];
+    if(k > 0)
+    {
+      joint_trajectory.velocities(point_index) = velocities.row(k-1).transpose();
+      joint_trajectory.accelerations(point_index) = accelerations.row(k-1).transpose();
+    }
+  }
+
+  // the sampled poses are exact, they spare the forward kinematics of later consumers like the blender
+  std::shared_ptr<pilz::TipPoseTrack> tip_pose_track = std::make_shared<pilz::TipPoseTrack>();
+  tip_pose_track->link_name = kinematics.getLinkName();
+  tip_pose_track->poses.swap(pose_samples);
+  joint_trajectory.setTipPoseTrack(tip_pose_track);
+}
+
+/**
+ * @brief solve the IK of the sampled poses of a Cartesian trajectory and fill the joint trajectory
+ * @param path_parameters: path parameters of the samples, used to interpolate between the knots of adaptive sampling
+ * @param pose_samples: poses of the samples, moved into the tip pose track of the joint trajectory on success
+ * @param goal_joint_position: solution of the last pose, empty if unknown
+ */
+static bool generateJointTrajectoryFromPoses(pilz::KinematicsSession &kinematics,
+                                             const pilz::JointLimitsContainer& joint_limits,
+                                             const std::vector<double> &time_samples,
+                                             const std::vector<double> &path_parameters,
+                                             pilz::PoseVector &pose_samples,
+                                             const Eigen::VectorXd &initial_joint_position,
+                                             const double &sampling_time,
+                                             pilz::JointTrajectoryBuffer &joint_trajectory,
+                                             moveit_msgs::MoveItErrorCodes &error_code,
+                                             bool check_self_collision,
+                                             const pilz::GeneratorOptions &options,
+                                             const Eigen::VectorXd &goal_joint_position)
+{
+  ros::Time generation_begin = ros::Time::now();
+
+  // resolve joint names and limits once, all joint vectors are ordered like the active joints of the group
+  const std::vector<std::string>& joint_names = kinematics.getJointNames();
+  const pilz::JointLimitsTable limits_table(joint_limits.getLimits(joint_names));
+
+  // joint steps between two samples are bound by the velocity limits
+  const Eigen::VectorXd max_joint_step = limits_table.max_velocity * sampling_time;
+
+  std::vector<Eigen::VectorXd> ik_solutions;
+  if(!solvePoseSamples(kinematics, pose_samples, path_parameters, initial_joint_position, max_joint_step, options,
+                       ik_solutions, check_self_collision, goal_joint_position))
+  {
+    ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+    joint_trajectory.setJointNames(joint_names);
+    return false;
+  }
+
+  Eigen::MatrixXd velocities, accelerations;
+  pilz::JointLimitViolation violation;
+  if(!verifySampleLimits(time_samples, ik_solutions, sampling_time, limits_table, joint_names,
+                         velocities, accelerations, violation))
+  {
+    ROS_ERROR_STREAM("Inverse kinematics solution at " << time_samples[violation.sample + 1]
+                     << "s violates the joint velocity/acceleration/deceleration limits.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    joint_trajectory.setJointNames(joint_names);
+    return false;
+  }
+
+  setJointTrajectorySamples(kinematics, time_samples, ik_solutions, velocities, accelerations, pose_samples,
+                            joint_trajectory);
+
+  error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+  double duration_ms = (ros::Time::now() - generation_begin).toSec() * 1000;
+  ROS_DEBUG_STREAM("Generate trajectory (N-Points: " << joint_trajectory.size()
+                  << ") took " << duration_ms << " ms | "
+                  << duration_ms / joint_trajectory.size() << " ms per Point");
+
+  return true;
+}
+
+/**
+ * @brief interpolate the joint positions of the poses on a solved joint path
+ *
+ * The IK is solved for poses whose interpolation deviates from the Cartesian pose by more than the tolerances of the
+ * adaptive sampling or is in self collision, seeded by the interpolation. A solution which jumps away from its
+ * predecessor is solved again seeded by the predecessor, like the sequential IK.
+ * @param solved_parameters: monotonic path parameters of the solved joint path
+ * @param solved_positions: joint positions of the solved joint path
+ * @param max_joint_step: maximal joint motion between two samples
+ */
+static bool interpolateJointPath(pilz::KinematicsSession &kinematics,
+                                 const std::vector<double> &solved_parameters,
+                                 const std::vector<Eigen::VectorXd> &solved_positions,
+                                 const std::vector<double> &path_parameters,
+                                 const pilz::PoseVector &pose_samples,
+                                 const Eigen::VectorXd &max_joint_step,
+                                 const pilz::GeneratorOptions &options,
+                                 std::vector<Eigen::VectorXd> &positions,
+                                 bool check_self_collision)
+{
+  const double EPSILON = 10e-9;
+  positions.resize(path_parameters.size());
+  Eigen::Affine3d pose_interpolated;
+  Eigen::VectorXd seed;
+  std::size_t ik_count = 0;
+  bool solved_last = false;
+  for(std::size_t k = 0; k < path_parameters.size(); ++k)
+  {
+    // the interval [i-1, i] of the solved path which contains the parameter
+    const std::size_t i = std::min<std::size_t>(
+          std::max<std::size_t>(1, std::upper_bound(solved_parameters.begin(), solved_parameters.end(),
+                                                    path_parameters[k]) - solved_parameters.begin()),
+          solved_parameters.size() - 1);
+    const double interval = solved_parameters[i] - solved_parameters[i-1];
+    const double s = interval > EPSILON ? std::min(1.0, std::max(0.0, (path_parameters[k] - solved_parameters[i-1])
+                                                                      / interval))
+                                        : 1.0;
+    positions[k] = solved_positions[i-1] + s * (solved_positions[i] - solved_positions[i-1]);
+
+    if(!kinematics.fk(positions[k], pose_interpolated))
+    {
+      return false;
+    }
+    const double position_deviation = (pose_interpolated.translation() - pose_samples[k].translation()).norm();
+    const double orientation_deviation =
+        Eigen::AngleAxisd(pose_samples[k].linear().transpose() * pose_interpolated.linear()).angle();
+    bool solved = false;
+    if(position_deviation > options.adaptive_sampling_position_tolerance ||
+       orientation_deviation > options.adaptive_sampling_orientation_tolerance ||
+       (check_self_collision && !kinematics.isSelfCollisionFree(positions[k])))
+    {
+      seed = positions[k];
+      ++ik_count;
+      if(!kinematics.solveIK(pose_samples[k], seed, positions[k], check_self_collision))
+      {
+        return false;
+      }
+      solved = true;
+    }
+
+    // the interpolated samples are continuous, a solved sample or its successor might have switched the IK branch
+    if(k > 0 && (solved || solved_last) &&
+       !((positions[k] - positions[k-1]).cwiseAbs().array() <= max_joint_step.array()).all())
+    {
+      ++ik_count;
+      if(!kinematics.solveIK(pose_samples[k], positions[k-1], positions[k], check_self_collision) ||
+         !((positions[k] - positions[k-1]).cwiseAbs().array() <= max_joint_step.array()).all())
+      {
+        ROS_ERROR_STREAM("Inverse kinematics solution of the " << k << "th sample is not continuous.");
+        return false;
+      }
+      solved = true;
+    }
+    solved_last = solved;
+  }
+
+  ROS_DEBUG_STREAM("Interpolated " << path_parameters.size() - ik_count << " of " << path_parameters.size()
+                   << " samples on the solved joint path.");
+  return true;
+}
+
+/**
+ * @brief reduce the time scaling of a profile until its joint trajectory on a solved joint path obeys the limits
+ *
+ * The joint positions of the samples of the scaled profiles are interpolated on the solved joint path.
+ * @param solved_parameters: monotonic path parameters of the solved joint path
+ * @param solved_positions: joint positions of the solved joint path
+ * @param time_samples: samples of the profile with the given time scaling
+ * @param pose_samples: poses of the samples, moved into the tip pose track of the joint trajectory on success
+ * @param positions: joint positions of the samples
+ * @param time_scaling: time scaling of the samples, reduced to the one of the generated trajectory
+ */
+static bool generateJointTrajectoryOnJointPath(pilz::KinematicsSession &kinematics,
+                                               const pilz::JointLimitsTable &limits_table,
+                                               const pilz::CartesianPath &path,
+                                               const pilz::VelocityProfileFactory &velocity_profile_factory,
+                                               const std::vector<double> &solved_parameters,
+                                               const std::vector<Eigen::VectorXd> &solved_positions,
+                                               const double &sampling_time,
+                                               double min_time_scaling,
+                                               std::vector<double> &time_samples,
+                                               pilz::PoseVector &pose_samples,
+                                               std::vector<Eigen::VectorXd> &positions,
+                                               pilz::JointTrajectoryBuffer &joint_trajectory,
+                                               double &time_scaling,
+                                               moveit_msgs::MoveItErrorCodes &error_code,
+                                               bool check_self_collision,
+                                               const pilz::GeneratorOptions &options)
+{
+  // the reduced factor is computed exactly for the current samples, the resampling only causes small deviations
+  const std::size_t MAX_ITERATIONS = 10;
+
+  const std::vector<std::string>& joint_names = kinematics.getJointNames();
+  const Eigen::VectorXd max_joint_step = limits_table.max_velocity * sampling_time;
+  std::vector<double> path_parameters;
+  Eigen::MatrixXd velocities, accelerations;
+  pilz::JointLimitViolation violation;
+  for(std::size_t iteration = 0; iteration < MAX_ITERATIONS; ++iteration)
+  {
+    if(verifySampleLimits(time_samples, positions, sampling_time, limits_table, joint_names,
+                          velocities, accelerations, violation))
+    {
+      setJointTrajectorySamples(kinematics, time_samples, positions, velocities, accelerations, pose_samples,
+                                joint_trajectory);
+      error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+      return true;
+    }
+
+    if(violation.type == pilz::JointLimitViolation::DURATION)
+    {
+      break;
+    }
+
+    time_scaling *= pilz::computeFeasibleTimeScaling(velocities, accelerations,
+                                                     Eigen::VectorXd::Zero(joint_names.size()), limits_table)
+        * (1.0 - options.velocity_scaling_search_margin);
+    if(time_scaling < min_time_scaling)
+    {
+      ROS_ERROR_STREAM("The joint limits require a time scaling of " << time_scaling
+                       << ", which is below the minimum of " << min_time_scaling << ".");
+      break;
+    }
+    ROS_DEBUG_STREAM("Reduce the time scaling to " << time_scaling << ".");
+
+    // resample the slower profile on the solved joint path
+    sampleVelocityProfile(*velocity_profile_factory(time_scaling), sampling_time, time_samples, path_parameters);
+    path.getPoses(path_parameters, pose_samples);
+    if(!interpolateJointPath(kinematics, solved_parameters, solved_positions, path_parameters, pose_samples,
+                             max_joint_step, options, positions, check_self_collision))
+    {
+      ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+      joint_trajectory.setJointNames(joint_names);
+      return false;
+    }
+  }
+
+  ROS_ERROR("Failed to find a velocity profile which obeys the joint velocity/acceleration/deceleration limits.");
+  error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+  joint_trajectory.setJointNames(joint_names);
+  return false;
+}
+
+bool pilz::generateJointTrajectory(pilz::KinematicsSession &kinematics,
+                                   const pilz::JointLimitsContainer& joint_limits,
+                                   const KDL::Trajectory &trajectory,
+                                   const Eigen::VectorXd &initial_joint_position,
+                                   const double &sampling_time,
+                                   pilz::JointTrajectoryBuffer &joint_trajectory,
+                                   moveit_msgs::MoveItErrorCodes &error_code,
+                                   bool check_self_collision,
+                                   const pilz::GeneratorOptions &options)
+{
+  ROS_DEBUG("Generate joint trajectory from a Cartesian trajectory.");
 
-  if(!robot_model->getJointModelGroup(group_name)->canSetStateFromIK(link_name))
-  {
-    ROS_ERROR_STREAM("No valid IK solver exists for " << link_name << " in planning group " << group_name);
-    return false;
-  }
+  const std::vector<double> time_samples = sampleTimes(trajectory.Duration(), sampling_time);
 
-  if(frame_id != robot_model->getModelFrame())
+  // sample the trajectory
+  PoseVector pose_samples(time_samples.size());
+  for(std::size_t k = 0; k < time_samples.size(); ++k)
   {
-    ROS_ERROR_STREAM("Given frame (" << frame_id << ") is unequal to model frame(" << robot_model->getModelFrame() << ")");
-    return false;
+    tf::transformKDLToEigen(trajectory.Pos(time_samples[k]), pose_samples[k]);
   }
 
-  // create robot state
-  robot_state::RobotState rstate(robot_model);
-  rstate.setToDefaultValues();
-
-  // set the seed
-  rstate.setVariablePositions(seed);
-
-  // call ik
-  // TODO: Should consider self collision already.
-  if(rstate.setFromIK(robot_model->getJointModelGroup(group_name),
-                      pose,
-                      link_name,
-                      max_attempt))
+  // interpolate over the path length of the segment, otherwise over time
+  std::vector<double> path_parameters(time_samples);
+  const KDL::Trajectory_Segment* segment = dynamic_cast<const KDL::Trajectory_Segment*>(&trajectory);
+  if(segment)
   {
-    // self collision checking
-    if(check_self_collision)
-    {
-      planning_scene::PlanningScene rscene(robot_model);
-      rscene.setCurrentState(rstate);
-      collision_detection::CollisionRequest collision_req;
-      collision_detection::CollisionResult collision_res;
-      rscene.checkSelfCollision(collision_req, collision_res);
-
-      // LCOV_EXCL_START
-      if(collision_res.collision)
-      {
-        ROS_ERROR("Inverse kinematics solution has self collision.");
-        return false;
-      }
-      // LCOV_EXCL_STOP
-    }
-
-    // copy the solution
-    for(const auto& joint_name : robot_model->getJointModelGroup(group_name)->getActiveJointModelNames())
+    // KDL offers no const access to the velocity profile
+    const KDL::VelocityProfile* profile = const_cast<KDL::Trajectory_Segment*>(segment)->GetProfile();
+    for(std::size_t k = 0; k < time_samples.size(); ++k)
     {
-      solution[joint_name] = rstate.getVariablePosition(joint_name);
+      path_parameters[k] = profile->Pos(time_samples[k]);
     }
-    return true;
-  }
-  else
-  {
-    ROS_ERROR_STREAM("Inverse kinematics for pose \n"
-                     << pose.translation()
-                     << " has no solution.");
-    return false;
   }
-}
 
+  return generateJointTrajectoryFromPoses(kinematics, joint_limits, time_samples, path_parameters, pose_samples,
+                                          initial_joint_position, sampling_time, joint_trajectory, error_code,
+                                          check_self_collision, options, Eigen::VectorXd());
+}
 
-bool pilz::computePoseIK(const moveit::core::RobotModelConstPtr &robot_model,
-                         const std::string &group_name,
-                         const std::string &link_name,
-                         const geometry_msgs::Pose &pose,
-                         const std::string &frame_id,
-                         const std::map<std::string, double> &seed,
-                         std::map<std::string, double> &solution,
-                         bool check_self_collision,
-                         int max_attempt)
+bool pilz::generateJointTrajectory(pilz::KinematicsSession &kinematics,
+                                   const pilz::JointLimitsContainer& joint_limits,
+                                   const pilz::CartesianPath &path,
+                                   const KDL::VelocityProfile &velocity_profile,
+                                   const Eigen::VectorXd &initial_joint_position,
+                                   const double &sampling_time,
+                                   pilz::JointTrajectoryBuffer &joint_trajectory,
+                                   moveit_msgs::MoveItErrorCodes &error_code,
+                                   bool check_self_collision,
+                                   const pilz::GeneratorOptions &options,
+                                   const Eigen::VectorXd &goal_joint_position)
 {
-  Eigen::Affine3d pose_eigen;
-  tf::poseMsgToEigen(pose, pose_eigen);
-  return computePoseIK(robot_model,
-                       group_name,
-                       link_name,
-                       pose_eigen,
-                       frame_id,
-                       seed,
-                       solution,
-                       check_self_collision,
-                       max_attempt);
+  ROS_DEBUG("Generate joint trajectory from a Cartesian path and velocity profile.");
+
+  // evaluate the velocity profile, then all poses of the path in one call
+  std::vector<double> time_samples, path_parameters;
+  sampleVelocityProfile(velocity_profile, sampling_time, time_samples, path_parameters);
+  PoseVector pose_samples;
+  path.getPoses(path_parameters, pose_samples);
+
+  return generateJointTrajectoryFromPoses(kinematics, joint_limits, time_samples, path_parameters, pose_samples,
+                                          initial_joint_position, sampling_time, joint_trajectory, error_code,
+                                          check_self_collision, options, goal_joint_position);
 }
 
-bool pilz::computeLinkFK(const moveit::core::RobotModelConstPtr &robot_model,
-                         const std::string &link_name,
-                         const std::map<std::string, double> &joint_state,
-                         Eigen::Affine3d &pose)
+bool pilz::generateJointTrajectoryTimeScaled(pilz::KinematicsSession &kinematics,
+                                             const pilz::JointLimitsContainer& joint_limits,
+                                             const pilz::CartesianPath &path,
+                                             const pilz::VelocityProfileFactory &velocity_profile_factory,
+                                             const Eigen::VectorXd &initial_joint_position,
+                                             const double &sampling_time,
+                                             double min_time_scaling,
+                                             pilz::JointTrajectoryBuffer &joint_trajectory,
+                                             double &time_scaling,
+                                             moveit_msgs::MoveItErrorCodes &error_code,
+                                             bool check_self_collision,
+                                             const pilz::GeneratorOptions &options,
+                                             const Eigen::VectorXd &goal_joint_position)
 {
-  // create robot state
-  robot_state::RobotState rstate(robot_model);
-
-  // check the reference frame of the target pose
-  if(!rstate.knowsFrameTransform(link_name))
+  ROS_DEBUG("Generate joint trajectory from a Cartesian path with the fastest feasible velocity profile.");
+
+  const std::vector<std::string>& joint_names = kinematics.getJointNames();
+  const pilz::JointLimitsTable limits_table(joint_limits.getLimits(joint_names));
+  const Eigen::VectorXd max_joint_step = limits_table.max_velocity * sampling_time;
+
+  // solve the path geometry once at the samples of the unscaled profile
+  time_scaling = 1.0;
+  std::vector<double> time_samples, path_parameters;
+  sampleVelocityProfile(*velocity_profile_factory(time_scaling), sampling_time, time_samples, path_parameters);
+  PoseVector pose_samples;
+  path.getPoses(path_parameters, pose_samples);
+
+  std::vector<Eigen::VectorXd> solved_positions;
+  if(!solvePoseSamples(kinematics, pose_samples, path_parameters, initial_joint_position, max_joint_step, options,
+                       solved_positions, check_self_collision, goal_joint_position))
   {
-    ROS_ERROR_STREAM("The target link " << link_name << " is not known by robot.");
+    ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+    joint_trajectory.setJointNames(joint_names);
     return false;
   }
+  std::vector<Eigen::VectorXd> positions(solved_positions);
 
-  // set the joint positions
-  rstate.setVariablePositions(joint_state);
-
-  // update the frame
-  rstate.update();
-  pose = rstate.getFrameTransform(link_name);
-
-  return true;
+  return generateJointTrajectoryOnJointPath(kinematics, limits_table, path, velocity_profile_factory, path_parameters,
+                                            solved_positions, sampling_time, min_time_scaling, time_samples,
+                                            pose_samples, positions, joint_trajectory, time_scaling, error_code,
+                                            check_self_collision, options);
 }
 
-bool pilz::verifySampleJointLimits(const std::map<std::string, double> &position_last,
-                                   const std::map<std::string, double> &velocity_last,
-                                   const std::map<std::string, double> &position_current,
-                                   double duration_last,
-                                   double duration_current,
-                                   const pilz::JointLimitsContainer& joint_limits)
+bool pilz::generateJointTrajectoryTimeOptimal(pilz::KinematicsSession &kinematics,
+                                              const pilz::JointLimitsContainer& joint_limits,
+                                              const pilz::CartesianPath &path,
+                                              double max_path_velocity,
+                                              double max_path_acceleration,
+                                              double max_path_deceleration,
+                                              const Eigen::VectorXd &initial_joint_position,
+                                              const double &sampling_time,
+                                              double min_time_scaling,
+                                              pilz::JointTrajectoryBuffer &joint_trajectory,
+                                              double &time_scaling,
+                                              moveit_msgs::MoveItErrorCodes &error_code,
+                                              bool check_self_collision,
+                                              const pilz::GeneratorOptions &options,
+                                              const Eigen::VectorXd &goal_joint_position)
 {
-  const double EPSILON = 10e-6;
-  if(duration_current <= EPSILON)
+  ROS_DEBUG("Generate joint trajectory from a Cartesian path with the time optimal velocity profile.");
+
+  const std::size_t MIN_GRID_INTERVALS = 10;
+  const double EPSILON = 10e-9;
+
+  const std::vector<std::string>& joint_names = kinematics.getJointNames();
+  const pilz::JointLimitsTable limits_table(joint_limits.getLimits(joint_names));
+  const std::size_t joint_count = joint_names.size();
+
+  // uniform grid of the path length, avoid division by zero
+  const double path_length = std::max(path.getPathLength(), std::numeric_limits<double>::epsilon());
+  const std::size_t interval_count = std::max(MIN_GRID_INTERVALS, static_cast<std::size_t>(
+                                                std::ceil(path_length / options.time_optimal_grid_step)));
+  const double grid_step = path_length / interval_count;
+  std::vector<double> grid(interval_count + 1);
+  for(std::size_t i = 0; i <= interval_count; ++i)
   {
-    ROS_ERROR("Sample duration too small, cannot compute the velocity");
-    return false;
+    grid[i] = path_length * i / interval_count;
   }
 
-  double velocity_current, acceleration_current;
+  // solve the joint path on the grid, joint steps are bound like the ones of the path at full velocity
+  PoseVector grid_poses;
+  path.getPoses(grid, grid_poses);
+  std::vector<Eigen::VectorXd> grid_positions;
+  if(!pilz::computePoseSequenceIK(kinematics, grid_poses, initial_joint_position,
+                                  limits_table.max_velocity * grid_step / max_path_velocity, options, grid_positions,
+                                  check_self_collision, goal_joint_position))
+  {
+    ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+    joint_trajectory.setJointNames(joint_names);
+    return false;
+  }
 
-  for(auto pos : position_current)
+  // constraints of the path velocity and acceleration at the grid points from the derivatives of the joint path
+  std::vector<double> max_squared_velocity(grid.size(), max_path_velocity*max_path_velocity);
+  std::vector<pilz::VelocityProfile_TOPP::ConstraintMatrix> constraints(interval_count);
+  Eigen::VectorXd first_derivative, second_derivative;
+  for(std::size_t i = 0; i <= interval_count; ++i)
   {
-    velocity_current = (pos.second - position_last.at(pos.first))/duration_current;
+    const std::size_t center = std::min(std::max<std::size_t>(i, 1), interval_count - 1);
+    first_derivative = (grid_positions[std::min(i + 1, interval_count)] - grid_positions[i == 0 ? 0 : i - 1])
+        / (grid[std::min(i + 1, interval_count)] - grid[i == 0 ? 0 : i - 1]);
+    second_derivative = (grid_positions[center + 1] - 2*grid_positions[center] + grid_positions[center - 1])
+        / (grid_step*grid_step);
 
-    if(!joint_limits.verifyVelocityLimit(pos.first, velocity_current))
+    for(std::size_t j = 0; j < joint_count; ++j)
     {
-      ROS_ERROR_STREAM("Joint velocity limit of " << pos.first << " violated. Set the velocity scaling factor lower!"
-                       << " Actual joint velocity is " << velocity_current
-                       << ", while the limit is " << joint_limits.getLimit(pos.first).max_velocity
-                       << ". ");
-      return false;
+      if(std::fabs(first_derivative(j)) > EPSILON && std::isfinite(limits_table.max_velocity(j)))
+      {
+        max_squared_velocity[i] = std::min(max_squared_velocity[i],
+                                           std::pow(limits_table.max_velocity(j) / first_derivative(j), 2));
+      }
+    }
+    if(i == interval_count)
+    {
+      break;
     }
 
-    acceleration_current = (velocity_current - velocity_last.at(pos.first))/(duration_last + duration_current)*2;
-    // acceleration case
-    if(fabs(velocity_last.at(pos.first))<=fabs(velocity_current))
+    pilz::VelocityProfile_TOPP::ConstraintMatrix& rows = constraints[i];
+    rows.resize(2 + 2*joint_count, Eigen::NoChange);
+    rows.row(0) <<  1, 0, max_path_acceleration;
+    rows.row(1) << -1, 0, max_path_deceleration;
+    Eigen::Index row_count = 2;
+    for(std::size_t j = 0; j < joint_count; ++j)
     {
-      if(joint_limits.getLimit(pos.first).has_acceleration_limits &&
-         fabs(acceleration_current)>fabs(joint_limits.getLimit(pos.first).max_acceleration))
+      // the joint accelerates if the joint acceleration has the sign of the joint velocity
+      double max_positive = std::min(limits_table.max_acceleration(j), limits_table.max_deceleration(j));
+      double max_negative = max_positive;
+      if(first_derivative(j) > EPSILON)
       {
-        ROS_ERROR_STREAM("Joint acceleration limit of " << pos.first
-                         << " violated. Set the acceleration scaling factor lower!"
-                         << " Actual joint acceleration is " << acceleration_current
-                         << ", while the limit is " << joint_limits.getLimit(pos.first).max_acceleration
-                         << ". ");
-        return false;
+        max_positive = limits_table.max_acceleration(j);
+        max_negative = limits_table.max_deceleration(j);
       }
-    }
-    // deceleration case
-    else
-    {
-      if(joint_limits.getLimit(pos.first).has_deceleration_limits &&
-         fabs(acceleration_current)>fabs(joint_limits.getLimit(pos.first).max_deceleration))
+      else if(first_derivative(j) < -EPSILON)
       {
-        ROS_ERROR_STREAM("Joint deceleration limit of " << pos.first
-                         << " violated. Set the acceleration scaling factor lower!"
-                         << " Actual joint deceleration is " << acceleration_current
-                         << ", while the limit is " << joint_limits.getLimit(pos.first).max_deceleration
-                         << ". ");
-        return false;
+        max_positive = limits_table.max_deceleration(j);
+        max_negative = limits_table.max_acceleration(j);
+      }
+      if(std::isfinite(max_positive))
+      {
+        rows.row(row_count++) << first_derivative(j), second_derivative(j), max_positive;
+      }
+      if(std::isfinite(max_negative))
+      {
+        rows.row(row_count++) << -first_derivative(j), -second_derivative(j), max_negative;
       }
     }
+    rows.conservativeResize(row_count, Eigen::NoChange);
   }
 
-  return true;
+  pilz::VelocityProfile_TOPP time_optimal_profile;
+  if(!time_optimal_profile.SetProfileConstraints(grid, max_squared_velocity, constraints))
+  {
+    ROS_ERROR("Failed to compute a time optimal velocity profile which obeys the joint limits.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    joint_trajectory.setJointNames(joint_names);
+    return false;
+  }
+  ROS_DEBUG_STREAM("Time optimal duration of the path: " << time_optimal_profile.Duration() << "s");
+
+  // slower profiles are uniformly stretched in time
+  const pilz::VelocityProfileFactory velocity_profile_factory = [&](double factor)
+  {
+    std::unique_ptr<KDL::VelocityProfile> profile(time_optimal_profile.Clone());
+    profile->SetProfileDuration(0, path_length, time_optimal_profile.Duration() / factor);
+    return profile;
+  };
+
+  // sample the time optimal profile on the solved joint path, the grid only approximates the limits in between
+  time_scaling = 1.0;
+  std::vector<double> time_samples, path_parameters;
+  sampleVelocityProfile(time_optimal_profile, sampling_time, time_samples, path_parameters);
+  PoseVector pose_samples;
+  path.getPoses(path_parameters, pose_samples);
+  std::vector<Eigen::VectorXd> positions;
+  if(!interpolateJointPath(kinematics, grid, grid_positions, path_parameters, pose_samples,
+                           limits_table.max_velocity * sampling_time, options, positions, check_self_collision))
+  {
+    ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+    joint_trajectory.setJointNames(joint_names);
+    return false;
+  }
+
+  return generateJointTrajectoryOnJointPath(kinematics, limits_table, path, velocity_profile_factory, grid,
+                                            grid_positions, sampling_time, min_time_scaling, time_samples,
+                                            pose_samples, positions, joint_trajectory, time_scaling, error_code,
+                                            check_self_collision, options);
 }
 
-bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot_model,
-                                   const pilz::JointLimitsContainer& joint_limits,
-                                   const KDL::Trajectory &trajectory,
-                                   const std::string &group_name,
-                                   const std::string &link_name,
-                                   const std::map<std::string, double> &initial_joint_position,
-                                   const double &sampling_time,
-                                   trajectory_msgs::JointTrajectory &joint_trajectory,
-                                   moveit_msgs::MoveItErrorCodes &error_code,
-                                   bool check_self_collision)
+/**
+ * @brief interpolate the joint positions between knots by cubic Hermite splines of the path parameter
+ *
+ * The tangent at a knot is the difference quotient of its neighbors, at the first and the last knot the one of the
+ * adjacent interval. Two knots are interpolated linearly.
+ * @param knot_parameters: strictly increasing path parameters of the knots
+ * @param knot_positions: joint positions of the knots
+ * @param path_parameters: increasing path parameters of the interpolated positions
+ * @param positions: interpolated joint positions
+ */
+static void interpolateKnots(const std::vector<double> &knot_parameters,
+                             const std::vector<Eigen::VectorXd> &knot_positions,
+                             const std::vector<double> &path_parameters,
+                             std::vector<Eigen::VectorXd> &positions)
 {
-  ROS_DEBUG("Generate joint trajectory from a Cartesian trajectory.");
-
-  ros::Time generation_begin = ros::Time::now();
+  const std::size_t knot_count = knot_parameters.size();
+  std::vector<Eigen::VectorXd> tangents(knot_count);
+  for(std::size_t i = 0; i < knot_count; ++i)
+  {
+    const std::size_t previous = i == 0 ? 0 : i - 1;
+    const std::size_t next = std::min(i + 1, knot_count - 1);
+    tangents[i] = (knot_positions[next] - knot_positions[previous])
+        / (knot_parameters[next] - knot_parameters[previous]);
+  }
 
-  // generate the time samples
-  const double EPSILON = 10e-06; // avoid adding the last time sample twice
-  std::vector<double> time_samples;
-  for(double t_sample=0.0; t_sample < trajectory.Duration() - EPSILON; t_sample+=sampling_time)
+  positions.resize(path_parameters.size());
+  std::size_t i = 0;
+  for(std::size_t k = 0; k < path_parameters.size(); ++k)
   {
-    time_samples.push_back(t_sample);
+    // the knot interval [i, i+1] of the sample only moves forward
+    while(i + 2 < knot_count && path_parameters[k] > knot_parameters[i+1])
+    {
+      ++i;
+    }
+    const double h = knot_parameters[i+1] - knot_parameters[i];
+    const double t = std::min(1.0, std::max(0.0, (path_parameters[k] - knot_parameters[i]) / h));
+    const double t2 = t*t;
+    const double t3 = t2*t;
+    positions[k] = (2*t3 - 3*t2 + 1) * knot_positions[i] + (t3 - 2*t2 + t) * h * tangents[i]
+        + (-2*t3 + 3*t2) * knot_positions[i+1] + (t3 - t2) * h * tangents[i+1];
   }
-  time_samples.push_back(trajectory.Duration());
+}
 
-  // sample the trajectory and solve the inverse kinematics
-  Eigen::Affine3d pose_sample;
-  std::map<std::string, double> ik_solution_last, ik_solution, joint_velocity_last;
-  ik_solution_last = initial_joint_position;
-  for(const auto& item: ik_solution_last)
+bool pilz::generateJointTrajectoryApproximated(pilz::KinematicsSession &kinematics,
+                                               const pilz::JointLimitsContainer& joint_limits,
+                                               const pilz::CartesianPath &path,
+                                               const KDL::VelocityProfile &velocity_profile,
+                                               const Eigen::VectorXd &initial_joint_position,
+                                               const Eigen::VectorXd &goal_joint_position,
+                                               const double &sampling_time,
+                                               double position_tolerance,
+                                               double orientation_tolerance,
+                                               pilz::JointTrajectoryBuffer &joint_trajectory,
+                                               moveit_msgs::MoveItErrorCodes &error_code,
+                                               bool check_self_collision)
+{
+  ROS_DEBUG("Generate joint trajectory from a joint space approximation of a Cartesian path.");
+
+  const std::vector<std::string>& joint_names = kinematics.getJointNames();
+  const pilz::JointLimitsTable limits_table(joint_limits.getLimits(joint_names));
+
+  std::vector<double> time_samples, path_parameters;
+  sampleVelocityProfile(velocity_profile, sampling_time, time_samples, path_parameters);
+  PoseVector pose_samples;
+  path.getPoses(path_parameters, pose_samples);
+  const std::size_t sample_count = time_samples.size();
+
+  // start with the joint space interpolation from start to goal
+  std::vector<double> knot_parameters {path_parameters.front(), path_parameters.back()};
+  std::vector<Eigen::VectorXd> knot_positions {initial_joint_position, goal_joint_position};
+  if(knot_parameters.back() <= knot_parameters.front())
   {
-    joint_velocity_last[item.first] = 0.0;
+    // zero length path, avoid division by zero
+    knot_parameters.back() = knot_parameters.front() + 1.0;
   }
 
-  for(std::vector<double>::const_iterator time_iter=time_samples.begin();  time_iter!=time_samples.end(); ++time_iter )
+  std::vector<Eigen::VectorXd> positions;
+  PoseVector tip_poses(sample_count);
+  std::vector<std::size_t> worst_samples;
+  Eigen::VectorXd knot_position;
+  while(true)
   {
-    tf::transformKDLToEigen(trajectory.Pos(*time_iter), pose_sample);
+    interpolateKnots(knot_parameters, knot_positions, path_parameters, positions);
+
+    // the sample of each knot interval with the largest deviation relative to the tolerances, if exceeded
+    worst_samples.clear();
+    std::size_t interval = 0;
+    std::size_t worst_sample = sample_count;
+    double worst_deviation = 1.0;
+    for(std::size_t k = 0; k < sample_count; ++k)
+    {
+      while(interval + 2 < knot_parameters.size() && path_parameters[k] > knot_parameters[interval+1])
+      {
+        if(worst_sample < sample_count)
+        {
+          worst_samples.push_back(worst_sample);
+        }
+        ++interval;
+        worst_sample = sample_count;
+        worst_deviation = 1.0;
+      }
 
-    if(!computePoseIK(robot_model,
-                      group_name,
-                      link_name,
-                      pose_sample,
-                      robot_model->getModelFrame(),
-                      ik_solution_last,
-                      ik_solution,
-                      check_self_collision))
+      if(!kinematics.fk(positions[k], tip_poses[k]))
+      {
+        ROS_ERROR("Failed to compute the forward kinematics of the joint space approximation.");
+        error_code.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+        joint_trajectory.setJointNames(joint_names);
+        return false;
+      }
+      const double position_deviation = (tip_poses[k].translation() - pose_samples[k].translation()).norm();
+      const double orientation_deviation =
+          Eigen::AngleAxisd(pose_samples[k].linear().transpose() * tip_poses[k].linear()).angle();
+      const double deviation = std::max(position_deviation / position_tolerance,
+                                        orientation_deviation / orientation_tolerance);
+      if(deviation > worst_deviation)
+      {
+        worst_deviation = deviation;
+        worst_sample = k;
+      }
+    }
+    if(worst_sample < sample_count)
     {
-      ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
-      error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
-      joint_trajectory.points.clear();
-      return false;
+      worst_samples.push_back(worst_sample);
     }
-
-    //check the joint limits
-    double duration_current_sample = sampling_time;
-    // last interval can be shorter than the sampling time
-    if(time_iter==(time_samples.end()-1) && time_samples.size()>1)
+    if(worst_samples.empty())
     {
-      duration_current_sample = *time_iter - *(time_iter-1);
+      break;
     }
-    if(time_samples.size()==1)
+
+    // insert a knot at the worst sample of each interval, seeded by its interpolation
+    for(std::size_t k : worst_samples)
     {
-      duration_current_sample = *time_iter;
+      if(!kinematics.solveIK(pose_samples[k], positions[k], knot_position, check_self_collision))
+      {
+        ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
+        error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+        joint_trajectory.setJointNames(joint_names);
+        return false;
+      }
+      const std::size_t knot = std::upper_bound(knot_parameters.begin(), knot_parameters.end(), path_parameters[k])
+          - knot_parameters.begin();
+      knot_parameters.insert(knot_parameters.begin() + knot, path_parameters[k]);
+      knot_positions.insert(knot_positions.begin() + knot, knot_position);
     }
+  }
+  ROS_DEBUG_STREAM("Approximated " << sample_count << " samples by " << knot_parameters.size() << " knots.");
 
-    // skip the first sample with zero time from start for limits checking
-    if(time_iter!=time_samples.begin() && !verifySampleJointLimits(ik_solution_last,
-                                                                   joint_velocity_last,
-                                                                   ik_solution,
-                                                                   sampling_time,
-                                                                   duration_current_sample,
-                                                                   joint_limits))
+  // only the knots are IK solutions, the splines between them may leave the position limits or collide
+  std::vector<double> sample_position(joint_names.size());
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    Eigen::VectorXd::Map(sample_position.data(), sample_position.size()) = positions[k];
+    if(!joint_limits.verifyPositionLimits(joint_names, sample_position))
     {
-      ROS_ERROR_STREAM("Inverse kinematics solution at " << *time_iter
-                       << "s violates the joint velocity/acceleration/deceleration limits.");
+      ROS_ERROR_STREAM("Joint space approximation at " << time_samples[k] << "s violates the joint position limits.");
       error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
-      joint_trajectory.points.clear();
+      joint_trajectory.setJointNames(joint_names);
+      return false;
+    }
+    if(!kinematics.isSelfCollisionFree(positions[k]))
+    {
+      ROS_ERROR_STREAM("Joint space approximation at " << time_samples[k] << "s is in self collision.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+      joint_trajectory.setJointNames(joint_names);
       return false;
     }
+  }
+
+  Eigen::MatrixXd velocities, accelerations;
+  pilz::JointLimitViolation violation;
+  if(!verifySampleLimits(time_samples, positions, sampling_time, limits_table, joint_names,
+                         velocities, accelerations, violation))
+  {
+    ROS_ERROR_STREAM("Joint space approximation at " << time_samples[violation.sample + 1]
+                     << "s violates the joint velocity/acceleration/deceleration limits.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    joint_trajectory.setJointNames(joint_names);
+    return false;
+  }
 
-    // fill the point with joint values
-    trajectory_msgs::JointTrajectoryPoint point;
+  // the track holds the poses of the approximation, they deviate from the path within the tolerances
+  setJointTrajectorySamples(kinematics, time_samples, positions, velocities, accelerations, tip_poses,
+                            joint_trajectory);
+  error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+  return true;
+}
 
-    // set joint names
-    joint_trajectory.joint_names.clear();
-    for(const auto& start_joint : initial_joint_position)
+bool pilz::checkPathManipulability(pilz::KinematicsSession &kinematics,
+                                   const pilz::CartesianPath &path,
+                                   const Eigen::VectorXd &initial_joint_position,
+                                   const Eigen::VectorXd &goal_joint_position,
+                                   const pilz::GeneratorOptions &options,
+                                   double &min_manipulability,
+                                   double &min_path_parameter)
+{
+  const std::size_t interval_count = std::max(1u, options.singularity_prescan_intervals);
+  const bool goal_known = goal_joint_position.size() == initial_joint_position.size();
+
+  min_manipulability = std::numeric_limits<double>::infinity();
+  min_path_parameter = 0.0;
+  Eigen::VectorXd positions(initial_joint_position), guess;
+  double manipulability;
+  for(std::size_t i = 0; i <= interval_count; ++i)
+  {
+    const double s = path.getPathLength() * i / interval_count;
+    if(i == interval_count && goal_known)
     {
-      joint_trajectory.joint_names.push_back(start_joint.first);
+      positions = goal_joint_position;
     }
-
-    point.time_from_start =  ros::Duration(*time_iter);
-    for(const auto& joint_name : joint_trajectory.joint_names)
+    else if(i > 0)
     {
-      point.positions.push_back(ik_solution.at(joint_name));
-
-      if(time_iter!=time_samples.begin())
-      {
-        double joint_velocity = (ik_solution.at(joint_name) - ik_solution_last.at(joint_name))/duration_current_sample;
-        point.velocities.push_back(joint_velocity);
-        point.accelerations.push_back((joint_velocity - joint_velocity_last.at(joint_name))/(duration_current_sample
-                                                                                             +sampling_time)*2);
-        joint_velocity_last[joint_name] = joint_velocity;
-      }
-      else
+      guess = goal_known ? Eigen::VectorXd(initial_joint_position + (goal_joint_position - initial_joint_position)
+                                           * (static_cast<double>(i) / interval_count))
+                         : positions;
+      const Eigen::Affine3d pose = path.getPose(s);
+      if(!kinematics.solveIKDifferential(pose, guess, positions,
+                                         options.differential_ik_position_tolerance,
+                                         options.differential_ik_orientation_tolerance,
+                                         options.differential_ik_max_iterations) &&
+         !kinematics.solveIK(pose, guess, positions))
       {
-        point.velocities.push_back(0.);
-        point.accelerations.push_back(0.);
-        joint_velocity_last[joint_name] = 0.;
+        ROS_DEBUG_STREAM("Skip the point at path parameter " << s << " without IK solution in the pre-scan.");
+        positions = guess;
+        continue;
       }
     }
 
-    // update joint trajectory
-    joint_trajectory.points.push_back(point);
-    ik_solution_last = ik_solution;
+    if(kinematics.computeManipulability(positions, manipulability) && manipulability < min_manipulability)
+    {
+      min_manipulability = manipulability;
+      min_path_parameter = s;
+    }
   }
 
-  error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
-  double duration_ms = (ros::Time::now() - generation_begin).toSec() * 1000;
-  ROS_DEBUG_STREAM("Generate trajectory (N-Points: " << joint_trajectory.points.size()
-                  << ") took " << duration_ms << " ms | "
-                  << duration_ms / joint_trajectory.points.size() << " ms per Point");
-
-  return true;
+  ROS_DEBUG_STREAM("Smallest manipulability " << min_manipulability << " of the path at path parameter "
+                   << min_path_parameter << ".");
+  return min_manipulability >= options.singularity_prescan_min_manipulability;
 }
 
 bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot_model,
@@ -341,86 +1517,112 @@ bool pilz::generateJointTrajectory(const moveit::core::RobotModelConstPtr &robot
                                    trajectory_msgs::JointTrajectory &joint_trajectory,
                                    moveit_msgs::MoveItErrorCodes &error_code,
                                    bool check_self_collision)
+{
+  KinematicsSession kinematics(robot_model, group_name, link_name);
+  Eigen::VectorXd initial_joint_position_vector, initial_joint_velocity_vector;
+  if(!kinematics.toJointVector(initial_joint_position, initial_joint_position_vector) ||
+     !kinematics.toJointVector(initial_joint_velocity, initial_joint_velocity_vector))
+  {
+    error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
+    return false;
+  }
+  return generateJointTrajectory(kinematics,
+                                 joint_limits,
+                                 trajectory,
+                                 initial_joint_position_vector,
+                                 initial_joint_velocity_vector,
+                                 joint_trajectory,
+                                 error_code,
+                                 check_self_collision);
+}
+
+bool pilz::generateJointTrajectory(pilz::KinematicsSession &kinematics,
+                                   const pilz::JointLimitsContainer &joint_limits,
+                                   const pilz::CartesianTrajectory &trajectory,
+                                   const Eigen::VectorXd &initial_joint_position,
+                                   const Eigen::VectorXd &initial_joint_velocity,
+                                   trajectory_msgs::JointTrajectory &joint_trajectory,
+                                   moveit_msgs::MoveItErrorCodes &error_code,
+                                   bool check_self_collision)
 {
   ROS_DEBUG("Generate joint trajectory from a Cartesian trajectory.");
 
   ros::Time generation_begin = ros::Time::now();
 
-  std::map<std::string, double> ik_solution_last = initial_joint_position;
-  std::map<std::string, double> joint_velocity_last = initial_joint_velocity;
-  double duration_last = 0;
-  double duration_current = 0;
-  joint_trajectory.joint_names.clear();
-  for(const auto& joint_position:ik_solution_last)
-  {
-    joint_trajectory.joint_names.push_back(joint_position.first);
-  }
-  std::map<std::string, double> ik_solution;
-  for(size_t i=0; i<trajectory.points.size(); ++i)
+  // resolve joint names and limits once, all joint vectors are ordered like the active joints of the group
+  const std::vector<std::string>& joint_names = kinematics.getJointNames();
+  const std::size_t joint_count = joint_names.size();
+  const std::size_t sample_count = trajectory.points.size();
+
+  joint_trajectory.joint_names = joint_names;
+
+  // compute the inverse kinematics of all samples, each seeded by its predecessor
+  Eigen::MatrixXd positions(sample_count, joint_count);
+  Eigen::VectorXd ik_solution_last = initial_joint_position;
+  Eigen::VectorXd ik_solution(joint_count);
+  Eigen::Affine3d pose_sample;
+  for(size_t i=0; i<sample_count; ++i)
   {
-    // compute inverse kinematics
-    if(!computePoseIK(robot_model,
-                      group_name,
-                      link_name,
-                      trajectory.points.at(i).pose,
-                      robot_model->getModelFrame(),
-                      ik_solution_last,
-                      ik_solution,
-                      check_self_collision))
+    tf::poseMsgToEigen(trajectory.points.at(i).pose, pose_sample);
+    if(!kinematics.solveIK(pose_sample, ik_solution_last, ik_solution, check_self_collision))
     {
       ROS_ERROR("Failed to compute inverse kinematics solution for sampled Cartesian pose.");
       error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
       joint_trajectory.points.clear();
       return false;
     }
+    positions.row(i) = ik_solution.transpose();
+    ik_solution_last.swap(ik_solution);
+  }
 
-    // verify the joint limits
-    if(i==0)
-    {
-      duration_current = trajectory.points.front().time_from_start.toSec();
-      duration_last = duration_current;
-    }
-    else
-    {
-      duration_current = trajectory.points.at(i).time_from_start.toSec()
-          - trajectory.points.at(i-1).time_from_start.toSec();
-    }
+  // verify the joint limits of all samples in one pass, the first sample uses its own duration twice
+  Eigen::VectorXd durations(sample_count);
+  Eigen::VectorXd durations_last(sample_count);
+  for(size_t i=0; i<sample_count; ++i)
+  {
+    durations(i) = trajectory.points.at(i).time_from_start.toSec()
+        - (i == 0 ? 0. : trajectory.points.at(i-1).time_from_start.toSec());
+    durations_last(i) = i == 0 ? durations(i) : durations(i-1);
+  }
 
-    if(!verifySampleJointLimits(ik_solution_last,
-                                joint_velocity_last,
-                                ik_solution,
-                                duration_last,
-                                duration_current,
-                                joint_limits))
-    {
-      // LCOV_EXCL_START since the same code was captured in a test in the other overload generateJointTrajectory(..., KDL::Trajectory, ...)
-      // TODO: refactor to avoid code duplication.
-      ROS_ERROR_STREAM("Inverse kinematics solution of the " << i
-                       << "th sample violates the joint velocity/acceleration/deceleration limits.");
-      error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
-      joint_trajectory.points.clear();
-      return false;
-      // LCOV_EXCL_STOP
-    }
+  Eigen::MatrixXd velocities, accelerations;
+  JointLimitViolation violation;
+  if(!verifyJointTrajectoryLimits(positions,
+                                  initial_joint_position,
+                                  initial_joint_velocity,
+                                  durations,
+                                  durations_last,
+                                  JointLimitsTable(joint_limits.getLimits(joint_names)),
+                                  joint_names,
+                                  velocities,
+                                  accelerations,
+                                  violation))
+  {
+    // LCOV_EXCL_START since the same code was captured in a test in the other overload generateJointTrajectory(..., KDL::Trajectory, ...)
+    ROS_ERROR_STREAM("Inverse kinematics solution of the " << violation.sample
+                     << "th sample violates the joint velocity/acceleration/deceleration limits.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    joint_trajectory.points.clear();
+    return false;
+    // LCOV_EXCL_STOP
+  }
 
-    // compute the waypoint
-    trajectory_msgs::JointTrajectoryPoint waypoint_joint;
+  // compute the waypoints
+  joint_trajectory.points.reserve(joint_trajectory.points.size() + sample_count);
+  for(size_t i=0; i<sample_count; ++i)
+  {
+    joint_trajectory.points.emplace_back();
+    trajectory_msgs::JointTrajectoryPoint& waypoint_joint = joint_trajectory.points.back();
     waypoint_joint.time_from_start =  ros::Duration(trajectory.points.at(i).time_from_start);
-    for(const auto& joint_name : joint_trajectory.joint_names)
+    waypoint_joint.positions.resize(joint_count);
+    waypoint_joint.velocities.resize(joint_count);
+    waypoint_joint.accelerations.resize(joint_count);
+    for(std::size_t j = 0; j < joint_count; ++j)
     {
-      waypoint_joint.positions.push_back(ik_solution.at(joint_name));
-      double joint_velocity = (ik_solution.at(joint_name) - ik_solution_last.at(joint_name))/duration_current;
-      waypoint_joint.velocities.push_back(joint_velocity);
-      waypoint_joint.accelerations.push_back((joint_velocity - joint_velocity_last.at(joint_name))/(duration_current
-                                                                                                    +duration_last)*2);
-      //update the joint velocity
-      joint_velocity_last[joint_name] = joint_velocity;
+      waypoint_joint.positions[j] = positions(i, j);
+      waypoint_joint.velocities[j] = velocities(i, j);
+      waypoint_joint.accelerations[j] = accelerations(i, j);
     }
-
-    // update joint trajectory
-    joint_trajectory.points.push_back(waypoint_joint);
-    ik_solution_last = ik_solution;
-    duration_last = duration_current;
   }
 
   error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
@@ -553,19 +1755,21 @@ bool pilz::linearSearchIntersectionPoint(const std::string &link_name,
                                          const double &r,
                                          const robot_trajectory::RobotTrajectoryPtr &traj,
                                          bool inverseOrder,
-                                         std::size_t &index)
+                                         std::size_t &index,
+                                         const TipPoseTrackConstPtr &tip_pose_track)
 {
   ROS_DEBUG("Start linear search for intersection point.");
 
   const size_t waypoint_num = traj->getWayPointCount();
+  const TipPoseLookup tip_poses(traj, link_name, tip_pose_track);
 
   if(inverseOrder)
   {
     for(size_t i = waypoint_num-1; i>0; --i)
     {
       if(intersectionFound(center_position,
-                           traj->getWayPointPtr(i)->getFrameTransform(link_name).translation(),
-                           traj->getWayPointPtr(i-1)->getFrameTransform(link_name).translation(),
+                           tip_poses.getPose(i).translation(),
+                           tip_poses.getPose(i-1).translation(),
                            r))
       {
         index = i;
@@ -578,8 +1782,8 @@ bool pilz::linearSearchIntersectionPoint(const std::string &link_name,
     for(size_t i = 0; i < waypoint_num-1; ++i)
     {
       if(intersectionFound(center_position,
-                           traj->getWayPointPtr(i)->getFrameTransform(link_name).translation(),
-                           traj->getWayPointPtr(i+1)->getFrameTransform(link_name).translation(),
+                           tip_poses.getPose(i).translation(),
+                           tip_poses.getPose(i+1).translation(),
                            r))
       {
         index = i;
@@ -591,10 +1795,150 @@ bool pilz::linearSearchIntersectionPoint(const std::string &link_name,
   return false;
 }
 
+/**
+ * @brief true if a way point with the given distance to the center counts as inside of the sphere, the searches for
+ * intersection points share this comparison
+ */
+static bool isInsideSphere(double distance, double r)
+{
+  return distance <= r;
+}
+
+/**
+ * @brief true if a way point with the given distance to the center counts as outside of the sphere
+ */
+static bool isOutsideSphere(double distance, double r)
+{
+  return distance >= r;
+}
+
+/**
+ * @brief interpolate the time at which the link crosses the sphere between a way point inside and its neighbour
+ * outside of the sphere, the link is assumed to move on a straight line between them
+ */
+static double interpolateCrossingTime(const Eigen::Vector3d &center_position,
+                                      double r,
+                                      const robot_trajectory::RobotTrajectoryPtr &traj,
+                                      const pilz::TipPoseLookup &tip_poses,
+                                      std::size_t index_inside,
+                                      std::size_t index_outside)
+{
+  const Eigen::Vector3d p_inside = tip_poses.getPose(index_inside).translation() - center_position;
+  const Eigen::Vector3d step = tip_poses.getPose(index_outside).translation()
+      - tip_poses.getPose(index_inside).translation();
+
+  // positive root of |p_inside + lambda*step| = r
+  double lambda = 0.;
+  const double a = step.squaredNorm();
+  if(a > std::numeric_limits<double>::epsilon())
+  {
+    const double b = p_inside.dot(step);
+    const double c = p_inside.squaredNorm() - r*r;
+    lambda = (-b + std::sqrt(std::max(0., b*b - a*c))) / a;
+    lambda = std::min(1., std::max(0., lambda));
+  }
+
+  const double time_inside = traj->getWayPointDurationFromStart(index_inside);
+  return time_inside + lambda*(traj->getWayPointDurationFromStart(index_outside) - time_inside);
+}
+
+bool pilz::searchIntersectionPoint(const std::string &link_name,
+                                   const Eigen::Vector3d &center_position,
+                                   const double &r,
+                                   const robot_trajectory::RobotTrajectoryPtr &traj,
+                                   bool inverseOrder,
+                                   std::size_t &index,
+                                   double &crossing_time,
+                                   const TipPoseTrackConstPtr &tip_pose_track)
+{
+  const std::size_t waypoint_num = traj->getWayPointCount();
+  const TipPoseLookup tip_poses(traj, link_name, tip_pose_track);
+
+  // step s of the search visits the way point sample(s), the distance to the center is expected to grow with s
+  auto sample = [&](std::size_t s) {return inverseOrder ? waypoint_num - 1 - s : s;};
+  auto distance = [&](std::size_t s) {return (tip_poses.getPose(sample(s)).translation() - center_position).norm();};
+
+  bool monotonic = tip_poses.hasTrack() && waypoint_num > 1;
+  std::size_t lo = 0;
+  std::size_t hi = 0;
+  if(monotonic)
+  {
+    double distance_lo = distance(lo);
+    monotonic = isInsideSphere(distance_lo, r);
+
+    // gallop until a way point outside of the sphere is found
+    double distance_hi = distance_lo;
+    std::size_t step = 1;
+    while(monotonic)
+    {
+      hi = std::min(lo + step, waypoint_num - 1);
+      distance_hi = distance(hi);
+      if(distance_hi < distance_lo)
+      {
+        monotonic = false;
+      }
+      else if(!isOutsideSphere(distance_hi, r))
+      {
+        // the sphere might be left between the probes, only the linear search can tell
+        if(hi == waypoint_num - 1)
+        {
+          monotonic = false;
+          break;
+        }
+        lo = hi;
+        distance_lo = distance_hi;
+        step *= 2;
+      }
+      else
+      {
+        break;
+      }
+    }
+
+    // bisection between the last way point inside and the first one outside of the sphere
+    while(monotonic && hi - lo > 1)
+    {
+      const std::size_t mid = lo + (hi - lo) / 2;
+      const double distance_mid = distance(mid);
+      if(distance_mid < distance_lo || distance_mid > distance_hi)
+      {
+        monotonic = false;
+      }
+      else if(isOutsideSphere(distance_mid, r))
+      {
+        hi = mid;
+        distance_hi = distance_mid;
+      }
+      else
+      {
+        lo = mid;
+        distance_lo = distance_mid;
+      }
+    }
+  }
+
+  if(monotonic)
+  {
+    index = sample(lo);
+  }
+  else
+  {
+    ROS_DEBUG("Distance to the blending sphere center is not monotonic, search linearly.");
+    if(!linearSearchIntersectionPoint(link_name, center_position, r, traj, inverseOrder, index, tip_pose_track))
+    {
+      return false;
+    }
+    lo = inverseOrder ? waypoint_num - 1 - index : index;
+  }
+
+  crossing_time = interpolateCrossingTime(center_position, r, traj, tip_poses, index, sample(lo + 1));
+  return true;
+}
+
 bool pilz::intersectionFound(const Eigen::Vector3d &p_center,
                              const Eigen::Vector3d &p_current,
                              const Eigen::Vector3d &p_next,
                              const double &r)
 {
-  return ((p_current - p_center).norm() <= r) && ((p_next - p_center).norm() >= r);
+  return isInsideSphere((p_current - p_center).norm(), r) && isOutsideSphere((p_next - p_center).norm(), r);
 }
@@ -19,9 +19,11 @@
 #include <moveit/robot_state/conversions.h>
 #include <eigen_conversions/eigen_msg.h>
 #include <eigen_conversions/eigen_kdl.h>
-#include <kdl/velocityprofile_trap.hpp>
+#include <cmath>
 
 #include "pilz_trajectory_generation/limits_container.h"
+#include "pilz_trajectory_generation/velocity_profile_atrap.h"
+#include "pilz_trajectory_generation/velocity_profile_scurve.h"
 
 namespace pilz{
 
@@ -72,12 +74,8 @@ bool TrajectoryGenerator::validateRequest(const planning_interface::MotionPlanRe
     error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
     return false;
   }
-  // does not allow start velocity
-  if(!std::all_of(req.start_state.joint_state.velocity.begin(), req.start_state.joint_state.velocity.end(),
-                  [](double v) { return v==0; }))
+  if(!validateStartVelocity(req, error_code))
   {
-    ROS_ERROR("Trajectory Generator does not allow non-zero start velocity.");
-    error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
     return false;
   }
 
@@ -207,7 +205,7 @@ bool TrajectoryGenerator::validateRequest(const planning_interface::MotionPlanRe
 
 bool TrajectoryGenerator::setResponse(const planning_interface::MotionPlanRequest &req,
                                       planning_interface::MotionPlanResponse &res,
-                                      const trajectory_msgs::JointTrajectory &joint_trajectory,
+                                      const JointTrajectoryBuffer &joint_trajectory,
                                       const moveit_msgs::MoveItErrorCodes &err_code,
                                       const ros::Time& planning_start) const
 {
@@ -224,12 +222,22 @@ bool TrajectoryGenerator::setResponse(const planning_interface::MotionPlanReques
   }
   else
   {
-    // convert trajectory_msgs::JointTrajectory to robot_trajectory::RobotTrajectory
+    // fill the robot trajectory directly, the message representation is not needed
     robot_trajectory::RobotTrajectoryPtr rt(new robot_trajectory::RobotTrajectory(robot_model_, req.group_name));
     moveit::core::RobotState start_rs(robot_model_);
     start_rs.setToDefaultValues();
     moveit::core::robotStateMsgToRobotState(req.start_state, start_rs, false);
-    rt->setRobotTrajectoryMsg(start_rs,joint_trajectory);
+    if(!joint_trajectory.toRobotTrajectory(start_rs, *rt))
+    {
+      ROS_ERROR("Failed to convert the joint trajectory into a robot trajectory.");
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+      if(res.trajectory_)
+      {
+        res.trajectory_->clear();
+      }
+      res.planning_time_ = (ros::Time::now() - planning_start).toSec();
+      return false;
+    }
     res.trajectory_ = rt;
     res.error_code_.val = err_code.val;
     res.planning_time_ = (ros::Time::now() - planning_start).toSec();
@@ -237,19 +245,52 @@ bool TrajectoryGenerator::setResponse(const planning_interface::MotionPlanReques
   }
 }
 
-std::unique_ptr<KDL::VelocityProfile> TrajectoryGenerator::cartesianTrapVelocityProfile(
+bool TrajectoryGenerator::validateStartVelocity(const planning_interface::MotionPlanRequest &req,
+                                                moveit_msgs::MoveItErrorCodes &error_code) const
+{
+  // does not allow start velocity
+  if(!std::all_of(req.start_state.joint_state.velocity.begin(), req.start_state.joint_state.velocity.end(),
+                  [](double v) { return v==0; }))
+  {
+    ROS_ERROR("Trajectory Generator does not allow non-zero start velocity.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<KDL::VelocityProfile> TrajectoryGenerator::cartesianVelocityProfile(
     const planning_interface::MotionPlanRequest &req,
     const MotionPlanInfo& plan_info,
-    const std::unique_ptr<KDL::Path> &path) const
+    const CartesianPath &path,
+    double time_scaling) const
 {
-  std::unique_ptr<KDL::VelocityProfile> vp_trans(
-        new KDL::VelocityProfile_Trap(
-          req.max_velocity_scaling_factor*planner_limits_.getCartesianLimits().getMaxTranslationalVelocity(),
-          req.max_acceleration_scaling_factor*planner_limits_.getCartesianLimits().getMaxTranslationalAcceleration()));
+  std::unique_ptr<KDL::VelocityProfile> vp_trans;
+  const CartesianLimit& cartesian_limits = planner_limits_.getCartesianLimits();
+  const double velocity_scaling = time_scaling*req.max_velocity_scaling_factor;
+  const double acceleration_scaling = time_scaling*time_scaling*req.max_acceleration_scaling_factor;
+  // the deceleration limit is given as negative value
+  double max_trans_dec = fabs(cartesian_limits.getMaxTranslationalDeceleration());
+  if(options_.jerk_limited_profile && cartesian_limits.hasMaxTranslationalJerk())
+  {
+    // the jerk is scaled with the acceleration
+    vp_trans.reset(new VelocityProfile_SCurve(
+                     velocity_scaling*cartesian_limits.getMaxTranslationalVelocity(),
+                     acceleration_scaling*cartesian_limits.getMaxTranslationalAcceleration(),
+                     acceleration_scaling*max_trans_dec,
+                     time_scaling*acceleration_scaling*cartesian_limits.getMaxTranslationalJerk()));
+  }
+  else
+  {
+    vp_trans.reset(new VelocityProfile_ATrap(
+                     velocity_scaling*cartesian_limits.getMaxTranslationalVelocity(),
+                     acceleration_scaling*cartesian_limits.getMaxTranslationalAcceleration(),
+                     acceleration_scaling*max_trans_dec));
+  }
 
-  if(path->PathLength() > std::numeric_limits<double>::epsilon()) // avoid division by zero
+  if(path.getPathLength() > std::numeric_limits<double>::epsilon()) // avoid division by zero
   {
-    vp_trans->SetProfile(0, path->PathLength());
+    vp_trans->SetProfile(0, path.getPathLength());
   }
   else
   {
@@ -258,4 +299,114 @@ std::unique_ptr<KDL::VelocityProfile> TrajectoryGenerator::cartesianTrapVelocity
   return std::move(vp_trans);
 }
 
+bool TrajectoryGenerator::generateCartesianJointTrajectory(const planning_interface::MotionPlanRequest &req,
+                                                           const MotionPlanInfo &plan_info,
+                                                           KinematicsSession &kinematics,
+                                                           const CartesianPath &path,
+                                                           double sampling_time,
+                                                           JointTrajectoryBuffer &joint_trajectory,
+                                                           TrajectoryScaling &scaling,
+                                                           moveit_msgs::MoveItErrorCodes &error_code) const
+{
+  scaling.velocity_scaling_factor = req.max_velocity_scaling_factor;
+  scaling.acceleration_scaling_factor = req.max_acceleration_scaling_factor;
+
+  // fail fast on a path close to a singularity, unless the trajectory may be slowed down to the joint limits
+  double min_manipulability, min_path_parameter;
+  if(options_.singularity_prescan &&
+     !checkPathManipulability(kinematics, path, plan_info.start_joint_position, plan_info.goal_joint_position,
+                              options_, min_manipulability, min_path_parameter))
+  {
+    if(!options_.velocity_scaling_search && !options_.time_optimal_parameterization)
+    {
+      ROS_ERROR_STREAM("The path passes close to a singularity (manipulability " << min_manipulability
+                       << " at path parameter " << min_path_parameter << ").");
+      error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+      joint_trajectory.setJointNames(kinematics.getJointNames());
+      return false;
+    }
+    ROS_WARN_STREAM("The path passes close to a singularity (manipulability " << min_manipulability
+                    << " at path parameter " << min_path_parameter << "), the trajectory is slowed down.");
+  }
+
+  if(!options_.velocity_scaling_search && !options_.time_optimal_parameterization)
+  {
+    std::unique_ptr<KDL::VelocityProfile> vp(cartesianVelocityProfile(req, plan_info, path));
+    return generateJointTrajectory(kinematics,
+                                   planner_limits_.getJointLimitContainer(),
+                                   path,
+                                   *vp,
+                                   plan_info.start_joint_position,
+                                   sampling_time,
+                                   joint_trajectory,
+                                   error_code,
+                                   false,
+                                   options_,
+                                   plan_info.goal_joint_position);
+  }
+
+  // both reduced factors must stay within the valid range of the request
+  const double min_time_scaling = std::max(MIN_SCALING_FACTOR/req.max_velocity_scaling_factor,
+                                           std::sqrt(MIN_SCALING_FACTOR/req.max_acceleration_scaling_factor));
+  double time_scaling;
+  if(options_.time_optimal_parameterization)
+  {
+    // the scaled Cartesian limits bound the path velocity and acceleration like the trapezoid profile, the path
+    // parameter combines translation and rotation by the equivalent radius max_trans_vel/max_rot_vel, so the
+    // rotational velocity stays below max_rot_vel without a separate bound
+    const CartesianLimit& cartesian_limits = planner_limits_.getCartesianLimits();
+    if(!generateJointTrajectoryTimeOptimal(kinematics,
+                                           planner_limits_.getJointLimitContainer(),
+                                           path,
+                                           req.max_velocity_scaling_factor
+                                           *cartesian_limits.getMaxTranslationalVelocity(),
+                                           req.max_acceleration_scaling_factor
+                                           *cartesian_limits.getMaxTranslationalAcceleration(),
+                                           req.max_acceleration_scaling_factor
+                                           *fabs(cartesian_limits.getMaxTranslationalDeceleration()),
+                                           plan_info.start_joint_position,
+                                           sampling_time,
+                                           min_time_scaling,
+                                           joint_trajectory,
+                                           time_scaling,
+                                           error_code,
+                                           false,
+                                           options_,
+                                           plan_info.goal_joint_position))
+    {
+      return false;
+    }
+  }
+  else if(!generateJointTrajectoryTimeScaled(kinematics,
+                                             planner_limits_.getJointLimitContainer(),
+                                             path,
+                                             [&](double factor)
+                                             {
+                                               return cartesianVelocityProfile(req, plan_info, path, factor);
+                                             },
+                                             plan_info.start_joint_position,
+                                             sampling_time,
+                                             min_time_scaling,
+                                             joint_trajectory,
+                                             time_scaling,
+                                             error_code,
+                                             false,
+                                             options_,
+                                             plan_info.goal_joint_position))
+  {
+    return false;
+  }
+
+  // a uniform slow down of the profile by time_scaling prolongs the duration by 1/time_scaling
+  if(time_scaling < 1.0)
+  {
+    scaling.velocity_scaling_factor *= time_scaling;
+    scaling.acceleration_scaling_factor *= time_scaling*time_scaling;
+    ROS_INFO_STREAM("Reduced the velocity scaling factor to " << scaling.velocity_scaling_factor
+                    << " and the acceleration scaling factor to " << scaling.acceleration_scaling_factor
+                    << " to obey the joint limits.");
+  }
+  return true;
+}
+
 }
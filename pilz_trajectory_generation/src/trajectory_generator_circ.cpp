@@ -21,18 +21,14 @@
 #include <ros/ros.h>
 #include <eigen_conversions/eigen_msg.h>
 #include <moveit/robot_state/conversions.h>
-#include <eigen_conversions/eigen_kdl.h>
-#include <kdl_conversions/kdl_msg.h>
 #include <kdl/utilities/error.h>
-#include <kdl/utilities/utility.h>
-#include <kdl/trajectory_segment.hpp>
-#include <kdl/rotational_interpolation_sa.hpp>
 
 namespace pilz {
 
 TrajectoryGeneratorCIRC::TrajectoryGeneratorCIRC(const moveit::core::RobotModelConstPtr &robot_model,
-                                               const LimitsContainer &planner_limits)
-:TrajectoryGenerator::TrajectoryGenerator(robot_model, planner_limits)
+                                               const LimitsContainer &planner_limits,
+                                               const GeneratorOptions &options)
+:TrajectoryGenerator::TrajectoryGenerator(robot_model, planner_limits, options)
 {
   if(!planner_limits_.hasFullCartesianLimits())
   {
@@ -48,13 +44,22 @@ TrajectoryGeneratorCIRC::~TrajectoryGeneratorCIRC()
 bool TrajectoryGeneratorCIRC::generate(const planning_interface::MotionPlanRequest &req,
                                        planning_interface::MotionPlanResponse &res,
                                        double sampling_time)
+{
+  GeneratedTrajectoryInfo info;
+  return generate(req, res, info, sampling_time);
+}
+
+bool TrajectoryGeneratorCIRC::generate(const planning_interface::MotionPlanRequest &req,
+                                       planning_interface::MotionPlanResponse &res,
+                                       GeneratedTrajectoryInfo &info,
+                                       double sampling_time)
 {
   ROS_INFO("Start generation of CIRC trajectory!");
 
   ros::Time planning_begin = ros::Time::now();
   moveit_msgs::MoveItErrorCodes error_code;
   MotionPlanInfo plan_info;
-  trajectory_msgs::JointTrajectory joint_trajectory;
+  JointTrajectoryBuffer joint_trajectory;
 
   // validate the common requirements of motion plan request
   if(!validateRequest(req, error_code))
@@ -62,50 +67,44 @@ bool TrajectoryGeneratorCIRC::generate(const planning_interface::MotionPlanReque
     ROS_ERROR("Failed to validate the planning request of a CIRC command.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
+  // kinematics of the planning group, used for request extraction and trajectory sampling
+  KinematicsSession kinematics(robot_model_, req.group_name);
+  kinematics.setSelectNearestSolution(options_.ik_nearest_solution);
+
   // extract planning information from the motion plan request
-  if(!extractMotionPlanInfo(req, plan_info, error_code))
+  if(!extractMotionPlanInfo(req, kinematics, plan_info, error_code))
   {
     ROS_ERROR("Cannot extract needed information from motion plan request.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
 
   // create Cartesian path for circle
-  std::unique_ptr<KDL::Path> path(setPathCIRC(plan_info, error_code));
+  std::unique_ptr<CartesianPath> path(setPathCIRC(plan_info, error_code));
   if(!path)
   {
     ROS_ERROR("Failed to set Cartesian path of the circle.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
 
-  // create velocity profile
-  std::unique_ptr<KDL::VelocityProfile> vp(cartesianTrapVelocityProfile(req, plan_info, path));
-
-  // combine path and velocity profile into Cartesian trajectory
-  // with the third parameter set to false, KDL::Trajectory_Segment does not take
-  // the ownship of Path and Velocity Profile
-  KDL::Trajectory_Segment cart_trajectory(path.get(), vp.get(), false);
-
   // sample the Cartesian trajectory and compute joint trajectory using inverse kinematics
-  if(!generateJointTrajectory(robot_model_,
-                              planner_limits_.getJointLimitContainer(),
-                              cart_trajectory,
-                              plan_info.group_name,
-                              plan_info.link_name,
-                              plan_info.start_joint_position,
-                              sampling_time,
-                              joint_trajectory,
-                              error_code))
+  TrajectoryScaling scaling;
+  if(!generateCartesianJointTrajectory(req, plan_info, kinematics, *path, sampling_time, joint_trajectory, scaling,
+                                       error_code))
   {
     ROS_ERROR("Failed to generate valid joint trajectory from the Cartesian path.");
-  }
-  else
-  {
-    ROS_INFO_STREAM("CIRC Trajectory with " << joint_trajectory.points.size() << " Points generated. Took "
-                    << (ros::Time::now() - planning_begin).toSec() * 1000 << " ms.");
+    return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
 
+  ROS_INFO_STREAM("CIRC Trajectory with " << joint_trajectory.size() << " Points generated. Took "
+                  << (ros::Time::now() - planning_begin).toSec() * 1000 << " ms.");
 
-  return setResponse(req, res, joint_trajectory, error_code, planning_begin);
+  if(!setResponse(req, res, joint_trajectory, error_code, planning_begin))
+  {
+    return false;
+  }
+  info.tip_pose_track = joint_trajectory.getTipPoseTrack();
+  info.scaling = scaling;
+  return true;
 }
 
 bool TrajectoryGeneratorCIRC::validateRequest(const planning_interface::MotionPlanRequest &req,
@@ -143,6 +142,7 @@ bool TrajectoryGeneratorCIRC::validateRequest(const planning_interface::MotionPl
 }
 
 bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req,
+                                                    KinematicsSession& kinematics,
                                                     TrajectoryGenerator::MotionPlanInfo &info,
                                                     moveit_msgs::MoveItErrorCodes &error_code) const
 {
@@ -172,16 +172,20 @@ bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
       return false;
     }
 
+    std::map<std::string, double> goal_joint_position;
     for(const auto &joint_item : req.goal_constraints.front().joint_constraints)
     {
-      info.goal_joint_position[joint_item.joint_name] = joint_item.position;
+      goal_joint_position[joint_item.joint_name] = joint_item.position;
+    }
+    if(!kinematics.toJointVector(goal_joint_position, info.goal_joint_position))
+    {
+      error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS;
+      return false;
     }
 
 
-      computeLinkFK(robot_model_,
-                    info.link_name,
-                    info.goal_joint_position,
-                    info.goal_pose);
+      kinematics.setLinkName(info.link_name);
+      kinematics.fk(info.goal_joint_position, info.goal_pose);
 
   }
   // goal given in Cartesian space
@@ -203,6 +207,8 @@ bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
         .constraint_region.primitive_poses.front().position;
     goal_pose_msg.orientation = req.goal_constraints.front().orientation_constraints.front().orientation;
     tf::poseMsgToEigen(goal_pose_msg, info.goal_pose);
+
+    kinematics.setLinkName(info.link_name);
   }
 
   // copy start state only with the joint
@@ -210,25 +216,23 @@ bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
   start_state.setToDefaultValues();
   moveit::core::robotStateMsgToRobotState(req.start_state, start_state, false);
 
-  for(const auto& joint_name : robot_model_->getJointModelGroup(req.group_name)->getActiveJointModelNames())
-  {
-    info.start_joint_position[joint_name] = start_state.getVariablePosition(joint_name);
-  }
+  info.joint_names = kinematics.getJointNames();
+  kinematics.toJointVector(start_state, info.start_joint_position);
 
-    computeLinkFK(robot_model_,
-                  info.link_name,
-                  info.start_joint_position,
-                  info.start_pose);
-
-    //check goal pose ik before Cartesian motion plan starts
-    std::map<std::string, double> ik_solution;
-    if(!computePoseIK(robot_model_,
-                      info.group_name,
-                      info.link_name,
-                      info.goal_pose,
-                      frame_id,
-                      info.start_joint_position,
-                      ik_solution))
+    kinematics.fk(info.start_joint_position, info.start_pose);
+
+    //check goal pose ik before Cartesian motion plan starts, a joint goal is its own IK solution
+    bool goal_valid {false};
+    if(req.goal_constraints.front().joint_constraints.size() != 0)
+    {
+      goal_valid = kinematics.isSelfCollisionFree(info.goal_joint_position);
+    }
+    else
+    {
+      goal_valid = frame_id == robot_model_->getModelFrame() &&
+          kinematics.solveIK(info.goal_pose, info.start_joint_position, info.goal_joint_position, true);
+    }
+    if(!goal_valid)
     {
       // LCOV_EXCL_START
       ROS_ERROR_STREAM("Failed to compute inverse kinematics for link: " << info.link_name << " of goal pose.");
@@ -248,21 +252,18 @@ bool TrajectoryGeneratorCIRC::extractMotionPlanInfo(const planning_interface::Mo
   return true;
 }
 
-std::unique_ptr<KDL::Path> TrajectoryGeneratorCIRC::setPathCIRC(const MotionPlanInfo &info,
-                                                                 moveit_msgs::MoveItErrorCodes &error_code) const
+std::unique_ptr<CartesianPath> TrajectoryGeneratorCIRC::setPathCIRC(const MotionPlanInfo &info,
+                                                                     moveit_msgs::MoveItErrorCodes &error_code) const
 {
   ROS_DEBUG("Set Cartesian path for CIRC command.");
 
-  KDL::Frame start_pose, goal_pose;
-  tf::transformEigenToKDL(info.start_pose, start_pose);
-  tf::transformEigenToKDL(info.goal_pose, goal_pose);
-
-  KDL::Vector path_point;
-  tf::vectorEigenToKDL(info.circ_path_point.second, path_point);
+  const Eigen::Affine3d& start_pose = info.start_pose;
+  const Eigen::Affine3d& goal_pose = info.goal_pose;
+  const Eigen::Vector3d& path_point = info.circ_path_point.second;
 
   // pass the ratio of translational by rotational velocity as equivalent radius
   // to get a trajectory with rotational speed, if no (or very little) translational distance
-  // The KDL::Path implementation chooses the motion with the longer duration (translation vs. rotation)
+  // The CartesianPath implementation chooses the motion with the longer duration (translation vs. rotation)
   // and uses eqradius as scaling factor between the distances.
   double eqradius = planner_limits_.getCartesianLimits().getMaxTranslationalVelocity()/
       planner_limits_.getCartesianLimits().getMaxRotationalVelocity();
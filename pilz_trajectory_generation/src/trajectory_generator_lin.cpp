@@ -19,16 +19,13 @@
 #include "ros/ros.h"
 #include "eigen_conversions/eigen_msg.h"
 #include "moveit/robot_state/conversions.h"
-#include <eigen_conversions/eigen_kdl.h>
-#include <kdl/path_line.hpp>
-#include <kdl/utilities/error.h>
-#include <kdl/trajectory_segment.hpp>
 
 namespace pilz {
 
 TrajectoryGeneratorLIN::TrajectoryGeneratorLIN(const moveit::core::RobotModelConstPtr &robot_model,
-                                               const LimitsContainer &planner_limits)
-  :TrajectoryGenerator::TrajectoryGenerator(robot_model, planner_limits)
+                                               const LimitsContainer &planner_limits,
+                                               const GeneratorOptions &options)
+  :TrajectoryGenerator::TrajectoryGenerator(robot_model, planner_limits, options)
 {
   if(!planner_limits_.hasFullCartesianLimits())
   {
@@ -45,13 +42,22 @@ TrajectoryGeneratorLIN::~TrajectoryGeneratorLIN()
 bool TrajectoryGeneratorLIN::generate(const planning_interface::MotionPlanRequest &req,
                                       planning_interface::MotionPlanResponse &res,
                                       double sampling_time)
+{
+  GeneratedTrajectoryInfo info;
+  return generate(req, res, info, sampling_time);
+}
+
+bool TrajectoryGeneratorLIN::generate(const planning_interface::MotionPlanRequest &req,
+                                      planning_interface::MotionPlanResponse &res,
+                                      GeneratedTrajectoryInfo &info,
+                                      double sampling_time)
 {
   ROS_INFO("Starting generation of LIN Trajectory!");
 
   ros::Time planning_begin = ros::Time::now();
   moveit_msgs::MoveItErrorCodes error_code;
   MotionPlanInfo plan_info;
-  trajectory_msgs::JointTrajectory joint_trajectory;
+  JointTrajectoryBuffer joint_trajectory;
 
   // validate the common requirements of motion plan request
   if(!validateRequest(req, error_code))
@@ -59,54 +65,73 @@ bool TrajectoryGeneratorLIN::generate(const planning_interface::MotionPlanReques
     ROS_ERROR("Failed to validate the planning request of a LIN command.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
+  // kinematics of the planning group, used for request extraction and trajectory sampling
+  KinematicsSession kinematics(robot_model_, req.group_name);
+  kinematics.setSelectNearestSolution(options_.ik_nearest_solution);
+
   // extract planning information from the motion plan request
-  if(!extractMotionPlanInfo(req, plan_info, error_code))
+  if(!extractMotionPlanInfo(req, kinematics, plan_info, error_code))
   {
     ROS_ERROR("Failed to extract planning information of a LIN command.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
 
   // create Cartesian path for lin
-  std::unique_ptr<KDL::Path> path(setPathLIN(plan_info, error_code));
-
-  // create velocity profile
-  std::unique_ptr<KDL::VelocityProfile> vp(cartesianTrapVelocityProfile(req, plan_info, path));
-
-  // combine path and velocity profile into Cartesian trajectory
-  // with the third parameter set to false, KDL::Trajectory_Segment does not take
-  // the ownship of Path and Velocity Profile
-  KDL::Trajectory_Segment cart_trajectory(path.get(), vp.get(), false);
+  std::unique_ptr<CartesianPath> path(setPathLIN(plan_info, error_code));
 
+  TrajectoryScaling scaling;
+  if(options_.lin_approximation)
+  {
+    // time the joint space approximation of the line with the Cartesian velocity profile
+    scaling.velocity_scaling_factor = req.max_velocity_scaling_factor;
+    scaling.acceleration_scaling_factor = req.max_acceleration_scaling_factor;
+    std::unique_ptr<KDL::VelocityProfile> vp(cartesianVelocityProfile(req, plan_info, *path));
+    if(!generateJointTrajectoryApproximated(kinematics,
+                                            planner_limits_.getJointLimitContainer(),
+                                            *path,
+                                            *vp,
+                                            plan_info.start_joint_position,
+                                            plan_info.goal_joint_position,
+                                            sampling_time,
+                                            options_.lin_approximation_position_tolerance,
+                                            options_.lin_approximation_orientation_tolerance,
+                                            joint_trajectory,
+                                            error_code))
+    {
+      ROS_ERROR("Failed to generate valid joint trajectory from the joint space approximation of the line.");
+      return setResponse(req, res, joint_trajectory, error_code, planning_begin);
+    }
+  }
   // sample the Cartesian trajectory and compute joint trajectory using inverse kinematics
-  if(!generateJointTrajectory(robot_model_,
-                              planner_limits_.getJointLimitContainer(),
-                              cart_trajectory,
-                              plan_info.group_name,
-                              plan_info.link_name,
-                              plan_info.start_joint_position,
-                              sampling_time,
-                              joint_trajectory,
-                              error_code))
+  else if(!generateCartesianJointTrajectory(req, plan_info, kinematics, *path, sampling_time, joint_trajectory,
+                                            scaling, error_code))
   {
     ROS_ERROR("Failed to generate valid joint trajectory from the Cartesian path.");
     return setResponse(req, res, joint_trajectory, error_code, planning_begin);
   }
 
   // Last point should be hard velocity and acceleration zero
-  std::fill(joint_trajectory.points.back().velocities.begin(),
-            joint_trajectory.points.back().velocities.end(), 0.0);
-  std::fill(joint_trajectory.points.back().accelerations.begin(),
-            joint_trajectory.points.back().accelerations.end(), 0.0);
+  joint_trajectory.velocities(joint_trajectory.size() - 1).setZero();
+  joint_trajectory.accelerations(joint_trajectory.size() - 1).setZero();
 
-  ROS_INFO_STREAM("LIN Trajectory with " << joint_trajectory.points.size() << " Points generated. Took "
+  ROS_INFO_STREAM("LIN Trajectory with " << joint_trajectory.size() << " Points generated. Took "
                   << (ros::Time::now() - planning_begin).toSec() * 1000 << " ms.");
 
-  return setResponse(req, res, joint_trajectory, error_code, planning_begin);
+  if(!setResponse(req, res, joint_trajectory, error_code, planning_begin))
+  {
+    return false;
+  }
+  info.tip_pose_track = joint_trajectory.getTipPoseTrack();
+  info.scaling = scaling;
+  return true;
 
 
 }
 
-bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req, TrajectoryGenerator::MotionPlanInfo &info, moveit_msgs::MoveItErrorCodes &error_code) const
+bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::MotionPlanRequest &req,
+                                                   KinematicsSession& kinematics,
+                                                   TrajectoryGenerator::MotionPlanInfo &info,
+                                                   moveit_msgs::MoveItErrorCodes &error_code) const
 {
   ROS_DEBUG("Extract necessary information from motion plan request.");
 
@@ -126,13 +151,21 @@ bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::Mot
       return false;
     }
 
+    std::map<std::string, double> goal_joint_position;
     for(const auto &joint_item : req.goal_constraints.front().joint_constraints)
     {
-      info.goal_joint_position[joint_item.joint_name] = joint_item.position;
+      goal_joint_position[joint_item.joint_name] = joint_item.position;
+    }
+    if(!kinematics.toJointVector(goal_joint_position, info.goal_joint_position))
+    {
+      error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS;
+      return false;
     }
 
+    kinematics.setLinkName(info.link_name);
+
     // Ignored return value because at this point the function should always return 'true'.
-    computeLinkFK(robot_model_, info.link_name, info.goal_joint_position, info.goal_pose);
+    kinematics.fk(info.goal_joint_position, info.goal_pose);
   }
   // goal given in Cartesian space
   else
@@ -153,6 +186,8 @@ bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::Mot
         .constraint_region.primitive_poses.front().position;
     goal_pose_msg.orientation = req.goal_constraints.front().orientation_constraints.front().orientation;
     tf::poseMsgToEigen(goal_pose_msg, info.goal_pose);
+
+    kinematics.setLinkName(info.link_name);
   }
 
   // copy start state only with the joint
@@ -160,23 +195,31 @@ bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::Mot
   start_state.setToDefaultValues();
   moveit::core::robotStateMsgToRobotState(req.start_state, start_state, false);
 
-  for(const auto& joint_name : robot_model_->getJointModelGroup(req.group_name)->getActiveJointModelNames())
-  {
-    info.start_joint_position[joint_name] = start_state.getVariablePosition(joint_name);
-  }
+  info.joint_names = kinematics.getJointNames();
+  kinematics.toJointVector(start_state, info.start_joint_position);
 
   // Ignored return value because at this point the function should always return 'true'.
-  computeLinkFK(robot_model_, info.link_name, info.start_joint_position, info.start_pose);
+  kinematics.fk(info.start_joint_position, info.start_pose);
 
   //check goal pose ik before Cartesian motion plan starts
-  std::map<std::string, double> ik_solution;
-  if(!computePoseIK(robot_model_,
-                    info.group_name,
-                    info.link_name,
-                    info.goal_pose,
-                    frame_id,
-                    info.start_joint_position,
-                    ik_solution))
+  if(frame_id != robot_model_->getModelFrame())
+  {
+    ROS_ERROR_STREAM("Given frame (" << frame_id << ") is unequal to model frame("
+                     << robot_model_->getModelFrame() << ")");
+    error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+    return false;
+  }
+  // a joint goal is its own IK solution, the IK of a Cartesian goal is kept for the trajectory sampling
+  if(req.goal_constraints.front().joint_constraints.size() != 0)
+  {
+    if(!kinematics.isSelfCollisionFree(info.goal_joint_position))
+    {
+      ROS_ERROR("The joint goal is in self collision.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+      return false;
+    }
+  }
+  else if(!kinematics.solveIK(info.goal_pose, info.start_joint_position, info.goal_joint_position, true))
   {
     ROS_ERROR_STREAM("Failed to compute inverse kinematics for link: " << info.link_name << " of goal pose.");
     error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
@@ -186,23 +229,15 @@ bool TrajectoryGeneratorLIN::extractMotionPlanInfo(const planning_interface::Mot
   return true;
 }
 
-std::unique_ptr<KDL::Path> TrajectoryGeneratorLIN::setPathLIN(const TrajectoryGenerator::MotionPlanInfo &info,
-                                                              moveit_msgs::MoveItErrorCodes &error_code) const
+std::unique_ptr<CartesianPath> TrajectoryGeneratorLIN::setPathLIN(const TrajectoryGenerator::MotionPlanInfo &info,
+                                                                  moveit_msgs::MoveItErrorCodes &error_code) const
 {
   ROS_DEBUG("Set Cartesian path for LIN command.");
 
-  KDL::Frame start_pose, goal_pose;
-  tf::transformEigenToKDL(info.start_pose, start_pose);
-  tf::transformEigenToKDL(info.goal_pose, goal_pose);
   double eqradius = planner_limits_.getCartesianLimits().getMaxTranslationalVelocity()/
       planner_limits_.getCartesianLimits().getMaxRotationalVelocity();
-  KDL::RotationalInterpolation* rot_interpo = new KDL::RotationalInterpolation_SingleAxis();
 
-  return std::unique_ptr<KDL::Path>(new KDL::Path_Line(start_pose,
-                                                       goal_pose,
-                                                       rot_interpo,
-                                                       eqradius,
-                                                       true));
+  return std::unique_ptr<CartesianPath>(new CartesianPathLine(info.start_pose, info.goal_pose, eqradius));
 
 }
 
@@ -20,13 +20,325 @@
 #include "eigen_conversions/eigen_msg.h"
 #include "moveit/robot_state/conversions.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace pilz {
 
+namespace {
+
+/// relative margin of the unit move limits, keeps the common phase durations feasible despite rounding errors
+constexpr double SYNCHRONIZATION_TOLERANCE {1e-9};
+
+/**
+ * @brief compute the limit of a unit move which shares the feasible phase durations with all joints
+ *
+ * A joint moving the distance d with the limit l is feasible for the same phase durations as a unit move with the
+ * limit l/d. The unit move with the strictest of these limits is therefore feasible for all joints.
+ * @param distance: distance of each joint
+ * @param limits: limits of each joint
+ * @param limit: the limit to compute (e.g. max_velocity)
+ * @param scaling_factor: scaling factor of the limit
+ */
+double unitMoveLimit(const Eigen::VectorXd& distance,
+                     const std::vector<pilz_extensions::JointLimit>& limits,
+                     double pilz_extensions::JointLimit::* limit,
+                     const double& scaling_factor)
+{
+  double ratio {0.0};
+  for(std::size_t i = 0; i < limits.size(); ++i)
+  {
+    if(distance(i) != 0.0)
+    {
+      ratio = std::max(ratio, std::fabs(distance(i))/std::fabs(scaling_factor*(limits[i].*limit)));
+    }
+  }
+  return 1.0/(ratio*(1.0 + SYNCHRONIZATION_TOLERANCE));
+}
+
+/**
+ * @brief set the fastest profile of each joint and synchronize all joints to common phase durations
+ *
+ * The phase durations of the slowest joint are used if all other joints can follow them. Otherwise the phase
+ * durations are searched jointly for all joints as the fastest profile of the unit move.
+ * @param start_pos
+ * @param goal_pos
+ * @param velocity_profile: profile of each joint, created with the limits of the joint
+ * @param unit_profile: profile with the limits of the unit move of all joints, see unitMoveLimit()
+ * @param leading_axis: index of the slowest joint
+ * @return false if the profile of a joint cannot be synchronized, it keeps its fastest profile
+ */
+template<class VelocityProfile>
+bool synchronizeVelocityProfiles(const Eigen::VectorXd& start_pos,
+                                 const Eigen::VectorXd& goal_pos,
+                                 std::vector<VelocityProfile>& velocity_profile,
+                                 VelocityProfile unit_profile,
+                                 std::size_t& leading_axis)
+{
+  // compute the fastest trajectory and choose the slowest joint as leading axis
+  leading_axis = 0;
+  double max_duration = -1.0;
+  for(std::size_t i = 0; i < velocity_profile.size(); ++i)
+  {
+    velocity_profile[i].SetProfile(start_pos(i), goal_pos(i));
+    if(velocity_profile[i].Duration() > max_duration)
+    {
+      max_duration = velocity_profile[i].Duration();
+      leading_axis = i;
+    }
+  }
+
+  if(max_duration<=0)
+  {
+    return true;
+  }
+
+  // Full Synchronization
+  // reset the velocity profile for other joints
+  double acc_time = velocity_profile[leading_axis].FirstPhaseDuration();
+  double const_time = velocity_profile[leading_axis].SecondPhaseDuration();
+  double dec_time = velocity_profile[leading_axis].ThirdPhaseDuration();
+
+  bool synchronized = true;
+  for(std::size_t i = 0; i < velocity_profile.size(); ++i)
+  {
+    if(i != leading_axis)
+    {
+      // make full synchronization
+      if(!velocity_profile[i].SetProfileAllDurations(start_pos(i), goal_pos(i), acc_time, const_time, dec_time))
+      {
+        synchronized = false;
+      }
+    }
+  }
+  if(synchronized)
+  {
+    return true;
+  }
+
+  // the phase split of the leading axis violates the limits of another joint,
+  // search the fastest phase durations of all joints
+  unit_profile.SetProfile(0.0, 1.0);
+  acc_time = unit_profile.FirstPhaseDuration();
+  const_time = unit_profile.SecondPhaseDuration();
+  dec_time = unit_profile.ThirdPhaseDuration();
+  ROS_DEBUG_STREAM("Phase durations of the leading axis are infeasible, synchronize to " << acc_time << ", "
+                   << const_time << ", " << dec_time);
+
+  synchronized = true;
+  for(std::size_t i = 0; i < velocity_profile.size(); ++i)
+  {
+    if(!velocity_profile[i].SetProfileAllDurations(start_pos(i), goal_pos(i), acc_time, const_time, dec_time))
+    {
+      synchronized = false;
+    }
+  }
+  return synchronized;
+}
+
+/// doublings of the phase durations searched for a synchronization from a moving start state
+constexpr int MAX_STRETCH_DOUBLINGS {10};
+/// bisection steps of the stretch factor of the phase durations
+constexpr int STRETCH_SEARCH_STEPS {32};
+
+/**
+ * @brief phase durations of a synchronized motion
+ */
+struct PhaseDurations
+{
+  double acc_time;
+  double const_time;
+  double dec_time;
+};
+
+/**
+ * @brief set all profiles to the stretched phase durations, each joint keeps its start velocity
+ * @return false if the phase durations violate the limits of a joint
+ */
+bool setAllDurations(const Eigen::VectorXd& start_pos,
+                     const Eigen::VectorXd& goal_pos,
+                     const Eigen::VectorXd& start_vel,
+                     const PhaseDurations& phases,
+                     double stretch,
+                     std::vector<VelocityProfile_ATrap>& velocity_profile)
+{
+  for(std::size_t i = 0; i < velocity_profile.size(); ++i)
+  {
+    if(!velocity_profile[i].SetProfileStartVelocityAllDurations(start_pos(i), goal_pos(i), start_vel(i),
+                                                                 stretch*phases.acc_time,
+                                                                 stretch*phases.const_time,
+                                                                 stretch*phases.dec_time))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief search the smallest stretch factor of the phase durations which is feasible for all joints
+ *
+ * The stretch factor is doubled until all joints are feasible and then refined by bisection.
+ * @return the stretch factor, zero if none is found
+ */
+double searchStretch(const Eigen::VectorXd& start_pos,
+                     const Eigen::VectorXd& goal_pos,
+                     const Eigen::VectorXd& start_vel,
+                     const PhaseDurations& phases,
+                     std::vector<VelocityProfile_ATrap>& velocity_profile)
+{
+  if(phases.acc_time <= 0 || phases.dec_time <= 0)
+  {
+    return 0.0;
+  }
+
+  double lower_stretch = 0.0, upper_stretch = 1.0;
+  int doublings = 0;
+  while(!setAllDurations(start_pos, goal_pos, start_vel, phases, upper_stretch, velocity_profile))
+  {
+    if(++doublings > MAX_STRETCH_DOUBLINGS)
+    {
+      return 0.0;
+    }
+    lower_stretch = upper_stretch;
+    upper_stretch *= 2.0;
+  }
+  if(lower_stretch == 0.0)
+  {
+    return upper_stretch;
+  }
+
+  for(int step = 0; step < STRETCH_SEARCH_STEPS; ++step)
+  {
+    double stretch = 0.5*(lower_stretch + upper_stretch);
+    if(setAllDurations(start_pos, goal_pos, start_vel, phases, stretch, velocity_profile))
+    {
+      upper_stretch = stretch;
+    }
+    else
+    {
+      lower_stretch = stretch;
+    }
+  }
+  return upper_stretch;
+}
+
+/**
+ * @brief set the fastest profile of each joint from a moving start state and synchronize all joints
+ *
+ * The slowest joint is the leading axis and the other joints follow its phase durations if possible. Otherwise
+ * the phase split of each joint, scaled to the duration of the leading axis, is stretched until all joints are
+ * feasible and the split with the shortest duration is used.
+ * A joint with a start velocity pointing away from its goal first brakes to standstill.
+ * @param start_pos
+ * @param goal_pos
+ * @param start_vel
+ * @param velocity_profile: profile of each joint, created with the limits of the joint
+ * @param leading_axis: index of the slowest joint
+ * @return false if the joints cannot be synchronized
+ */
+bool synchronizeVelocityProfiles(const Eigen::VectorXd& start_pos,
+                                 const Eigen::VectorXd& goal_pos,
+                                 const Eigen::VectorXd& start_vel,
+                                 std::vector<VelocityProfile_ATrap>& velocity_profile,
+                                 std::size_t& leading_axis)
+{
+  // compute the fastest trajectory of each joint and choose the slowest joint as leading axis
+  leading_axis = 0;
+  double max_duration = -1.0;
+  bool leading_axis_set = false;
+  std::vector<PhaseDurations> phases(velocity_profile.size());
+  std::vector<double> durations(velocity_profile.size());
+  for(std::size_t i = 0; i < velocity_profile.size(); ++i)
+  {
+    bool profile_set = velocity_profile[i].SetProfileStartVelocity(start_pos(i), goal_pos(i), start_vel(i));
+    double brake_time = 0.0;
+    VelocityProfile_ATrap rest_profile(velocity_profile[i]);
+    if(!profile_set)
+    {
+      // the start velocity points away from the goal, brake to standstill and move to the goal from there,
+      // a goal next to the start position results in the brake phase as first phase
+      VelocityProfile_ATrap brake_profile(velocity_profile[i]);
+      brake_profile.SetProfileStartVelocity(start_pos(i),
+                                            std::nextafter(start_pos(i), std::copysign(HUGE_VAL, start_vel(i))),
+                                            start_vel(i));
+      brake_time = brake_profile.FirstPhaseDuration();
+      rest_profile.SetProfile(brake_profile.Pos(brake_time), goal_pos(i));
+    }
+    phases[i] = {brake_time + rest_profile.FirstPhaseDuration(),
+                 rest_profile.SecondPhaseDuration(),
+                 rest_profile.ThirdPhaseDuration()};
+    durations[i] = brake_time + rest_profile.Duration();
+
+    if(durations[i] > max_duration)
+    {
+      max_duration = durations[i];
+      leading_axis = i;
+      leading_axis_set = profile_set;
+    }
+  }
+
+  if(max_duration<=0)
+  {
+    return true;
+  }
+
+  // Full Synchronization
+  bool synchronized = true;
+  for(std::size_t i = 0; i < velocity_profile.size(); ++i)
+  {
+    if(i == leading_axis && leading_axis_set)
+    {
+      continue;
+    }
+    if(!velocity_profile[i].SetProfileStartVelocityAllDurations(start_pos(i), goal_pos(i), start_vel(i),
+                                                                 phases[leading_axis].acc_time,
+                                                                 phases[leading_axis].const_time,
+                                                                 phases[leading_axis].dec_time))
+    {
+      synchronized = false;
+      break;
+    }
+  }
+  if(synchronized)
+  {
+    return true;
+  }
+
+  // search the phase split with the shortest synchronized duration
+  PhaseDurations best_phases {0.0, 0.0, 0.0};
+  double best_stretch = 0.0;
+  for(std::size_t i = 0; i < velocity_profile.size(); ++i)
+  {
+    if(durations[i] <= 0)
+    {
+      continue;
+    }
+    const double scale = max_duration/durations[i];
+    const PhaseDurations candidate {scale*phases[i].acc_time, scale*phases[i].const_time, scale*phases[i].dec_time};
+    const double stretch = searchStretch(start_pos, goal_pos, start_vel, candidate, velocity_profile);
+    if(stretch > 0 && (best_stretch == 0 || stretch < best_stretch))
+    {
+      best_stretch = stretch;
+      best_phases = candidate;
+    }
+  }
+  if(best_stretch == 0)
+  {
+    return false;
+  }
+  ROS_DEBUG_STREAM("Phase durations of the leading axis are infeasible, synchronized duration "
+                   << best_stretch*max_duration);
+
+  return setAllDurations(start_pos, goal_pos, start_vel, best_phases, best_stretch, velocity_profile);
+}
+}
+
 TrajectoryGeneratorPTP::TrajectoryGeneratorPTP(const robot_model::RobotModelConstPtr& robot_model,
-                                               const LimitsContainer &planner_limits)
-  :TrajectoryGenerator::TrajectoryGenerator(robot_model, planner_limits)
+                                               const LimitsContainer &planner_limits,
+                                               const GeneratorOptions &options)
+  :TrajectoryGenerator::TrajectoryGenerator(robot_model, planner_limits, options)
 {
 
   if(!planner_limits_.hasJointLimits())
@@ -73,7 +385,16 @@ TrajectoryGeneratorPTP::~TrajectoryGeneratorPTP()
 }
 
 bool TrajectoryGeneratorPTP::generate(const planning_interface::MotionPlanRequest &req,
-                                      planning_interface::MotionPlanResponse& res,
+                                      planning_interface::MotionPlanResponse &res,
+                                      double sampling_time)
+{
+  GeneratedTrajectoryInfo info;
+  return generate(req, res, info, sampling_time);
+}
+
+bool TrajectoryGeneratorPTP::generate(const planning_interface::MotionPlanRequest &req,
+                                      planning_interface::MotionPlanResponse &res,
+                                      GeneratedTrajectoryInfo &info,
                                       double sampling_time)
 {
   ROS_INFO("Starting generation of PTP Trajectory!");
@@ -87,122 +408,207 @@ bool TrajectoryGeneratorPTP::generate(const planning_interface::MotionPlanReques
   // validate the common requirements of motion plan request
   if(!validateRequest(req, error_code) )
   {
-    trajectory_msgs::JointTrajectory joint_trajectory_empty;
+    JointTrajectoryBuffer joint_trajectory_empty;
     setResponse(req, res, joint_trajectory_empty, error_code, planning_begin);
     return false;
   }
 
   // extract planning information from the motion plan request
-  if(!extractMotionPlanInfo(req, plan_info, error_code))
+  KinematicsSession kinematics(robot_model_, req.group_name);
+  kinematics.setSelectNearestSolution(options_.ik_nearest_solution);
+  if(!extractMotionPlanInfo(req, kinematics, plan_info, error_code))
   {
     res.error_code_ = error_code;
-    trajectory_msgs::JointTrajectory joint_trajectory_empty;
+    JointTrajectoryBuffer joint_trajectory_empty;
     setResponse(req, res, joint_trajectory_empty, error_code, planning_begin);
     return false;
   }
 
   // plan the ptp trajectory
-  trajectory_msgs::JointTrajectory joint_trajectory;
-  planPTP(plan_info.start_joint_position, plan_info.goal_joint_position, joint_trajectory,
-          req.max_velocity_scaling_factor, req.max_acceleration_scaling_factor, sampling_time);
+  JointTrajectoryBuffer joint_trajectory;
+  if(!planPTP(plan_info.joint_names, plan_info.start_joint_position, plan_info.start_joint_velocity,
+              plan_info.goal_joint_position, joint_trajectory,
+              req.max_velocity_scaling_factor, req.max_acceleration_scaling_factor, sampling_time))
+  {
+    error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    JointTrajectoryBuffer joint_trajectory_empty;
+    setResponse(req, res, joint_trajectory_empty, error_code, planning_begin);
+    return false;
+  }
 
-  ROS_INFO_STREAM("PTP Trajectory with " << joint_trajectory.points.size() << " Points generated. Took "
+  ROS_INFO_STREAM("PTP Trajectory with " << joint_trajectory.size() << " Points generated. Took "
                   << (ros::Time::now() - planning_begin).toSec() * 1000 << " ms.");
 
   error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
   setResponse(req, res, joint_trajectory, error_code, planning_begin);
+  info = GeneratedTrajectoryInfo();
+  info.scaling.velocity_scaling_factor = req.max_velocity_scaling_factor;
+  info.scaling.acceleration_scaling_factor = req.max_acceleration_scaling_factor;
+  return true;
+}
+
+
+bool TrajectoryGeneratorPTP::generateAnalytic(const planning_interface::MotionPlanRequest& req,
+                                              PTPTrajectory& trajectory,
+                                              moveit_msgs::MoveItErrorCodes& error_code)
+{
+  ROS_INFO("Starting generation of analytic PTP Trajectory!");
+
+  // validate the common requirements of motion plan request
+  if(!validateRequest(req, error_code))
+  {
+    return false;
+  }
+
+  // extract planning information from the motion plan request
+  MotionPlanInfo plan_info;
+  KinematicsSession kinematics(robot_model_, req.group_name);
+  kinematics.setSelectNearestSolution(options_.ik_nearest_solution);
+  if(!extractMotionPlanInfo(req, kinematics, plan_info, error_code))
+  {
+    return false;
+  }
+
+  if(!plan_info.start_joint_velocity.isZero())
+  {
+    ROS_ERROR("The analytic ptp trajectory requires a start state at rest.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
+    return false;
+  }
+
+  if(!planPTPAnalytic(plan_info.joint_names, plan_info.start_joint_position, plan_info.goal_joint_position,
+                      trajectory, req.max_velocity_scaling_factor, req.max_acceleration_scaling_factor))
+  {
+    error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    return false;
+  }
+
+  error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
   return true;
 }
 
 
-void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_pos,
-                                     const std::map<std::string, double>& goal_pos,
-                                     trajectory_msgs::JointTrajectory &joint_trajectory,
+bool TrajectoryGeneratorPTP::planPTP(const std::vector<std::string>& joint_names,
+                                     const Eigen::VectorXd& start_pos,
+                                     const Eigen::VectorXd& start_vel,
+                                     const Eigen::VectorXd& goal_pos,
+                                     JointTrajectoryBuffer &joint_trajectory,
                                      const double &velocity_scaling_factor,
                                      const double &acceleration_scaling_factor,
                                      const double &sampling_time)
 {
   // initialize joint names
-  for(const auto& item : goal_pos)
-  {
-    joint_trajectory.joint_names.push_back(item.first);
-  }
+  joint_trajectory.setJointNames(joint_names);
+
+  const bool start_at_rest = start_vel.isZero();
 
   // check if goal already reached
-  bool goal_reached = true;
-  for(auto const& goal: goal_pos)
+  if(start_at_rest && isGoalReached(start_pos, goal_pos))
   {
-    if(fabs(start_pos.at(goal.first) - goal.second) >= MIN_MOVEMENT )
-    {
-      goal_reached = false;
-      break;
-    }
+    ROS_INFO_STREAM("Goal already reached, set one goal point explicitly.");
+    const std::size_t point_index = joint_trajectory.addPoint(sampling_time);
+    joint_trajectory.positions(point_index) = start_pos;
+    return true;
   }
-  if(goal_reached)
+
+  if(useJerkLimitedProfile(joint_names))
   {
-    ROS_INFO_STREAM("Goal already reached, set one goal point explicitly.");
-    if(joint_trajectory.points.empty())
+    if(start_at_rest)
     {
-      trajectory_msgs::JointTrajectoryPoint point;
-      point.time_from_start =  ros::Duration(sampling_time);
-      for(const std::string & joint_name : joint_trajectory.joint_names)
-      {
-        point.positions.push_back(start_pos.at(joint_name));
-        point.velocities.push_back(0);
-        point.accelerations.push_back(0);
-      }
-      joint_trajectory.points.push_back(point);
+      return planPTPJerkLimited(joint_names, start_pos, goal_pos, joint_trajectory,
+                                velocity_scaling_factor, acceleration_scaling_factor, sampling_time);
     }
-    return;
+    ROS_WARN("The jerk limited velocity profile requires a start state at rest, "
+             "the trapezoidal velocity profile is used.");
   }
 
-  // compute the fastest trajectory and choose the slowest joint as leading axis
-  std::string leading_axis = joint_trajectory.joint_names.front();
-  double max_duration = -1.0;
-
-  std::map<std::string, VelocityProfile_ATrap> velocity_profile;
-  for(const auto& joint_name : joint_trajectory.joint_names)
+  std::vector<VelocityProfile_ATrap> velocity_profile;
+  std::size_t leading_axis = 0;
+  const bool synchronized = planVelocityProfiles(joint_names, start_pos, start_vel, goal_pos,
+                                                 velocity_scaling_factor, acceleration_scaling_factor,
+                                                 velocity_profile, leading_axis);
+  if(!synchronized)
   {
-
-    // create vecocity profile if necessary
-    velocity_profile.insert(std::make_pair(
-                              joint_name,
-                              VelocityProfile_ATrap(
-                                velocity_scaling_factor*joint_limits_.getLimit(joint_name).max_velocity,
-                                acceleration_scaling_factor*joint_limits_.getLimit(joint_name).max_acceleration,
-                                acceleration_scaling_factor*joint_limits_.getLimit(joint_name).max_deceleration)));
-
-    velocity_profile.at(joint_name).SetProfile(start_pos.at(joint_name), goal_pos.at(joint_name));
-    if(velocity_profile.at(joint_name).Duration() > max_duration)
-    {
-      max_duration = velocity_profile.at(joint_name).Duration();
-      leading_axis = joint_name;
-    }
+    ROS_ERROR("Not all joints can be synchronized to common phase durations.");
+    joint_trajectory.clear();
+    return false;
   }
+  const double max_duration = velocity_profile[leading_axis].Duration();
 
   // TODO throw exception?
   if(max_duration<=0)
   {
     ROS_ERROR("Trajectory duration is zero. It should not happen here.");
-    joint_trajectory.points.clear();
-    return;
+    joint_trajectory.clear();
+    return true;
   }
 
-  // Full Synchronization
-  // TODO!!! we assume all axes have same max_vel, max_acc, max_dec values
-  // reset the velocity profile for other joints
-  double acc_time = velocity_profile.at(leading_axis).FirstPhaseDuration();
-  double const_time = velocity_profile.at(leading_axis).SecondPhaseDuration();
-  double dec_time = velocity_profile.at(leading_axis).ThirdPhaseDuration();
+  // first generate the time samples
+  std::vector<double> time_samples;
+  for(double t_sample=0.0; t_sample<max_duration; t_sample+=sampling_time)
+  {
+    time_samples.push_back(t_sample);
+  }
+  // add last time
+  time_samples.push_back(max_duration);
 
-  for(const auto& joint_name : joint_trajectory.joint_names)
+  // construct joint trajectory point, the time samples are sorted and evaluated for all joints at once
+  VelocityProfile_ATrapBatch velocity_profile_batch(velocity_profile);
+  joint_trajectory.reserve(time_samples.size());
+  for(double time_stamp : time_samples)
   {
-    if(joint_name != leading_axis)
-    {
-      // make full synchronization
-      velocity_profile.at(joint_name).SetProfileAllDurations(start_pos.at(joint_name), goal_pos.at(joint_name),
-                                                             acc_time,const_time,dec_time);
-    }
+    const std::size_t point_index = joint_trajectory.addPoint(time_stamp);
+    Eigen::Map<Eigen::VectorXd> positions = joint_trajectory.positions(point_index);
+    Eigen::Map<Eigen::VectorXd> velocities = joint_trajectory.velocities(point_index);
+    Eigen::Map<Eigen::VectorXd> accelerations = joint_trajectory.accelerations(point_index);
+    velocity_profile_batch.evaluate(time_stamp, positions, velocities, accelerations);
+  }
+  return true;
+}
+
+
+bool TrajectoryGeneratorPTP::planPTPJerkLimited(const std::vector<std::string>& joint_names,
+                                                const Eigen::VectorXd& start_pos,
+                                                const Eigen::VectorXd& goal_pos,
+                                                JointTrajectoryBuffer &joint_trajectory,
+                                                const double &velocity_scaling_factor,
+                                                const double &acceleration_scaling_factor,
+                                                const double &sampling_time)
+{
+  const std::size_t joint_count = joint_names.size();
+
+  const std::vector<pilz_extensions::JointLimit> limits = joint_limits_.getLimits(joint_names);
+  std::vector<VelocityProfile_SCurve> velocity_profile;
+  velocity_profile.reserve(joint_count);
+  for(std::size_t i = 0; i < joint_count; ++i)
+  {
+    velocity_profile.push_back(VelocityProfile_SCurve(velocity_scaling_factor*limits[i].max_velocity,
+                                                      acceleration_scaling_factor*limits[i].max_acceleration,
+                                                      acceleration_scaling_factor*limits[i].max_deceleration,
+                                                      acceleration_scaling_factor*limits[i].max_jerk));
+  }
+
+  const Eigen::VectorXd distance = goal_pos - start_pos;
+  VelocityProfile_SCurve unit_profile(
+        unitMoveLimit(distance, limits, &pilz_extensions::JointLimit::max_velocity, velocity_scaling_factor),
+        unitMoveLimit(distance, limits, &pilz_extensions::JointLimit::max_acceleration, acceleration_scaling_factor),
+        unitMoveLimit(distance, limits, &pilz_extensions::JointLimit::max_deceleration, acceleration_scaling_factor),
+        unitMoveLimit(distance, limits, &pilz_extensions::JointLimit::max_jerk, acceleration_scaling_factor));
+
+  std::size_t leading_axis = 0;
+  if(!synchronizeVelocityProfiles(start_pos, goal_pos, velocity_profile, unit_profile, leading_axis))
+  {
+    ROS_ERROR("Not all joints can be synchronized to common phase durations.");
+    joint_trajectory.clear();
+    return false;
+  }
+  const double max_duration = velocity_profile[leading_axis].Duration();
+
+  if(max_duration<=0)
+  {
+    ROS_ERROR("Trajectory duration is zero. It should not happen here.");
+    joint_trajectory.clear();
+    return true;
   }
 
   // first generate the time samples
@@ -215,42 +621,225 @@ void TrajectoryGeneratorPTP::planPTP(const std::map<std::string, double>& start_
   time_samples.push_back(max_duration);
 
   // construct joint trajectory point
+  joint_trajectory.reserve(time_samples.size());
   for(double time_stamp : time_samples)
   {
-    trajectory_msgs::JointTrajectoryPoint point;
-    point.time_from_start =  ros::Duration(time_stamp);
-    for(std::string & joint_name : joint_trajectory.joint_names)
+    const std::size_t point_index = joint_trajectory.addPoint(time_stamp);
+    Eigen::Map<Eigen::VectorXd> positions = joint_trajectory.positions(point_index);
+    Eigen::Map<Eigen::VectorXd> velocities = joint_trajectory.velocities(point_index);
+    Eigen::Map<Eigen::VectorXd> accelerations = joint_trajectory.accelerations(point_index);
+    for(std::size_t i = 0; i < joint_count; ++i)
     {
-      point.positions.push_back(velocity_profile.at(joint_name).Pos(time_stamp));
-      point.velocities.push_back(velocity_profile.at(joint_name).Vel(time_stamp));
-      point.accelerations.push_back(velocity_profile.at(joint_name).Acc(time_stamp));
+      positions(i) = velocity_profile[i].Pos(time_stamp);
+      velocities(i) = velocity_profile[i].Vel(time_stamp);
+      accelerations(i) = velocity_profile[i].Acc(time_stamp);
     }
-    joint_trajectory.points.push_back(point);
   }
+  return true;
+}
+
+
+bool TrajectoryGeneratorPTP::planPTPAnalytic(const std::vector<std::string>& joint_names,
+                                             const Eigen::VectorXd& start_pos,
+                                             const Eigen::VectorXd& goal_pos,
+                                             PTPTrajectory& trajectory,
+                                             const double& velocity_scaling_factor,
+                                             const double& acceleration_scaling_factor)
+{
+  const std::size_t joint_count = joint_names.size();
+
+  if(useJerkLimitedProfile(joint_names))
+  {
+    ROS_ERROR("The jerk limited velocity profile has no analytic representation.");
+    return false;
+  }
+
+  trajectory.joint_names = joint_names;
+  trajectory.start_position = start_pos;
+  trajectory.goal_position = goal_pos;
+  trajectory.acc_duration = 0.0;
+  trajectory.const_duration = 0.0;
+  trajectory.dec_duration = 0.0;
+  trajectory.velocity = Eigen::VectorXd::Zero(joint_count);
+  trajectory.acceleration = Eigen::VectorXd::Zero(joint_count);
+  trajectory.deceleration = Eigen::VectorXd::Zero(joint_count);
+
+  // the robot stays at the start position, as in the sampled trajectory
+  if(isGoalReached(start_pos, goal_pos))
+  {
+    ROS_INFO_STREAM("Goal already reached, the trajectory has zero duration.");
+    trajectory.goal_position = start_pos;
+    return true;
+  }
+
+  std::vector<VelocityProfile_ATrap> velocity_profile;
+  std::size_t leading_axis = 0;
+  if(!planVelocityProfiles(joint_names, start_pos, Eigen::VectorXd::Zero(joint_count), goal_pos,
+                           velocity_scaling_factor, acceleration_scaling_factor,
+                           velocity_profile, leading_axis))
+  {
+    ROS_ERROR("Not all joints can be synchronized to common phase durations.");
+    return false;
+  }
+
+  if(velocity_profile[leading_axis].Duration() <= 0)
+  {
+    ROS_ERROR("Trajectory duration is zero. It should not happen here.");
+    return false;
+  }
+
+  trajectory.acc_duration = velocity_profile[leading_axis].FirstPhaseDuration();
+  trajectory.const_duration = velocity_profile[leading_axis].SecondPhaseDuration();
+  trajectory.dec_duration = velocity_profile[leading_axis].ThirdPhaseDuration();
+
+  // the acceleration phase and the deceleration phase are not empty, their values are read at the phase ends
+  for(std::size_t i = 0; i < joint_count; ++i)
+  {
+    trajectory.velocity(i) = velocity_profile[i].Vel(trajectory.acc_duration);
+    trajectory.acceleration(i) = velocity_profile[i].Acc(trajectory.acc_duration);
+    trajectory.deceleration(i) = velocity_profile[i].Acc(trajectory.duration());
+  }
+  return true;
+}
+
+
+bool TrajectoryGeneratorPTP::planVelocityProfiles(const std::vector<std::string>& joint_names,
+                                                  const Eigen::VectorXd& start_pos,
+                                                  const Eigen::VectorXd& start_vel,
+                                                  const Eigen::VectorXd& goal_pos,
+                                                  const double& velocity_scaling_factor,
+                                                  const double& acceleration_scaling_factor,
+                                                  std::vector<VelocityProfile_ATrap>& velocity_profile,
+                                                  std::size_t& leading_axis) const
+{
+  const std::size_t joint_count = joint_names.size();
+
+  const std::vector<pilz_extensions::JointLimit> limits = joint_limits_.getLimits(joint_names);
+  velocity_profile.clear();
+  velocity_profile.reserve(joint_count);
+  for(std::size_t i = 0; i < joint_count; ++i)
+  {
+    // create vecocity profile if necessary
+    velocity_profile.push_back(VelocityProfile_ATrap(velocity_scaling_factor*limits[i].max_velocity,
+                                                     acceleration_scaling_factor*limits[i].max_acceleration,
+                                                     acceleration_scaling_factor*limits[i].max_deceleration));
+  }
+
+  if(!start_vel.isZero())
+  {
+    return synchronizeVelocityProfiles(start_pos, goal_pos, start_vel, velocity_profile, leading_axis);
+  }
+
+  const Eigen::VectorXd distance = goal_pos - start_pos;
+  VelocityProfile_ATrap unit_profile(
+        unitMoveLimit(distance, limits, &pilz_extensions::JointLimit::max_velocity, velocity_scaling_factor),
+        unitMoveLimit(distance, limits, &pilz_extensions::JointLimit::max_acceleration, acceleration_scaling_factor),
+        unitMoveLimit(distance, limits, &pilz_extensions::JointLimit::max_deceleration, acceleration_scaling_factor));
+
+  return synchronizeVelocityProfiles(start_pos, goal_pos, velocity_profile, unit_profile, leading_axis);
+}
+
+
+bool TrajectoryGeneratorPTP::useJerkLimitedProfile(const std::vector<std::string>& joint_names) const
+{
+  if(!options_.jerk_limited_profile)
+  {
+    return false;
+  }
+
+  for(const auto& limit : joint_limits_.getLimits(joint_names))
+  {
+    if(!limit.has_jerk_limits || limit.max_jerk <= 0)
+    {
+      ROS_WARN_ONCE("Not all joints have jerk limits, the trapezoidal velocity profile is used.");
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool TrajectoryGeneratorPTP::isGoalReached(const Eigen::VectorXd& start_pos, const Eigen::VectorXd& goal_pos) const
+{
+  for(Eigen::Index i = 0; i < start_pos.size(); ++i)
+  {
+    if(fabs(start_pos(i) - goal_pos(i)) >= MIN_MOVEMENT )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool TrajectoryGeneratorPTP::validateStartVelocity(const planning_interface::MotionPlanRequest& req,
+                                                   moveit_msgs::MoveItErrorCodes& error_code) const
+{
+  const sensor_msgs::JointState& joint_state = req.start_state.joint_state;
+  if(joint_state.velocity.empty())
+  {
+    return true;
+  }
+
+  if(joint_state.velocity.size() != joint_state.name.size())
+  {
+    ROS_ERROR("Joint state name and velocity do not match in start state.");
+    error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
+    return false;
+  }
+
+  for(std::size_t i = 0; i < joint_state.name.size(); ++i)
+  {
+    if(!joint_limits_.verifyVelocityLimit(joint_state.name[i],
+                                          joint_state.velocity[i]/req.max_velocity_scaling_factor))
+    {
+      ROS_ERROR_STREAM("Start velocity of joint " << joint_state.name[i] << " exceeds the scaled velocity limit.");
+      error_code.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
+      return false;
+    }
+  }
+  return true;
 }
 
 
 bool TrajectoryGeneratorPTP::extractMotionPlanInfo(const planning_interface::MotionPlanRequest& req,
+                                                   KinematicsSession& kinematics,
                                                    MotionPlanInfo& info,
                                                    moveit_msgs::MoveItErrorCodes& error_code) const
 {
   info.group_name = req.group_name;
-
-  // extract start state information
-  info.start_joint_position.clear();
-  for(std::size_t i=0; i<req.start_state.joint_state.name.size(); ++i)
+  info.joint_names = kinematics.getJointNames();
+
+  // extract start state information of the planning group
+  robot_state::RobotState start_state(robot_model_);
+  start_state.setToDefaultValues();
+  moveit::core::robotStateMsgToRobotState(req.start_state, start_state, false);
+  kinematics.toJointVector(start_state, info.start_joint_position);
+
+  // joints without start velocity are at rest
+  info.start_joint_velocity = Eigen::VectorXd::Zero(info.joint_names.size());
+  const sensor_msgs::JointState& joint_state = req.start_state.joint_state;
+  for(std::size_t i = 0; i < joint_state.velocity.size(); ++i)
   {
-    info.start_joint_position[req.start_state.joint_state.name[i]] = req.start_state.joint_state.position[i];
+    auto it = std::find(info.joint_names.begin(), info.joint_names.end(), joint_state.name[i]);
+    if(it != info.joint_names.end())
+    {
+      info.start_joint_velocity(std::distance(info.joint_names.begin(), it)) = joint_state.velocity[i];
+    }
   }
 
   // extract goal
-  info.goal_joint_position.clear();
   if(req.goal_constraints.at(0).joint_constraints.size() != 0)
   {
-    for(std::size_t i=0; i<req.goal_constraints.at(0).joint_constraints.size(); ++i)
+    // joints without goal constraint keep their start position
+    info.goal_joint_position = info.start_joint_position;
+    for(const auto& joint_constraint : req.goal_constraints.at(0).joint_constraints)
     {
-      info.goal_joint_position[req.goal_constraints.at(0).joint_constraints[i].joint_name] =
-          req.goal_constraints.at(0).joint_constraints[i].position;
+      auto it = std::find(info.joint_names.begin(), info.joint_names.end(), joint_constraint.joint_name);
+      if(it != info.joint_names.end())
+      {
+        info.goal_joint_position(std::distance(info.joint_names.begin(), it)) = joint_constraint.position;
+      }
     }
   }
   // slove the ik
@@ -267,13 +856,8 @@ bool TrajectoryGeneratorPTP::extractMotionPlanInfo(const planning_interface::Mot
     pose.orientation = req.goal_constraints.at(0).orientation_constraints.at(0).orientation;
     Eigen::Affine3d pose_eigen;
     tf::poseMsgToEigen(pose,pose_eigen);
-    if(!computePoseIK(robot_model_,
-                      req.group_name,
-                      req.goal_constraints.at(0).position_constraints.at(0).link_name,
-                      pose_eigen,
-                      robot_model_->getModelFrame(),
-                      info.start_joint_position,
-                      info.goal_joint_position))
+    kinematics.setLinkName(req.goal_constraints.at(0).position_constraints.at(0).link_name);
+    if(!kinematics.solveIK(pose_eigen, info.start_joint_position, info.goal_joint_position, true))
     {
       ROS_ERROR("No IK solution for goal pose.");
       error_code.val =  moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
@@ -17,6 +17,8 @@
 
 #include "pilz_trajectory_generation/velocity_profile_atrap.h"
 
+#include <algorithm>
+
 namespace pilz {
 
 VelocityProfile_ATrap::VelocityProfile_ATrap(double max_vel, double max_acc, double max_dec)
@@ -254,7 +256,7 @@ bool VelocityProfile_ATrap::SetProfileStartVelocity(double pos1, double pos2, do
   else
   {
     // acceleration to max velocity
-    t_a_ = fabs(max_vel_-start_vel_)/max_acc_;
+    t_a_ = fabs(max_vel_-s*start_vel_)/max_acc_;
     a1_ = start_pos_;
     a2_ = start_vel_;
     a3_ = 0.5*s*max_acc_;
@@ -262,13 +264,13 @@ bool VelocityProfile_ATrap::SetProfileStartVelocity(double pos1, double pos2, do
     // constant velocity
     t_b_ = (dis - min_dis_max_vel)/max_vel_;
     b1_ = a1_ +  a2_*t_a_ + a3_*t_a_*t_a_;
-    b2_ = max_vel_;
+    b2_ = s*max_vel_;
     b3_ = 0;
 
     // deceleration to zero velocity
     t_c_ = max_vel_/max_dec_;
     c1_ = b1_ + b2_*t_b_ + b3_*t_b_*t_b_;
-    c2_ = max_vel_;
+    c2_ = s*max_vel_;
     c3_ = -0.5*s*max_dec_;
   }
 
@@ -276,6 +278,66 @@ bool VelocityProfile_ATrap::SetProfileStartVelocity(double pos1, double pos2, do
 }
 
 
+bool VelocityProfile_ATrap::SetProfileStartVelocityAllDurations(double pos1, double pos2, double vel1,
+                                                               double duration1, double duration2, double duration3)
+{
+  if(vel1 == 0)
+  {
+    return SetProfileAllDurations(pos1, pos2, duration1, duration2, duration3);
+  }
+
+  if(duration1 <= 0 || duration3 <= 0 || duration2 < 0)
+  {
+    return false;
+  }
+
+  // compute the constant velocity, the first phase covers the mean of start and constant velocity
+  double new_vel = (pos2 - pos1 - 0.5*vel1*duration1)/(0.5*duration1 + duration2 + 0.5*duration3);
+  double new_acc = (new_vel - vel1)/duration1;
+  double new_dec = -new_vel/duration3;
+
+  // the first phase brakes if the velocity decreases, brakes and accelerates if the direction changes
+  double first_phase_limit = max_acc_;
+  if(new_vel*vel1 < 0)
+  {
+    first_phase_limit = std::min(max_acc_, max_dec_);
+  }
+  else if(fabs(new_vel) < fabs(vel1))
+  {
+    first_phase_limit = max_dec_;
+  }
+
+  if((fabs(new_vel)>max_vel_) || (fabs(new_acc)>first_phase_limit) || (fabs(new_dec)>max_dec_))
+  {
+    return false;
+  }
+
+  start_pos_ = pos1;
+  end_pos_ = pos2;
+  start_vel_ = vel1;
+
+  // first phase
+  a1_ = start_pos_;
+  a2_ = start_vel_;
+  a3_ = new_acc/2.0;
+  t_a_ = duration1;
+
+  // constant phase
+  b1_ = a1_ + a2_*t_a_ + a3_*t_a_*t_a_;
+  b2_ = new_vel;
+  b3_ = 0;
+  t_b_ = duration2;
+
+  // third phase
+  c1_ = b1_ + b2_*t_b_;
+  c2_ = new_vel;
+  c3_ = new_dec/2.0;
+  t_c_ = duration3;
+
+  return true;
+}
+
+
 
 double VelocityProfile_ATrap::Duration() const
 {
@@ -432,4 +494,126 @@ void VelocityProfile_ATrap::setEmptyProfile()
   t_c_ = 0;
 }
 
+constexpr int VelocityProfile_ATrapBatch::PHASE_COUNT;
+
+VelocityProfile_ATrapBatch::VelocityProfile_ATrapBatch(const std::vector<VelocityProfile_ATrap> &profiles)
+{
+  const Eigen::Index joint_count = profiles.size();
+  phase_begin_.resize(joint_count, PHASE_COUNT - 1);
+  pos_coef0_.setZero(joint_count, PHASE_COUNT);
+  pos_coef1_.setZero(joint_count, PHASE_COUNT);
+  pos_coef2_.setZero(joint_count, PHASE_COUNT);
+  vel_coef0_.setZero(joint_count, PHASE_COUNT);
+  vel_coef1_.setZero(joint_count, PHASE_COUNT);
+  time_shift1_.setZero(joint_count, PHASE_COUNT);
+  time_shift2_.setZero(joint_count, PHASE_COUNT);
+  acc_.setZero(joint_count, PHASE_COUNT);
+
+  for(Eigen::Index i = 0; i < joint_count; ++i)
+  {
+    const VelocityProfile_ATrap& p = profiles[i];
+
+    // same phase limits as in Pos(), Vel() and Acc()
+    phase_begin_.row(i) << 0, p.t_a_, p.t_a_+p.t_b_, p.t_a_+p.t_b_+p.t_c_;
+
+    // before the motion
+    pos_coef0_(i, 0) = p.start_pos_;
+    vel_coef0_(i, 0) = p.start_vel_;
+
+    // acceleration phase
+    pos_coef0_(i, 1) = p.a1_;
+    pos_coef1_(i, 1) = p.a2_;
+    pos_coef2_(i, 1) = p.a3_;
+    vel_coef0_(i, 1) = p.a2_;
+    vel_coef1_(i, 1) = 2*p.a3_;
+    acc_(i, 1) = 2*p.a3_;
+
+    // constant phase
+    pos_coef0_(i, 2) = p.b1_;
+    pos_coef1_(i, 2) = p.b2_;
+    pos_coef2_(i, 2) = p.b3_;
+    vel_coef0_(i, 2) = p.b2_;
+    vel_coef1_(i, 2) = 2*p.b3_;
+    time_shift1_(i, 2) = p.t_a_;
+    acc_(i, 2) = 2*p.b3_;
+
+    // deceleration phase
+    pos_coef0_(i, 3) = p.c1_;
+    pos_coef1_(i, 3) = p.c2_;
+    pos_coef2_(i, 3) = p.c3_;
+    vel_coef0_(i, 3) = p.c2_;
+    vel_coef1_(i, 3) = 2*p.c3_;
+    time_shift1_(i, 3) = p.t_a_;
+    time_shift2_(i, 3) = p.t_b_;
+    acc_(i, 3) = 2*p.c3_;
+
+    // after the motion
+    pos_coef0_(i, 4) = p.end_pos_;
+  }
+
+  reset();
+}
+
+void VelocityProfile_ATrapBatch::reset()
+{
+  phase_.assign(phase_begin_.rows(), 0);
+  acc_phase_.assign(phase_begin_.rows(), 0);
+  cur_pos_coef0_ = pos_coef0_.col(0);
+  cur_pos_coef1_ = pos_coef1_.col(0);
+  cur_pos_coef2_ = pos_coef2_.col(0);
+  cur_vel_coef0_ = vel_coef0_.col(0);
+  cur_vel_coef1_ = vel_coef1_.col(0);
+  cur_time_shift1_ = time_shift1_.col(0);
+  cur_time_shift2_ = time_shift2_.col(0);
+  cur_acc_ = acc_.col(0);
+  dt_.resize(phase_begin_.rows());
+}
+
+void VelocityProfile_ATrapBatch::evaluate(double time,
+                                          Eigen::Ref<Eigen::VectorXd> positions,
+                                          Eigen::Ref<Eigen::VectorXd> velocities,
+                                          Eigen::Ref<Eigen::VectorXd> accelerations)
+{
+  // move the phase cursors, the coefficients only change at phase transitions
+  for(Eigen::Index i = 0; i < phase_begin_.rows(); ++i)
+  {
+    int& phase = phase_[i];
+    const int phase_last = phase;
+    // the position phases are closed at the beginning, the last one is also closed at its end
+    while(phase < PHASE_COUNT - 1 && (phase < PHASE_COUNT - 2 ? time >= phase_begin_(i, phase)
+                                                              : time > phase_begin_(i, phase)))
+    {
+      ++phase;
+    }
+    if(phase != phase_last)
+    {
+      cur_pos_coef0_(i) = pos_coef0_(i, phase);
+      cur_pos_coef1_(i) = pos_coef1_(i, phase);
+      cur_pos_coef2_(i) = pos_coef2_(i, phase);
+      cur_vel_coef0_(i) = vel_coef0_(i, phase);
+      cur_vel_coef1_(i) = vel_coef1_(i, phase);
+      cur_time_shift1_(i) = time_shift1_(i, phase);
+      cur_time_shift2_(i) = time_shift2_(i, phase);
+    }
+
+    // the acceleration phases are closed at their end
+    int& acc_phase = acc_phase_[i];
+    const int acc_phase_last = acc_phase;
+    while(acc_phase < PHASE_COUNT - 1 && time > phase_begin_(i, acc_phase))
+    {
+      ++acc_phase;
+    }
+    if(acc_phase != acc_phase_last)
+    {
+      cur_acc_(i) = acc_(i, acc_phase);
+    }
+  }
+
+  // evaluate the polynomials of all joints
+  dt_ = (time - cur_time_shift1_) - cur_time_shift2_;
+  positions.array() = cur_pos_coef0_ + dt_*(cur_pos_coef1_ + cur_pos_coef2_*dt_);
+  velocities.array() = cur_vel_coef0_ + cur_vel_coef1_*dt_;
+  accelerations.array() = cur_acc_;
+}
+
 }
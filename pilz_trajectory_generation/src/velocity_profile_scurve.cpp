@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/velocity_profile_scurve.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+
+namespace pilz {
+
+namespace {
+
+/**
+ * @brief search the velocity at which a monotonically increasing distance function reaches the given distance
+ */
+template<class DistanceFunction>
+double searchVelocity(const DistanceFunction& distance, double target_distance, double lower, double upper)
+{
+  for(int i = 0; i < 200; ++i)
+  {
+    const double middle = 0.5*(lower + upper);
+    if(middle <= lower || middle >= upper)
+    {
+      break;
+    }
+    if(distance(middle) < target_distance)
+    {
+      lower = middle;
+    }
+    else
+    {
+      upper = middle;
+    }
+  }
+  return 0.5*(lower + upper);
+}
+
+}
+
+VelocityProfile_SCurve::VelocityProfile_SCurve(double max_vel, double max_acc, double max_dec, double max_jerk)
+  : max_vel_(fabs(max_vel)), max_acc_(fabs(max_acc)), max_dec_(fabs(max_dec)), max_jerk_(fabs(max_jerk)),
+    start_pos_(0), end_pos_(0), start_vel_(0),
+    t_a_(0),t_b_(0),t_c_(0)
+{
+}
+
+void VelocityProfile_SCurve::SetProfile(double pos1, double pos2)
+{
+  start_pos_ = pos1;
+  end_pos_ = pos2;
+  start_vel_ = 0.0;
+
+  if(start_pos_ == end_pos_)
+  {
+    // goal already reached, set everything to zero
+    setEmptyProfile();
+    return;
+  }
+
+  segments_.clear();
+  appendRestToRest(end_pos_ - start_pos_, t_a_, t_b_, t_c_);
+}
+
+void VelocityProfile_SCurve::SetProfileDuration(double pos1, double pos2, double duration)
+{
+  // compute the fastest case
+  SetProfile(pos1,pos2);
+
+  // cannot be faster
+  if(Duration()>duration || Duration()<=0)
+  {
+    return;
+  }
+
+  double ratio = Duration()/duration;
+  for(auto& segment : segments_)
+  {
+    segment.begin_time /= ratio;
+    segment.duration /= ratio;
+    segment.vel *= ratio;
+    segment.acc *= ratio*ratio;
+    segment.jerk *= ratio*ratio*ratio;
+  }
+  t_a_/=ratio;
+  t_b_/=ratio;
+  t_c_/=ratio;
+}
+
+bool VelocityProfile_SCurve::SetProfileAllDurations(double pos1, double pos2, double duration1,
+                                                   double duration2, double duration3)
+{
+  // compute the fastest case
+  SetProfile(pos1,pos2);
+
+  assert(duration1>0);
+  assert(duration3>0);
+
+  // cannot be faster
+  if(Duration() > (duration1 + duration2 + duration3))
+  {
+    return false;
+  }
+
+  // get the sign
+  double s = ((end_pos_ - start_pos_)>0.0) - ((end_pos_ - start_pos_)<0.0);
+  // compute the new velocity, the symmetric ramps cover half of the distance of the constant velocity
+  double dis = fabs(end_pos_-start_pos_);
+  double new_vel = dis/(duration2 + duration1/2.0 + duration3/2.0);
+
+  // the lowest jerk within the acceleration limit is reached by the longest ramps
+  double ramp1 = std::min(duration1/2.0, duration1 - new_vel/max_acc_);
+  double ramp3 = std::min(duration3/2.0, duration3 - new_vel/max_dec_);
+  if(new_vel > max_vel_ || ramp1 <= 0 || ramp3 <= 0)
+  {
+    return false;
+  }
+
+  double jerk1 = new_vel/(duration1 - ramp1)/ramp1;
+  double jerk3 = new_vel/(duration3 - ramp3)/ramp3;
+  if(jerk1 > max_jerk_ || jerk3 > max_jerk_)
+  {
+    return false;
+  }
+
+  //set profile
+  segments_.clear();
+  appendVelocityChange(duration1, ramp1, s*new_vel);
+  appendSegment(duration2, 0.0);
+  appendVelocityChange(duration3, ramp3, -s*new_vel);
+  t_a_ = duration1;
+  t_b_ = duration2;
+  t_c_ = duration3;
+  return true;
+}
+
+bool VelocityProfile_SCurve::SetProfileStartVelocity(double pos1, double pos2, double vel1)
+{
+  if(vel1 == 0)
+  {
+    SetProfile(pos1,pos2);
+    return true;
+  }
+
+  // get the sign
+  double s = ((pos2 - pos1)>0.0) - ((pos2 - pos1)<0.0);
+
+  if (s*vel1 <= 0)
+  {
+    //TODO initial velocity is in opposite derection of start-end vector
+    return false;
+  }
+
+  start_pos_ = pos1;
+  end_pos_ = pos2;
+  start_vel_ = vel1;
+  segments_.clear();
+
+  double speed = fabs(start_vel_);
+  double dis = fabs(end_pos_ - start_pos_);
+
+  // minimum brake distance
+  double brake_ramp;
+  double brake_time = fastestVelocityChange(speed, max_dec_, brake_ramp);
+  double min_brake_dis = 0.5*speed*brake_time;
+
+  // brake, move back to the goal
+  if(dis <= min_brake_dis)
+  {
+    appendVelocityChange(brake_time, brake_ramp, -start_vel_);
+    t_a_ = brake_time;
+
+    double acc_duration, const_duration;
+    appendRestToRest(-s*(min_brake_dis - dis), acc_duration, const_duration, t_c_);
+    t_b_ = acc_duration + const_duration;
+    return true;
+  }
+
+  // compute the reached velocity
+  double new_vel = max_vel_;
+  if(startVelocityDistance(speed, max_vel_) > dis)
+  {
+    new_vel = searchVelocity([this, speed](double vel){return startVelocityDistance(speed, vel);}, dis, 0.0, max_vel_);
+  }
+
+  // change to the new velocity, keep it and decelerate to zero velocity
+  double ramp1, ramp3;
+  t_a_ = fastestVelocityChange(fabs(new_vel - speed), new_vel >= speed ? max_acc_ : max_dec_, ramp1);
+  t_b_ = std::max(0.0, (dis - startVelocityDistance(speed, new_vel))/new_vel);
+  t_c_ = fastestVelocityChange(new_vel, max_dec_, ramp3);
+
+  appendVelocityChange(t_a_, ramp1, s*(new_vel - speed));
+  appendSegment(t_b_, 0.0);
+  appendVelocityChange(t_c_, ramp3, -s*new_vel);
+  return true;
+}
+
+double VelocityProfile_SCurve::Duration() const
+{
+  return t_a_ + t_b_ + t_c_;
+}
+
+double VelocityProfile_SCurve::Pos(double time) const
+{
+  if (time<0)
+  {
+    return start_pos_;
+  }
+  else if (time>Duration() || segments_.empty())
+  {
+    return end_pos_;
+  }
+
+  auto segment = std::find_if(segments_.begin(), std::prev(segments_.end()),
+                              [time](const Segment& seg){return time < seg.begin_time + seg.duration;});
+  double dt = time - segment->begin_time;
+  return segment->pos + dt*(segment->vel + dt*(segment->acc/2.0 + dt*segment->jerk/6.0));
+}
+
+double VelocityProfile_SCurve::Vel(double time) const
+{
+  if (time<0)
+  {
+    return start_vel_;
+  }
+  else if (time>Duration() || segments_.empty())
+  {
+    return 0;
+  }
+
+  auto segment = std::find_if(segments_.begin(), std::prev(segments_.end()),
+                              [time](const Segment& seg){return time < seg.begin_time + seg.duration;});
+  double dt = time - segment->begin_time;
+  return segment->vel + dt*(segment->acc + dt*segment->jerk/2.0);
+}
+
+double VelocityProfile_SCurve::Acc(double time) const
+{
+  if (time<=0 || time>Duration() || segments_.empty())
+  {
+    return 0;
+  }
+
+  auto segment = std::find_if(segments_.begin(), std::prev(segments_.end()),
+                              [time](const Segment& seg){return time < seg.begin_time + seg.duration;});
+  double dt = time - segment->begin_time;
+  return segment->acc + dt*segment->jerk;
+}
+
+KDL::VelocityProfile* VelocityProfile_SCurve::Clone() const
+{
+  return new VelocityProfile_SCurve(*this);
+}
+
+// LCOV_EXCL_START // No tests for the print function
+void VelocityProfile_SCurve::Write(std::ostream &os) const
+{
+  os << *this;
+}
+
+std::ostream &operator<<(std::ostream &os, const VelocityProfile_SCurve &p)
+{
+  os << "S-Curve " << std::endl
+     << "maximal velocity: " << p.max_vel_ << std::endl
+     << "maximal acceleration: " << p.max_acc_ << std::endl
+     << "maximal deceleration: " << p.max_dec_ << std::endl
+     << "maximal jerk: " << p.max_jerk_ << std::endl
+     << "start position: " << p.start_pos_ << std::endl
+     << "end position: " << p.end_pos_ << std::endl
+     << "start velocity: " << p.start_vel_ << std::endl;
+  for(const auto& segment : p.segments_)
+  {
+    os << "segment at " << segment.begin_time << ": duration " << segment.duration
+       << " jerk " << segment.jerk << std::endl;
+  }
+  os << "FirstPhaseDuration " << p.FirstPhaseDuration() << std::endl
+     << "SecondPhaseDuration " << p.SecondPhaseDuration() << std::endl
+     << "ThirdPhaseDuration " << p.ThirdPhaseDuration() << std::endl;
+  return os;
+}
+// LCOV_EXCL_STOP
+
+VelocityProfile_SCurve::~VelocityProfile_SCurve()
+{
+
+}
+
+void VelocityProfile_SCurve::setEmptyProfile()
+{
+  segments_.clear();
+
+  t_a_ = 0;
+  t_b_ = 0;
+  t_c_ = 0;
+}
+
+void VelocityProfile_SCurve::appendSegment(double duration, double jerk)
+{
+  if(duration <= 0)
+  {
+    return;
+  }
+
+  Segment segment;
+  segment.duration = duration;
+  segment.jerk = jerk;
+  if(segments_.empty())
+  {
+    segment.begin_time = 0;
+    segment.pos = start_pos_;
+    segment.vel = start_vel_;
+    segment.acc = 0;
+  }
+  else
+  {
+    const Segment& last = segments_.back();
+    double dt = last.duration;
+    segment.begin_time = last.begin_time + last.duration;
+    segment.pos = last.pos + dt*(last.vel + dt*(last.acc/2.0 + dt*last.jerk/6.0));
+    segment.vel = last.vel + dt*(last.acc + dt*last.jerk/2.0);
+    segment.acc = last.acc + dt*last.jerk;
+  }
+  segments_.push_back(segment);
+}
+
+void VelocityProfile_SCurve::appendVelocityChange(double duration, double ramp_duration, double delta_vel)
+{
+  if(duration <= 0 || ramp_duration <= 0)
+  {
+    return;
+  }
+
+  double acc = delta_vel/(duration - ramp_duration);
+  double jerk = acc/ramp_duration;
+  appendSegment(ramp_duration, jerk);
+  appendSegment(duration - 2.0*ramp_duration, 0.0);
+  appendSegment(ramp_duration, -jerk);
+}
+
+double VelocityProfile_SCurve::fastestVelocityChange(double delta_vel, double max_acc, double& ramp_duration) const
+{
+  if(delta_vel <= 0)
+  {
+    ramp_duration = 0;
+    return 0;
+  }
+
+  // maximal acceleration can be reached
+  if(delta_vel*max_jerk_ >= max_acc*max_acc)
+  {
+    ramp_duration = max_acc/max_jerk_;
+    return delta_vel/max_acc + ramp_duration;
+  }
+
+  ramp_duration = sqrt(delta_vel/max_jerk_);
+  return 2.0*ramp_duration;
+}
+
+double VelocityProfile_SCurve::restToRestDistance(double vel) const
+{
+  double ramp;
+  return 0.5*vel*(fastestVelocityChange(vel, max_acc_, ramp) + fastestVelocityChange(vel, max_dec_, ramp));
+}
+
+double VelocityProfile_SCurve::startVelocityDistance(double start_vel, double vel) const
+{
+  double ramp;
+  double change_time = fastestVelocityChange(fabs(vel - start_vel), vel >= start_vel ? max_acc_ : max_dec_, ramp);
+  return 0.5*(start_vel + vel)*change_time + 0.5*vel*fastestVelocityChange(vel, max_dec_, ramp);
+}
+
+void VelocityProfile_SCurve::appendRestToRest(double distance, double& acc_duration, double& const_duration,
+                                              double& dec_duration)
+{
+  acc_duration = 0;
+  const_duration = 0;
+  dec_duration = 0;
+  if(distance == 0)
+  {
+    return;
+  }
+
+  // get the sign
+  double s = (distance>0.0) - (distance<0.0);
+  double dis = fabs(distance);
+
+  // compute the reached velocity, max_vel can be reached if the distance is long enough
+  double new_vel = max_vel_;
+  if(restToRestDistance(max_vel_) > dis)
+  {
+    new_vel = searchVelocity([this](double vel){return restToRestDistance(vel);}, dis, 0.0, max_vel_);
+  }
+
+  double ramp1, ramp3;
+  acc_duration = fastestVelocityChange(new_vel, max_acc_, ramp1);
+  const_duration = std::max(0.0, (dis - restToRestDistance(new_vel))/new_vel);
+  dec_duration = fastestVelocityChange(new_vel, max_dec_, ramp3);
+
+  appendVelocityChange(acc_duration, ramp1, s*new_vel);
+  appendSegment(const_duration, 0.0);
+  appendVelocityChange(dec_duration, ramp3, -s*new_vel);
+}
+
+}
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pilz_trajectory_generation/velocity_profile_topp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace pilz {
+
+namespace {
+
+/// relative tolerance of the constraints
+const double CONSTRAINT_EPSILON = 1e-9;
+
+/// smallest path velocity to divide by
+const double VELOCITY_EPSILON = 1e-12;
+
+}
+
+VelocityProfile_TOPP::VelocityProfile_TOPP()
+  : time_scaling_(1.0)
+{
+}
+
+bool VelocityProfile_TOPP::SetProfileConstraints(const std::vector<double> &grid,
+                                                 const std::vector<double> &max_squared_velocity,
+                                                 const std::vector<ConstraintMatrix> &constraints)
+{
+  setEmptyProfile();
+  const std::size_t point_count = grid.size();
+  if(point_count < 2 || max_squared_velocity.size() != point_count || constraints.size() != point_count - 1)
+  {
+    return false;
+  }
+
+  // backward pass: the end is reached at rest
+  std::vector<double> controllable_min(point_count, 0.0), controllable_max(point_count, 0.0);
+  for(std::size_t i = point_count - 1; i-- > 0;)
+  {
+    if(!controllableRange(constraints[i], grid[i+1] - grid[i], max_squared_velocity[i],
+                          controllable_min[i+1], controllable_max[i+1], controllable_min[i], controllable_max[i]))
+    {
+      return false;
+    }
+  }
+  if(controllable_min.front() > CONSTRAINT_EPSILON)
+  {
+    return false;
+  }
+
+  // forward pass: start at rest with the largest path acceleration which keeps the successor controllable
+  std::vector<double> squared_velocities(point_count, 0.0);
+  accelerations_.assign(point_count - 1, 0.0);
+  for(std::size_t i = 0; i + 1 < point_count; ++i)
+  {
+    const double step = grid[i+1] - grid[i];
+    const double x = squared_velocities[i];
+    double lower = (controllable_min[i+1] - x) / (2*step);
+    double upper = (controllable_max[i+1] - x) / (2*step);
+    for(Eigen::Index r = 0; r < constraints[i].rows(); ++r)
+    {
+      const double a = constraints[i](r, 0);
+      const double bound = constraints[i](r, 2) - constraints[i](r, 1) * x;
+      if(a > CONSTRAINT_EPSILON)
+      {
+        upper = std::min(upper, bound / a);
+      }
+      else if(a < -CONSTRAINT_EPSILON)
+      {
+        lower = std::max(lower, bound / a);
+      }
+    }
+    // the backward pass guarantees lower <= upper up to rounding
+    const double u = std::max(lower, upper);
+    squared_velocities[i+1] = std::min(controllable_max[i+1],
+                                       std::max(controllable_min[i+1], std::max(0.0, x + 2*step*u)));
+    accelerations_[i] = (squared_velocities[i+1] - x) / (2*step);
+  }
+
+  // time of the grid points, the path acceleration is constant in between
+  velocities_.resize(point_count);
+  times_.resize(point_count);
+  velocities_[0] = 0.0;
+  times_[0] = 0.0;
+  for(std::size_t i = 0; i + 1 < point_count; ++i)
+  {
+    velocities_[i+1] = std::sqrt(squared_velocities[i+1]);
+    const double velocity_sum = velocities_[i] + velocities_[i+1];
+    if(velocity_sum < VELOCITY_EPSILON)
+    {
+      // the profile stops within the path
+      setEmptyProfile();
+      return false;
+    }
+    times_[i+1] = times_[i] + 2*(grid[i+1] - grid[i]) / velocity_sum;
+  }
+  grid_ = grid;
+  return true;
+}
+
+bool VelocityProfile_TOPP::controllableRange(const ConstraintMatrix &constraints,
+                                             double step,
+                                             double max_squared_velocity,
+                                             double next_min,
+                                             double next_max,
+                                             double &min,
+                                             double &max)
+{
+  // all constraints of (u, x), including the velocity bounds and the successor range
+  ConstraintMatrix rows(constraints.rows() + 4, 3);
+  rows.topRows(constraints.rows()) = constraints;
+  rows.bottomRows(4) <<           0, -1, 0,
+                                  0,  1, max_squared_velocity,
+                               2*step,  1, next_max,
+                              -2*step, -1, -next_min;
+
+  // the feasible polygon is bounded, the extremes of x are at its vertices
+  min = std::numeric_limits<double>::infinity();
+  max = -std::numeric_limits<double>::infinity();
+  for(Eigen::Index r1 = 0; r1 < rows.rows(); ++r1)
+  {
+    for(Eigen::Index r2 = r1 + 1; r2 < rows.rows(); ++r2)
+    {
+      const double det = rows(r1, 0)*rows(r2, 1) - rows(r1, 1)*rows(r2, 0);
+      if(std::fabs(det) < CONSTRAINT_EPSILON)
+      {
+        continue;
+      }
+      const double u = (rows(r1, 2)*rows(r2, 1) - rows(r1, 1)*rows(r2, 2)) / det;
+      const double x = (rows(r1, 0)*rows(r2, 2) - rows(r1, 2)*rows(r2, 0)) / det;
+      if(((rows.col(0)*u + rows.col(1)*x - rows.col(2)).array()
+          <= CONSTRAINT_EPSILON * (1.0 + rows.col(2).array().abs())).all())
+      {
+        min = std::min(min, x);
+        max = std::max(max, x);
+      }
+    }
+  }
+  if(min > max)
+  {
+    return false;
+  }
+  min = std::max(0.0, min);
+  max = std::min(max_squared_velocity, max);
+  return true;
+}
+
+void VelocityProfile_TOPP::SetProfile(double /*pos1*/, double /*pos2*/)
+{
+  time_scaling_ = 1.0;
+}
+
+void VelocityProfile_TOPP::SetProfileDuration(double pos1, double pos2, double duration)
+{
+  // compute the fastest case
+  SetProfile(pos1, pos2);
+
+  // cannot be faster
+  if(Duration()>duration || Duration()<=0)
+  {
+    return;
+  }
+
+  time_scaling_ = Duration()/duration;
+}
+
+double VelocityProfile_TOPP::Duration() const
+{
+  return times_.empty() ? 0.0 : times_.back() / time_scaling_;
+}
+
+std::size_t VelocityProfile_TOPP::interval(double time) const
+{
+  const std::size_t i = std::upper_bound(times_.begin(), times_.end(), time) - times_.begin();
+  return std::min(std::max<std::size_t>(i, 1), times_.size() - 1) - 1;
+}
+
+double VelocityProfile_TOPP::Pos(double time) const
+{
+  if(times_.empty())
+  {
+    return 0.0;
+  }
+  const double t = time * time_scaling_;
+  if(t <= 0)
+  {
+    return grid_.front();
+  }
+  else if(t >= times_.back())
+  {
+    return grid_.back();
+  }
+
+  const std::size_t i = interval(t);
+  const double dt = t - times_[i];
+  return grid_[i] + dt*(velocities_[i] + dt*accelerations_[i]/2.0);
+}
+
+double VelocityProfile_TOPP::Vel(double time) const
+{
+  const double t = time * time_scaling_;
+  if(times_.empty() || t <= 0 || t >= times_.back())
+  {
+    return 0.0;
+  }
+
+  const std::size_t i = interval(t);
+  return time_scaling_ * (velocities_[i] + (t - times_[i])*accelerations_[i]);
+}
+
+double VelocityProfile_TOPP::Acc(double time) const
+{
+  const double t = time * time_scaling_;
+  if(times_.empty() || t <= 0 || t > times_.back())
+  {
+    return 0.0;
+  }
+
+  return time_scaling_ * time_scaling_ * accelerations_[interval(t)];
+}
+
+KDL::VelocityProfile* VelocityProfile_TOPP::Clone() const
+{
+  return new VelocityProfile_TOPP(*this);
+}
+
+// LCOV_EXCL_START // No tests for the print function
+void VelocityProfile_TOPP::Write(std::ostream &os) const
+{
+  os << *this;
+}
+
+std::ostream &operator<<(std::ostream &os, const VelocityProfile_TOPP &p)
+{
+  os << "TOPP " << std::endl
+     << "grid points: " << p.grid_.size() << std::endl
+     << "time scaling: " << p.time_scaling_ << std::endl
+     << "Duration " << p.Duration() << std::endl;
+  return os;
+}
+// LCOV_EXCL_STOP
+
+VelocityProfile_TOPP::~VelocityProfile_TOPP()
+{
+
+}
+
+void VelocityProfile_TOPP::setEmptyProfile()
+{
+  grid_.clear();
+  velocities_.clear();
+  accelerations_.clear();
+  times_.clear();
+  time_scaling_ = 1.0;
+}
+
+}
@@ -947,8 +947,12 @@ bool testutils::generateTrajFromBlendTestData(const robot_model::RobotModelConst
                                               planning_interface::MotionPlanResponse& res_1,
                                               planning_interface::MotionPlanResponse& res_2,
                                               double& dis_1,
-                                              double& dis_2)
+                                              double& dis_2,
+                                              pilz::GeneratedTrajectoryInfo* info_1,
+                                              pilz::GeneratedTrajectoryInfo* info_2)
 {
+  pilz::GeneratedTrajectoryInfo info;
+
   // generate first trajectory
   planning_interface::MotionPlanRequest req_1;
   req_1.group_name = group_name;
@@ -968,11 +972,15 @@ bool testutils::generateTrajFromBlendTestData(const robot_model::RobotModelConst
                                                         goal_state_1.getRobotModel()->getJointModelGroup(group_name)));
 
   // trajectory generation
-  if(!tg->generate(req_1, res_1, sampling_time_1))
+  if(!tg->generate(req_1, res_1, info, sampling_time_1))
   {
     std::cout << "Failed to generate first trajectory." << std::endl;
     return false;
   }
+  if(info_1)
+  {
+    *info_1 = info;
+  }
 
   // generate second LIN trajectory
   planning_interface::MotionPlanRequest req_2;
@@ -989,11 +997,15 @@ bool testutils::generateTrajFromBlendTestData(const robot_model::RobotModelConst
         kinematic_constraints::constructGoalConstraints(goal_state_2,
                                                         goal_state_2.getRobotModel()->getJointModelGroup(group_name)));
   // trajectory generation
-  if(!tg->generate(req_2, res_2, sampling_time_2))
+  if(!tg->generate(req_2, res_2, info, sampling_time_2))
   {
     std::cout << "Failed to generate second trajectory." << std::endl;
     return false;
   }
+  if(info_2)
+  {
+    *info_2 = info;
+  }
 
   // estimate a proper blend radius
   dis_1 = (start_state.getFrameTransform(link_name).translation()
@@ -455,6 +455,8 @@ bool checkBlendResult(const pilz::TrajectoryBlendRequest& blend_req,
  * @param[out] res_lin_2: result of the second LIN motion planning
  * @param[out] dis_lin_1: translational distance of the first LIN
  * @param[out] dis_lin_2: translational distance of the second LIN
+ * @param[out] info_1: generation results of the first LIN, e.g. its tip pose track, not set if nullptr
+ * @param[out] info_2: generation results of the second LIN, not set if nullptr
  * @return true if succeed
  */
 bool generateTrajFromBlendTestData(const moveit::core::RobotModelConstPtr &robot_model,
@@ -466,7 +468,9 @@ bool generateTrajFromBlendTestData(const moveit::core::RobotModelConstPtr &robot
                                    const double &sampling_time_2,
                                    planning_interface::MotionPlanResponse& res_lin_1,
                                    planning_interface::MotionPlanResponse& res_lin_2,
-                                   double &dis_lin_1, double &dis_lin_2);
+                                   double &dis_lin_1, double &dis_lin_2,
+                                   pilz::GeneratedTrajectoryInfo* info_1 = nullptr,
+                                   pilz::GeneratedTrajectoryInfo* info_2 = nullptr);
 
 void generateRequestMsgFromBlendTestData(const moveit::core::RobotModelConstPtr &robot_model,
                                          const blend_test_data& data,
@@ -49,6 +49,7 @@ TEST_F(CartesianLimitsAggregator, OnlyVelocity)
   EXPECT_EQ(limit.getMaxTranslationalVelocity(), 10);
   EXPECT_FALSE(limit.hasMaxTranslationalAcceleration());
   EXPECT_FALSE(limit.hasMaxTranslationalDeceleration());
+  EXPECT_FALSE(limit.hasMaxTranslationalJerk());
   EXPECT_FALSE(limit.hasMaxRotationalVelocity());
 }
 
@@ -69,6 +70,9 @@ TEST_F(CartesianLimitsAggregator, AllValues)
   EXPECT_TRUE(limit.hasMaxTranslationalDeceleration());
   EXPECT_EQ(limit.getMaxTranslationalDeceleration(), -3);
 
+  EXPECT_TRUE(limit.hasMaxTranslationalJerk());
+  EXPECT_EQ(limit.getMaxTranslationalJerk(), 5);
+
   EXPECT_TRUE(limit.hasMaxRotationalVelocity());
   EXPECT_EQ(limit.getMaxRotationalVelocity(), 4);
 }
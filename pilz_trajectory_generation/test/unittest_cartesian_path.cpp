@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <eigen_conversions/eigen_kdl.h>
+#include <kdl/path_circle.hpp>
+#include <kdl/path_line.hpp>
+#include <kdl/rotational_interpolation_sa.hpp>
+#include <kdl/utilities/error.h>
+
+#include "pilz_trajectory_generation/cartesian_path.h"
+
+// Modultest Level1 of the classes CartesianPathLine and CartesianPathCircle
+#define EPSILON 1.0e-10
+
+namespace
+{
+
+Eigen::Affine3d createPose(double x, double y, double z, double roll, double pitch, double yaw)
+{
+  Eigen::Affine3d pose = Eigen::Translation3d(x, y, z)
+      * Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ())
+      * Eigen::AngleAxisd(pitch, Eigen::Vector3d::UnitY())
+      * Eigen::AngleAxisd(roll, Eigen::Vector3d::UnitX());
+  return pose;
+}
+
+/**
+ * @brief compare the path with the KDL path at equally spaced path parameters
+ */
+void expectEqualPaths(const KDL::Path& expected, const pilz::CartesianPath& path)
+{
+  ASSERT_NEAR(expected.PathLength(), path.getPathLength(), EPSILON);
+
+  std::vector<double> path_parameters;
+  for(std::size_t i = 0; i <= 20; ++i)
+  {
+    path_parameters.push_back(path.getPathLength() * i / 20.);
+  }
+
+  pilz::PoseVector poses;
+  path.getPoses(path_parameters, poses);
+  ASSERT_EQ(path_parameters.size(), poses.size());
+
+  for(std::size_t i = 0; i < path_parameters.size(); ++i)
+  {
+    Eigen::Affine3d expected_pose;
+    tf::transformKDLToEigen(expected.Pos(path_parameters[i]), expected_pose);
+    EXPECT_TRUE(expected_pose.isApprox(poses[i], EPSILON)) << "at path parameter " << path_parameters[i];
+    EXPECT_TRUE(path.getPose(path_parameters[i]).isApprox(poses[i], EPSILON))
+        << "at path parameter " << path_parameters[i];
+  }
+}
+
+std::unique_ptr<KDL::Path> createKDLLine(const Eigen::Affine3d& start_pose, const Eigen::Affine3d& goal_pose,
+                                         double eqradius)
+{
+  KDL::Frame start, goal;
+  tf::transformEigenToKDL(start_pose, start);
+  tf::transformEigenToKDL(goal_pose, goal);
+  return std::unique_ptr<KDL::Path>(
+        new KDL::Path_Line(start, goal, new KDL::RotationalInterpolation_SingleAxis(), eqradius, true));
+}
+
+std::unique_ptr<KDL::Path> createKDLCircle(const Eigen::Affine3d& start_pose, const Eigen::Vector3d& center_point,
+                                           const Eigen::Vector3d& plane_point, const Eigen::Affine3d& goal_pose,
+                                           double angle, double eqradius)
+{
+  KDL::Frame start, goal;
+  tf::transformEigenToKDL(start_pose, start);
+  tf::transformEigenToKDL(goal_pose, goal);
+  KDL::Vector center, plane;
+  tf::vectorEigenToKDL(center_point, center);
+  tf::vectorEigenToKDL(plane_point, plane);
+  return std::unique_ptr<KDL::Path>(
+        new KDL::Path_Circle(start, center, plane, goal.M, angle, new KDL::RotationalInterpolation_SingleAxis(),
+                             eqradius, true));
+}
+
+}
+
+/**
+ * @brief Line whose path length is defined by the translation
+ */
+TEST(CartesianPathTest, LineTranslationLimited)
+{
+  const Eigen::Affine3d start = createPose(0.1, 0.2, 0.3, 0.1, -0.2, 0.3);
+  const Eigen::Affine3d goal = createPose(0.5, -0.2, 0.4, 0.2, 0.1, 0.5);
+  const double eqradius = 0.1;
+
+  pilz::CartesianPathLine path(start, goal, eqradius);
+  EXPECT_NEAR((goal.translation() - start.translation()).norm(), path.getPathLength(), EPSILON);
+  expectEqualPaths(*createKDLLine(start, goal, eqradius), path);
+}
+
+/**
+ * @brief Line whose path length is defined by the rotation
+ */
+TEST(CartesianPathTest, LineRotationLimited)
+{
+  const Eigen::Affine3d start = createPose(0.1, 0.2, 0.3, 0.1, -0.2, 0.3);
+  const Eigen::Affine3d goal = createPose(0.15, 0.2, 0.3, 1.2, 0.4, -2.0);
+  const double eqradius = 1.0;
+
+  pilz::CartesianPathLine path(start, goal, eqradius);
+  expectEqualPaths(*createKDLLine(start, goal, eqradius), path);
+}
+
+/**
+ * @brief Line with a rotation close to pi, the rotation has to take the short way
+ */
+TEST(CartesianPathTest, LineRotationCloseToPi)
+{
+  const Eigen::Affine3d start = createPose(0., 0., 0., 0., 0., -1.6);
+  const Eigen::Affine3d goal = createPose(0., 0., 0.1, 0., 0., 1.6);
+  const double eqradius = 0.5;
+
+  pilz::CartesianPathLine path(start, goal, eqradius);
+  EXPECT_NEAR((2*M_PI - 3.2) * eqradius, path.getPathLength(), EPSILON);
+  expectEqualPaths(*createKDLLine(start, goal, eqradius), path);
+}
+
+/**
+ * @brief Line with equal start and goal pose
+ */
+TEST(CartesianPathTest, LineZeroLength)
+{
+  const Eigen::Affine3d start = createPose(0.1, 0.2, 0.3, 0.1, -0.2, 0.3);
+
+  pilz::CartesianPathLine path(start, start, 1.0);
+  EXPECT_EQ(0., path.getPathLength());
+  EXPECT_TRUE(start.isApprox(path.getPose(0.), EPSILON));
+}
+
+/**
+ * @brief Circle whose path length is defined by the translation
+ */
+TEST(CartesianPathTest, CircleTranslationLimited)
+{
+  const Eigen::Vector3d center(0.3, 0.1, 0.5);
+  const Eigen::Affine3d start = createPose(0.5, 0.1, 0.5, 0.1, -0.2, 0.3);
+  const Eigen::Affine3d goal = createPose(0.3, 0.3, 0.5, 0.3, 0.0, 0.6);
+  const double eqradius = 0.1;
+
+  pilz::CartesianPathCircle path(start, center, goal.translation(), goal.linear(), M_PI/2, eqradius);
+  EXPECT_NEAR(0.2, path.getRadius(), EPSILON);
+  EXPECT_NEAR(0.2*M_PI/2, path.getPathLength(), EPSILON);
+  expectEqualPaths(*createKDLCircle(start, center, goal.translation(), goal, M_PI/2, eqradius), path);
+
+  // the arc ends at the goal
+  EXPECT_TRUE(goal.isApprox(path.getPose(path.getPathLength()), 1e-8));
+}
+
+/**
+ * @brief Circle whose path length is defined by the rotation, the arc is longer than half a circle
+ */
+TEST(CartesianPathTest, CircleRotationLimited)
+{
+  const Eigen::Vector3d center(0.3, 0.1, 0.5);
+  const Eigen::Affine3d start = createPose(0.35, 0.1, 0.5, 0.1, -0.2, 0.3);
+  const Eigen::Affine3d goal = createPose(0.3, 0.15, 0.55, 1.3, 0.5, -1.6);
+  const Eigen::Vector3d plane_point(0.3, 0.15, 0.5);
+  const double eqradius = 1.0;
+
+  pilz::CartesianPathCircle path(start, center, plane_point, goal.linear(), 1.5*M_PI, eqradius);
+  expectEqualPaths(*createKDLCircle(start, center, plane_point, goal, 1.5*M_PI, eqradius), path);
+}
+
+/**
+ * @brief Circle with the start at the center point
+ */
+TEST(CartesianPathTest, CircleTooSmall)
+{
+  const Eigen::Affine3d start = createPose(0.3, 0.1, 0.5, 0., 0., 0.);
+  EXPECT_THROW(pilz::CartesianPathCircle(start, start.translation(), Eigen::Vector3d(0.5, 0.1, 0.5),
+                                         start.linear(), M_PI/2, 1.0),
+               KDL::Error_MotionPlanning_Circle_ToSmall);
+}
+
+/**
+ * @brief Circle with colinear start, center and plane point
+ */
+TEST(CartesianPathTest, CircleNoPlane)
+{
+  const Eigen::Affine3d start = createPose(0.5, 0.1, 0.5, 0., 0., 0.);
+  EXPECT_THROW(pilz::CartesianPathCircle(start, Eigen::Vector3d(0.3, 0.1, 0.5), Eigen::Vector3d(0.1, 0.1, 0.5),
+                                         start.linear(), M_PI, 1.0),
+               KDL::Error_MotionPlanning_Circle_No_Plane);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -112,7 +112,7 @@ TEST_P(CommandPlannerTest, ObtainLoadedPlanningAlgorithms)
   std::vector<std::string> algs;
 
   planner_instance_->getPlanningAlgorithms(algs);
-  ASSERT_EQ(3u, algs.size()) << "Found more or less planning algorithms as expected! Found:"
+  ASSERT_EQ(4u, algs.size()) << "Found more or less planning algorithms as expected! Found:"
                             << ::testing::PrintToString(algs);
 
 
@@ -124,6 +124,7 @@ TEST_P(CommandPlannerTest, ObtainLoadedPlanningAlgorithms)
   }
   ASSERT_EQ(algs.size(), algs_set.size()) << "There are two or more algorithms with the same name!";
   ASSERT_TRUE(algs_set.find("LIN") != algs_set.end());
+  ASSERT_TRUE(algs_set.find("LIN_APPROX") != algs_set.end());
   ASSERT_TRUE(algs_set.find("PTP") != algs_set.end());
   ASSERT_TRUE(algs_set.find("CIRC") != algs_set.end());
 }
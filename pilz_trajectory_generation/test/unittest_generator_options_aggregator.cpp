@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <ros/ros.h>
+
+#include "pilz_trajectory_generation/generator_options.h"
+#include "pilz_trajectory_generation/generator_options_aggregator.h"
+
+/**
+ * @brief Check that the defaults are kept if no options are set
+ */
+TEST(GeneratorOptionsAggregator, Defaults)
+{
+  ros::NodeHandle nh("~/not_set");
+
+  pilz::GeneratorOptions defaults;
+  pilz::GeneratorOptions options = pilz::GeneratorOptionsAggregator::getAggregatedOptions(nh);
+  EXPECT_EQ(defaults.thread_pool_size, options.thread_pool_size);
+  EXPECT_FALSE(options.thread_pool);
+  EXPECT_EQ(defaults.parallel_ik, options.parallel_ik);
+  EXPECT_EQ(defaults.parallel_ik_threads, options.parallel_ik_threads);
+  EXPECT_EQ(defaults.parallel_ik_min_samples, options.parallel_ik_min_samples);
+  EXPECT_EQ(defaults.adaptive_sampling, options.adaptive_sampling);
+  EXPECT_EQ(defaults.adaptive_sampling_max_knot_interval, options.adaptive_sampling_max_knot_interval);
+  EXPECT_EQ(defaults.adaptive_sampling_position_tolerance, options.adaptive_sampling_position_tolerance);
+  EXPECT_EQ(defaults.adaptive_sampling_orientation_tolerance, options.adaptive_sampling_orientation_tolerance);
+  EXPECT_EQ(defaults.differential_ik, options.differential_ik);
+  EXPECT_EQ(defaults.differential_ik_max_iterations, options.differential_ik_max_iterations);
+  EXPECT_EQ(defaults.differential_ik_position_tolerance, options.differential_ik_position_tolerance);
+  EXPECT_EQ(defaults.differential_ik_orientation_tolerance, options.differential_ik_orientation_tolerance);
+  EXPECT_EQ(defaults.ik_nearest_solution, options.ik_nearest_solution);
+  EXPECT_EQ(defaults.jerk_limited_profile, options.jerk_limited_profile);
+  EXPECT_EQ(defaults.plan_cache, options.plan_cache);
+  EXPECT_EQ(defaults.plan_cache_capacity, options.plan_cache_capacity);
+  EXPECT_EQ(defaults.plan_cache_joint_resolution, options.plan_cache_joint_resolution);
+  EXPECT_EQ(defaults.velocity_scaling_search, options.velocity_scaling_search);
+  EXPECT_EQ(defaults.velocity_scaling_search_margin, options.velocity_scaling_search_margin);
+  EXPECT_EQ(defaults.time_optimal_parameterization, options.time_optimal_parameterization);
+  EXPECT_EQ(defaults.lin_approximation, options.lin_approximation);
+  EXPECT_EQ(defaults.time_optimal_grid_step, options.time_optimal_grid_step);
+  EXPECT_EQ(defaults.lin_approximation_position_tolerance, options.lin_approximation_position_tolerance);
+  EXPECT_EQ(defaults.lin_approximation_orientation_tolerance, options.lin_approximation_orientation_tolerance);
+  EXPECT_EQ(defaults.singularity_prescan, options.singularity_prescan);
+  EXPECT_EQ(defaults.singularity_prescan_intervals, options.singularity_prescan_intervals);
+  EXPECT_EQ(defaults.singularity_prescan_min_manipulability, options.singularity_prescan_min_manipulability);
+  EXPECT_EQ(defaults.blend_crossing_time_alignment, options.blend_crossing_time_alignment);
+}
+
+/**
+ * @brief Check if all values are set correctly
+ */
+TEST(GeneratorOptionsAggregator, AllValues)
+{
+  ros::NodeHandle nh("~/all");
+
+  pilz::GeneratorOptions options = pilz::GeneratorOptionsAggregator::getAggregatedOptions(nh);
+  EXPECT_EQ(2u, options.thread_pool_size);
+  EXPECT_TRUE(options.parallel_ik);
+  EXPECT_EQ(3u, options.parallel_ik_threads);
+  EXPECT_EQ(50u, options.parallel_ik_min_samples);
+  EXPECT_TRUE(options.adaptive_sampling);
+  EXPECT_EQ(8u, options.adaptive_sampling_max_knot_interval);
+  EXPECT_DOUBLE_EQ(0.0005, options.adaptive_sampling_position_tolerance);
+  EXPECT_DOUBLE_EQ(0.002, options.adaptive_sampling_orientation_tolerance);
+  EXPECT_TRUE(options.differential_ik);
+  EXPECT_EQ(5u, options.differential_ik_max_iterations);
+  EXPECT_DOUBLE_EQ(0.00002, options.differential_ik_position_tolerance);
+  EXPECT_DOUBLE_EQ(0.0003, options.differential_ik_orientation_tolerance);
+  EXPECT_TRUE(options.ik_nearest_solution);
+  EXPECT_TRUE(options.jerk_limited_profile);
+  EXPECT_TRUE(options.plan_cache);
+  EXPECT_EQ(16u, options.plan_cache_capacity);
+  EXPECT_DOUBLE_EQ(0.001, options.plan_cache_joint_resolution);
+  EXPECT_TRUE(options.velocity_scaling_search);
+  EXPECT_DOUBLE_EQ(0.05, options.velocity_scaling_search_margin);
+  EXPECT_TRUE(options.time_optimal_parameterization);
+  EXPECT_DOUBLE_EQ(0.002, options.time_optimal_grid_step);
+  EXPECT_DOUBLE_EQ(0.002, options.lin_approximation_position_tolerance);
+  EXPECT_DOUBLE_EQ(0.02, options.lin_approximation_orientation_tolerance);
+  EXPECT_TRUE(options.singularity_prescan);
+  EXPECT_EQ(10u, options.singularity_prescan_intervals);
+  EXPECT_DOUBLE_EQ(0.01, options.singularity_prescan_min_manipulability);
+  EXPECT_TRUE(options.blend_crossing_time_alignment);
+}
+
+/**
+ * @brief Check that negative counts and tolerances are ignored
+ */
+TEST(GeneratorOptionsAggregator, NegativeValues)
+{
+  ros::NodeHandle nh("~/negative");
+
+  pilz::GeneratorOptions defaults;
+  pilz::GeneratorOptions options = pilz::GeneratorOptionsAggregator::getAggregatedOptions(nh);
+  EXPECT_EQ(defaults.thread_pool_size, options.thread_pool_size);
+  EXPECT_EQ(defaults.parallel_ik_threads, options.parallel_ik_threads);
+  EXPECT_EQ(defaults.parallel_ik_min_samples, options.parallel_ik_min_samples);
+  EXPECT_EQ(defaults.adaptive_sampling_max_knot_interval, options.adaptive_sampling_max_knot_interval);
+  EXPECT_EQ(defaults.adaptive_sampling_position_tolerance, options.adaptive_sampling_position_tolerance);
+  EXPECT_EQ(defaults.adaptive_sampling_orientation_tolerance, options.adaptive_sampling_orientation_tolerance);
+  EXPECT_EQ(defaults.differential_ik_max_iterations, options.differential_ik_max_iterations);
+  EXPECT_EQ(defaults.differential_ik_position_tolerance, options.differential_ik_position_tolerance);
+  EXPECT_EQ(defaults.differential_ik_orientation_tolerance, options.differential_ik_orientation_tolerance);
+  EXPECT_EQ(defaults.plan_cache_capacity, options.plan_cache_capacity);
+  EXPECT_EQ(defaults.plan_cache_joint_resolution, options.plan_cache_joint_resolution);
+  EXPECT_EQ(defaults.velocity_scaling_search_margin, options.velocity_scaling_search_margin);
+  EXPECT_EQ(defaults.time_optimal_grid_step, options.time_optimal_grid_step);
+  EXPECT_EQ(defaults.lin_approximation_position_tolerance, options.lin_approximation_position_tolerance);
+  EXPECT_EQ(defaults.lin_approximation_orientation_tolerance, options.lin_approximation_orientation_tolerance);
+  EXPECT_EQ(defaults.singularity_prescan_intervals, options.singularity_prescan_intervals);
+  EXPECT_EQ(defaults.singularity_prescan_min_manipulability, options.singularity_prescan_min_manipulability);
+  EXPECT_EQ(defaults.blend_crossing_time_alignment, options.blend_crossing_time_alignment);
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "unittest_generator_options_aggregator");
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
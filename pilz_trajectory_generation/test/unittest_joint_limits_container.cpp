@@ -43,6 +43,8 @@ class JointLimitsContainerTest : public ::testing::Test
     pilz_extensions::JointLimit lim3;
     lim3.has_velocity_limits = true;
     lim3.max_velocity = 10;
+    lim3.has_jerk_limits = true;
+    lim3.max_jerk = 20;                   //<- Expected for common_limit_.max_jerk
 
     pilz_extensions::JointLimit lim4;
     lim4.has_position_limits = true;
@@ -65,6 +67,8 @@ class JointLimitsContainerTest : public ::testing::Test
     lim6.max_velocity = 2;                //<- Expected for common_limit_.max_velocity
     lim6.has_deceleration_limits = true;
     lim6.max_deceleration = -100;
+    lim6.has_jerk_limits = true;
+    lim6.max_jerk = 50;
 
 
     container_.addLimit("joint1", lim1);
@@ -119,6 +123,15 @@ TEST_F(JointLimitsContainerTest, CheckDecelerationUnification)
   EXPECT_EQ(-5, common_limit_.max_deceleration);
 }
 
+/**
+ * @brief Check jerk
+ */
+TEST_F(JointLimitsContainerTest, CheckJerkUnification)
+{
+  EXPECT_TRUE(common_limit_.has_jerk_limits);
+  EXPECT_EQ(20, common_limit_.max_jerk);
+}
+
 /**
  * @brief Check AddLimit for positive and null deceleration
  */
@@ -154,6 +167,7 @@ TEST_F(JointLimitsContainerTest, CheckEmptyContainer)
   EXPECT_FALSE(limits.has_position_limits);
   EXPECT_FALSE(limits.has_velocity_limits);
   EXPECT_FALSE(limits.has_acceleration_limits);
+  EXPECT_FALSE(limits.has_jerk_limits);
 }
 
 /**
@@ -198,6 +212,27 @@ TEST_F(JointLimitsContainerTest, CheckVerifyPositionLimits)
                std::out_of_range);
 }
 
+/**
+ * @brief Check that the limits of multiple joints are returned in the requested order
+ */
+TEST_F(JointLimitsContainerTest, CheckGetLimits)
+{
+  std::vector<std::string> joint_names {"joint6", "joint1", "unknown_joint"};
+  std::vector<pilz_extensions::JointLimit> limits = container_.getLimits(joint_names);
+  ASSERT_EQ(3u, limits.size());
+
+  EXPECT_TRUE(limits[0].has_velocity_limits);
+  EXPECT_EQ(2, limits[0].max_velocity);
+  EXPECT_TRUE(limits[1].has_acceleration_limits);
+  EXPECT_EQ(3, limits[1].max_acceleration);
+
+  // unknown joint is not limited
+  EXPECT_FALSE(limits[2].has_position_limits);
+  EXPECT_FALSE(limits[2].has_velocity_limits);
+  EXPECT_FALSE(limits[2].has_acceleration_limits);
+  EXPECT_FALSE(limits[2].has_deceleration_limits);
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/conversions.h>
+
+#include "pilz_trajectory_generation/plan_cache.h"
+
+const std::string PARAM_PLANNING_GROUP_NAME("planning_group");
+
+/**
+ * @brief Unittest of the PlanCache class
+ */
+class PlanCacheTest : public ::testing::Test
+{
+protected:
+
+  virtual void SetUp()
+  {
+    ASSERT_FALSE(robot_model_ == nullptr) << "There is no robot model!";
+    ASSERT_TRUE(ph_.getParam(PARAM_PLANNING_GROUP_NAME, planning_group_));
+    joint_names_ = robot_model_->getJointModelGroup(planning_group_)->getActiveJointModelNames();
+  }
+
+  /**
+   * @brief create a PTP request with a joint goal
+   */
+  planning_interface::MotionPlanRequest createRequest(double start_offset = 0.) const
+  {
+    planning_interface::MotionPlanRequest req;
+    req.planner_id = "PTP";
+    req.group_name = planning_group_;
+    req.max_velocity_scaling_factor = 0.5;
+    req.max_acceleration_scaling_factor = 0.5;
+
+    req.start_state.joint_state.name = joint_names_;
+    req.start_state.joint_state.position.assign(joint_names_.size(), 0.1 + start_offset);
+
+    moveit_msgs::Constraints goal;
+    for(const auto& name : joint_names_)
+    {
+      moveit_msgs::JointConstraint joint_constraint;
+      joint_constraint.joint_name = name;
+      joint_constraint.position = 0.5;
+      goal.joint_constraints.push_back(joint_constraint);
+    }
+    req.goal_constraints.push_back(goal);
+    return req;
+  }
+
+  /**
+   * @brief create a successful response with a trajectory of the given number of way points
+   */
+  planning_interface::MotionPlanResponse createResponse(std::size_t way_point_count) const
+  {
+    planning_interface::MotionPlanResponse res;
+    res.trajectory_.reset(new robot_trajectory::RobotTrajectory(robot_model_, planning_group_));
+    for(std::size_t i = 0; i < way_point_count; ++i)
+    {
+      robot_state::RobotStatePtr state(new robot_state::RobotState(robot_model_));
+      state->setToDefaultValues();
+      state->setJointGroupPositions(planning_group_, std::vector<double>(joint_names_.size(), 0.01*i));
+      res.trajectory_->addSuffixWayPoint(state, 0.008);
+    }
+    res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+    return res;
+  }
+
+protected:
+  ros::NodeHandle ph_ {"~"};
+  robot_model::RobotModelConstPtr robot_model_ {robot_model_loader::RobotModelLoader("robot_description").getModel()};
+  std::string planning_group_;
+  std::vector<std::string> joint_names_;
+};
+
+/**
+ * @brief Check that a cache without capacity or with a non-positive resolution can not be created
+ */
+TEST_F(PlanCacheTest, InvalidConstruction)
+{
+  EXPECT_THROW(pilz::PlanCache(0, 1e-4), std::invalid_argument);
+  EXPECT_THROW(pilz::PlanCache(10, 0.), std::invalid_argument);
+  EXPECT_THROW(pilz::PlanCache(10, -1e-4), std::invalid_argument);
+}
+
+/**
+ * @brief Check that start states which only differ below the joint resolution share a key
+ */
+TEST_F(PlanCacheTest, KeyQuantizesStartState)
+{
+  pilz::PlanCache cache(10, 1e-3);
+  const std::string key = cache.computeKey(createRequest());
+
+  EXPECT_EQ(key, cache.computeKey(createRequest(1e-4)));
+  EXPECT_NE(key, cache.computeKey(createRequest(1e-2)));
+
+  // the order of the joints in the start state does not matter
+  planning_interface::MotionPlanRequest reversed = createRequest();
+  std::reverse(reversed.start_state.joint_state.name.begin(), reversed.start_state.joint_state.name.end());
+  EXPECT_EQ(key, cache.computeKey(reversed));
+
+  // a missing start velocity is the same as zero velocity
+  planning_interface::MotionPlanRequest with_velocity = createRequest();
+  with_velocity.start_state.joint_state.velocity.assign(joint_names_.size(), 0.);
+  EXPECT_EQ(key, cache.computeKey(with_velocity));
+  with_velocity.start_state.joint_state.velocity.front() = 0.1;
+  EXPECT_NE(key, cache.computeKey(with_velocity));
+
+  // the velocities are not quantized with the joint resolution
+  with_velocity.start_state.joint_state.velocity.front() = 1e-4;
+  EXPECT_NE(key, cache.computeKey(with_velocity));
+}
+
+/**
+ * @brief Check that the planner id, scaling factors and goal are part of the key
+ */
+TEST_F(PlanCacheTest, KeyDistinguishesRequests)
+{
+  pilz::PlanCache cache(10, 1e-3);
+  const std::string key = cache.computeKey(createRequest());
+
+  planning_interface::MotionPlanRequest req = createRequest();
+  req.planner_id = "LIN";
+  EXPECT_NE(key, cache.computeKey(req));
+
+  req = createRequest();
+  req.max_velocity_scaling_factor = 0.4;
+  EXPECT_NE(key, cache.computeKey(req));
+
+  req = createRequest();
+  req.max_acceleration_scaling_factor = 0.4;
+  EXPECT_NE(key, cache.computeKey(req));
+
+  // goals are not quantized
+  req = createRequest();
+  req.goal_constraints.front().joint_constraints.front().position += 1e-6;
+  EXPECT_NE(key, cache.computeKey(req));
+
+  // the tolerances of the goal are part of the key
+  req = createRequest();
+  req.goal_constraints.front().joint_constraints.front().tolerance_above = 0.01;
+  EXPECT_NE(key, cache.computeKey(req));
+
+  req = createRequest();
+  req.goal_constraints.front().joint_constraints.front().tolerance_below = 0.01;
+  EXPECT_NE(key, cache.computeKey(req));
+
+  req = createRequest();
+  moveit_msgs::PositionConstraint aux_point;
+  aux_point.constraint_region.primitive_poses.resize(1);
+  req.path_constraints.position_constraints.push_back(aux_point);
+  EXPECT_NE(key, cache.computeKey(req));
+}
+
+/**
+ * @brief Check a miss, a hit and the counters
+ */
+TEST_F(PlanCacheTest, MissAndHit)
+{
+  pilz::PlanCache cache(10, 1e-4);
+  const std::string key = cache.computeKey(createRequest());
+
+  planning_interface::MotionPlanResponse res;
+  EXPECT_FALSE(cache.lookup(key, res));
+  EXPECT_FALSE(res.trajectory_);
+  EXPECT_EQ(0u, cache.hits());
+  EXPECT_EQ(1u, cache.misses());
+
+  planning_interface::MotionPlanResponse planned = createResponse(5);
+  cache.insert(key, planned);
+  EXPECT_EQ(1u, cache.size());
+
+  ASSERT_TRUE(cache.lookup(key, res));
+  EXPECT_EQ(1u, cache.hits());
+  EXPECT_EQ(1u, cache.misses());
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val);
+  ASSERT_TRUE(res.trajectory_);
+  EXPECT_NE(planned.trajectory_, res.trajectory_);
+  ASSERT_EQ(planned.trajectory_->getWayPointCount(), res.trajectory_->getWayPointCount());
+  EXPECT_EQ(planned.trajectory_->getGroupName(), res.trajectory_->getGroupName());
+  for(std::size_t i = 0; i < res.trajectory_->getWayPointCount(); ++i)
+  {
+    EXPECT_EQ(planned.trajectory_->getWayPointDurationFromPrevious(i),
+              res.trajectory_->getWayPointDurationFromPrevious(i));
+    EXPECT_TRUE(planned.trajectory_->getWayPoint(i).distance(res.trajectory_->getWayPoint(i)) == 0.);
+  }
+}
+
+/**
+ * @brief Check that a hit for a start state which differs below the joint resolution starts at that state
+ */
+TEST_F(PlanCacheTest, HitRebasesStartState)
+{
+  pilz::PlanCache cache(10, 1e-2);
+  const planning_interface::MotionPlanRequest req = createRequest(0.002);
+  const std::string key = cache.computeKey(req);
+  ASSERT_EQ(cache.computeKey(createRequest()), key);
+
+  const std::string link_name = robot_model_->getJointModelGroup(planning_group_)->getLinkModelNames().back();
+  planning_interface::MotionPlanResponse planned = createResponse(5);
+  std::shared_ptr<pilz::TipPoseTrack> track = std::make_shared<pilz::TipPoseTrack>();
+  track->link_name = link_name;
+  for(std::size_t i = 0; i < planned.trajectory_->getWayPointCount(); ++i)
+  {
+    track->poses.push_back(planned.trajectory_->getWayPointPtr(i)->getFrameTransform(link_name));
+  }
+  pilz::GeneratedTrajectoryInfo planned_info;
+  planned_info.tip_pose_track = track;
+  cache.insert(key, planned, planned_info);
+
+  planning_interface::MotionPlanResponse res;
+  pilz::GeneratedTrajectoryInfo info;
+  ASSERT_TRUE(cache.lookup(key, req.start_state, res, info));
+  ASSERT_EQ(planned.trajectory_->getWayPointCount(), res.trajectory_->getWayPointCount());
+
+  std::vector<double> first_positions;
+  res.trajectory_->getFirstWayPoint().copyJointGroupPositions(planning_group_, first_positions);
+  for(double position : first_positions)
+  {
+    EXPECT_DOUBLE_EQ(0.102, position);
+  }
+  for(std::size_t i = 1; i < res.trajectory_->getWayPointCount(); ++i)
+  {
+    EXPECT_TRUE(planned.trajectory_->getWayPoint(i).distance(res.trajectory_->getWayPoint(i)) == 0.);
+  }
+
+  ASSERT_TRUE(info.tip_pose_track);
+  EXPECT_TRUE(info.tip_pose_track->poses.front().isApprox(
+                res.trajectory_->getFirstWayPointPtr()->getFrameTransform(link_name)));
+  EXPECT_TRUE(track->poses.front().isApprox(
+                planned.trajectory_->getFirstWayPointPtr()->getFrameTransform(link_name)));
+}
+
+/**
+ * @brief Check that modifying a returned or inserted trajectory does not change the cache
+ */
+TEST_F(PlanCacheTest, CopiesTrajectories)
+{
+  pilz::PlanCache cache(10, 1e-4);
+  const std::string key = cache.computeKey(createRequest());
+
+  planning_interface::MotionPlanResponse planned = createResponse(5);
+  cache.insert(key, planned);
+  planned.trajectory_->clear();
+
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(cache.lookup(key, res));
+  EXPECT_EQ(5u, res.trajectory_->getWayPointCount());
+  res.trajectory_->clear();
+
+  ASSERT_TRUE(cache.lookup(key, res));
+  EXPECT_EQ(5u, res.trajectory_->getWayPointCount());
+}
+
+/**
+ * @brief Check that failed responses are not cached
+ */
+TEST_F(PlanCacheTest, FailedResponseNotCached)
+{
+  pilz::PlanCache cache(10, 1e-4);
+  const std::string key = cache.computeKey(createRequest());
+
+  planning_interface::MotionPlanResponse failed = createResponse(5);
+  failed.error_code_.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+  cache.insert(key, failed);
+  EXPECT_EQ(0u, cache.size());
+
+  planning_interface::MotionPlanResponse res;
+  EXPECT_FALSE(cache.lookup(key, res));
+}
+
+/**
+ * @brief Check that the least recently used entry is evicted if the cache is full
+ */
+TEST_F(PlanCacheTest, LeastRecentlyUsedEviction)
+{
+  pilz::PlanCache cache(2, 1e-4);
+  const std::string key_1 = cache.computeKey(createRequest(0.1));
+  const std::string key_2 = cache.computeKey(createRequest(0.2));
+  const std::string key_3 = cache.computeKey(createRequest(0.3));
+
+  cache.insert(key_1, createResponse(1));
+  cache.insert(key_2, createResponse(2));
+
+  // use the first entry, the second one becomes the least recently used
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(cache.lookup(key_1, res));
+
+  cache.insert(key_3, createResponse(3));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.lookup(key_1, res));
+  EXPECT_EQ(1u, res.trajectory_->getWayPointCount());
+  EXPECT_FALSE(cache.lookup(key_2, res));
+  EXPECT_TRUE(cache.lookup(key_3, res));
+  EXPECT_EQ(3u, res.trajectory_->getWayPointCount());
+}
+
+/**
+ * @brief Check that clear removes all entries but keeps the counters
+ */
+TEST_F(PlanCacheTest, Clear)
+{
+  pilz::PlanCache cache(10, 1e-4);
+  const std::string key = cache.computeKey(createRequest());
+  cache.insert(key, createResponse(5));
+
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(cache.lookup(key, res));
+
+  cache.clear();
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.lookup(key, res));
+  EXPECT_EQ(1u, cache.hits());
+  EXPECT_EQ(1u, cache.misses());
+}
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "unittest_plan_cache");
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -91,19 +91,18 @@ protected:
     cartesian_limit.setMaxTranslationalDeceleration(1.0*M_PI);
     cartesian_limit.setMaxTranslationalVelocity(1.0*M_PI);
 
-    pilz::LimitsContainer limits;
-    limits.setJointLimits(joint_limits);
-    limits.setCartesianLimits(cartesian_limit);
+    limits_.setJointLimits(joint_limits);
+    limits_.setCartesianLimits(cartesian_limit);
 
-    planning_context_ = std::unique_ptr<typename T::Type_>(new typename T::Type_("TestPlanningContext", "TestGroup", robot_model_, limits));
+    planning_context_ = std::unique_ptr<typename T::Type_>(new typename T::Type_("TestPlanningContext", "TestGroup", robot_model_, limits_));
 
     // Define and set the current scene
-    planning_scene::PlanningScenePtr scene(new planning_scene::PlanningScene(robot_model_));
+    scene_.reset(new planning_scene::PlanningScene(robot_model_));
     robot_state::RobotState currentState(robot_model_);
     currentState.setToDefaultValues();
     currentState.setJointGroupPositions(planning_group_, {0, 1.57, 1.57, 0, 0.2, 0});
-    scene->setCurrentState(currentState);
-    planning_context_->setPlanningScene(scene); // TODO Check what happens if this is missing
+    scene_->setCurrentState(currentState);
+    planning_context_->setPlanningScene(scene_); // TODO Check what happens if this is missing
   }
 
   /**
@@ -161,6 +160,8 @@ protected:
   robot_model::RobotModelConstPtr robot_model_ {
     robot_model_loader::RobotModelLoader(!T::Value_ ? PARAM_MODEL_NO_GRIPPER_NAME: PARAM_MODEL_WITH_GRIPPER_NAME).getModel()};
 
+  pilz::LimitsContainer limits_;
+  planning_scene::PlanningScenePtr scene_;
   std::unique_ptr<planning_interface::PlanningContext> planning_context_;
 
   std::string planning_group_, target_link_;
@@ -222,6 +223,43 @@ TYPED_TEST(PlanningContextTest, SolveValidRequestDetailedResponse)
   EXPECT_TRUE(result) << testutils::demangel(typeid(TypeParam).name());
   EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res.error_code_.val)
       << testutils::demangel(typeid(TypeParam).name());
+
+  // the scaling factors of the request are kept, no achieved factors are reported
+  ASSERT_FALSE(res.description_.empty()) << testutils::demangel(typeid(TypeParam).name());
+  EXPECT_EQ("plan", res.description_.front()) << testutils::demangel(typeid(TypeParam).name());
+}
+
+/**
+ * @brief Solve a valid request twice with a plan cache. Expect the second trajectory from the cache.
+ */
+TYPED_TEST(PlanningContextTest, SolveCachedRequest)
+{
+  pilz::PlanCachePtr plan_cache = std::make_shared<pilz::PlanCache>(10, 1e-4);
+  this->planning_context_.reset(new typename TypeParam::Type_("TestPlanningContext", "TestGroup", this->robot_model_,
+                                                              this->limits_, pilz::GeneratorOptions(), plan_cache));
+  this->planning_context_->setPlanningScene(this->scene_);
+
+  planning_interface::MotionPlanRequest req  = this->getValidRequest(testutils::demangel(typeid(TypeParam).name()));
+  this->planning_context_->setMotionPlanRequest(req);
+
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(this->planning_context_->solve(res)) << testutils::demangel(typeid(TypeParam).name());
+  EXPECT_EQ(0u, plan_cache->hits());
+  EXPECT_EQ(1u, plan_cache->misses());
+  EXPECT_EQ(1u, plan_cache->size());
+
+  // the generation results are cached with the trajectory
+  auto context = dynamic_cast<typename TypeParam::Type_*>(this->planning_context_.get());
+  ASSERT_NE(nullptr, context);
+  planning_interface::MotionPlanResponse res_cached;
+  pilz::GeneratedTrajectoryInfo info;
+  ASSERT_TRUE(context->solve(res_cached, info)) << testutils::demangel(typeid(TypeParam).name());
+  EXPECT_EQ(1u, plan_cache->hits());
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res_cached.error_code_.val);
+  ASSERT_EQ(res.trajectory_->getWayPointCount(), res_cached.trajectory_->getWayPointCount());
+  EXPECT_DOUBLE_EQ(res.trajectory_->getDuration(), res_cached.trajectory_->getDuration());
+  EXPECT_EQ(req.max_velocity_scaling_factor, info.scaling.velocity_scaling_factor);
+  EXPECT_EQ(req.max_acceleration_scaling_factor, info.scaling.acceleration_scaling_factor);
 }
 
 /**
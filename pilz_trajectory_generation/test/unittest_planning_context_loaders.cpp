@@ -95,6 +95,8 @@ INSTANTIATE_TEST_CASE_P(InstantiationName, PlanningContextLoadersTest, ::testing
                           std::vector<std::string>{"pilz::PlanningContextLoaderPTP", "PTP", PARAM_MODEL_WITH_GRIPPER_NAME}, // Test for PTP
                           std::vector<std::string>{"pilz::PlanningContextLoaderLIN", "LIN", PARAM_MODEL_NO_GRIPPER_NAME}, // Test for LIN
                           std::vector<std::string>{"pilz::PlanningContextLoaderLIN", "LIN", PARAM_MODEL_WITH_GRIPPER_NAME}, // Test for LIN
+                          std::vector<std::string>{"pilz::PlanningContextLoaderLINApprox", "LIN_APPROX", PARAM_MODEL_NO_GRIPPER_NAME}, // Test for LIN_APPROX
+                          std::vector<std::string>{"pilz::PlanningContextLoaderLINApprox", "LIN_APPROX", PARAM_MODEL_WITH_GRIPPER_NAME}, // Test for LIN_APPROX
                           std::vector<std::string>{"pilz::PlanningContextLoaderCIRC", "CIRC", PARAM_MODEL_NO_GRIPPER_NAME}, // Test for CIRC
                           std::vector<std::string>{"pilz::PlanningContextLoaderCIRC", "CIRC", PARAM_MODEL_WITH_GRIPPER_NAME} // Test for CIRC
                           ));
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "pilz_trajectory_generation/thread_pool.h"
+
+/**
+ * @brief Test that all tasks of a group are executed by the workers of the pool
+ */
+TEST(ThreadPoolTest, RunAllTasks)
+{
+  pilz::ThreadPool pool(4);
+  EXPECT_EQ(4u, pool.size());
+
+  std::atomic<int> count {0};
+  pilz::TaskGroup group(&pool);
+  for(int i = 0; i < 1000; ++i)
+  {
+    group.run([&count]{ ++count; });
+  }
+  group.wait();
+  EXPECT_EQ(1000, count);
+}
+
+/**
+ * @brief Test that the number of hardware threads is used by default
+ */
+TEST(ThreadPoolTest, DefaultSize)
+{
+  pilz::ThreadPool pool;
+  EXPECT_EQ(std::max(1u, std::thread::hardware_concurrency()), pool.size());
+}
+
+/**
+ * @brief Test that groups waiting inside tasks do not block a pool with a single worker
+ */
+TEST(ThreadPoolTest, NestedGroups)
+{
+  pilz::ThreadPool pool(1);
+
+  std::atomic<int> count {0};
+  pilz::TaskGroup outer(&pool);
+  for(int i = 0; i < 4; ++i)
+  {
+    outer.run([&pool, &count]
+    {
+      pilz::TaskGroup inner(&pool);
+      for(int j = 0; j < 4; ++j)
+      {
+        inner.run([&count]{ ++count; });
+      }
+      inner.wait();
+    });
+  }
+  outer.wait();
+  EXPECT_EQ(16, count);
+}
+
+/**
+ * @brief Test that tasks which have not started are skipped after the group is cancelled
+ */
+TEST(ThreadPoolTest, Cancel)
+{
+  pilz::ThreadPool pool(1);
+
+  std::atomic<bool> release {false};
+  std::atomic<int> count {0};
+  pilz::TaskGroup group(&pool);
+  group.run([&release]
+  {
+    while(!release)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  for(int i = 0; i < 10; ++i)
+  {
+    group.run([&count]{ ++count; });
+  }
+
+  group.cancel();
+  EXPECT_TRUE(group.isCancelled());
+  group.run([&count]{ ++count; });
+  release = true;
+  group.wait();
+  EXPECT_EQ(0, count);
+}
+
+/**
+ * @brief Test that the exception of a task cancels the group and is rethrown by wait()
+ */
+TEST(ThreadPoolTest, Exception)
+{
+  pilz::ThreadPool pool(2);
+
+  pilz::TaskGroup group(&pool);
+  group.run([]{ throw std::runtime_error("task failed"); });
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  EXPECT_TRUE(group.isCancelled());
+  EXPECT_NO_THROW(group.wait());
+}
+
+/**
+ * @brief Test that the tasks of a group without pool are executed on the calling thread
+ */
+TEST(ThreadPoolTest, NoPool)
+{
+  const std::thread::id caller = std::this_thread::get_id();
+  int count {0};
+  pilz::TaskGroup group(nullptr);
+  for(int i = 0; i < 3; ++i)
+  {
+    group.run([&count, caller]
+    {
+      EXPECT_EQ(caller, std::this_thread::get_id());
+      ++count;
+    });
+  }
+  group.wait();
+  EXPECT_EQ(3, count);
+}
+
+/**
+ * @brief Test that queued tasks are executed before the pool is destroyed
+ */
+TEST(ThreadPoolTest, DestroyWithQueuedTasks)
+{
+  std::atomic<int> count {0};
+  {
+    pilz::ThreadPool pool(2);
+    for(int i = 0; i < 100; ++i)
+    {
+      pool.submit([&count]{ ++count; });
+    }
+  }
+  EXPECT_EQ(100, count);
+}
+
+/**
+ * @brief Test that a waiting group only executes its own tasks and leaves the tasks of other groups to the workers
+ */
+TEST(ThreadPoolTest, WaitRunsOnlyOwnTasks)
+{
+  pilz::ThreadPool pool(1);
+
+  // keep the single worker busy
+  std::atomic<bool> started {false};
+  std::atomic<bool> release {false};
+  pilz::TaskGroup blocking(&pool);
+  blocking.run([&started, &release]
+  {
+    started = true;
+    while(!release)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  while(!started)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::atomic<int> foreign_count {0};
+  pilz::TaskGroup foreign(&pool);
+  foreign.run([&foreign_count]{ ++foreign_count; });
+
+  std::atomic<int> own_count {0};
+  pilz::TaskGroup own(&pool);
+  own.run([&own_count]{ ++own_count; });
+  own.wait();
+
+  EXPECT_EQ(1, own_count);
+  EXPECT_EQ(0, foreign_count);
+
+  release = true;
+  blocking.wait();
+  foreign.wait();
+  EXPECT_EQ(1, foreign_count);
+}
+
+/**
+ * @brief Test that all users of the process get the same pool while it is alive
+ */
+TEST(ThreadPoolTest, SharedPool)
+{
+  pilz::ThreadPoolPtr first = pilz::ThreadPool::getSharedPool(2);
+  pilz::ThreadPoolPtr second = pilz::ThreadPool::getSharedPool(3);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(2u, second->size());
+
+  first.reset();
+  second.reset();
+  pilz::ThreadPoolPtr third = pilz::ThreadPool::getSharedPool(3);
+  EXPECT_EQ(3u, third->size());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
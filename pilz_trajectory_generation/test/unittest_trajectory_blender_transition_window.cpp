@@ -370,6 +370,102 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, searchIntersectionPoint)
 
 }
 
+/**
+ * @brief Tests that the bisection search for intersection points finds the same points as the linear search.
+ *
+ * Test Sequence:
+ *    1. Generate two linear trajectories from the test data set.
+ *    2. Search the intersection points with both searches for several blending radii.
+ *
+ *    3. Search the intersection points with both searches for blending radii which equal the distance of a way point
+ *       to the center.
+ *
+ * Expected Results:
+ *    1. Two linear trajectories generated, both carry a tip pose track.
+ *    2. Both searches find the same indices, the crossing time lies between the intersection point and its
+ *       neighbour outside of the sphere.
+ *    3. Both searches find the same indices.
+ */
+TEST_P(TrajectoryBlenderTransitionWindowTest, searchIntersectionPointBisection)
+{
+  auto test_data = test_data_.front();
+  planning_interface::MotionPlanResponse res_lin_1, res_lin_2;
+  pilz::GeneratedTrajectoryInfo info_lin_1, info_lin_2;
+  double dis_lin_1, dis_lin_2;
+  ASSERT_TRUE(testutils::generateTrajFromBlendTestData(robot_model_,
+                                                       lin_,
+                                                       planning_group_,
+                                                       target_link_,
+                                                       test_data,
+                                                       sampling_time_, sampling_time_,
+                                                       res_lin_1, res_lin_2,
+                                                       dis_lin_1, dis_lin_2,
+                                                       &info_lin_1, &info_lin_2))
+      << "Failed to generate LIN trajectories from test data";
+
+  // search for the link of the tip pose track, the generator samples the tip frame of the solver for joint goals
+  ASSERT_TRUE(info_lin_1.tip_pose_track);
+  const std::string link_name = info_lin_1.tip_pose_track->link_name;
+  ASSERT_TRUE(pilz::TipPoseLookup(res_lin_1.trajectory_, link_name, info_lin_1.tip_pose_track).hasTrack());
+  ASSERT_TRUE(pilz::TipPoseLookup(res_lin_2.trajectory_, link_name, info_lin_2.tip_pose_track).hasTrack());
+
+  robot_state::RobotState intersection_state(robot_model_);
+  intersection_state.setJointGroupPositions(planning_group_, test_data.mid_position);
+  const Eigen::Vector3d center = intersection_state.getFrameTransform(link_name).translation();
+
+  for(double scale : {0.01, 0.1, 0.3, 0.5, 0.9, 1.2})
+  {
+    std::size_t linear_index, index;
+    double crossing_time;
+
+    bool linear_found = pilz::linearSearchIntersectionPoint(link_name, center, scale*dis_lin_1,
+                                                            res_lin_1.trajectory_, true, linear_index);
+    ASSERT_EQ(linear_found, pilz::searchIntersectionPoint(link_name, center, scale*dis_lin_1,
+                                                          res_lin_1.trajectory_, true, index, crossing_time,
+                                                          info_lin_1.tip_pose_track))
+        << "scale: " << scale;
+    if(linear_found)
+    {
+      EXPECT_EQ(linear_index, index) << "scale: " << scale;
+      EXPECT_LE(res_lin_1.trajectory_->getWayPointDurationFromStart(index-1), crossing_time + other_tolerance_);
+      EXPECT_GE(res_lin_1.trajectory_->getWayPointDurationFromStart(index), crossing_time - other_tolerance_);
+    }
+
+    linear_found = pilz::linearSearchIntersectionPoint(link_name, center, scale*dis_lin_2,
+                                                       res_lin_2.trajectory_, false, linear_index);
+    ASSERT_EQ(linear_found, pilz::searchIntersectionPoint(link_name, center, scale*dis_lin_2,
+                                                          res_lin_2.trajectory_, false, index, crossing_time,
+                                                          info_lin_2.tip_pose_track))
+        << "scale: " << scale;
+    if(linear_found)
+    {
+      EXPECT_EQ(linear_index, index) << "scale: " << scale;
+      EXPECT_LE(res_lin_2.trajectory_->getWayPointDurationFromStart(index), crossing_time + other_tolerance_);
+      EXPECT_GE(res_lin_2.trajectory_->getWayPointDurationFromStart(index+1), crossing_time - other_tolerance_);
+    }
+  }
+
+  // way points exactly on the sphere count as inside and as outside for both searches
+  const pilz::PoseVector& poses = info_lin_2.tip_pose_track->poses;
+  for(std::size_t k : {std::size_t(1), poses.size() / 3, poses.size() / 2, poses.size() - 2})
+  {
+    const double r = (poses.at(k).translation() - center).norm();
+    std::size_t linear_index, index;
+    double crossing_time;
+
+    bool linear_found = pilz::linearSearchIntersectionPoint(link_name, center, r,
+                                                            res_lin_2.trajectory_, false, linear_index);
+    ASSERT_EQ(linear_found, pilz::searchIntersectionPoint(link_name, center, r,
+                                                          res_lin_2.trajectory_, false, index, crossing_time,
+                                                          info_lin_2.tip_pose_track))
+        << "way point: " << k;
+    if(linear_found)
+    {
+      EXPECT_EQ(linear_index, index) << "way point: " << k;
+    }
+  }
+}
+
 /**
  * @brief  Tests the blending of two cartesian linear trajectories using robot model
  * The test sequence is repeated twice, using robot model with and without gripper
@@ -428,6 +524,151 @@ TEST_P(TrajectoryBlenderTransitionWindowTest, testLINLINBlending)
 
 }
 
+/**
+ * @brief Tests that the blending with the tip pose tracks of the generator gives the same result as without.
+ *
+ * Test Sequence:
+ *    1. Generate two linear trajectories from the test data set.
+ *    2. Blend them without and with the tip pose tracks of the generator.
+ *
+ * Expected Results:
+ *    1. Two linear trajectories generated, both come with a tip pose track.
+ *    2. Both blendings result in the same trajectories, the tracks of the response match their trajectories.
+ */
+TEST_P(TrajectoryBlenderTransitionWindowTest, testLINLINBlendingTipPoseTracks)
+{
+  auto test_data = test_data_.front();
+  planning_interface::MotionPlanResponse res_lin_1, res_lin_2;
+  pilz::GeneratedTrajectoryInfo info_lin_1, info_lin_2;
+  double dis_lin_1, dis_lin_2;
+  ASSERT_TRUE(testutils::generateTrajFromBlendTestData(robot_model_,
+                                                       lin_,
+                                                       planning_group_,
+                                                       target_link_,
+                                                       test_data,
+                                                       sampling_time_, sampling_time_,
+                                                       res_lin_1, res_lin_2,
+                                                       dis_lin_1, dis_lin_2,
+                                                       &info_lin_1, &info_lin_2))
+      << "Failed to generate LIN trajectories from test data";
+  ASSERT_TRUE(info_lin_1.tip_pose_track);
+  ASSERT_TRUE(info_lin_2.tip_pose_track);
+
+  pilz::TrajectoryBlendRequest blend_req;
+  blend_req.group_name = planning_group_;
+  blend_req.link_name = info_lin_1.tip_pose_track->link_name;
+  blend_req.blend_radius = dis_lin_1 > dis_lin_2 ? 0.5*dis_lin_2 : 0.5*dis_lin_1;
+  blend_req.first_trajectory = res_lin_1.trajectory_;
+  blend_req.second_trajectory = res_lin_2.trajectory_;
+
+  pilz::TrajectoryBlendResponse fk_res;
+  ASSERT_TRUE(blender_->blend(blend_req, fk_res));
+  EXPECT_FALSE(fk_res.first_tip_pose_track);
+  EXPECT_FALSE(fk_res.second_tip_pose_track);
+
+  blend_req.first_tip_pose_track = info_lin_1.tip_pose_track;
+  blend_req.second_tip_pose_track = info_lin_2.tip_pose_track;
+  pilz::TrajectoryBlendResponse track_res;
+  ASSERT_TRUE(blender_->blend(blend_req, track_res));
+
+  const std::vector<std::pair<robot_trajectory::RobotTrajectoryPtr, robot_trajectory::RobotTrajectoryPtr> > pairs {
+    {fk_res.first_trajectory, track_res.first_trajectory},
+    {fk_res.blend_trajectory, track_res.blend_trajectory},
+    {fk_res.second_trajectory, track_res.second_trajectory}};
+  for(const auto& pair : pairs)
+  {
+    ASSERT_EQ(pair.first->getWayPointCount(), pair.second->getWayPointCount());
+    for(std::size_t i = 0; i < pair.first->getWayPointCount(); ++i)
+    {
+      EXPECT_TRUE(pilz::isRobotStateEqual(pair.first->getWayPointPtr(i), pair.second->getWayPointPtr(i),
+                                          planning_group_, other_tolerance_));
+    }
+  }
+
+  const std::vector<std::pair<robot_trajectory::RobotTrajectoryPtr, pilz::TipPoseTrackConstPtr> > tracks {
+    {track_res.first_trajectory, track_res.first_tip_pose_track},
+    {track_res.blend_trajectory, track_res.blend_tip_pose_track},
+    {track_res.second_trajectory, track_res.second_tip_pose_track}};
+  // the tracks hold the target poses of the inverse kinematics
+  const double pose_tolerance = 1e-4;
+  for(const auto& track : tracks)
+  {
+    ASSERT_TRUE(track.second);
+    ASSERT_EQ(track.first->getWayPointCount(), track.second->poses.size());
+    for(std::size_t i = 0; i < track.first->getWayPointCount(); ++i)
+    {
+      EXPECT_TRUE(track.second->poses[i].isApprox(
+                    track.first->getWayPointPtr(i)->getFrameTransform(blend_req.link_name), pose_tolerance));
+    }
+  }
+}
+
+/**
+ * @brief Tests that the blender aligns the trajectories by the times of the intersection points by default.
+ *
+ * Test Sequence:
+ *    1. Generate two linear trajectories from the test data set.
+ *    2. Blend them for several radii with the default blender and with crossing time alignment.
+ *
+ * Expected Results:
+ *    1. Two linear trajectories generated.
+ *    2. The blend trajectories of the default blender have the length given by the alignment of the intersection
+ *       points. With crossing time alignment, the blending succeeds as well.
+ */
+TEST_P(TrajectoryBlenderTransitionWindowTest, testLINLINBlendingSampleAlignment)
+{
+  auto test_data = test_data_.front();
+  planning_interface::MotionPlanResponse res_lin_1, res_lin_2;
+  double dis_lin_1, dis_lin_2;
+  ASSERT_TRUE(testutils::generateTrajFromBlendTestData(robot_model_,
+                                                       lin_,
+                                                       planning_group_,
+                                                       target_link_,
+                                                       test_data,
+                                                       sampling_time_, sampling_time_,
+                                                       res_lin_1, res_lin_2,
+                                                       dis_lin_1, dis_lin_2))
+      << "Failed to generate LIN trajectories from test data";
+
+  const robot_trajectory::RobotTrajectoryPtr& traj_1 = res_lin_1.trajectory_;
+  const robot_trajectory::RobotTrajectoryPtr& traj_2 = res_lin_2.trajectory_;
+  const Eigen::Vector3d center = traj_1->getLastWayPoint().getFrameTransform(target_link_).translation();
+
+  TrajectoryBlenderTransitionWindow crossing_time_blender(planner_limits_, true);
+
+  for(double scale : {0.2, 0.35, 0.5})
+  {
+    pilz::TrajectoryBlendRequest blend_req;
+    blend_req.group_name = planning_group_;
+    blend_req.link_name = target_link_;
+    blend_req.blend_radius = scale * std::min(dis_lin_1, dis_lin_2);
+    blend_req.first_trajectory = traj_1;
+    blend_req.second_trajectory = traj_2;
+
+    // alignment of the intersection points as computed before the crossing times were introduced
+    std::size_t first_index, second_index;
+    ASSERT_TRUE(pilz::linearSearchIntersectionPoint(target_link_, center, blend_req.blend_radius, traj_1, true,
+                                                    first_index));
+    ASSERT_TRUE(pilz::linearSearchIntersectionPoint(target_link_, center, blend_req.blend_radius, traj_2, false,
+                                                    second_index));
+    const double tau_1 = traj_1->getWayPointDurationFromStart(traj_1->getWayPointCount()) -
+        traj_1->getWayPointDurationFromStart(first_index);
+    const double tau_2 = traj_2->getWayPointDurationFromStart(second_index);
+    const std::size_t align_index = tau_1 > tau_2 ? traj_1->getWayPointCount() - second_index - 1 : first_index;
+    const std::size_t expected_blend_samples = second_index + align_index - first_index + 1;
+
+    pilz::TrajectoryBlendResponse blend_res;
+    ASSERT_TRUE(blender_->blend(blend_req, blend_res)) << "scale: " << scale;
+    EXPECT_EQ(expected_blend_samples, blend_res.blend_trajectory->getWayPointCount()) << "scale: " << scale;
+    EXPECT_NEAR(expected_blend_samples * sampling_time_,
+                blend_res.blend_trajectory->getWayPointDurationFromStart(expected_blend_samples - 1),
+                other_tolerance_) << "scale: " << scale;
+
+    pilz::TrajectoryBlendResponse crossing_time_res;
+    EXPECT_TRUE(crossing_time_blender.blend(blend_req, crossing_time_res)) << "scale: " << scale;
+  }
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "unittest_trajectory_blender_transition_window");
@@ -21,6 +21,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <stdexcept>
 
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/robot_model/robot_model.h>
@@ -38,6 +39,7 @@
 #include <kdl/trajectory_segment.hpp>
 
 #include "pilz_trajectory_generation/trajectory_functions.h"
+#include "pilz_trajectory_generation/self_collision_checker.h"
 #include "pilz_trajectory_generation/limits_container.h"
 #include "pilz_trajectory_generation/cartesian_trajectory.h"
 #include "pilz_trajectory_generation/cartesian_trajectory_point.h"
@@ -417,6 +419,644 @@ TEST_P(TrajectoryFunctionsTest, testComputePoseIKInvalidFrameId)
                                    false));
 }
 
+/**
+ * @brief Test that one kinematics session can be reused for consecutive IK/FK computations
+ *
+ * Test Sequence:
+ *    1. Create a session and compute IK/FK of random states with it.
+ *
+ * Expected Results:
+ *    1. IK solutions reproduce the random poses, FK equals the pose of the random state.
+ */
+TEST_P(TrajectoryFunctionsTest, testKinematicsSessionReuse)
+{
+  robot_state::RobotState rstate(robot_model_);
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+  EXPECT_EQ(jmg, kinematics.getJointModelGroup());
+  EXPECT_EQ(tcp_link_, kinematics.getLinkName());
+
+  while(random_test_number_>0)
+  {
+    rstate.setToRandomPositions(jmg, rng_);
+    rstate.update();
+    Eigen::Affine3d pose_expect = rstate.getFrameTransform(tcp_link_);
+
+    std::map<std::string, double> ik_seed;
+    for(const auto& joint_name : jmg->getActiveJointModelNames())
+    {
+      double position = rstate.getVariablePosition(joint_name);
+      ik_seed[joint_name] = position > 0 ? position - IK_SEED_OFFSET : position + IK_SEED_OFFSET;
+    }
+
+    std::map<std::string, double> ik_actual;
+    ASSERT_TRUE(kinematics.solveIK(pose_expect, ik_seed, ik_actual));
+
+    Eigen::Affine3d pose_actual;
+    ASSERT_TRUE(kinematics.fk(ik_actual, pose_actual));
+    EXPECT_TRUE(tfNear(pose_expect, pose_actual, 4*EPSILON));
+
+    --random_test_number_;
+  }
+}
+
+/**
+ * @brief Test that the parallel IK of a pose sequence matches the sequential IK
+ *
+ * Test Sequence:
+ *    1. Create a continuous pose sequence by FK of a joint interpolation.
+ *    2. Solve the sequence sequentially and in parallel chunks.
+ *
+ * Expected Results:
+ *    1. -
+ *    2. Both succeed, the solutions are continuous and match each other.
+ */
+TEST_P(TrajectoryFunctionsTest, testComputePoseSequenceIKParallel)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToRandomPositions(jmg, rng_);
+  Eigen::VectorXd start, goal;
+  kinematics.toJointVector(rstate, start);
+  goal = 0.8*start; // stay within the joint limits
+
+  const std::size_t sample_count {400};
+  pilz::PoseVector poses(sample_count);
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    double s = static_cast<double>(k)/(sample_count - 1);
+    ASSERT_TRUE(kinematics.fk(start + s*(goal - start), poses[k]));
+  }
+
+  Eigen::VectorXd max_joint_step = Eigen::VectorXd::Constant(start.size(), 0.1);
+
+  pilz::GeneratorOptions sequential_options;
+  std::vector<Eigen::VectorXd> sequential_solutions;
+  ASSERT_TRUE(pilz::computePoseSequenceIK(kinematics, poses, start, max_joint_step, sequential_options,
+                                          sequential_solutions));
+
+  pilz::GeneratorOptions parallel_options;
+  parallel_options.thread_pool = std::make_shared<pilz::ThreadPool>(2);
+  parallel_options.parallel_ik = true;
+  parallel_options.parallel_ik_threads = 4;
+  parallel_options.parallel_ik_min_samples = 10;
+  std::vector<Eigen::VectorXd> parallel_solutions;
+  ASSERT_TRUE(pilz::computePoseSequenceIK(kinematics, poses, start, max_joint_step, parallel_options,
+                                          parallel_solutions));
+
+  ASSERT_EQ(sample_count, parallel_solutions.size());
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    EXPECT_LT((parallel_solutions[k] - sequential_solutions[k]).cwiseAbs().maxCoeff(), 4*IK_SEED_OFFSET);
+    if(k > 0)
+    {
+      EXPECT_LE((parallel_solutions[k] - parallel_solutions[k-1]).cwiseAbs().maxCoeff(), 0.1);
+    }
+  }
+}
+
+/**
+ * @brief Test that a known goal joint position is used as last solution of a pose sequence
+ *
+ * Test Sequence:
+ *    1. Solve the poses sequentially, in parallel and adaptively with the goal joint position of the last pose.
+ *    2. Solve the poses with a goal joint position which jumps away from the sequence.
+ *
+ * Expected Results:
+ *    1. The last solution is the goal joint position, all solutions are continuous.
+ *    2. The goal joint position is ignored, the last pose is solved by IK.
+ */
+TEST_P(TrajectoryFunctionsTest, testComputePoseSequenceIKGoalJointPosition)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToRandomPositions(jmg, rng_);
+  Eigen::VectorXd start, goal;
+  kinematics.toJointVector(rstate, start);
+  goal = 0.8*start; // stay within the joint limits
+
+  const std::size_t sample_count {200};
+  pilz::PoseVector poses(sample_count);
+  std::vector<double> path_parameters(sample_count);
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    path_parameters[k] = static_cast<double>(k)/(sample_count - 1);
+    ASSERT_TRUE(kinematics.fk(start + path_parameters[k]*(goal - start), poses[k]));
+  }
+
+  Eigen::VectorXd max_joint_step = Eigen::VectorXd::Constant(start.size(), 0.1);
+
+  pilz::GeneratorOptions parallel_options;
+  parallel_options.thread_pool = std::make_shared<pilz::ThreadPool>(2);
+  parallel_options.parallel_ik = true;
+  parallel_options.parallel_ik_threads = 4;
+  parallel_options.parallel_ik_min_samples = 10;
+  pilz::GeneratorOptions adaptive_options;
+  adaptive_options.adaptive_sampling = true;
+
+  std::vector<std::vector<Eigen::VectorXd> > solutions(3);
+  ASSERT_TRUE(pilz::computePoseSequenceIK(kinematics, poses, start, max_joint_step, pilz::GeneratorOptions(),
+                                          solutions[0], false, goal));
+  ASSERT_TRUE(pilz::computePoseSequenceIK(kinematics, poses, start, max_joint_step, parallel_options,
+                                          solutions[1], false, goal));
+  ASSERT_TRUE(pilz::computePoseSequenceIKAdaptive(kinematics, poses, path_parameters, start, max_joint_step,
+                                                  adaptive_options, solutions[2], false, goal));
+  for(const auto& sequence : solutions)
+  {
+    ASSERT_EQ(sample_count, sequence.size());
+    EXPECT_EQ(goal, sequence.back());
+    for(std::size_t k = 1; k < sample_count; ++k)
+    {
+      EXPECT_LE((sequence[k] - sequence[k-1]).cwiseAbs().maxCoeff(), 0.1);
+    }
+  }
+
+  Eigen::VectorXd goal_jump = goal;
+  goal_jump(0) += 1.0;
+  std::vector<Eigen::VectorXd> jump_solutions;
+  ASSERT_TRUE(pilz::computePoseSequenceIK(kinematics, poses, start, max_joint_step, pilz::GeneratorOptions(),
+                                          jump_solutions, false, goal_jump));
+  EXPECT_LT((jump_solutions.back() - goal).cwiseAbs().maxCoeff(), 4*IK_SEED_OFFSET);
+}
+
+/**
+ * @brief Test that the singularity pre-scan detects a path through a wrist singularity
+ *
+ * Test Sequence:
+ *    1. Compute the manipulability of a random state and of the same state with a straight wrist.
+ *    2. Pre-scan a path which stays at the straight wrist.
+ *    3. Pre-scan the same path without minimal manipulability.
+ *
+ * Expected Results:
+ *    1. The manipulability with the straight wrist is zero and smaller than the one of the random state.
+ *    2. Fails, the smallest manipulability is zero.
+ *    3. Succeeds.
+ */
+TEST_P(TrajectoryFunctionsTest, testCheckPathManipulability)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToRandomPositions(jmg, rng_);
+  Eigen::VectorXd regular, singular;
+  kinematics.toJointVector(rstate, regular);
+  regular(4) = 1.0;
+  singular = regular;
+  singular(4) = 0.0; // the axes of the 4th and the 6th joint are aligned
+
+  double regular_manipulability, singular_manipulability;
+  ASSERT_TRUE(kinematics.computeManipulability(regular, regular_manipulability));
+  ASSERT_TRUE(kinematics.computeManipulability(singular, singular_manipulability));
+  EXPECT_NEAR(0.0, singular_manipulability, EPSILON);
+  EXPECT_LT(singular_manipulability, regular_manipulability);
+
+  Eigen::Affine3d pose;
+  ASSERT_TRUE(kinematics.fk(singular, pose));
+  pilz::CartesianPathLine path(pose, pose, 1.0);
+
+  pilz::GeneratorOptions options;
+  double min_manipulability, min_path_parameter;
+  EXPECT_FALSE(pilz::checkPathManipulability(kinematics, path, singular, singular, options, min_manipulability,
+                                             min_path_parameter));
+  EXPECT_NEAR(0.0, min_manipulability, EPSILON);
+
+  options.singularity_prescan_min_manipulability = 0.0;
+  EXPECT_TRUE(pilz::checkPathManipulability(kinematics, path, singular, singular, options, min_manipulability,
+                                            min_path_parameter));
+}
+
+/**
+ * @brief Test that every sample of the joint space approximation is checked against the position limits
+ *
+ * The line is the chord of the arc of the tcp when only the first joint moves, so the other joints have the same
+ * position at the start and the goal but have to move in between.
+ *
+ * Test Sequence:
+ *    1. Approximate the line with position limits which contain the whole joint path.
+ *    2. Approximate the line with position limits which contain the start and the goal but not the samples between.
+ *
+ * Expected Results:
+ *    1. Succeeds.
+ *    2. Fails with PLANNING_FAILED.
+ */
+TEST_P(TrajectoryFunctionsTest, testGenerateJointTrajectoryApproximatedPositionLimits)
+{
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+  const std::vector<std::string>& joint_names = kinematics.getJointNames();
+
+  Eigen::VectorXd start = Eigen::VectorXd::Zero(static_cast<long>(joint_names.size()));
+  start(1) = 0.5;
+  start(2) = 1.0;
+  start(4) = 1.0;
+  Eigen::VectorXd goal = start;
+  goal(0) = 0.3;
+
+  Eigen::Affine3d start_pose, goal_pose;
+  ASSERT_TRUE(kinematics.fk(start, start_pose));
+  ASSERT_TRUE(kinematics.fk(goal, goal_pose));
+  pilz::CartesianPathLine path(start_pose, goal_pose, 1.0);
+  KDL::VelocityProfile_Trap velocity_profile(0.5, 1.0);
+  velocity_profile.SetProfile(0.0, path.getPathLength());
+
+  pilz::JointLimitsContainer joint_limits;
+  for(const auto& joint_name : joint_names)
+  {
+    pilz_extensions::JointLimit limit;
+    limit.has_position_limits = true;
+    limit.min_position = -3.0;
+    limit.max_position = 3.0;
+    limit.has_velocity_limits = true;
+    limit.max_velocity = 10.0;
+    limit.has_acceleration_limits = true;
+    limit.max_acceleration = 100.0;
+    limit.has_deceleration_limits = true;
+    limit.max_deceleration = -100.0;
+    ASSERT_TRUE(joint_limits.addLimit(joint_name, limit));
+  }
+
+  pilz::JointTrajectoryBuffer joint_trajectory(joint_names);
+  moveit_msgs::MoveItErrorCodes error_code;
+  ASSERT_TRUE(pilz::generateJointTrajectoryApproximated(kinematics, joint_limits, path, velocity_profile, start, goal,
+                                                        0.01, 1e-4, 1e-3, joint_trajectory, error_code));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, error_code.val);
+
+  // the joint at the start and the goal stays within a tiny interval, the approximation has to leave it
+  pilz::JointLimitsContainer tight_limits;
+  for(std::size_t j = 0; j < joint_names.size(); ++j)
+  {
+    pilz_extensions::JointLimit limit = joint_limits.getLimit(joint_names[j]);
+    if(j > 0)
+    {
+      limit.min_position = start(j) - 1e-4;
+      limit.max_position = start(j) + 1e-4;
+    }
+    ASSERT_TRUE(tight_limits.addLimit(joint_names[j], limit));
+  }
+
+  pilz::JointTrajectoryBuffer tight_trajectory(joint_names);
+  EXPECT_FALSE(pilz::generateJointTrajectoryApproximated(kinematics, tight_limits, path, velocity_profile, start,
+                                                         goal, 0.01, 1e-4, 1e-3, tight_trajectory, error_code));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::PLANNING_FAILED, error_code.val);
+}
+
+/**
+ * @brief Test that the adaptive sampling keeps the interpolated samples within the Cartesian tolerances
+ *
+ * The poses follow a joint path which is quadratic in the path parameter, so the linear interpolation
+ * between the initial knots is not exact and requires bisection.
+ */
+TEST_P(TrajectoryFunctionsTest, testComputePoseSequenceIKAdaptive)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToRandomPositions(jmg, rng_);
+  Eigen::VectorXd start, goal;
+  kinematics.toJointVector(rstate, start);
+  goal = 0.8*start; // stay within the joint limits
+
+  const std::size_t sample_count {200};
+  pilz::PoseVector poses(sample_count);
+  std::vector<double> path_parameters(sample_count);
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    path_parameters[k] = static_cast<double>(k)/(sample_count - 1);
+    double s = path_parameters[k] * path_parameters[k];
+    ASSERT_TRUE(kinematics.fk(start + s*(goal - start), poses[k]));
+  }
+
+  Eigen::VectorXd max_joint_step = Eigen::VectorXd::Constant(start.size(), 0.1);
+
+  pilz::GeneratorOptions options;
+  options.adaptive_sampling = true;
+  options.adaptive_sampling_max_knot_interval = 32;
+  std::vector<Eigen::VectorXd> solutions;
+  ASSERT_TRUE(pilz::computePoseSequenceIKAdaptive(kinematics, poses, path_parameters, start, max_joint_step,
+                                                  options, solutions));
+
+  ASSERT_EQ(sample_count, solutions.size());
+  Eigen::Affine3d pose;
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    ASSERT_TRUE(kinematics.fk(solutions[k], pose));
+    EXPECT_LE((pose.translation() - poses[k].translation()).norm(),
+              options.adaptive_sampling_position_tolerance + IK_EPSILON);
+    EXPECT_LE(Eigen::AngleAxisd(poses[k].linear().transpose() * pose.linear()).angle(),
+              options.adaptive_sampling_orientation_tolerance + IK_EPSILON);
+    if(k > 0)
+    {
+      EXPECT_LE((solutions[k] - solutions[k-1]).cwiseAbs().maxCoeff(), 0.1);
+    }
+  }
+
+  // the number of path parameters must match the number of poses
+  path_parameters.pop_back();
+  EXPECT_FALSE(pilz::computePoseSequenceIKAdaptive(kinematics, poses, path_parameters, start, max_joint_step,
+                                                   options, solutions));
+}
+
+/**
+ * @brief Test that the differential IK converges from a seed close to the solution
+ *
+ * Test Sequence:
+ *    1. Solve the pose of a random state from a slightly disturbed seed.
+ *    2. Solve the same pose without any Jacobian step.
+ *
+ * Expected Results:
+ *    1. The solution reaches the pose within the tolerances.
+ *    2. Fails, the seed does not reach the pose.
+ */
+TEST_P(TrajectoryFunctionsTest, testSolveIKDifferential)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToRandomPositions(jmg, rng_);
+  Eigen::VectorXd expected, seed, solution;
+  kinematics.toJointVector(rstate, expected);
+  // stay away from the joint limits
+  expected *= 0.8;
+
+  Eigen::Affine3d pose, solution_pose;
+  ASSERT_TRUE(kinematics.fk(expected, pose));
+
+  seed = expected + Eigen::VectorXd::Constant(expected.size(), 0.01);
+  ASSERT_TRUE(kinematics.solveIKDifferential(pose, seed, solution, 1e-5, 1e-4, 10));
+  ASSERT_TRUE(kinematics.fk(solution, solution_pose));
+  EXPECT_LE((solution_pose.translation() - pose.translation()).norm(), 1e-5);
+  EXPECT_LE(Eigen::AngleAxisd(pose.linear().transpose() * solution_pose.linear()).angle(), 1e-4);
+
+  EXPECT_FALSE(kinematics.solveIKDifferential(pose, seed, solution, 1e-5, 1e-4, 0));
+}
+
+/**
+ * @brief Test that the differential IK of a pose sequence matches the solution of the IK solver
+ */
+TEST_P(TrajectoryFunctionsTest, testComputePoseSequenceIKDifferential)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToRandomPositions(jmg, rng_);
+  Eigen::VectorXd start, goal;
+  kinematics.toJointVector(rstate, start);
+  goal = 0.8*start; // stay within the joint limits
+
+  const std::size_t sample_count {100};
+  pilz::PoseVector poses(sample_count);
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    double s = static_cast<double>(k)/(sample_count - 1);
+    ASSERT_TRUE(kinematics.fk(start + s*(goal - start), poses[k]));
+  }
+
+  Eigen::VectorXd max_joint_step = Eigen::VectorXd::Constant(start.size(), 0.1);
+
+  pilz::GeneratorOptions options;
+  std::vector<Eigen::VectorXd> solutions;
+  ASSERT_TRUE(pilz::computePoseSequenceIK(kinematics, poses, start, max_joint_step, options, solutions));
+
+  options.differential_ik = true;
+  std::vector<Eigen::VectorXd> differential_solutions;
+  ASSERT_TRUE(pilz::computePoseSequenceIK(kinematics, poses, start, max_joint_step, options,
+                                          differential_solutions));
+
+  ASSERT_EQ(sample_count, differential_solutions.size());
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    EXPECT_LT((differential_solutions[k] - solutions[k]).cwiseAbs().maxCoeff(), IK_SEED_OFFSET);
+  }
+}
+
+/**
+ * @brief Test that the nearest of all IK solutions of the IKFast plugin is selected for the tcp link
+ */
+TEST_P(TrajectoryFunctionsTest, testSolveIKNearestSolution)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::KinematicsSession kinematics(robot_model_, planning_group_, tcp_link_);
+  kinematics.setSelectNearestSolution(true);
+
+  robot_state::RobotState rstate(robot_model_);
+  while(random_test_number_ > 0)
+  {
+    rstate.setToRandomPositions(jmg, rng_);
+    Eigen::VectorXd expected, seed, solution;
+    kinematics.toJointVector(rstate, expected);
+    seed = expected + Eigen::VectorXd::Constant(expected.size(), IK_SEED_OFFSET);
+
+    Eigen::Affine3d pose, solution_pose;
+    ASSERT_TRUE(kinematics.fk(expected, pose));
+    EXPECT_TRUE(kinematics.solveIK(pose, seed, solution));
+    ASSERT_TRUE(kinematics.fk(solution, solution_pose));
+
+    EXPECT_LT((solution - expected).cwiseAbs().maxCoeff(), 4*IK_SEED_OFFSET);
+    EXPECT_TRUE(tfNear(pose, solution_pose, EPSILON));
+
+    --random_test_number_;
+  }
+}
+
+/**
+ * @brief Test that the reused self collision checker agrees with a planning scene constructed per state
+ *
+ * Test Sequence:
+ *    1. Check random states, the same state again and the state with only the last joint moved.
+ *
+ * Expected Results:
+ *    1. All results are equal to the self collision check of a new planning scene.
+ */
+TEST_P(TrajectoryFunctionsTest, testSelfCollisionChecker)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::SelfCollisionChecker& checker = pilz::SelfCollisionChecker::getThreadInstance(robot_model_);
+  EXPECT_EQ(&checker, &pilz::SelfCollisionChecker::getThreadInstance(robot_model_));
+
+  auto expectedCollisionFree = [this](const robot_state::RobotState& state)
+  {
+    planning_scene::PlanningScene scene(robot_model_);
+    scene.setCurrentState(state);
+    collision_detection::CollisionRequest collision_req;
+    collision_detection::CollisionResult collision_res;
+    scene.checkSelfCollision(collision_req, collision_res);
+    return !collision_res.collision;
+  };
+
+  robot_state::RobotState rstate(robot_model_);
+  const std::string& last_joint = jmg->getActiveJointModelNames().back();
+  while(random_test_number_ > 0)
+  {
+    rstate.setToRandomPositions(jmg, rng_);
+    rstate.update();
+    EXPECT_EQ(expectedCollisionFree(rstate), checker.isCollisionFree(rstate));
+    EXPECT_EQ(expectedCollisionFree(rstate), checker.isCollisionFree(rstate));
+
+    rstate.setVariablePosition(last_joint, 0.9*rstate.getVariablePosition(last_joint));
+    rstate.update();
+    EXPECT_EQ(expectedCollisionFree(rstate), checker.isCollisionFree(rstate));
+
+    --random_test_number_;
+  }
+}
+
+/**
+ * @brief Test that the self collision checker restores CONDITIONAL entries of the allowed collision matrix
+ *
+ * Test Sequence:
+ *    1. Set a CONDITIONAL entry for two links which do not move with the last joint.
+ *    2. Check the default state and the same state with only the last joint moved.
+ *
+ * Expected Results:
+ *    1. -
+ *    2. The pair is skipped by the second check, its entry is still CONDITIONAL afterwards.
+ */
+TEST_P(TrajectoryFunctionsTest, testSelfCollisionCheckerRestoresConditionalEntries)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  pilz::SelfCollisionChecker checker(robot_model_);
+
+  const std::vector<const moveit::core::LinkModel*>& links = robot_model_->getLinkModelsWithCollisionGeometry();
+  ASSERT_LE(2u, links.size());
+  const std::string& name1 = links[0]->getName();
+  const std::string& name2 = links[1]->getName();
+  checker.getAllowedCollisionMatrix().setEntry(name1, name2, [](collision_detection::Contact&) { return true; });
+
+  robot_state::RobotState rstate(robot_model_);
+  rstate.setToDefaultValues();
+  ASSERT_TRUE(checker.isCollisionFree(rstate));
+  const std::string& last_joint = jmg->getActiveJointModelNames().back();
+  rstate.setVariablePosition(last_joint, rstate.getVariablePosition(last_joint) + 0.1);
+  EXPECT_TRUE(checker.isCollisionFree(rstate));
+
+  collision_detection::AllowedCollision::Type type;
+  ASSERT_TRUE(checker.getAllowedCollisionMatrix().getEntry(name1, name2, type));
+  EXPECT_EQ(collision_detection::AllowedCollision::CONDITIONAL, type);
+  collision_detection::DecideContactFn decide_contact;
+  ASSERT_TRUE(checker.getAllowedCollisionMatrix().getEntry(name1, name2, decide_contact));
+  EXPECT_TRUE(decide_contact);
+}
+
+/**
+ * @brief Test that a joint trajectory buffer is converted like the equivalent joint trajectory message
+ */
+TEST_P(TrajectoryFunctionsTest, testJointTrajectoryBufferToRobotTrajectory)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  const std::vector<std::string>& joint_names = jmg->getActiveJointModelNames();
+
+  pilz::JointTrajectoryBuffer buffer(joint_names);
+  buffer.reserve(10);
+  for(std::size_t k = 0; k < 10; ++k)
+  {
+    const std::size_t index = buffer.addPoint(0.1 * (k + 1));
+    buffer.positions(index).setConstant(0.01 * k);
+    buffer.velocities(index).setConstant(0.1);
+    buffer.accelerations(index).setConstant(-0.2);
+  }
+  ASSERT_EQ(10u, buffer.size());
+
+  trajectory_msgs::JointTrajectory joint_trajectory;
+  buffer.toMsg(joint_trajectory);
+  ASSERT_EQ(10u, joint_trajectory.points.size());
+  EXPECT_EQ(joint_names, joint_trajectory.joint_names);
+
+  robot_state::RobotState start_state(robot_model_);
+  start_state.setToDefaultValues();
+  robot_trajectory::RobotTrajectory expected(robot_model_, planning_group_);
+  expected.setRobotTrajectoryMsg(start_state, joint_trajectory);
+  robot_trajectory::RobotTrajectory actual(robot_model_, planning_group_);
+  ASSERT_TRUE(buffer.toRobotTrajectory(start_state, actual));
+
+  ASSERT_EQ(expected.getWayPointCount(), actual.getWayPointCount());
+  for(std::size_t k = 0; k < actual.getWayPointCount(); ++k)
+  {
+    EXPECT_NEAR(expected.getWayPointDurationFromPrevious(k), actual.getWayPointDurationFromPrevious(k), EPSILON);
+    EXPECT_FALSE(actual.getWayPoint(k).dirtyLinkTransforms()) << "at way point " << k;
+    for(const auto& joint_name : joint_names)
+    {
+      EXPECT_NEAR(expected.getWayPoint(k).getVariablePosition(joint_name),
+                  actual.getWayPoint(k).getVariablePosition(joint_name), EPSILON);
+      EXPECT_NEAR(expected.getWayPoint(k).getVariableVelocity(joint_name),
+                  actual.getWayPoint(k).getVariableVelocity(joint_name), EPSILON);
+      EXPECT_NEAR(expected.getWayPoint(k).getVariableAcceleration(joint_name),
+                  actual.getWayPoint(k).getVariableAcceleration(joint_name), EPSILON);
+    }
+  }
+
+  // unknown joints are rejected
+  pilz::JointTrajectoryBuffer invalid_buffer({"unknown_joint"});
+  invalid_buffer.addPoint(0.1);
+  EXPECT_FALSE(invalid_buffer.toRobotTrajectory(start_state, actual));
+}
+
+/**
+ * @brief Test that the poses of a tip pose track are used as long as they match the link and the way points
+ */
+TEST_P(TrajectoryFunctionsTest, testTipPoseTrack)
+{
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup(planning_group_);
+  robot_trajectory::RobotTrajectoryPtr trajectory(new robot_trajectory::RobotTrajectory(robot_model_,
+                                                                                        planning_group_));
+
+  // the track is shifted against the forward kinematics to see where the poses come from
+  std::shared_ptr<pilz::TipPoseTrack> track = std::make_shared<pilz::TipPoseTrack>();
+  track->link_name = tcp_link_;
+  const Eigen::Vector3d shift(1.0, 0.0, 0.0);
+  for(std::size_t k = 0; k < 5; ++k)
+  {
+    robot_state::RobotStatePtr state(new robot_state::RobotState(robot_model_));
+    state->setToRandomPositions(jmg, rng_);
+    trajectory->addSuffixWayPoint(state, 0.1);
+    track->poses.push_back(Eigen::Translation3d(shift) * state->getFrameTransform(tcp_link_));
+  }
+
+  const pilz::TipPoseLookup tip_poses(trajectory, tcp_link_, track);
+  EXPECT_TRUE(tip_poses.hasTrack());
+  const pilz::TipPoseLookup other_link_poses(trajectory, ik_fast_link_, track);
+  EXPECT_FALSE(other_link_poses.hasTrack());
+  const pilz::TipPoseLookup untracked_poses(trajectory, tcp_link_);
+  EXPECT_FALSE(untracked_poses.hasTrack());
+  for(std::size_t k = 0; k < trajectory->getWayPointCount(); ++k)
+  {
+    EXPECT_TRUE(tip_poses.getPose(k).isApprox(track->poses[k], EPSILON));
+    EXPECT_TRUE(other_link_poses.getPose(k).isApprox(trajectory->getWayPointPtr(k)->getFrameTransform(ik_fast_link_),
+                                                     EPSILON));
+    EXPECT_TRUE(untracked_poses.getPose(k).isApprox(trajectory->getWayPointPtr(k)->getFrameTransform(tcp_link_),
+                                                    EPSILON));
+  }
+
+  // a track which does not match the way point count is not used
+  trajectory->addSuffixWayPoint(trajectory->getLastWayPoint(), 0.1);
+  EXPECT_FALSE(pilz::TipPoseLookup(trajectory, tcp_link_, track).hasTrack());
+}
+
+/**
+ * @brief Test that a kinematics session rejects unknown planning groups and links
+ */
+TEST_P(TrajectoryFunctionsTest, testKinematicsSessionInvalid)
+{
+  Eigen::Affine3d pose = Eigen::Affine3d::Identity();
+  std::map<std::string, double> seed, solution;
+
+  pilz::KinematicsSession invalid_group(robot_model_, "InvalidGroupName", tcp_link_);
+  EXPECT_FALSE(invalid_group.solveIK(pose, seed, solution));
+
+  pilz::KinematicsSession invalid_link(robot_model_, planning_group_, "WrongLink");
+  EXPECT_FALSE(invalid_link.solveIK(pose, seed, solution));
+  EXPECT_FALSE(invalid_link.fk(seed, pose));
+  EXPECT_FALSE(invalid_link.setLinkName("WrongLink"));
+  EXPECT_TRUE(invalid_link.setLinkName(tcp_link_));
+}
+
 /**
  * @brief Check that function VerifySampleJointLimits() returns 'false' in case
  * of very small sample duration.
@@ -439,6 +1079,26 @@ TEST_P(TrajectoryFunctionsTest, testVerifySampleJointLimitsWithSmallDuration)
                                              duration_last, duration_current, joint_limits));
 }
 
+/**
+ * @brief Check that function VerifySampleJointLimits() throws for a joint without limit.
+ *
+ * Test Sequence:
+ *    1. Call function with a joint which is not in the joint limits container.
+ *
+ * Expected Results:
+ *    1. std::out_of_range is thrown.
+ */
+TEST_P(TrajectoryFunctionsTest, testVerifySampleJointLimitsWithoutLimit)
+{
+  const std::map<std::string, double> position_last { {"joint", 1.0} };
+  const std::map<std::string, double> position_current { {"joint", 1.1} };
+  const std::map<std::string, double> velocity_last { {"joint", 0.0} };
+  const pilz::JointLimitsContainer joint_limits;
+
+  EXPECT_THROW(pilz::verifySampleJointLimits(position_last, velocity_last, position_current, 0.1, 0.1, joint_limits),
+               std::out_of_range);
+}
+
 /**
  * @brief Check that function VerifySampleJointLimits() returns 'false' in case
  * of a velocity violation.
@@ -549,6 +1209,144 @@ TEST_P(TrajectoryFunctionsTest, testVerifySampleJointLimitsDecelerationViolation
                                              duration_last, duration_current, joint_limits));
 }
 
+/**
+ * @brief Check that function verifyJointTrajectoryLimits() reports the first violation of a trajectory and
+ * computes the same velocities and accelerations as the sample wise check.
+ *
+ * Test Sequence:
+ *    1. Call function with a trajectory of two joints within the limits.
+ *    2. Violate the velocity limit of the second joint at two samples and the acceleration limit of the first
+ *       joint at a later sample.
+ *
+ * Expected Results:
+ *    1. Function returns 'true', velocities and accelerations are the finite differences of the samples.
+ *    2. Function returns 'false' and reports the velocity violation of the second joint at the earlier sample.
+ */
+TEST_P(TrajectoryFunctionsTest, testVerifyJointTrajectoryLimitsFirstViolation)
+{
+  const std::vector<std::string> joint_names {"joint1", "joint2"};
+  pilz_extensions::JointLimit limit;
+  limit.has_velocity_limits = true;
+  limit.max_velocity = 1.0;
+  limit.has_acceleration_limits = true;
+  limit.max_acceleration = 2.0;
+  limit.has_deceleration_limits = true;
+  limit.max_deceleration = -2.0;
+  const pilz::JointLimitsTable limits(std::vector<pilz_extensions::JointLimit>(2, limit));
+
+  const double sampling_time {0.1};
+  const std::size_t sample_count {6};
+  Eigen::MatrixXd positions(sample_count, 2);
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    positions(k, 0) = 0.005 * (k+1);
+    positions(k, 1) = -0.005 * (k+1);
+  }
+  const Eigen::VectorXd initial_position = Eigen::VectorXd::Zero(2);
+  Eigen::VectorXd initial_velocity(2);
+  initial_velocity << 0.05, -0.05;
+  const Eigen::VectorXd durations = Eigen::VectorXd::Constant(sample_count, sampling_time);
+
+  Eigen::MatrixXd velocities, accelerations;
+  pilz::JointLimitViolation violation;
+  EXPECT_TRUE(pilz::verifyJointTrajectoryLimits(positions, initial_position, initial_velocity, durations, durations,
+                                                limits, joint_names, velocities, accelerations, violation));
+  EXPECT_EQ(pilz::JointLimitViolation::NONE, violation.type);
+  ASSERT_EQ(sample_count, static_cast<std::size_t>(velocities.rows()));
+  for(std::size_t k = 0; k < sample_count; ++k)
+  {
+    EXPECT_NEAR(0.05, velocities(k, 0), EPSILON);
+    EXPECT_NEAR(-0.05, velocities(k, 1), EPSILON);
+    EXPECT_NEAR(0., accelerations(k, 0), EPSILON);
+  }
+
+  // the first joint violates its acceleration limit at sample 4, the second its velocity limit at samples 3 and 5
+  positions(3, 1) -= 0.2;
+  positions.block(4, 0, 2, 1).array() += 0.05;
+  positions(5, 1) -= 0.4;
+  EXPECT_FALSE(pilz::verifyJointTrajectoryLimits(positions, initial_position, initial_velocity, durations, durations,
+                                                 limits, joint_names, velocities, accelerations, violation));
+  EXPECT_EQ(pilz::JointLimitViolation::VELOCITY, violation.type);
+  EXPECT_EQ(3u, violation.sample);
+  EXPECT_EQ(1u, violation.joint);
+  EXPECT_NEAR(-2.05, violation.value, EPSILON);
+  EXPECT_NEAR(1.0, violation.limit, EPSILON);
+}
+
+/**
+ * @brief Check that the trajectory scaled by computeFeasibleTimeScaling() obeys the limits.
+ *
+ * Test Sequence:
+ *    1. Compute the factor of a trajectory within the limits.
+ *    2. Compute the factor of a trajectory which violates the velocity limit of the first joint and the deceleration
+ *       limit of the second joint, then verify the trajectory stretched in time by the factor.
+ *
+ * Expected Results:
+ *    1. The factor is 1.
+ *    2. The factor is the smaller one of both violations and the stretched trajectory obeys the limits.
+ */
+TEST_P(TrajectoryFunctionsTest, testComputeFeasibleTimeScaling)
+{
+  const std::vector<std::string> joint_names {"joint1", "joint2"};
+  pilz_extensions::JointLimit limit;
+  limit.has_velocity_limits = true;
+  limit.max_velocity = 1.0;
+  limit.has_acceleration_limits = true;
+  limit.max_acceleration = 2.0;
+  limit.has_deceleration_limits = true;
+  limit.max_deceleration = -4.0;
+  const pilz::JointLimitsTable limits(std::vector<pilz_extensions::JointLimit>(2, limit));
+  const Eigen::VectorXd zero = Eigen::VectorXd::Zero(2);
+
+  const double sampling_time {0.1};
+  const std::size_t sample_count {8};
+  const Eigen::VectorXd durations = Eigen::VectorXd::Constant(sample_count, sampling_time);
+  Eigen::MatrixXd sample_velocities(sample_count, 2);
+  sample_velocities << 0.1, 0.1,
+                       0.2, 0.2,
+                       0.2, 0.2,
+                       0.1, 0.1,
+                       0.1, 0.1,
+                       0.1, 0.1,
+                       0.1, 0.1,
+                       0.1, 0.1;
+  Eigen::MatrixXd positions(sample_count, 2);
+  positions.row(0) = sampling_time * sample_velocities.row(0);
+  for(std::size_t k = 1; k < sample_count; ++k)
+  {
+    positions.row(k) = positions.row(k-1) + sampling_time * sample_velocities.row(k);
+  }
+
+  Eigen::MatrixXd velocities, accelerations;
+  pilz::JointLimitViolation violation;
+  ASSERT_TRUE(pilz::verifyJointTrajectoryLimits(positions, zero, zero, durations, durations, limits, joint_names,
+                                                velocities, accelerations, violation));
+  EXPECT_DOUBLE_EQ(1.0, pilz::computeFeasibleTimeScaling(velocities, accelerations, zero, limits));
+
+  // the first joint reaches 1.5 times its velocity limit, the second joint brakes with 2.5 times its deceleration limit
+  sample_velocities << 0.2, 0.2,
+                       0.4, 0.4,
+                       0.6, 0.6,
+                       0.8, 0.8,
+                       1.0, 1.0,
+                       1.2, 1.0,
+                       1.4, 1.0,
+                       1.5, 0.0;
+  positions.row(0) = sampling_time * sample_velocities.row(0);
+  for(std::size_t k = 1; k < sample_count; ++k)
+  {
+    positions.row(k) = positions.row(k-1) + sampling_time * sample_velocities.row(k);
+  }
+  ASSERT_FALSE(pilz::verifyJointTrajectoryLimits(positions, zero, zero, durations, durations, limits, joint_names,
+                                                 velocities, accelerations, violation));
+  const double time_scaling = pilz::computeFeasibleTimeScaling(velocities, accelerations, zero, limits);
+  EXPECT_NEAR(std::min(1.0/1.5, std::sqrt(1.0/2.5)), time_scaling, EPSILON);
+
+  const Eigen::VectorXd stretched_durations = durations / (0.999 * time_scaling);
+  EXPECT_TRUE(pilz::verifyJointTrajectoryLimits(positions, zero, zero, stretched_durations, stretched_durations,
+                                                limits, joint_names, velocities, accelerations, violation));
+}
+
 /**
  * @brief Check that function generateJointTrajectory() returns 'false' if
  * a joint trajectory cannot be computed from a cartesian trajectory.
@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 
 #include "pilz_trajectory_generation/trajectory_generator_lin.h"
+#include "pilz_trajectory_generation/planning_context_lin.h"
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
 #include "test_utils.h"
 #include "pilz_industrial_motion_testutils/xml_testdata_loader.h"
@@ -319,6 +320,42 @@ TEST_P(TrajectoryGeneratorLINTest, cartesianTrapezoidProfile)
   EXPECT_NEAR((0.1+0.15*23/24)*M_PI, waypoint_aa.angle(),other_tolerance_);
 }
 
+/**
+ * @brief Check that the Cartesian profile decelerates with the translational deceleration limit.
+ *
+ * Test Sequence:
+ *    1. Plan the LIN trajectory with the deceleration limit equal to the acceleration limit.
+ *    2. Plan the same LIN trajectory with a higher deceleration limit.
+ *
+ * Expected Results:
+ *    1. Trajectory is generated.
+ *    2. Trajectory is generated, reaches the goal on a line and is shorter by the saved braking time.
+ */
+TEST_P(TrajectoryGeneratorLINTest, cartesianAsymmetricTrapezoidProfile)
+{
+  pilz_industrial_motion_testutils::STestMotionCommand lin_cmd;
+  ASSERT_TRUE(tdp_->getLin("LINCmd2", lin_cmd));
+  moveit_msgs::MotionPlanRequest lin_joint_req = req_director_.getLINJointReq(robot_model_, lin_cmd);
+
+  planning_interface::MotionPlanResponse res_sym;
+  ASSERT_TRUE(lin_->generate(lin_joint_req, res_sym, 0.01));
+  double duration_sym = res_sym.trajectory_->getWayPointDurationFromStart(res_sym.trajectory_->getWayPointCount());
+
+  LimitsContainer planner_limits = planner_limits_;
+  CartesianLimit cart_limits = planner_limits.getCartesianLimits();
+  cart_limits.setMaxTranslationalDeceleration(-2*cart_limits.getMaxTranslationalAcceleration());
+  planner_limits.setCartesianLimits(cart_limits);
+  TrajectoryGeneratorLIN lin(robot_model_, planner_limits);
+
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(lin.generate(lin_joint_req, res, 0.01));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
+  EXPECT_TRUE(checkLinResponse(lin_joint_req, res));
+
+  double duration = res.trajectory_->getWayPointDurationFromStart(res.trajectory_->getWayPointCount());
+  EXPECT_LT(duration, duration_sym - 0.01);
+}
+
 /**
  * @brief Check that lin planner returns 'false' if
  * calculated lin trajectory violates velocity/acceleration or deceleration limits.
@@ -344,6 +381,143 @@ TEST_P(TrajectoryGeneratorLINTest, LinPlannerLimitViolation)
   ASSERT_FALSE(lin_->generate(lin_joint_req, res));
 }
 
+/**
+ * @brief Check that the velocity scaling search reduces the scaling factors of a lin request violating the limits.
+ *
+ * Test Sequence:
+ *    1. Call function of a generator with velocity scaling search with the lin request violating the limits.
+ *
+ * Expected Results:
+ *    1. Trajectory is generated within the joint limits, the reduced scaling factors are returned with it.
+ */
+TEST_P(TrajectoryGeneratorLINTest, LinVelocityScalingSearch)
+{
+  pilz_industrial_motion_testutils::STestMotionCommand lin_cmd;
+  ASSERT_TRUE(tdp_->getLin("LINCmdLimitViolation", lin_cmd));
+  moveit_msgs::MotionPlanRequest lin_joint_req = req_director_.getLINJointReq(robot_model_, lin_cmd);
+
+  GeneratorOptions options;
+  options.velocity_scaling_search = true;
+  TrajectoryGeneratorLIN lin(robot_model_, planner_limits_, options);
+
+  planning_interface::MotionPlanResponse res;
+  GeneratedTrajectoryInfo info;
+  ASSERT_TRUE(lin.generate(lin_joint_req, res, info));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
+  EXPECT_TRUE(checkLinResponse(lin_joint_req, res));
+
+  const TrajectoryScaling& scaling = info.scaling;
+  EXPECT_LT(scaling.velocity_scaling_factor, lin_joint_req.max_velocity_scaling_factor);
+  EXPECT_LT(scaling.acceleration_scaling_factor, lin_joint_req.max_acceleration_scaling_factor);
+  // the acceleration is reduced by the square of the time scaling
+  EXPECT_NEAR(scaling.acceleration_scaling_factor / lin_joint_req.max_acceleration_scaling_factor,
+              std::pow(scaling.velocity_scaling_factor / lin_joint_req.max_velocity_scaling_factor, 2),
+              other_tolerance_);
+
+  // the achieved factors are reported in the description of the detailed response
+  PlanningContextLIN context("TestPlanningContext", planning_group_, robot_model_, planner_limits_, options);
+  context.setMotionPlanRequest(lin_joint_req);
+  planning_interface::MotionPlanDetailedResponse res_detailed;
+  ASSERT_TRUE(context.solve(res_detailed));
+  ASSERT_FALSE(res_detailed.description_.empty());
+  EXPECT_EQ(0u, res_detailed.description_.front().find("plan (velocity_scaling_factor: "));
+}
+
+/**
+ * @brief Check the time optimal parameterization of the LIN path under the joint limits.
+ *
+ * Test Sequence:
+ *    1. Call function of a generator with time optimal parameterization with the lin request violating the limits.
+ *    2. Plan a lin request which obeys the limits with the trapezoid and the time optimal profile.
+ *
+ * Expected Results:
+ *    1. Trajectory is generated within the joint limits. The reported factors do not exceed the ones of the request,
+ *       the acceleration scaling factor is reduced by the square of the time scaling.
+ *    2. Both trajectories are generated, the time optimal one is not slower up to the discretization of its grid.
+ */
+TEST_P(TrajectoryGeneratorLINTest, LinTimeOptimalParameterization)
+{
+  GeneratorOptions options;
+  options.time_optimal_parameterization = true;
+  TrajectoryGeneratorLIN lin(robot_model_, planner_limits_, options);
+
+  pilz_industrial_motion_testutils::STestMotionCommand lin_cmd;
+  ASSERT_TRUE(tdp_->getLin("LINCmdLimitViolation", lin_cmd));
+  moveit_msgs::MotionPlanRequest lin_joint_req = req_director_.getLINJointReq(robot_model_, lin_cmd);
+
+  planning_interface::MotionPlanResponse res;
+  GeneratedTrajectoryInfo info;
+  ASSERT_TRUE(lin.generate(lin_joint_req, res, info));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
+  EXPECT_TRUE(checkLinResponse(lin_joint_req, res));
+
+  const double time_scaling = info.scaling.velocity_scaling_factor/lin_joint_req.max_velocity_scaling_factor;
+  EXPECT_LE(time_scaling, 1.0);
+  EXPECT_NEAR(lin_joint_req.max_acceleration_scaling_factor*time_scaling*time_scaling,
+              info.scaling.acceleration_scaling_factor, other_tolerance_);
+
+  ASSERT_TRUE(tdp_->getLin("LINCmd2", lin_cmd));
+  lin_joint_req = req_director_.getLINJointReq(robot_model_, lin_cmd);
+
+  planning_interface::MotionPlanResponse res_trap;
+  ASSERT_TRUE(lin_->generate(lin_joint_req, res_trap));
+  double duration_trap = res_trap.trajectory_->getWayPointDurationFromStart(res_trap.trajectory_->getWayPointCount());
+
+  planning_interface::MotionPlanResponse res_topp;
+  ASSERT_TRUE(lin.generate(lin_joint_req, res_topp));
+  EXPECT_TRUE(checkLinResponse(lin_joint_req, res_topp));
+  double duration_topp = res_topp.trajectory_->getWayPointDurationFromStart(res_topp.trajectory_->getWayPointCount());
+  EXPECT_LE(duration_topp, 1.02*duration_trap);
+}
+
+/**
+ * @brief Check the joint space approximation of the line.
+ *
+ * Test Sequence:
+ *    1. Call function of a generator with joint space approximation with a lin request.
+ *
+ * Expected Results:
+ *    1. Trajectory is generated within the joint limits, reaches the goal and all way points are within the position
+ *       tolerance of the line.
+ */
+TEST_P(TrajectoryGeneratorLINTest, LinJointSpaceApproximation)
+{
+  GeneratorOptions options;
+  options.lin_approximation = true;
+  TrajectoryGeneratorLIN lin(robot_model_, planner_limits_, options);
+
+  pilz_industrial_motion_testutils::STestMotionCommand lin_cmd;
+  ASSERT_TRUE(tdp_->getLin("LINCmd1", lin_cmd));
+  moveit_msgs::MotionPlanRequest lin_joint_req = req_director_.getLINJointReq(robot_model_, lin_cmd);
+
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(lin.generate(lin_joint_req, res));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
+
+  moveit_msgs::MotionPlanResponse res_msg;
+  res.getMessage(res_msg);
+  EXPECT_TRUE(testutils::isGoalReached(robot_model_, res_msg.trajectory.joint_trajectory, lin_joint_req,
+                                       pose_norm_tolerance_));
+  EXPECT_TRUE(testutils::checkJointTrajectory(res_msg.trajectory.joint_trajectory,
+                                              planner_limits_.getJointLimitContainer()));
+
+  // distance of the way points from the line
+  std::string link_name;
+  Eigen::Affine3d goal_pose;
+  ASSERT_TRUE(testutils::getExpectedGoalPose(robot_model_, lin_joint_req, link_name, goal_pose));
+  robot_state::RobotState start_state(robot_model_);
+  moveit::core::jointStateToRobotState(lin_joint_req.start_state.joint_state, start_state);
+  const Eigen::Vector3d start_position = start_state.getFrameTransform(link_name).translation();
+  const Eigen::Vector3d direction = (goal_pose.translation() - start_position).normalized();
+  for(std::size_t i = 0; i < res.trajectory_->getWayPointCount(); ++i)
+  {
+    robot_state::RobotState way_point(res.trajectory_->getWayPoint(i));
+    const Eigen::Vector3d offset = way_point.getFrameTransform(link_name).translation() - start_position;
+    EXPECT_LE((offset - offset.dot(direction)*direction).norm(),
+              options.lin_approximation_position_tolerance + other_tolerance_) << "at way point " << i;
+  }
+}
+
 /**
  * @brief test joint linear movement with equal goal and start
  *
@@ -17,6 +17,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 #include "pilz_trajectory_generation/trajectory_generator_ptp.h"
 #include "pilz_trajectory_generation/joint_limits_aggregator.h"
 #include "test_utils.h"
@@ -593,6 +595,89 @@ TEST_P(TrajectoryGeneratorPTPTest, testScalingFactor)
 }
 
 
+/**
+ * @brief test joints with different limits
+ *
+ * The phases of the leading axis (joint_1) violate the acceleration limit of joint_6,
+ * the shortest phases feasible for both joints are used.
+ *  - joint_1: 4 rad with max_vel 1, max_acc 10, max_dec 10
+ *  - joint_6: 1 rad with max_vel 10, max_acc 0.5, max_dec 0.5
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testDifferentJointLimits)
+{
+  // create ptp generator with different limits
+  pilz_extensions::joint_limits_interface::JointLimits joint_limit;
+  pilz::JointLimitsContainer joint_limits;
+
+  joint_limit.has_position_limits = true;
+  joint_limit.max_position = 2.967;
+  joint_limit.min_position = -2.967;
+  joint_limit.has_velocity_limits = true;
+  joint_limit.max_velocity = 1;
+  joint_limit.has_acceleration_limits = true;
+  joint_limit.max_acceleration = 10;
+  joint_limit.has_deceleration_limits = true;
+  joint_limit.max_deceleration = -10;
+  for(const auto& joint_name : {"prbt_joint_1", "prbt_joint_2", "prbt_joint_3", "prbt_joint_4", "prbt_joint_5"})
+  {
+    joint_limits.addLimit(joint_name, joint_limit);
+  }
+  joint_limit.max_velocity = 10;
+  joint_limit.max_acceleration = 0.5;
+  joint_limit.max_deceleration = -0.5;
+  joint_limits.addLimit("prbt_joint_6", joint_limit);
+
+  pilz::LimitsContainer planner_limits;
+  planner_limits.setJointLimits(joint_limits);
+  ptp_.reset(new TrajectoryGeneratorPTP(robot_model_, planner_limits));
+
+  planning_interface::MotionPlanResponse res;
+  planning_interface::MotionPlanRequest req;
+  testutils::createDummyRequest(robot_model_, planning_group_, req);
+  req.start_state.joint_state.position[0] = -2.0;
+  moveit_msgs::Constraints gc;
+  moveit_msgs::JointConstraint jc;
+  jc.joint_name = "prbt_joint_1";
+  jc.position = 2.0;
+  gc.joint_constraints.push_back(jc);
+  jc.joint_name = "prbt_joint_6";
+  jc.position = 1.0;
+  gc.joint_constraints.push_back(jc);
+  req.goal_constraints.push_back(gc);
+
+  ASSERT_TRUE(ptp_->generate(req,res));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
+
+  moveit_msgs::MotionPlanResponse res_msg;
+  res.getMessage(res_msg);
+  EXPECT_TRUE(checkTrajectory(res_msg.trajectory.joint_trajectory, req, joint_limits));
+
+  // trajectory duration, 6s with the common limit of all joints
+  EXPECT_NEAR(4.5, res.trajectory_->getWayPointDurationFromStart(res.trajectory_->getWayPointCount()),
+              joint_acceleration_tolerance_);
+
+  // way point at 0.5s, end of the acceleration phase
+  int index;
+  index = testutils::getWayPointIndex(res.trajectory_, 0.5);
+  // joint_1
+  EXPECT_NEAR(-1.75, res_msg.trajectory.joint_trajectory.points[index].positions[0], joint_position_tolerance_);
+  EXPECT_NEAR(1.0, res_msg.trajectory.joint_trajectory.points[index].velocities[0], joint_velocity_tolerance_);
+  // joint_6
+  EXPECT_NEAR(0.0625, res_msg.trajectory.joint_trajectory.points[index].positions[5], joint_position_tolerance_);
+  EXPECT_NEAR(0.25, res_msg.trajectory.joint_trajectory.points[index].velocities[5], joint_velocity_tolerance_);
+
+  // way point at 2s
+  index = testutils::getWayPointIndex(res.trajectory_, 2.0);
+  // joint_1
+  EXPECT_NEAR(-0.25, res_msg.trajectory.joint_trajectory.points[index].positions[0], joint_position_tolerance_);
+  EXPECT_NEAR(1.0, res_msg.trajectory.joint_trajectory.points[index].velocities[0], joint_velocity_tolerance_);
+  EXPECT_NEAR(0.0, res_msg.trajectory.joint_trajectory.points[index].accelerations[0], joint_acceleration_tolerance_);
+  // joint_6
+  EXPECT_NEAR(0.4375, res_msg.trajectory.joint_trajectory.points[index].positions[5], joint_position_tolerance_);
+  EXPECT_NEAR(0.25, res_msg.trajectory.joint_trajectory.points[index].velocities[5], joint_velocity_tolerance_);
+  EXPECT_NEAR(0.0, res_msg.trajectory.joint_trajectory.points[index].accelerations[5], joint_acceleration_tolerance_);
+}
+
 /**
  * @brief test the ptp trajectory generator of joint space goal
  * with zero start velocity
@@ -710,6 +795,90 @@ TEST_P(TrajectoryGeneratorPTPTest, testJointGoalZeroStartVel1)
   EXPECT_NEAR(0.0, res_msg.trajectory.joint_trajectory.points[index].velocities[5], joint_velocity_tolerance_);
 }
 
+/**
+ * @brief test that the analytic ptp trajectory of the generator API gives the same points as the sampled trajectory
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testAnalyticTrajectory)
+{
+  planning_interface::MotionPlanRequest req;
+  testutils::createDummyRequest(robot_model_, planning_group_, req);
+  req.start_state.joint_state.position[2] = 0.1;
+  moveit_msgs::Constraints gc;
+  moveit_msgs::JointConstraint jc;
+  jc.joint_name = "prbt_joint_1";
+  jc.position = 1.5;
+  gc.joint_constraints.push_back(jc);
+  jc.joint_name = "prbt_joint_3";
+  jc.position = 2.1;
+  gc.joint_constraints.push_back(jc);
+  jc.joint_name = "prbt_joint_6";
+  jc.position = 3.0;
+  gc.joint_constraints.push_back(jc);
+  req.goal_constraints.push_back(gc);
+
+  TrajectoryGeneratorPTP ptp(robot_model_, planner_limits_);
+  PTPTrajectory trajectory;
+  moveit_msgs::MoveItErrorCodes error_code;
+  ASSERT_TRUE(ptp.generateAnalytic(req, trajectory, error_code));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, error_code.val);
+  EXPECT_NEAR(4.5, trajectory.duration(), joint_acceleration_tolerance_);
+
+  // evaluation at any time, the values are the same as in testJointGoalZeroStartVel1
+  PTPTrajectoryEvaluator evaluator(trajectory);
+  const std::size_t joint_count = trajectory.joint_names.size();
+  Eigen::VectorXd positions(joint_count), velocities(joint_count), accelerations(joint_count);
+  evaluator.evaluate(1.0, positions, velocities, accelerations);
+  EXPECT_NEAR(0.125, positions(0), joint_position_tolerance_);
+  EXPECT_NEAR(0.25, velocities(0), joint_velocity_tolerance_);
+  EXPECT_NEAR(0.25, accelerations(0), joint_acceleration_tolerance_);
+  evaluator.evaluate(4.0, positions, velocities, accelerations);
+  EXPECT_NEAR(2.875, positions(5), joint_position_tolerance_);
+  EXPECT_NEAR(0.5, velocities(5), joint_velocity_tolerance_);
+  EXPECT_NEAR(-1.0, accelerations(5), joint_acceleration_tolerance_);
+  evaluator.evaluate(-1.0, positions, velocities, accelerations);
+  EXPECT_TRUE(positions.isApprox(trajectory.start_position));
+  EXPECT_TRUE(velocities.isZero());
+  evaluator.evaluate(10.0, positions, velocities, accelerations);
+  EXPECT_TRUE(positions.isApprox(trajectory.goal_position));
+  EXPECT_TRUE(accelerations.isZero());
+
+  // the sampled analytic trajectory equals the generated trajectory
+  const double sampling_time {0.008};
+  planning_interface::MotionPlanResponse res;
+  ASSERT_TRUE(ptp_->generate(req, res, sampling_time));
+  moveit_msgs::MotionPlanResponse res_msg;
+  res.getMessage(res_msg);
+
+  JointTrajectoryBuffer joint_trajectory;
+  evaluator.sample(sampling_time, joint_trajectory);
+  ASSERT_EQ(res_msg.trajectory.joint_trajectory.points.size(), joint_trajectory.size());
+  for(std::size_t j = 0; j < joint_count; ++j)
+  {
+    const auto& msg_joint_names = res_msg.trajectory.joint_trajectory.joint_names;
+    auto it = std::find(msg_joint_names.begin(), msg_joint_names.end(), trajectory.joint_names[j]);
+    ASSERT_NE(msg_joint_names.end(), it);
+    const std::size_t msg_index = std::distance(msg_joint_names.begin(), it);
+    for(std::size_t i = 0; i < joint_trajectory.size(); ++i)
+    {
+      const trajectory_msgs::JointTrajectoryPoint& point = res_msg.trajectory.joint_trajectory.points[i];
+      EXPECT_DOUBLE_EQ(point.positions[msg_index], joint_trajectory.positions(i)(j));
+      EXPECT_DOUBLE_EQ(point.velocities[msg_index], joint_trajectory.velocities(i)(j));
+      EXPECT_DOUBLE_EQ(point.accelerations[msg_index], joint_trajectory.accelerations(i)(j));
+    }
+  }
+
+  // goal already reached
+  req.goal_constraints.front().joint_constraints.clear();
+  jc.joint_name = "prbt_joint_3";
+  jc.position = 0.1;
+  req.goal_constraints.front().joint_constraints.push_back(jc);
+  ASSERT_TRUE(ptp.generateAnalytic(req, trajectory, error_code));
+  EXPECT_EQ(0.0, trajectory.duration());
+  PTPTrajectoryEvaluator(trajectory).sample(sampling_time, joint_trajectory);
+  ASSERT_EQ(1u, joint_trajectory.size());
+  EXPECT_TRUE(joint_trajectory.positions(0).isApprox(trajectory.start_position));
+}
+
 /**
  * @brief test the ptp_ trajectory generator of joint space goal
  * with zero start velocity
@@ -877,6 +1046,131 @@ TEST_P(TrajectoryGeneratorPTPTest, testJointGoalZeroStartVel2)
   EXPECT_NEAR(0.0, res_msg.trajectory.joint_trajectory.points[index].velocities[5], joint_velocity_tolerance_);
 }
 
+/**
+ * @brief test the ptp trajectory generator of joint space goal with non-zero start velocity
+ *  - joint_1 moves towards its goal
+ *  - joint_3 moves away from its start position which is its goal
+ *  - joint_6 moves away from its goal
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testJointGoalNonZeroStartVel)
+{
+  planning_interface::MotionPlanResponse res;
+  planning_interface::MotionPlanRequest req;
+  testutils::createDummyRequest(robot_model_, planning_group_, req);
+  req.start_state.joint_state.velocity.assign(req.start_state.joint_state.name.size(), 0.0);
+  req.start_state.joint_state.velocity[0] = 0.5;
+  req.start_state.joint_state.velocity[2] = 0.3;
+  req.start_state.joint_state.velocity[5] = -0.5;
+
+  moveit_msgs::Constraints gc;
+  moveit_msgs::JointConstraint jc;
+  jc.joint_name = "prbt_joint_1";
+  jc.position = 1.5;
+  gc.joint_constraints.push_back(jc);
+  jc.joint_name = "prbt_joint_6";
+  jc.position = 1.0;
+  gc.joint_constraints.push_back(jc);
+  req.goal_constraints.push_back(gc);
+
+  ASSERT_TRUE(ptp_->generate(req,res));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
+
+  moveit_msgs::MotionPlanResponse res_msg;
+  res.getMessage(res_msg);
+  EXPECT_TRUE(checkTrajectory(res_msg.trajectory.joint_trajectory, req, planner_limits_.getJointLimitContainer()));
+
+  // the trajectory starts with the start velocity
+  const trajectory_msgs::JointTrajectoryPoint& first_point = res_msg.trajectory.joint_trajectory.points.front();
+  EXPECT_NEAR(0.5, first_point.velocities[0], joint_velocity_tolerance_);
+  EXPECT_NEAR(0.3, first_point.velocities[2], joint_velocity_tolerance_);
+  EXPECT_NEAR(-0.5, first_point.velocities[5], joint_velocity_tolerance_);
+
+  // joint_3 returns to its start position
+  const trajectory_msgs::JointTrajectoryPoint& last_point = res_msg.trajectory.joint_trajectory.points.back();
+  EXPECT_NEAR(0.0, last_point.positions[2], joint_position_tolerance_);
+  EXPECT_NEAR(0.0, last_point.velocities[2], joint_velocity_tolerance_);
+
+  // the analytic trajectory requires a start state at rest
+  PTPTrajectory trajectory;
+  moveit_msgs::MoveItErrorCodes error_code;
+  TrajectoryGeneratorPTP ptp(robot_model_, planner_limits_);
+  EXPECT_FALSE(ptp.generateAnalytic(req, trajectory, error_code));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE, error_code.val);
+}
+
+/**
+ * @brief test the ptp trajectory generator with invalid start velocities
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testInvalidStartVel)
+{
+  planning_interface::MotionPlanResponse res;
+  planning_interface::MotionPlanRequest req;
+  testutils::createDummyRequest(robot_model_, planning_group_, req);
+  moveit_msgs::Constraints gc;
+  moveit_msgs::JointConstraint jc;
+  jc.joint_name = "prbt_joint_1";
+  jc.position = 1.5;
+  gc.joint_constraints.push_back(jc);
+  req.goal_constraints.push_back(gc);
+
+  // velocity is not given for all joints
+  req.start_state.joint_state.velocity.push_back(0.5);
+  EXPECT_FALSE(ptp_->generate(req,res));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE);
+
+  // velocity exceeds the scaled velocity limit
+  req.start_state.joint_state.velocity.assign(req.start_state.joint_state.name.size(), 0.0);
+  req.start_state.joint_state.velocity[0] = 0.8;
+  req.max_velocity_scaling_factor = 0.5;
+  EXPECT_FALSE(ptp_->generate(req,res));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE);
+
+  req.max_velocity_scaling_factor = 1.0;
+  EXPECT_TRUE(ptp_->generate(req,res));
+  EXPECT_EQ(res.error_code_.val, moveit_msgs::MoveItErrorCodes::SUCCESS);
+}
+
+/**
+ * @brief test that the sampled ptp trajectory is generated from rest and from a moving start state
+ */
+TEST_P(TrajectoryGeneratorPTPTest, testGenerateFromRestAndMovingStart)
+{
+  planning_interface::MotionPlanRequest req;
+  testutils::createDummyRequest(robot_model_, planning_group_, req);
+  moveit_msgs::Constraints gc;
+  moveit_msgs::JointConstraint jc;
+  jc.joint_name = "prbt_joint_1";
+  jc.position = 1.0;
+  gc.joint_constraints.push_back(jc);
+  jc.joint_name = "prbt_joint_2";
+  jc.position = -0.5;
+  gc.joint_constraints.push_back(jc);
+  req.goal_constraints.push_back(gc);
+
+  // from rest
+  planning_interface::MotionPlanResponse res_rest;
+  ASSERT_TRUE(ptp_->generate(req,res_rest));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res_rest.error_code_.val);
+  ASSERT_NE(nullptr, res_rest.trajectory_);
+  EXPECT_GT(res_rest.trajectory_->getWayPointCount(), 1u);
+  moveit_msgs::MotionPlanResponse res_msg;
+  res_rest.getMessage(res_msg);
+  EXPECT_TRUE(checkTrajectory(res_msg.trajectory.joint_trajectory, req, planner_limits_.getJointLimitContainer()));
+
+  // from a moving start state
+  req.start_state.joint_state.velocity.assign(req.start_state.joint_state.name.size(), 0.0);
+  req.start_state.joint_state.velocity[0] = 0.4;
+  req.start_state.joint_state.velocity[1] = 0.2;
+  planning_interface::MotionPlanResponse res_moving;
+  ASSERT_TRUE(ptp_->generate(req,res_moving));
+  EXPECT_EQ(moveit_msgs::MoveItErrorCodes::SUCCESS, res_moving.error_code_.val);
+  ASSERT_NE(nullptr, res_moving.trajectory_);
+  EXPECT_GT(res_moving.trajectory_->getWayPointCount(), 1u);
+  res_moving.getMessage(res_msg);
+  EXPECT_TRUE(checkTrajectory(res_msg.trajectory.joint_trajectory, req, planner_limits_.getJointLimitContainer()));
+  EXPECT_NEAR(0.4, res_msg.trajectory.joint_trajectory.points.front().velocities[0], joint_velocity_tolerance_);
+}
+
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "unittest_trajectory_generator_ptp");
@@ -16,6 +16,8 @@
  *
  */
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 
 #include "pilz_trajectory_generation/velocity_profile_atrap.h"
@@ -577,6 +579,147 @@ TEST(ATrapTest, Test_SetProfileStartVelocity6)
   EXPECT_NEAR(vp.Acc(3), -1.0, EPSILON);
 }
 
+TEST(ATrapTest, Test_SetProfileStartVelocityNegative)
+{
+  pilz::VelocityProfile_ATrap vp = pilz::VelocityProfile_ATrap(4,2,1);
+
+  // acceleration, constant, deceleration in negative direction
+  EXPECT_TRUE(vp.SetProfileStartVelocity(18, 3, -2));
+  EXPECT_NEAR(vp.Duration(), 6.0, EPSILON);
+  EXPECT_NEAR(vp.FirstPhaseDuration(), 1.0, EPSILON);
+  EXPECT_NEAR(vp.SecondPhaseDuration(), 1.0, EPSILON);
+  EXPECT_NEAR(vp.ThirdPhaseDuration(), 4.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(0), 18.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(0), -2.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(0.5), 16.75, EPSILON);
+  EXPECT_NEAR(vp.Acc(0.5), -2.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(1), 15.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(1), -4.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(2), 11.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(2), -4.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(2), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(3), 7.5, EPSILON);
+  EXPECT_NEAR(vp.Vel(3), -3.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(3), 1.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(6), 3.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(6), 0.0, EPSILON);
+}
+
+/**
+ * @brief Check that a motion in negative direction which reaches the maximal velocity mirrors the positive one
+ *
+ * Before the direction sign was applied, the negative motion of Test_SetProfileStartVelocityNegative had a first
+ * phase of |max_vel - vel1|/max_acc = 3s and the unsigned velocity +max_vel in the constant phase, so it moved away
+ * from the goal. The positive motion is unchanged.
+ */
+TEST(ATrapTest, Test_SetProfileStartVelocityNegativeMirrorsPositive)
+{
+  pilz::VelocityProfile_ATrap vp_positive = pilz::VelocityProfile_ATrap(4,2,1);
+  pilz::VelocityProfile_ATrap vp_negative = pilz::VelocityProfile_ATrap(4,2,1);
+
+  EXPECT_TRUE(vp_positive.SetProfileStartVelocity(-18, -3, 2));
+  EXPECT_TRUE(vp_negative.SetProfileStartVelocity(18, 3, -2));
+
+  // the phase durations of the positive motion as before, the negative motion no longer takes 3s to accelerate
+  EXPECT_NEAR(vp_positive.FirstPhaseDuration(), 1.0, EPSILON);
+  EXPECT_NEAR(vp_positive.SecondPhaseDuration(), 1.0, EPSILON);
+  EXPECT_NEAR(vp_positive.ThirdPhaseDuration(), 4.0, EPSILON);
+  EXPECT_NEAR(vp_negative.FirstPhaseDuration(), vp_positive.FirstPhaseDuration(), EPSILON);
+  EXPECT_NEAR(vp_negative.SecondPhaseDuration(), vp_positive.SecondPhaseDuration(), EPSILON);
+  EXPECT_NEAR(vp_negative.ThirdPhaseDuration(), vp_positive.ThirdPhaseDuration(), EPSILON);
+
+  for(double t = 0.0; t <= vp_positive.Duration(); t += 0.25)
+  {
+    EXPECT_NEAR(vp_negative.Pos(t), -vp_positive.Pos(t), EPSILON) << "t: " << t;
+    EXPECT_NEAR(vp_negative.Vel(t), -vp_positive.Vel(t), EPSILON) << "t: " << t;
+    EXPECT_NEAR(vp_negative.Acc(t), -vp_positive.Acc(t), EPSILON) << "t: " << t;
+  }
+
+  // the constant phase moves towards the goal with the signed maximal velocity
+  EXPECT_NEAR(vp_positive.Vel(1.5), 4.0, EPSILON);
+  EXPECT_NEAR(vp_negative.Vel(1.5), -4.0, EPSILON);
+  EXPECT_NEAR(vp_negative.Pos(vp_negative.Duration()), 3.0, EPSILON);
+}
+
+TEST(ATrapTest, Test_SetProfileStartVelocityAllDurations1)
+{
+  pilz::VelocityProfile_ATrap vp = pilz::VelocityProfile_ATrap(4,2,1);
+
+  // keep the start velocity, deceleration
+  EXPECT_TRUE(vp.SetProfileStartVelocityAllDurations(0, 10, 2, 2, 2, 2));
+  EXPECT_NEAR(vp.Duration(), 6.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(0), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(0), 2.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(2), 4.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(1), 2.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(1), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(4), 8.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(5), -1.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(6), 10.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(6), 0.0, EPSILON);
+
+  // zero start velocity equals SetProfileAllDurations
+  pilz::VelocityProfile_ATrap vp2 = pilz::VelocityProfile_ATrap(4,2,1);
+  EXPECT_TRUE(vp.SetProfileStartVelocityAllDurations(0, 10, 0, 3, 2, 4));
+  EXPECT_TRUE(vp2.SetProfileAllDurations(0, 10, 3, 2, 4));
+  EXPECT_EQ(vp, vp2);
+}
+
+TEST(ATrapTest, Test_SetProfileStartVelocityAllDurations2)
+{
+  pilz::VelocityProfile_ATrap vp = pilz::VelocityProfile_ATrap(4,2,1);
+
+  // start velocity away from the goal, the direction changes in the first phase
+  EXPECT_TRUE(vp.SetProfileStartVelocityAllDurations(0, 5.5, -1, 3, 1, 2));
+  EXPECT_NEAR(vp.Duration(), 6.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(1), -0.5, EPSILON);
+  EXPECT_NEAR(vp.Vel(1), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(1), 1.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(3), 1.5, EPSILON);
+  EXPECT_NEAR(vp.Vel(3), 2.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(4), 3.5, EPSILON);
+  EXPECT_NEAR(vp.Acc(5), -1.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(6), 5.5, EPSILON);
+  EXPECT_NEAR(vp.Vel(6), 0.0, EPSILON);
+
+  // the change of direction must obey the acceleration and the deceleration limit
+  EXPECT_FALSE(vp.SetProfileStartVelocityAllDurations(0, 5.5, -1.5, 3, 1, 2));
+  EXPECT_NEAR(vp.Pos(6), 5.5, EPSILON);
+}
+
+TEST(ATrapTest, Test_SetProfileStartVelocityAllDurations3)
+{
+  pilz::VelocityProfile_ATrap vp = pilz::VelocityProfile_ATrap(4,2,1);
+
+  // the goal is passed in the first phase, the profile returns to the goal
+  EXPECT_TRUE(vp.SetProfileStartVelocityAllDurations(0, 1, 3, 5, 1, 2));
+  EXPECT_GT(vp.Pos(3), 1.0);
+  EXPECT_LT(vp.Vel(5.5), 0.0);
+  EXPECT_NEAR(vp.Pos(8), 1.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(8), 0.0, EPSILON);
+
+  // the braking in the first phase is too short
+  EXPECT_FALSE(vp.SetProfileStartVelocityAllDurations(0, 1, 3, 2, 1, 2));
+
+  // invalid durations
+  EXPECT_FALSE(vp.SetProfileStartVelocityAllDurations(0, 1, 3, 0, 1, 2));
+  EXPECT_FALSE(vp.SetProfileStartVelocityAllDurations(0, 1, 3, 5, 1, 0));
+}
+
 /**
  * @brief Check that the clone function returns a equal profile
  *
@@ -592,6 +735,59 @@ TEST(ATrapTest, Test_Clone)
 }
 
 
+/**
+ * @brief Check that the batch evaluation of several profiles equals the evaluation of each profile,
+ * including the phase limits and the times before and after the motion
+ */
+TEST(ATrapTest, Test_BatchEvaluation)
+{
+  std::vector<pilz::VelocityProfile_ATrap> profiles;
+  profiles.push_back(pilz::VelocityProfile_ATrap(4,2,1));
+  profiles.back().SetProfile(3, 35);
+  profiles.push_back(pilz::VelocityProfile_ATrap(6,2,1.5));
+  profiles.back().SetProfile(5, -2);
+  profiles.push_back(pilz::VelocityProfile_ATrap(4,1,1));
+  profiles.back().SetProfileAllDurations(0, 10, 3, 2, 4);
+  profiles.push_back(pilz::VelocityProfile_ATrap(2,1,3));
+  profiles.back().SetProfileStartVelocity(1, 5, 0.5);
+  profiles.push_back(pilz::VelocityProfile_ATrap(2,1,1));
+  profiles.back().SetProfile(1, 1);
+
+  std::vector<double> time_samples {-1.0, 0.0, 11.0, 12.0};
+  for(double t = 0.01; t < 12.0; t += 0.01)
+  {
+    time_samples.push_back(t);
+  }
+  for(const auto& profile : profiles)
+  {
+    time_samples.push_back(profile.FirstPhaseDuration());
+    time_samples.push_back(profile.FirstPhaseDuration() + profile.SecondPhaseDuration());
+    time_samples.push_back(profile.Duration());
+  }
+  std::sort(time_samples.begin(), time_samples.end());
+
+  pilz::VelocityProfile_ATrapBatch batch(profiles);
+  Eigen::VectorXd positions(profiles.size()), velocities(profiles.size()), accelerations(profiles.size());
+  for(double t : time_samples)
+  {
+    batch.evaluate(t, positions, velocities, accelerations);
+    for(std::size_t i = 0; i < profiles.size(); ++i)
+    {
+      EXPECT_EQ(profiles[i].Pos(t), positions(i)) << "joint " << i << " at " << t;
+      EXPECT_EQ(profiles[i].Vel(t), velocities(i)) << "joint " << i << " at " << t;
+      EXPECT_EQ(profiles[i].Acc(t), accelerations(i)) << "joint " << i << " at " << t;
+    }
+  }
+
+  // the cursors start again from the beginning
+  batch.reset();
+  batch.evaluate(0.0, positions, velocities, accelerations);
+  for(std::size_t i = 0; i < profiles.size(); ++i)
+  {
+    EXPECT_EQ(profiles[i].Pos(0.0), positions(i));
+  }
+}
+
 
 int main(int argc, char **argv)
 {
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include "pilz_trajectory_generation/velocity_profile_scurve.h"
+
+// Modultest Level1 of Class VelocityProfile_SCurve
+#define EPSILON 1.0e-10
+
+TEST(SCurveTest, Test_SetProfile1)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  // can reach the maximal velocity and the maximal acceleration/deceleration
+  vp.SetProfile(0, 40);
+
+  EXPECT_NEAR(vp.FirstPhaseDuration(), 3.0, EPSILON);
+  EXPECT_NEAR(vp.SecondPhaseDuration(), 6.25, EPSILON);
+  EXPECT_NEAR(vp.ThirdPhaseDuration(), 4.5, EPSILON);
+  EXPECT_NEAR(vp.Duration(), 13.75, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(-1), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(-1), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(-1), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(0), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(0), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(0), 0.0, EPSILON);
+
+  // end of the acceleration ramp
+  EXPECT_NEAR(vp.Pos(1), 1.0/3.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(1), 1.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(1), 2.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(2), 7.0/3.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(2), 3.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(2), 2.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(3), 6.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(3), 4.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(3), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(9.25), 31.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(9.25), 4.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(9.25), 0.0, EPSILON);
+
+  // within the deceleration ramp
+  EXPECT_NEAR(vp.Pos(9.75), 33.0 - 1.0/24.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(9.75), 3.75, EPSILON);
+  EXPECT_NEAR(vp.Acc(9.75), -1.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(13.75), 40.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(13.75), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(13.75), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(15), 40.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(15), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(15), 0.0, EPSILON);
+}
+
+TEST(SCurveTest, Test_SetProfile2)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(10,2,2,1);
+
+  // neither the maximal velocity nor the maximal acceleration is reached
+  vp.SetProfile(8, 0);
+
+  double peak_vel = std::pow(4.0, 2.0/3.0);
+  double phase_duration = 2.0*std::pow(4.0, 1.0/3.0);
+
+  EXPECT_NEAR(vp.FirstPhaseDuration(), phase_duration, EPSILON);
+  EXPECT_NEAR(vp.SecondPhaseDuration(), 0.0, EPSILON);
+  EXPECT_NEAR(vp.ThirdPhaseDuration(), phase_duration, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(phase_duration/2.0), 8.0 - 2.0/3.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(phase_duration/2.0), -std::pow(4.0, 1.0/3.0), EPSILON);
+
+  EXPECT_NEAR(vp.Pos(phase_duration), 4.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(phase_duration), -peak_vel, EPSILON);
+  EXPECT_NEAR(vp.Acc(phase_duration), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(vp.Duration()), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(vp.Duration()), 0.0, EPSILON);
+}
+
+TEST(SCurveTest, Test_SetProfileEmpty)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  vp.SetProfile(3, 3);
+
+  EXPECT_EQ(vp.Duration(), 0.0);
+  EXPECT_EQ(vp.Pos(1), 3.0);
+  EXPECT_EQ(vp.Vel(1), 0.0);
+  EXPECT_EQ(vp.Acc(1), 0.0);
+}
+
+TEST(SCurveTest, Test_SetProfileDuration)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  // stretch the profile to the double duration
+  vp.SetProfileDuration(0, 40, 27.5);
+
+  EXPECT_NEAR(vp.Duration(), 27.5, EPSILON);
+  EXPECT_NEAR(vp.FirstPhaseDuration(), 6.0, EPSILON);
+  EXPECT_NEAR(vp.Pos(6), 6.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(6), 2.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(2), 0.5, EPSILON);
+  EXPECT_NEAR(vp.Pos(27.5), 40.0, EPSILON);
+
+  // cannot be faster
+  vp.SetProfileDuration(0, 40, 10);
+  EXPECT_NEAR(vp.Duration(), 13.75, EPSILON);
+}
+
+TEST(SCurveTest, Test_SetProfileAllDurations)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  // synchronize to the phases of Test_SetProfile1
+  EXPECT_TRUE(vp.SetProfileAllDurations(0, 20, 3, 6.25, 4.5));
+
+  EXPECT_NEAR(vp.Duration(), 13.75, EPSILON);
+
+  // the ramps cover the complete acceleration and deceleration phase
+  EXPECT_NEAR(vp.Acc(1.5), 4.0/3.0, EPSILON);
+  EXPECT_NEAR(vp.Pos(3), 3.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(3), 2.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(3), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(9.25), 15.5, EPSILON);
+  EXPECT_NEAR(vp.Vel(9.25), 2.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(9.25 + 2.25), -8.0/9.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(13.75), 20.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(13.75), 0.0, EPSILON);
+}
+
+TEST(SCurveTest, Test_SetProfileAllDurationsInvalid)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  // faster than the fastest profile
+  EXPECT_FALSE(vp.SetProfileAllDurations(0, 40, 3, 5, 4.5));
+  EXPECT_NEAR(vp.Duration(), 13.75, EPSILON);
+
+  // the short acceleration phase violates the jerk limit
+  EXPECT_FALSE(vp.SetProfileAllDurations(0, 1, 0.2, 10, 0.2));
+}
+
+TEST(SCurveTest, Test_SetProfileZeroStartVelocity)
+{
+  pilz::VelocityProfile_SCurve vp1 = pilz::VelocityProfile_SCurve(4,2,1,2);
+  pilz::VelocityProfile_SCurve vp2 = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  vp1.SetProfile(0, 40);
+  EXPECT_TRUE(vp2.SetProfileStartVelocity(0, 40, 0));
+
+  EXPECT_EQ(vp1.Duration(), vp2.Duration());
+  EXPECT_EQ(vp1.Pos(5), vp2.Pos(5));
+}
+
+TEST(SCurveTest, Test_SetProfileStartVelocity1)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  // accelerate from the start velocity to the maximal velocity
+  EXPECT_TRUE(vp.SetProfileStartVelocity(0, 40, 2));
+
+  EXPECT_NEAR(vp.FirstPhaseDuration(), 2.0, EPSILON);
+  EXPECT_NEAR(vp.SecondPhaseDuration(), 6.25, EPSILON);
+  EXPECT_NEAR(vp.ThirdPhaseDuration(), 4.5, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(0), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(0), 2.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(0), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(2), 6.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(2), 4.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(2), 0.0, EPSILON);
+
+  EXPECT_NEAR(vp.Pos(vp.Duration()), 40.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(vp.Duration()), 0.0, EPSILON);
+}
+
+TEST(SCurveTest, Test_SetProfileStartVelocity2)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  // the goal is within the brake distance, brake and move back
+  EXPECT_TRUE(vp.SetProfileStartVelocity(0, 1, 4));
+
+  EXPECT_NEAR(vp.FirstPhaseDuration(), 4.5, EPSILON);
+  EXPECT_NEAR(vp.Pos(4.5), 9.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(4.5), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(4.5), 0.0, EPSILON);
+
+  EXPECT_LT(vp.Vel(4.5 + vp.SecondPhaseDuration()), 0.0);
+
+  EXPECT_NEAR(vp.Pos(vp.Duration()), 1.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(vp.Duration()), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(vp.Duration()), 0.0, EPSILON);
+}
+
+TEST(SCurveTest, Test_SetProfileStartVelocityOpposite)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+
+  // start velocity points away from the goal
+  EXPECT_FALSE(vp.SetProfileStartVelocity(0, 1, -1));
+}
+
+/**
+ * @brief Sample asymmetric profiles and check the velocity, acceleration and jerk limits
+ */
+TEST(SCurveTest, Test_Limits)
+{
+  const double max_vel {1.5}, max_acc {3.0}, max_dec {1.0}, max_jerk {5.0};
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(max_vel, max_acc, max_dec, max_jerk);
+
+  for(double distance : {-0.01, 0.3, -2.0, 10.0})
+  {
+    vp.SetProfile(1.0, 1.0 + distance);
+
+    const int sample_count {2000};
+    const double dt = vp.Duration()/sample_count;
+    for(int i = 1; i <= sample_count; ++i)
+    {
+      double t = i*dt;
+      EXPECT_LE(std::fabs(vp.Vel(t)), max_vel + EPSILON);
+      EXPECT_LE(vp.Acc(t)*std::copysign(1.0, distance), max_acc + EPSILON);
+      EXPECT_GE(vp.Acc(t)*std::copysign(1.0, distance), -max_dec - EPSILON);
+      EXPECT_LE(std::fabs(vp.Acc(t) - vp.Acc(t - dt)), max_jerk*dt + EPSILON);
+    }
+    EXPECT_NEAR(vp.Pos(vp.Duration()), 1.0 + distance, EPSILON);
+  }
+}
+
+TEST(SCurveTest, Test_Clone)
+{
+  pilz::VelocityProfile_SCurve vp = pilz::VelocityProfile_SCurve(4,2,1,2);
+  vp.SetProfileStartVelocity(0, 40, 2);
+
+  std::unique_ptr<KDL::VelocityProfile> vp_clone(vp.Clone());
+
+  EXPECT_EQ(vp.Duration(), vp_clone->Duration());
+  for(double t : {0.0, 1.0, 5.0, 12.0})
+  {
+    EXPECT_EQ(vp.Pos(t), vp_clone->Pos(t));
+    EXPECT_EQ(vp.Vel(t), vp_clone->Vel(t));
+    EXPECT_EQ(vp.Acc(t), vp_clone->Acc(t));
+  }
+}
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
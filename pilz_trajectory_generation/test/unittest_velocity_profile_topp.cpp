@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2018 Pilz GmbH & Co. KG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pilz_trajectory_generation/velocity_profile_topp.h"
+
+// Modultest Level1 of Class VelocityProfile_TOPP
+#define EPSILON 1.0e-10
+
+namespace
+{
+
+/**
+ * @brief uniform grid from 0 to length with constant velocity, acceleration and deceleration limits
+ */
+void setConstantLimits(double length, double step, double max_vel, double max_acc, double max_dec,
+                       std::vector<double>& grid,
+                       std::vector<double>& max_squared_velocity,
+                       std::vector<pilz::VelocityProfile_TOPP::ConstraintMatrix>& constraints)
+{
+  const std::size_t point_count = static_cast<std::size_t>(std::round(length/step)) + 1;
+  grid.clear();
+  for(std::size_t i = 0; i < point_count; ++i)
+  {
+    grid.push_back(length*i/(point_count-1));
+  }
+  max_squared_velocity.assign(point_count, max_vel*max_vel);
+
+  pilz::VelocityProfile_TOPP::ConstraintMatrix acceleration_limits(2, 3);
+  acceleration_limits <<  1, 0, max_acc,
+                         -1, 0, max_dec;
+  constraints.assign(point_count - 1, acceleration_limits);
+}
+
+}
+
+/**
+ * @brief With constant limits the time optimal profile is the asymmetric trapezoid.
+ */
+TEST(TOPPTest, Test_SetProfileConstraintsTrapezoid)
+{
+  std::vector<double> grid, max_squared_velocity;
+  std::vector<pilz::VelocityProfile_TOPP::ConstraintMatrix> constraints;
+  setConstantLimits(40, 0.1, 4, 2, 1, grid, max_squared_velocity, constraints);
+
+  pilz::VelocityProfile_TOPP vp;
+  ASSERT_TRUE(vp.SetProfileConstraints(grid, max_squared_velocity, constraints));
+
+  EXPECT_NEAR(vp.Duration(), 13.0, 1e-8);
+
+  EXPECT_NEAR(vp.Pos(-1), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(-1), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(-1), 0.0, EPSILON);
+
+  // acceleration phase
+  EXPECT_NEAR(vp.Pos(1), 1.0, 1e-8);
+  EXPECT_NEAR(vp.Vel(1), 2.0, 1e-8);
+  EXPECT_NEAR(vp.Acc(1.5), 2.0, 1e-8);
+
+  // constant phase
+  EXPECT_NEAR(vp.Pos(6), 20.0, 1e-8);
+  EXPECT_NEAR(vp.Vel(6), 4.0, 1e-8);
+  EXPECT_NEAR(vp.Acc(6), 0.0, 1e-8);
+
+  // deceleration phase
+  EXPECT_NEAR(vp.Pos(12), 39.5, 1e-8);
+  EXPECT_NEAR(vp.Vel(12), 1.0, 1e-8);
+  EXPECT_NEAR(vp.Acc(12), -1.0, 1e-8);
+
+  EXPECT_NEAR(vp.Pos(14), 40.0, EPSILON);
+  EXPECT_NEAR(vp.Vel(14), 0.0, EPSILON);
+  EXPECT_NEAR(vp.Acc(14), 0.0, EPSILON);
+}
+
+/**
+ * @brief Slowing the profile down scales the velocity by the ratio of the durations and the acceleration by its square.
+ */
+TEST(TOPPTest, Test_SetProfileDuration)
+{
+  std::vector<double> grid, max_squared_velocity;
+  std::vector<pilz::VelocityProfile_TOPP::ConstraintMatrix> constraints;
+  setConstantLimits(40, 0.1, 4, 2, 1, grid, max_squared_velocity, constraints);
+
+  pilz::VelocityProfile_TOPP vp;
+  ASSERT_TRUE(vp.SetProfileConstraints(grid, max_squared_velocity, constraints));
+
+  // cannot be faster
+  vp.SetProfileDuration(0, 40, 10);
+  EXPECT_NEAR(vp.Duration(), 13.0, 1e-8);
+
+  vp.SetProfileDuration(0, 40, 26);
+  EXPECT_NEAR(vp.Duration(), 26.0, 1e-8);
+  EXPECT_NEAR(vp.Pos(2), 1.0, 1e-8);
+  EXPECT_NEAR(vp.Vel(2), 1.0, 1e-8);
+  EXPECT_NEAR(vp.Acc(3), 0.5, 1e-8);
+  EXPECT_NEAR(vp.Vel(12), 2.0, 1e-8);
+  EXPECT_NEAR(vp.Pos(26), 40.0, EPSILON);
+
+  // the time optimal profile is restored
+  vp.SetProfile(0, 40);
+  EXPECT_NEAR(vp.Duration(), 13.0, 1e-8);
+
+  pilz::VelocityProfile_TOPP* clone = static_cast<pilz::VelocityProfile_TOPP*>(vp.Clone());
+  EXPECT_NEAR(clone->Duration(), 13.0, 1e-8);
+  EXPECT_NEAR(clone->Vel(6), 4.0, 1e-8);
+  delete clone;
+}
+
+/**
+ * @brief A velocity bound in the middle of the path and a velocity dependent acceleration constraint are respected.
+ */
+TEST(TOPPTest, Test_SetProfileConstraintsVelocityDependent)
+{
+  std::vector<double> grid, max_squared_velocity;
+  std::vector<pilz::VelocityProfile_TOPP::ConstraintMatrix> constraints;
+  setConstantLimits(10, 0.01, 2, 1, 1, grid, max_squared_velocity, constraints);
+
+  pilz::VelocityProfile_TOPP vp;
+  ASSERT_TRUE(vp.SetProfileConstraints(grid, max_squared_velocity, constraints));
+  const double unconstrained_duration = vp.Duration();
+
+  // velocity bound of 0.5 between s = 4 and s = 6, acceleration u + 0.5*x <= 1
+  for(std::size_t i = 0; i < grid.size(); ++i)
+  {
+    if(grid[i] >= 4 - EPSILON && grid[i] <= 6 + EPSILON)
+    {
+      max_squared_velocity[i] = 0.25;
+    }
+    if(i + 1 < grid.size())
+    {
+      constraints[i].conservativeResize(3, Eigen::NoChange);
+      constraints[i].row(2) << 1, 0.5, 1;
+    }
+  }
+  ASSERT_TRUE(vp.SetProfileConstraints(grid, max_squared_velocity, constraints));
+  EXPECT_GT(vp.Duration(), unconstrained_duration);
+
+  for(double t = 0; t <= vp.Duration(); t += 0.001)
+  {
+    const double s = vp.Pos(t);
+    const double v = vp.Vel(t);
+    EXPECT_LE(v, 2.0 + 1e-8);
+    EXPECT_GE(v, -1e-8);
+    EXPECT_GE(vp.Acc(t), -1.0 - 1e-8);
+    EXPECT_LE(vp.Acc(t), 1.0 + 1e-8);
+    if(s >= 4 && s <= 6)
+    {
+      EXPECT_LE(v, 0.5 + 1e-8) << "at s = " << s;
+    }
+  }
+  EXPECT_NEAR(vp.Pos(vp.Duration()), 10.0, EPSILON);
+}
+
+/**
+ * @brief Infeasible constraints or inconsistent sizes result in an empty profile.
+ */
+TEST(TOPPTest, Test_SetProfileConstraintsInvalid)
+{
+  std::vector<double> grid, max_squared_velocity;
+  std::vector<pilz::VelocityProfile_TOPP::ConstraintMatrix> constraints;
+  setConstantLimits(1, 0.1, 1, 1, 1, grid, max_squared_velocity, constraints);
+
+  pilz::VelocityProfile_TOPP vp;
+  ASSERT_TRUE(vp.SetProfileConstraints(grid, max_squared_velocity, constraints));
+
+  // inconsistent sizes
+  std::vector<pilz::VelocityProfile_TOPP::ConstraintMatrix> too_few(constraints.begin(), constraints.end() - 1);
+  EXPECT_FALSE(vp.SetProfileConstraints(grid, max_squared_velocity, too_few));
+  EXPECT_NEAR(vp.Duration(), 0.0, EPSILON);
+  EXPECT_FALSE(vp.SetProfileConstraints(std::vector<double>(1, 0.0), std::vector<double>(1, 1.0),
+                                        std::vector<pilz::VelocityProfile_TOPP::ConstraintMatrix>()));
+
+  // the path acceleration must be at least 1, the end cannot be reached at rest
+  for(auto& constraint : constraints)
+  {
+    constraint.row(1) << -1, 0, -1;
+  }
+  EXPECT_FALSE(vp.SetProfileConstraints(grid, max_squared_velocity, constraints));
+  EXPECT_NEAR(vp.Duration(), 0.0, EPSILON);
+
+  // the path velocity must be zero, the path cannot be traversed
+  setConstantLimits(1, 0.1, 1, 1, 1, grid, max_squared_velocity, constraints);
+  max_squared_velocity.assign(grid.size(), 0.0);
+  EXPECT_FALSE(vp.SetProfileConstraints(grid, max_squared_velocity, constraints));
+  EXPECT_NEAR(vp.Pos(1), 0.0, EPSILON);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}